@@ -1,17 +1,51 @@
 {
+    "target_defaults": {
+        "include_dirs": [
+            "xmrig-override",
+            "xmrig",
+            "xmrig/3rdparty/argon2/include",
+            "xmrig/3rdparty/argon2/lib",
+            "<!(node -e \"require('nan')\")"
+        ],
+        # The default x86-64 build needs SSSE3, SSE4.1 and AES-NI, so it won't run
+        # on CPUs without SSE4.1 (AMD K10/Phenom, Intel before Penryn);
+        # CRYPTONIGHT_NATIVE=1 builds for the build host instead
+        "cflags_c": [
+            '<!@(uname -a | grep "aarch64" >/dev/null && echo "-march=armv8-a+crypto -flax-vector-conversions -DXMRIG_ARM=1" || (uname -a | grep "armv7" >/dev/null && echo "-mfpu=neon -flax-vector-conversions -DXMRIG_ARM=1" || (test -n "$CRYPTONIGHT_NATIVE" && echo "-march=native" || echo "-march=x86-64 -mtune=generic -mssse3 -msse4.1 -maes")))',
+            '<!@(uname -a | grep "x86_64" >/dev/null && echo "-DHAVE_SSE2 -DHAVE_SSSE3 -DHAVE_XOP -DHAVE_AVX2 -DHAVE_AVX512F" || echo)',
+            "-std=gnu11      -fPIC -DNDEBUG -Ofast -fno-fast-math -w"
+        ],
+        "cflags_cc": [
+            '<!@(uname -a | grep "aarch64" >/dev/null && echo "-march=armv8-a+crypto -flax-vector-conversions -DXMRIG_ARM=1" || (uname -a | grep "armv7" >/dev/null && echo "-mfpu=neon -flax-vector-conversions -DXMRIG_ARM=1" || (test -n "$CRYPTONIGHT_NATIVE" && echo "-march=native" || echo "-march=x86-64 -mtune=generic -mssse3 -msse4.1 -maes")))',
+            "-std=gnu++11 -s -fPIC -DNDEBUG -Ofast -fno-fast-math -fexceptions -fno-rtti -Wno-class-memaccess -w"
+        ],
+        "cflags_cc!": [ "-fno-exceptions" ]
+    },
     "targets": [
         {
             "target_name": "cryptonight-hashing",
+            "dependencies": [
+                "cryptonight-hashing-ssse3",
+                "cryptonight-hashing-xop",
+                "cryptonight-hashing-avx2",
+                "cryptonight-hashing-avx512f"
+            ],
             "sources": [
                 '<!@(uname -a | grep "x86_64" >/dev/null && echo "xmrig/crypto/cn/asm/cn_main_loop.S" || echo)',
                 '<!@(uname -a | grep "x86_64" >/dev/null && echo "xmrig/crypto/cn/asm/CryptonightR_template.S" || echo)',
                 '<!@(uname -a | grep "x86_64" >/dev/null && echo "xmrig/crypto/cn/r/CryptonightR_gen.cpp" || echo)',
-                '<!@(uname -a | grep "x86_64" >/dev/null && (grep avx2 /proc/cpuinfo >/dev/null && echo "xmrig/crypto/cn/gpu/cn_gpu_avx.cpp" || echo) || echo)',
-                '<!@(uname -a | grep "x86_64" >/dev/null && echo "xmrig/crypto/cn/gpu/cn_gpu_ssse3.cpp" || echo)',
+                '<!@(uname -a | grep "x86_64" >/dev/null && echo "xmrig/crypto/cn/CnMainLoop.cpp" || echo)',
                 '<!@(uname -a | grep "x86_64" >/dev/null || echo "xmrig/crypto/cn/gpu/cn_gpu_arm.cpp" || echo)',
                 "multihashing.cc",
                 "c29s.cc",
                 "c29v.cc",
+                "hash_ctx.cc",
+                "workers.cc",
+                "share.cc",
+                "tune.cc",
+                "rx_snapshot.cc",
+                "rx_shared.cc",
+                "xmrig-override/backend/cpu/Cpu.cpp",
                 "xmrig/crypto/cn/c_blake256.c",
                 "xmrig/crypto/cn/c_groestl.c",
                 "xmrig/crypto/cn/c_jh.c",
@@ -19,13 +53,14 @@
                 "xmrig/crypto/common/keccak.cpp",
                 "xmrig-override/crypto/common/Algorithm.cpp",
                 "xmrig/crypto/cn/CnCtx.cpp",
+                "xmrig/crypto/cn/CnRCache.cpp",
                 "xmrig/crypto/cn/CnHash.cpp",
                 "xmrig/crypto/common/MemoryPool.cpp",
                 "xmrig/crypto/common/VirtualMemory.cpp",
                 "xmrig/crypto/common/VirtualMemory_unix.cpp",
 
                 "xmrig/crypto/randomx/aes_hash.cpp",
-                "xmrig/crypto/randomx/argon2_ref.c",
+                "xmrig/crypto/randomx/argon2_cache.cpp",
                 "xmrig/crypto/randomx/bytecode_machine.cpp",
                 "xmrig/crypto/randomx/dataset.cpp",
                 "xmrig/crypto/randomx/soft_aes.cpp",
@@ -34,9 +69,9 @@
                 "xmrig/crypto/randomx/allocator.cpp",
                 "xmrig/crypto/randomx/randomx.cpp",
                 "xmrig/crypto/randomx/superscalar.cpp",
+                "xmrig/crypto/randomx/timing.cpp",
                 "xmrig/crypto/randomx/vm_compiled.cpp",
                 "xmrig/crypto/randomx/vm_interpreted_light.cpp",
-                "xmrig/crypto/randomx/argon2_core.c",
                 "xmrig/crypto/randomx/blake2_generator.cpp",
                 "xmrig/crypto/randomx/instructions_portable.cpp",
                 "xmrig/crypto/randomx/reciprocal.c",
@@ -53,11 +88,7 @@
                 "xmrig/3rdparty/argon2/lib/impl-select.c",
                 "xmrig/3rdparty/argon2/lib/blake2/blake2.c",
                 '<!@(uname -a | grep "x86_64" >/dev/null && echo "xmrig/3rdparty/argon2/arch/x86_64/lib/argon2-arch.c" || echo)',
-                '<!@(uname -a | grep "x86_64" >/dev/null && echo "xmrig/3rdparty/argon2/arch/x86_64/lib/argon2-avx2.c" || echo)',
-                '<!@(uname -a | grep "x86_64" >/dev/null && echo "xmrig/3rdparty/argon2/arch/x86_64/lib/argon2-avx512f.c" || echo)',
                 '<!@(uname -a | grep "x86_64" >/dev/null && echo "xmrig/3rdparty/argon2/arch/x86_64/lib/argon2-sse2.c" || echo)',
-                '<!@(uname -a | grep "x86_64" >/dev/null && echo "xmrig/3rdparty/argon2/arch/x86_64/lib/argon2-ssse3.c" || echo)',
-                '<!@(uname -a | grep "x86_64" >/dev/null && echo "xmrig/3rdparty/argon2/arch/x86_64/lib/argon2-xop.c" || echo)',
                 '<!@(uname -a | grep "x86_64" >/dev/null && echo "xmrig/3rdparty/argon2/arch/x86_64/lib/cpu-flags.c" || echo)',
                 '<!@(uname -a | grep "x86_64" >/dev/null || echo "xmrig/3rdparty/argon2/arch/generic/lib/argon2-arch.c" || echo)',
 
@@ -72,29 +103,46 @@
                 '<!@(uname -a | grep "x86_64" >/dev/null && echo "xmrig/crypto/astrobwt/Salsa20.cpp" || echo)',
                 "xmrig/crypto/astrobwt/sha3.cpp",
                 '<!@(uname -a | grep "x86_64" >/dev/null || echo "xmrig/crypto/astrobwt/salsa20_ref/salsa20.c" || echo)',
+            ]
+        },
+        # Kernels for instruction sets picked at runtime, built with the flags they need
+        {
+            "target_name": "cryptonight-hashing-ssse3",
+            "type": "static_library",
+            "sources": [
+                '<!@(uname -a | grep "x86_64" >/dev/null && echo "xmrig/crypto/cn/gpu/cn_gpu_ssse3.cpp" || echo)',
+                '<!@(uname -a | grep "x86_64" >/dev/null && echo "xmrig/3rdparty/argon2/arch/x86_64/lib/argon2-ssse3.c" || echo)'
+            ],
+            "cflags": [ "-mssse3" ]
+        },
+        {
+            "target_name": "cryptonight-hashing-xop",
+            "type": "static_library",
+            "sources": [
+                '<!@(uname -a | grep "x86_64" >/dev/null && echo "xmrig/3rdparty/argon2/arch/x86_64/lib/argon2-xop.c" || echo)'
             ],
-            "include_dirs": [
-                "xmrig-override",
-                "xmrig",
-                "xmrig/3rdparty/argon2/include",
-                "xmrig/3rdparty/argon2/lib",
-                "<!(node -e \"require('nan')\")"
+            "cflags": [ "-mxop" ]
+        },
+        {
+            "target_name": "cryptonight-hashing-avx2",
+            "type": "static_library",
+            "sources": [
+                '<!@(uname -a | grep "x86_64" >/dev/null && echo "xmrig/crypto/cn/gpu/cn_gpu_avx.cpp" || echo)',
+                '<!@(uname -a | grep "x86_64" >/dev/null && echo "xmrig/crypto/cn/vaes/cn_vaes_avx2.cpp" || echo)',
+                '<!@(uname -a | grep "x86_64" >/dev/null && echo "xmrig/crypto/common/keccak_avx2.cpp" || echo)',
+                '<!@(uname -a | grep "x86_64" >/dev/null && echo "xmrig/3rdparty/argon2/arch/x86_64/lib/argon2-avx2.c" || echo)'
             ],
-            "cflags_c": [
-                '<!@(uname -a | grep "aarch64" >/dev/null && echo "-march=armv8-a+crypto -flax-vector-conversions -DXMRIG_ARM=1" || (uname -a | grep "armv7" >/dev/null && echo "-mfpu=neon -flax-vector-conversions -DXMRIG_ARM=1" || echo "-march=native"))',
-                '<!@(grep Intel /proc/cpuinfo >/dev/null && echo -DCPU_INTEL || (grep AMD /proc/cpuinfo >/dev/null && (test `awk \'/cpu family/ && $NF~/^[0-9]*$/ {print $NF}\' /proc/cpuinfo | head -n1` -ge 23 && echo -DCPU_AMD || echo -DCPU_AMD_OLD) || echo))',
-                '<!@(grep avx2 /proc/cpuinfo >/dev/null && echo -DHAVE_AVX2 || echo)',
-                '<!@(grep sse2 /proc/cpuinfo >/dev/null && echo -DHAVE_SSE2 || echo)',
-                '<!@(grep ssse3 /proc/cpuinfo >/dev/null && echo -DHAVE_SSSE3 || echo)',
-                '<!@(grep avx512f /proc/cpuinfo >/dev/null && echo -DHAVE_AVX512F || echo)',
-                '<!@(grep xop /proc/cpuinfo >/dev/null && echo -DHAVE_XOP || echo)',
-                "-std=gnu11      -fPIC -DNDEBUG -Ofast -fno-fast-math -w"
+            "cflags": [ "-mavx2", "-mvaes" ]
+        },
+        {
+            "target_name": "cryptonight-hashing-avx512f",
+            "type": "static_library",
+            "sources": [
+                '<!@(uname -a | grep "x86_64" >/dev/null && echo "xmrig/crypto/cn/vaes/cn_vaes_avx512.cpp" || echo)',
+                '<!@(uname -a | grep "x86_64" >/dev/null && echo "xmrig/crypto/common/keccak_avx512.cpp" || echo)',
+                '<!@(uname -a | grep "x86_64" >/dev/null && echo "xmrig/3rdparty/argon2/arch/x86_64/lib/argon2-avx512f.c" || echo)'
             ],
-            "cflags_cc": [
-                '<!@(uname -a | grep "aarch64" >/dev/null && echo "-march=armv8-a+crypto -flax-vector-conversions -DXMRIG_ARM=1" || (uname -a | grep "armv7" >/dev/null && echo "-mfpu=neon -flax-vector-conversions -DXMRIG_ARM=1" || echo "-march=native"))',
-                '<!@(grep Intel /proc/cpuinfo >/dev/null && echo -DCPU_INTEL || (grep AMD /proc/cpuinfo >/dev/null && (test `awk \'/cpu family/ && $NF~/^[0-9]*$/ {print $NF}\' /proc/cpuinfo | head -n1` -ge 23 && echo -DCPU_AMD || echo -DCPU_AMD_OLD) || echo))',
-                "-std=gnu++11 -s -fPIC -DNDEBUG -Ofast -fno-fast-math -fexceptions -fno-rtti -Wno-class-memaccess -w"
-            ]
+            "cflags": [ "-mavx512f", "-mvaes" ]
         }
     ]
 }
@@ -7,10 +7,10 @@
 #define EDGE_BLOCK_MASK (EDGE_BLOCK_SIZE - 1)
 #define NEDGES ((uint32_t)1 << EDGEBITS)
 #define EDGEMASK ((uint32_t)NEDGES - 1)
-static uint64_t v0;
-static uint64_t v1;
-static uint64_t v2;
-static uint64_t v3;
+static thread_local uint64_t v0;
+static thread_local uint64_t v1;
+static thread_local uint64_t v2;
+static thread_local uint64_t v3;
 static uint64_t rotl(uint64_t x, uint64_t b) {
 	return (x << b) | (x >> (64 - b));
 }
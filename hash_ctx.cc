@@ -0,0 +1,618 @@
+#include "hash_ctx.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "crypto/common/VirtualMemory.h"
+#include "crypto/cn/CnAlgo.h"
+#include "crypto/cn/CnCtx.h"
+#include "crypto/cn/CryptoNight.h"
+#include "crypto/randomx/configuration.h"
+#include "crypto/defyx/defyx.h"
+#include "rx_shared.h"
+#include "rx_snapshot.h"
+#include "tune.h"
+
+
+// RandomX cache for one seed hash. It is never modified after construction:
+// a new seed gets a new cache and the old one goes away with its last user.
+// It is read from a snapshot if there is one, else built and snapshotted. When
+// publishing it is built in shared memory, attached caches are mapped from there.
+struct RxCache {
+    RxCache(const int variant, const RandomX_ConfigurationBase* config, const uint8_t* seed_hash_data) {
+        memcpy(seed_hash, seed_hash_data, sizeof(seed_hash));
+        cache = rx_shared::create_cache(variant, config, shared);
+        if (cache) {
+            tune::argon2();
+            randomx_init_cache(cache, seed_hash, sizeof(seed_hash));
+            rx_shared::publish_cache(variant, seed_hash, cache, shared);
+            rx_snapshot::save(variant, config, seed_hash, cache);
+            return;
+        }
+
+        if (rx_snapshot::load(variant, config, seed_hash, snapshot)) {
+            cache = snapshot.cache;
+            return;
+        }
+
+        cache = randomx_alloc_cache(static_cast<randomx_flags>(RANDOMX_FLAG_JIT | RANDOMX_FLAG_LARGE_PAGES), config);
+        if (!cache) {
+            cache = randomx_alloc_cache(RANDOMX_FLAG_JIT, config);
+        }
+        if (!cache) {
+            cache = randomx_alloc_cache(RANDOMX_FLAG_DEFAULT, config);
+        }
+        if (!cache) throw std::runtime_error("Can't allocate RandomX cache");
+
+        tune::argon2();
+        randomx_init_cache(cache, seed_hash, sizeof(seed_hash));
+        rx_snapshot::save(variant, config, seed_hash, cache);
+    }
+
+    RxCache(randomx_cache* cache, const uint8_t* seed_hash_data, const rx_shared::Segment& shared) : cache(cache), shared(shared) {
+        memcpy(seed_hash, seed_hash_data, sizeof(seed_hash));
+    }
+
+    ~RxCache() {
+        if (snapshot.cache) {
+            rx_snapshot::unmap(snapshot);
+        } else {
+            randomx_release_cache(cache);
+            rx_shared::unmap(shared);
+        }
+    }
+
+    randomx_cache* cache;
+    uint8_t seed_hash[32];
+    rx_snapshot::Mapped snapshot;
+    rx_shared::Segment shared;
+};
+
+// RandomX dataset for one seed hash, read only once built: the full one, or
+// its first items only for light VMs computing the others. It keeps the cache
+// it was built from for those VMs and the VM flags tuner. Like its cache it is
+// built in shared memory when publishing, attached ones are mapped from there.
+struct RxDataset {
+    RxDataset(const int variant, const std::shared_ptr<RxCache>& cache, const unsigned long items, const bool full) : cache(cache), items(items), full(full) {
+        dataset = rx_shared::create_dataset(variant, cache->shared.generation, items, shared);
+        if (dataset) return;
+
+        dataset = randomx_alloc_partial_dataset(RANDOMX_FLAG_LARGE_PAGES, items);
+        if (!dataset || !randomx_get_dataset_memory(dataset)) {
+            if (dataset) randomx_release_dataset(dataset);
+            dataset = randomx_alloc_partial_dataset(RANDOMX_FLAG_DEFAULT, items);
+        }
+        if (!dataset) throw std::runtime_error("Can't allocate RandomX dataset");
+    }
+
+    RxDataset(const std::shared_ptr<RxCache>& cache, randomx_dataset* dataset, const unsigned long items, const bool full, const rx_shared::Segment& shared) :
+        dataset(dataset), cache(cache), items(items), full(full), shared(shared) {}
+
+    ~RxDataset() {
+        randomx_release_dataset(dataset);
+        rx_shared::unmap(shared);
+    }
+
+    randomx_dataset* dataset;
+    std::shared_ptr<RxCache> cache;
+    const unsigned long items;
+    const bool full;
+    rx_shared::Segment shared;
+};
+
+namespace {
+
+// Most recently used caches of each variant, first is newest, handed out to
+// threads that need a new seed. Keeping more than one lets shares of the last
+// epoch verify without a rebuild while the next one is in use or being built.
+std::mutex rx_cache_mutex;
+std::list<std::shared_ptr<RxCache>> rx_cache[xmrig::Algorithm::MAX];
+size_t rx_cache_size = 2;
+std::mutex rx_init_mutex[xmrig::Algorithm::MAX]; // one cache init per variant at a time
+
+std::once_flag rx_config_applied[xmrig::Algorithm::MAX];
+
+// Config of variant, applied the first time. Caches, datasets and VMs carry it,
+// so threads hash different variants at the same time.
+const RandomX_ConfigurationBase* rx_config(const int variant) {
+    RandomX_ConfigurationBase* config;
+    switch (variant) {
+        case 0:  config = &RandomX_MoneroConfig;  break;
+        case 1:  config = &RandomX_ScalaConfig;   break;
+        case 2:  config = &RandomX_ArqmaConfig;   break;
+        case 17: config = &RandomX_WowneroConfig; break;
+        case 18: config = &RandomX_LokiConfig;    break;
+        case 19: config = &RandomX_VConfig;       break;
+        default: throw std::domain_error("Unknown RandomX algo");
+    }
+    std::call_once(rx_config_applied[variant], [config]() { config->Apply(); });
+    return config;
+}
+
+bool same_seed(const std::shared_ptr<RxCache>& cache, const uint8_t* seed_hash) {
+    return cache && memcmp(cache->seed_hash, seed_hash, sizeof(cache->seed_hash)) == 0;
+}
+
+// Fast mode of one variant: the dataset VMs use, built on a background thread
+// for the newest seed. A new seed's dataset replaces the old one once ready,
+// until then its hashes use light VMs. With a memory budget smaller than the
+// dataset only its first items are built (hybrid mode).
+struct RxFast {
+    std::atomic<bool> enabled;
+    std::atomic<unsigned long> items; // dataset items to build
+    std::shared_ptr<RxDataset> dataset;
+    std::shared_ptr<RxCache> pending;  // seed to build next
+    std::shared_ptr<RxCache> building; // seed being built
+    unsigned long building_items = 0;
+    std::thread builder;
+};
+
+std::mutex rx_fast_mutex;
+RxFast rx_fast[xmrig::Algorithm::MAX];
+std::atomic<bool> rx_fast_stop(false);
+
+// Items each dataset init thread fills before checking whether fast mode was
+// turned off or resized meanwhile
+const unsigned long RX_DATASET_CHUNK = 16384;
+
+// Hybrid datasets are sized in large pages
+const unsigned long RX_DATASET_ITEMS_ALIGN = 2 * 1024 * 1024 / RANDOMX_DATASET_ITEM_SIZE;
+
+// Dataset items of variant that fit in memory bytes
+unsigned long rx_dataset_items(const int variant, const size_t memory) {
+    const unsigned long items = randomx_dataset_item_count(rx_config(variant));
+    if (memory / RANDOMX_DATASET_ITEM_SIZE >= items) return items;
+    return memory / RANDOMX_DATASET_ITEM_SIZE / RX_DATASET_ITEMS_ALIGN * RX_DATASET_ITEMS_ALIGN;
+}
+
+void fill_dataset(const int variant, RxDataset* dataset, unsigned long start, const unsigned long end) {
+    const RxFast& fast = rx_fast[variant];
+    while (start < end && fast.enabled && fast.items == dataset->items && !rx_fast_stop) {
+        const unsigned long count = std::min(RX_DATASET_CHUNK, end - start);
+        randomx_init_dataset(dataset->dataset, dataset->cache->cache, start, count);
+        start += count;
+    }
+}
+
+// Returns nullptr if fast mode was turned off or resized meanwhile
+std::shared_ptr<RxDataset> build_dataset(const int variant, const std::shared_ptr<RxCache>& cache, const unsigned long items) {
+    const bool full = items == randomx_dataset_item_count(rx_config(variant));
+    std::shared_ptr<RxDataset> dataset = std::make_shared<RxDataset>(variant, cache, items, full);
+
+    const unsigned count = std::max(std::thread::hardware_concurrency(), 1u);
+    std::vector<std::thread> threads;
+    for (unsigned i = 1; i < count; ++i) {
+        threads.emplace_back(fill_dataset, variant, dataset.get(), items * i / count, items * (i + 1) / count);
+    }
+    fill_dataset(variant, dataset.get(), 0, items / count);
+    for (std::thread& thread : threads) thread.join();
+
+    return rx_fast[variant].enabled && rx_fast[variant].items == items && !rx_fast_stop ? dataset : nullptr;
+}
+
+void build_datasets(const int variant) {
+    RxFast& fast = rx_fast[variant];
+    for (;;) {
+        std::shared_ptr<RxCache> cache;
+        unsigned long items;
+        {
+            std::lock_guard<std::mutex> lock(rx_fast_mutex);
+            fast.building = fast.pending;
+            fast.pending.reset();
+            if (!fast.building) return;
+            cache = fast.building;
+            items = fast.building_items = fast.items;
+        }
+
+        std::shared_ptr<RxDataset> dataset;
+        try {
+            dataset = build_dataset(variant, cache, items);
+        } catch (const std::exception&) {
+            // Out of memory: stay in light mode
+        }
+
+        std::lock_guard<std::mutex> lock(rx_fast_mutex);
+        if (dataset && fast.enabled && fast.items == items) {
+            fast.dataset = dataset;
+            if (dataset->shared.data) rx_shared::publish_dataset(variant, dataset->shared);
+        }
+    }
+}
+
+// Starts building the dataset for cache unless it is there or on its way.
+// Must be called under rx_fast_mutex.
+void start_dataset(const int variant, const std::shared_ptr<RxCache>& cache) {
+    RxFast& fast = rx_fast[variant];
+    if (!fast.enabled || !fast.items || rx_fast_stop) return;
+    if (fast.dataset && fast.dataset->cache == cache) return;
+    if (fast.building == cache && fast.building_items == fast.items) return;
+
+    fast.pending = cache;
+    if (!fast.building) {
+        if (fast.builder.joinable()) fast.builder.join(); // it has returned
+        fast.builder = std::thread(build_datasets, variant);
+    }
+}
+
+struct StopBuilders {
+    ~StopBuilders() {
+        rx_fast_stop = true;
+        for (RxFast& fast : rx_fast) {
+            if (fast.builder.joinable()) fast.builder.join();
+        }
+    }
+} stop_builders;
+
+// Moves the cache for seed_hash to the front of the list and returns it, or
+// nullptr if there is none. Must be called under rx_cache_mutex.
+std::shared_ptr<RxCache> find_rx_cache(const int variant, const uint8_t* seed_hash) {
+    std::list<std::shared_ptr<RxCache>>& caches = rx_cache[variant];
+    for (std::list<std::shared_ptr<RxCache>>::iterator it = caches.begin(); it != caches.end(); ++it) {
+        if (same_seed(*it, seed_hash)) {
+            caches.splice(caches.begin(), caches, it);
+            return caches.front();
+        }
+    }
+    return nullptr;
+}
+
+// Drops the least recently used caches over rx_cache_size. Threads still
+// bound to one keep it alive until they switch. Must be called under rx_cache_mutex.
+void trim_rx_cache(std::list<std::shared_ptr<RxCache>>& caches) {
+    while (caches.size() > rx_cache_size) caches.pop_back();
+}
+
+std::shared_ptr<RxCache> get_rx_cache(const int variant, const uint8_t* seed_hash) {
+    {
+        std::lock_guard<std::mutex> lock(rx_cache_mutex);
+        std::shared_ptr<RxCache> cache = find_rx_cache(variant, seed_hash);
+        if (cache) return cache;
+    }
+
+    std::lock_guard<std::mutex> init_lock(rx_init_mutex[variant]);
+    {
+        std::lock_guard<std::mutex> lock(rx_cache_mutex);
+        std::shared_ptr<RxCache> cache = find_rx_cache(variant, seed_hash);
+        if (cache) return cache;
+    }
+
+    std::shared_ptr<RxCache> cache = std::make_shared<RxCache>(variant, rx_config(variant), seed_hash);
+    {
+        std::lock_guard<std::mutex> lock(rx_cache_mutex);
+        rx_cache[variant].push_front(cache);
+        trim_rx_cache(rx_cache[variant]);
+    }
+
+    std::lock_guard<std::mutex> lock(rx_fast_mutex);
+    start_dataset(variant, cache);
+    return cache;
+}
+
+// Attached shared memory of one variant: the announced cache, which is also
+// first in rx_cache, and the announced dataset
+struct RxAttached {
+    std::atomic<uint64_t> current; // rx_shared::current() they are for
+    std::shared_ptr<RxCache> cache;
+    std::shared_ptr<RxDataset> dataset;
+};
+
+std::mutex rx_attach_mutex;
+RxAttached rx_attached[xmrig::Algorithm::MAX];
+
+// Maps what was announced since the last call, a single atomic read if nothing was
+void attach_rx_shared(const int variant) {
+    RxAttached& attached = rx_attached[variant];
+    const uint64_t current = rx_shared::mode(variant) == rx_shared::ATTACH ? rx_shared::current(variant) : 0;
+    if (current == attached.current) return;
+
+    std::lock_guard<std::mutex> lock(rx_attach_mutex);
+    if (current == attached.current) return;
+
+    const RandomX_ConfigurationBase* config = rx_config(variant);
+    const uint32_t cache_generation = current >> 32;
+    const uint32_t dataset_generation = current & 0xFFFFFFFF;
+    if (!attached.cache || attached.cache->shared.generation != cache_generation) {
+        attached.cache.reset();
+        attached.dataset.reset();
+
+        rx_shared::Segment segment;
+        uint8_t seed_hash[32];
+        randomx_cache* cache = cache_generation ? rx_shared::attach_cache(variant, config, cache_generation, seed_hash, segment) : nullptr;
+        if (cache) {
+            attached.cache = std::make_shared<RxCache>(cache, seed_hash, segment);
+
+            // Replaces a cache built here for the seed
+            std::lock_guard<std::mutex> lock(rx_cache_mutex);
+            std::list<std::shared_ptr<RxCache>>& caches = rx_cache[variant];
+            caches.remove_if([&seed_hash](const std::shared_ptr<RxCache>& c) { return same_seed(c, seed_hash); });
+            caches.push_front(attached.cache);
+            trim_rx_cache(caches);
+        }
+    }
+
+    if (!attached.cache || !dataset_generation) {
+        attached.dataset.reset();
+    } else if (!attached.dataset || attached.dataset->shared.generation != dataset_generation) {
+        rx_shared::Segment segment;
+        unsigned long items;
+        randomx_dataset* dataset = rx_shared::attach_dataset(variant, config, dataset_generation, cache_generation, items, segment);
+        attached.dataset.reset();
+        if (dataset) {
+            const bool full = items == randomx_dataset_item_count(config);
+            attached.dataset = std::make_shared<RxDataset>(attached.cache, dataset, items, full, segment);
+        }
+    }
+    attached.current = current;
+}
+
+// Dataset for seed_hash if shared memory or fast mode has it ready
+std::shared_ptr<RxDataset> get_rx_dataset(const int variant, const uint8_t* seed_hash) {
+    if (rx_attached[variant].current) {
+        std::lock_guard<std::mutex> lock(rx_attach_mutex);
+        const std::shared_ptr<RxDataset>& dataset = rx_attached[variant].dataset;
+        if (dataset && same_seed(dataset->cache, seed_hash)) return dataset;
+    }
+    if (!rx_fast[variant].enabled) return nullptr;
+
+    std::lock_guard<std::mutex> lock(rx_fast_mutex);
+    const std::shared_ptr<RxDataset>& dataset = rx_fast[variant].dataset;
+    return dataset && same_seed(dataset->cache, seed_hash) ? dataset : nullptr;
+}
+
+}
+
+HashCtx& HashCtx::get() {
+    static thread_local HashCtx ctx;
+    return ctx;
+}
+
+HashCtx::~HashCtx() {
+    for (randomx_vm* vm : m_rx_vm) {
+        if (vm) randomx_destroy_vm(vm);
+    }
+    for (randomx_vm* vm : m_rx_fast_vm) {
+        if (vm) randomx_destroy_vm(vm);
+    }
+    if (m_ctx_count) xmrig::CnCtx::release(m_ctx, m_ctx_count);
+}
+
+size_t HashCtx::scratchpad_size(const xmrig::Algorithm::Id algo) {
+    switch (algo) {
+        case xmrig::Algorithm::AR2_CHUKWA:
+            return 512 * 1024;
+        case xmrig::Algorithm::AR2_WRKZ:
+            return 256 * 1024;
+        case xmrig::Algorithm::ASTROBWT_DERO:
+            return 20 * 1024 * 1024;
+        default:
+            break;
+    }
+
+    if (xmrig::Algorithm::family(algo) == xmrig::Algorithm::RANDOM_X) {
+        return RANDOMX_SCRATCHPAD_L3_MAX_SIZE;
+    }
+    return xmrig::CnAlgo<>::memory(algo);
+}
+
+bool HashCtx::rx_valid(const int variant) {
+    switch (variant) {
+        case 0: case 1: case 2: case 17: case 18: case 19:
+            return true;
+        default:
+            return false;
+    }
+}
+
+uint8_t* HashCtx::scratchpad(const xmrig::Algorithm::Id algo) {
+    return memory(scratchpad_size(algo));
+}
+
+uint8_t* HashCtx::memory(const size_t size) {
+    if (m_memory && m_memory->size() >= size) return m_memory->scratchpad();
+
+    // VMs keep a pointer to the old scratchpad, recreate them on next use
+    for (randomx_vm*& vm : m_rx_vm) {
+        if (vm) randomx_destroy_vm(vm);
+        vm = nullptr;
+    }
+    for (randomx_vm*& vm : m_rx_fast_vm) {
+        if (vm) randomx_destroy_vm(vm);
+        vm = nullptr;
+    }
+    for (std::shared_ptr<RxCache>& cache : m_rx_cache) cache.reset();
+    for (std::shared_ptr<RxDataset>& dataset : m_rx_dataset) dataset.reset();
+
+    m_memory.reset();
+    m_memory.reset(new xmrig::VirtualMemory(size, true, false, 0, 4096));
+    return m_memory->scratchpad();
+}
+
+cryptonight_ctx** HashCtx::cn(const xmrig::Algorithm::Id algo, const size_t ways) {
+    if (ways < 1 || ways > MAX_WAYS) throw std::domain_error("Unsupported number of ways");
+
+    const size_t size = scratchpad_size(algo);
+    uint8_t* scratchpad = memory(size * ways);
+    if (m_ctx_count < ways) {
+        xmrig::CnCtx::create(m_ctx + m_ctx_count, scratchpad, size, ways - m_ctx_count);
+        m_ctx_count = ways;
+    }
+
+    // Contexts are shared by all algorithms, so lay them out for this one
+    for (size_t i = 0; i < ways; ++i) {
+        m_ctx[i]->memory = scratchpad + i * size;
+    }
+
+    // CryptonightR code generated into ctx[0] by single and double hash
+    // kernels is different, so it can't be reused across them
+    if (ways != m_ctx_ways) {
+        m_ctx[0]->generated_code_data.algo = xmrig::Algorithm::INVALID;
+        m_ctx_ways = ways;
+    }
+    return m_ctx;
+}
+
+randomx_vm* HashCtx::rx_vm(const int variant, const uint8_t* seed_hash, const std::shared_ptr<RxDataset>& dataset) {
+    uint8_t* memory = scratchpad(xmrig::Algorithm::RX_0);
+    if (m_rx_vm[variant] && same_seed(m_rx_cache[variant], seed_hash) && m_rx_dataset[variant] == dataset) return m_rx_vm[variant];
+
+    std::shared_ptr<RxCache> cache = dataset ? dataset->cache : get_rx_cache(variant, seed_hash);
+    randomx_dataset* partial = dataset ? dataset->dataset : nullptr;
+    randomx_vm*& vm = m_rx_vm[variant];
+    if (!vm) {
+        const int flags = tune::rx_flags(variant, cache->cache, memory);
+        vm = randomx_create_vm(static_cast<randomx_flags>(flags), cache->cache, partial, memory);
+        if (!vm) {
+            vm = randomx_create_vm(static_cast<randomx_flags>(flags & ~RANDOMX_FLAG_LARGE_PAGES), cache->cache, partial, memory);
+        }
+        if (!vm) {
+            // No executable memory for the JIT, fall back to the interpreter
+            vm = randomx_create_vm(static_cast<randomx_flags>(flags & ~(RANDOMX_FLAG_LARGE_PAGES | RANDOMX_FLAG_JIT)), cache->cache, partial, memory);
+        }
+        if (!vm) throw std::runtime_error("Can't create RandomX VM");
+    }
+    else {
+        randomx_vm_set_cache(vm, cache->cache);
+        if (partial) randomx_vm_set_dataset(vm, partial);
+    }
+    m_rx_cache[variant] = cache;
+    m_rx_dataset[variant] = dataset;
+    return vm;
+}
+
+randomx_vm* HashCtx::rx_fast_vm(const int variant, const std::shared_ptr<RxDataset>& dataset) {
+    uint8_t* memory = scratchpad(xmrig::Algorithm::RX_0);
+    if (m_rx_fast_vm[variant] && m_rx_dataset[variant] == dataset) return m_rx_fast_vm[variant];
+
+    randomx_vm*& vm = m_rx_fast_vm[variant];
+    if (!vm) {
+        const int flags = tune::rx_flags(variant, dataset->cache->cache, memory) | RANDOMX_FLAG_FULL_MEM;
+
+        vm = randomx_create_vm(static_cast<randomx_flags>(flags), nullptr, dataset->dataset, memory);
+        if (!vm) {
+            vm = randomx_create_vm(static_cast<randomx_flags>(flags & ~RANDOMX_FLAG_LARGE_PAGES), nullptr, dataset->dataset, memory);
+        }
+        if (!vm) {
+            vm = randomx_create_vm(static_cast<randomx_flags>(flags & ~(RANDOMX_FLAG_LARGE_PAGES | RANDOMX_FLAG_JIT)), nullptr, dataset->dataset, memory);
+        }
+        if (!vm) throw std::runtime_error("Can't create RandomX VM");
+    }
+    else {
+        randomx_vm_set_dataset(vm, dataset->dataset);
+    }
+    m_rx_dataset[variant] = dataset;
+    return vm;
+}
+
+void HashCtx::rx_prepare(const int variant, const uint8_t* seed_hash) {
+    if (!rx_valid(variant)) throw std::domain_error("Unknown RandomX algo");
+
+    attach_rx_shared(variant);
+    get_rx_cache(variant, seed_hash);
+}
+
+void HashCtx::set_rx_fast(const int variant, const bool enabled, const size_t memory) {
+    if (!rx_valid(variant)) throw std::domain_error("Unknown RandomX algo");
+    const unsigned long items = enabled ? rx_dataset_items(variant, memory) : 0;
+
+    std::shared_ptr<RxCache> newest;
+    {
+        std::lock_guard<std::mutex> lock(rx_cache_mutex);
+        if (!rx_cache[variant].empty()) newest = rx_cache[variant].front();
+    }
+
+    std::lock_guard<std::mutex> lock(rx_fast_mutex);
+    RxFast& fast = rx_fast[variant];
+    fast.enabled = enabled;
+    if (fast.items != items) {
+        fast.items = items;
+        fast.dataset.reset();
+    }
+    if (!enabled) {
+        fast.dataset.reset();
+        fast.pending.reset();
+    } else if (newest) {
+        start_dataset(variant, newest);
+    }
+}
+
+bool HashCtx::get_rx_fast(const int variant, uint8_t* ready, uint8_t* building, size_t& memory) {
+    if (!rx_valid(variant)) throw std::domain_error("Unknown RandomX algo");
+
+    std::lock_guard<std::mutex> lock(rx_fast_mutex);
+    const RxFast& fast = rx_fast[variant];
+    const std::shared_ptr<RxCache>& next = fast.pending ? fast.pending : fast.building;
+    memset(ready, 0, 32);
+    memset(building, 0, 32);
+    if (fast.dataset) memcpy(ready, fast.dataset->cache->seed_hash, 32);
+    if (next) memcpy(building, next->seed_hash, 32);
+    memory = fast.items * RANDOMX_DATASET_ITEM_SIZE;
+    return fast.enabled;
+}
+
+void HashCtx::set_rx_shared(const int variant, const bool enabled, const bool publish, const std::string& name) {
+    if (!rx_valid(variant)) throw std::domain_error("Unknown RandomX algo");
+
+    const rx_shared::Mode mode = !enabled ? rx_shared::OFF : publish ? rx_shared::PUBLISH : rx_shared::ATTACH;
+    rx_shared::set(variant, rx_config(variant), mode, name);
+    attach_rx_shared(variant);
+}
+
+bool HashCtx::get_rx_shared(const int variant, bool& publish, std::string& name, uint32_t& generation, uint32_t& dataset) {
+    if (!rx_valid(variant)) throw std::domain_error("Unknown RandomX algo");
+
+    attach_rx_shared(variant);
+    const rx_shared::Mode mode = rx_shared::mode(variant);
+    const uint64_t current = rx_shared::current(variant);
+    publish = mode == rx_shared::PUBLISH;
+    name = rx_shared::name(variant);
+    generation = current >> 32;
+    dataset = current & 0xFFFFFFFF;
+    return mode != rx_shared::OFF;
+}
+
+void HashCtx::set_rx_cache_size(const size_t size) {
+    std::lock_guard<std::mutex> lock(rx_cache_mutex);
+    rx_cache_size = size;
+    for (std::list<std::shared_ptr<RxCache>>& caches : rx_cache) trim_rx_cache(caches);
+}
+
+size_t HashCtx::get_rx_cache_size() {
+    std::lock_guard<std::mutex> lock(rx_cache_mutex);
+    return rx_cache_size;
+}
+
+randomx_vm* HashCtx::rx_hash_vm(const int variant, const uint8_t* seed_hash) {
+    if (!rx_valid(variant)) throw std::domain_error("Unknown RandomX algo");
+
+    attach_rx_shared(variant);
+    std::shared_ptr<RxDataset> dataset = get_rx_dataset(variant, seed_hash);
+    if (dataset && dataset->full) return rx_fast_vm(variant, dataset);
+    return rx_vm(variant, seed_hash, dataset); // also drops an old dataset
+}
+
+void HashCtx::rx_hash(const int variant, const uint8_t* seed_hash, const void* input, const size_t size, uint8_t* output) {
+    randomx_vm* vm = rx_hash_vm(variant, seed_hash);
+    switch (variant) {
+      case 1:  defyx_calculate_hash  (vm, input, size, output);
+               break;
+      default: randomx_calculate_hash(vm, input, size, output);
+    }
+}
+
+void HashCtx::rx_hash(const int variant, const uint8_t* seed_hash, const std::pair<const uint8_t*, size_t>* inputs, const size_t count, uint8_t* output) {
+    randomx_vm* vm = rx_hash_vm(variant, seed_hash);
+    if (!count) return;
+
+    const bool defyx = variant == 1;
+    (defyx ? defyx_calculate_hash_first : randomx_calculate_hash_first)(vm, inputs[0].first, inputs[0].second);
+    for (size_t i = 1; i < count; ++i) {
+        (defyx ? defyx_calculate_hash_next : randomx_calculate_hash_next)(vm, inputs[i].first, inputs[i].second, output + (i - 1) * 32);
+    }
+    (defyx ? defyx_calculate_hash_last : randomx_calculate_hash_last)(vm, output + (count - 1) * 32);
+}
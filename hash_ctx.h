@@ -0,0 +1,96 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include "crypto/common/Algorithm.h"
+#include "crypto/randomx/randomx.h"
+
+struct cryptonight_ctx;
+struct RxCache;
+struct RxDataset;
+
+namespace xmrig {
+class VirtualMemory;
+}
+
+// Hashing state of one thread: a scratchpad sized for the biggest algorithm
+// family hashed on it so far, CryptoNight contexts using that scratchpad and
+// one RandomX VM per variant (two in fast mode). Contexts are never shared between threads, and
+// RandomX caches are immutable once built, so threads hash without locking.
+class HashCtx {
+public:
+    // Context of the calling thread, created on first use and destroyed with it
+    static HashCtx& get();
+
+    HashCtx(const HashCtx&) = delete;
+    HashCtx& operator=(const HashCtx&) = delete;
+    ~HashCtx();
+
+    // Context array for CnHash functions of algo hashing ways blobs at once,
+    // each context with its own scratchpad_size(algo) bytes of scratchpad
+    cryptonight_ctx** cn(xmrig::Algorithm::Id algo, size_t ways = 1);
+
+    // Scratchpad of at least scratchpad_size(algo) bytes
+    uint8_t* scratchpad(xmrig::Algorithm::Id algo);
+
+    // RandomX hash with the cache for seed_hash. variant uses the JS numbering
+    // (0 = rx/0, 1 = defyx, 2 = arq, 17 = wow, 18 = loki, 19 = v).
+    void rx_hash(int variant, const uint8_t* seed_hash, const void* input, size_t size, uint8_t* output);
+
+    // RandomX hashes of count inputs to count * 32 bytes of output, pipelined
+    // through one VM: the scratchpad of each input is filled in the same pass
+    // as the hash of the one before is finished
+    void rx_hash(int variant, const uint8_t* seed_hash, const std::pair<const uint8_t*, size_t>* inputs, size_t count, uint8_t* output);
+
+    // Builds the cache for seed_hash ahead of time, e.g. for the next epoch,
+    // so the first hash with it doesn't wait for it
+    static void rx_prepare(int variant, const uint8_t* seed_hash);
+
+    // Fast mode: VMs of variant use a full dataset built in the background
+    // for the newest seed once it is ready, light VMs until then. If the
+    // dataset doesn't fit in memory bytes, only the first items that do are
+    // built (in 2 MB steps) and light VMs read those instead of computing
+    // them. get_rx_fast() returns whether it is on, the seed of the ready
+    // dataset, the seed one is being built for (all zeros if none) and its size.
+    static void set_rx_fast(int variant, bool enabled, size_t memory = SIZE_MAX);
+    static bool get_rx_fast(int variant, uint8_t* ready, uint8_t* building, size_t& memory);
+
+    // Shared memory mode (see rx_shared.h): caches and datasets of variant built
+    // here are published under name, or those published under name by another
+    // process are attached instead of being built here. get_rx_shared()
+    // returns whether it is on, the mode, the name and the generations of the
+    // announced cache and dataset (0 if none).
+    static void set_rx_shared(int variant, bool enabled, bool publish, const std::string& name);
+    static bool get_rx_shared(int variant, bool& publish, std::string& name, uint32_t& generation, uint32_t& dataset);
+
+    // Number of caches kept per variant for the most recently used seeds (at
+    // least 1, 2 by default)
+    static void set_rx_cache_size(size_t size);
+    static size_t get_rx_cache_size();
+
+    static size_t scratchpad_size(xmrig::Algorithm::Id algo);
+    static bool rx_valid(int variant);
+
+private:
+    static const size_t MAX_WAYS = 5;
+
+    HashCtx() = default;
+
+    uint8_t* memory(size_t size);
+    randomx_vm* rx_vm(int variant, const uint8_t* seed_hash, const std::shared_ptr<RxDataset>& dataset);
+    randomx_vm* rx_fast_vm(int variant, const std::shared_ptr<RxDataset>& dataset);
+    randomx_vm* rx_hash_vm(int variant, const uint8_t* seed_hash);
+
+    std::unique_ptr<xmrig::VirtualMemory> m_memory;
+    cryptonight_ctx* m_ctx[MAX_WAYS] = {};
+    size_t m_ctx_count = 0;
+    size_t m_ctx_ways = 0; // ways of the last cn() call
+    randomx_vm* m_rx_vm[xmrig::Algorithm::MAX] = {};
+    std::shared_ptr<RxCache> m_rx_cache[xmrig::Algorithm::MAX]; // caches m_rx_vm are bound to
+    randomx_vm* m_rx_fast_vm[xmrig::Algorithm::MAX] = {};
+    std::shared_ptr<RxDataset> m_rx_dataset[xmrig::Algorithm::MAX]; // datasets the last used VM is bound to
+};
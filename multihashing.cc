@@ -5,6 +5,8 @@
 #include <nan.h>
 #include <stdexcept>
 #include <limits>
+#include <memory>
+#include <vector>
 
 //#if (defined(__AES__) && (__AES__ == 1)) || defined(__APPLE__) || defined(__ARM_ARCH)
 //#else
@@ -12,11 +14,9 @@
 //#define _mm_aesenc_si128(a, b) a
 //#endif
 
-#include "crypto/common/VirtualMemory.h"
-#include "crypto/cn/CnCtx.h" 
+#include "backend/cpu/Cpu.h"
 #include "crypto/cn/CnHash.h"
 #include "crypto/randomx/randomx.h"
-#include "crypto/defyx/defyx.h"
 #include "crypto/astrobwt/AstroBWT.h"
 
 extern "C" {
@@ -27,159 +27,443 @@ extern "C" {
 }
 
 #include "c29.h"
+#include "hash_ctx.h"
+#include "rx_snapshot.h"
+#include "share.h"
+#include "tune.h"
+#include "workers.h"
+
+#define FN(algo)  CnFn{ xmrig::Algorithm::algo, xmrig::Assembly::NONE }
+#define FNA(algo) CnFn{ xmrig::Algorithm::algo, xmrig::Assembly::AUTO }
+#define THROW_ERROR_EXCEPTION(x) Nan::ThrowError(x)
 
-#if (defined(__AES__) && (__AES__ == 1)) || (defined(__ARM_FEATURE_CRYPTO) && (__ARM_FEATURE_CRYPTO == 1))
-  #define SOFT_AES false
-  #if defined(CPU_INTEL)
-    #warning Using IvyBridge assembler implementation
-    #define ASM_TYPE xmrig::Assembly::INTEL
-  #elif defined(CPU_AMD)
-    #warning Using Ryzen assembler implementation
-    #define ASM_TYPE xmrig::Assembly::RYZEN
-  #elif defined(CPU_AMD_OLD)
-    #warning Using Bulldozer assembler implementation
-    #define ASM_TYPE xmrig::Assembly::BULLDOZER
-  #elif !defined(__ARM_ARCH)
-    #error Unknown ASM implementation!
-  #endif
-#else
-  #warning Using software AES
-  #define SOFT_AES true
-#endif
-
-#define FN(algo)  xmrig::CnHash::fn(xmrig::Algorithm::algo, SOFT_AES ? xmrig::CnHash::AV_SINGLE_SOFT : xmrig::CnHash::AV_SINGLE, xmrig::Assembly::NONE)
-#if defined(ASM_TYPE)
-  #define FNA(algo) xmrig::CnHash::fn(xmrig::Algorithm::algo, SOFT_AES ? xmrig::CnHash::AV_SINGLE_SOFT : xmrig::CnHash::AV_SINGLE, ASM_TYPE)
-#else
-  #define FNA(algo) xmrig::CnHash::fn(xmrig::Algorithm::algo, SOFT_AES ? xmrig::CnHash::AV_SINGLE_SOFT : xmrig::CnHash::AV_SINGLE, xmrig::Assembly::NONE)
-#endif
-
-const size_t max_mem_size = 20 * 1024 * 1024;
-xmrig::VirtualMemory mem(max_mem_size, true, false, 0, 4096);
-static struct cryptonight_ctx* ctx = nullptr;
-static randomx_cache* rx_cache[xmrig::Algorithm::Id::MAX] = {nullptr};
-static randomx_vm* rx_vm[xmrig::Algorithm::Id::MAX] = {nullptr};
-//static xmrig::Algorithm::Id rx_variant = xmrig::Algorithm::Id::MAX;
-static uint8_t rx_seed_hash[xmrig::Algorithm::Id::MAX][32] = {};
-
-struct InitCtx {
-    InitCtx() {
-        xmrig::CnCtx::create(&ctx, mem.scratchpad(), max_mem_size, 1);
-    }
-} s;
-
-void init_rx(const uint8_t* seed_hash_data, xmrig::Algorithm::Id algo) {
-    bool update_cache = false;
-    if (!rx_cache[algo]) {
-        rx_cache[algo] = randomx_alloc_cache(static_cast<randomx_flags>(RANDOMX_FLAG_JIT | RANDOMX_FLAG_LARGE_PAGES));
-        if (!rx_cache[algo]) {
-            rx_cache[algo] = randomx_alloc_cache(RANDOMX_FLAG_JIT);
-        }
-        update_cache = true;
+void callback(char* data, void* hint) {
+    free(data);
+}
+
+using namespace node;
+using namespace v8;
+using namespace Nan;
+
+// A job holds the parsed arguments of one call. execute() does the hashing on
+// whatever thread runs it, result() converts the output on the JS thread.
+struct HashJob {
+    const uint8_t* input;
+    size_t size;
+    uint8_t output[32];
+    uint8_t* out = nullptr; // caller's buffer to hash into instead of output
+
+    uint8_t* dest() { return out ? out : output; }
+
+    v8::Local<v8::Value> result() const {
+        return Nan::CopyBuffer(reinterpret_cast<const char*>(output), 32).ToLocalChecked();
     }
-    else if (memcmp(rx_seed_hash[algo], seed_hash_data, sizeof(rx_seed_hash[0])) != 0) {
-        update_cache = true;
+};
+
+struct CnJob : HashJob {
+    CnFn fn;
+    uint64_t height;
+
+    void execute(HashCtx& c) {
+        tune::cn(c, fn);
+        fn.get()(input, size, dest(), c.cn(fn.algo), height);
     }
+};
 
-    //if (algo != rx_variant) {
-        switch (algo) {
-            case 0:
-                randomx_apply_config(RandomX_MoneroConfig);
-                break;
-            case 1:
-                randomx_apply_config(RandomX_ScalaConfig);
-                break;
-            case 2:
-                randomx_apply_config(RandomX_ArqmaConfig);
-                break;
-            case 17:
-                randomx_apply_config(RandomX_WowneroConfig);
-                break;
-            case 18:
-                randomx_apply_config(RandomX_LokiConfig);
-                break;
-            case 19:
-                randomx_apply_config(RandomX_VConfig);
-                break;
-            default:
-                throw std::domain_error("Unknown RandomX algo");
-        }
-        //rx_variant = algo;
-        //update_cache = true;
-    //}
-
-    if (update_cache) {
-        memcpy(rx_seed_hash[algo], seed_hash_data, sizeof(rx_seed_hash[0]));
-        randomx_init_cache(rx_cache[algo], rx_seed_hash[algo], sizeof(rx_seed_hash[0]));
-        if (rx_vm[algo]) {
-            randomx_vm_set_cache(rx_vm[algo], rx_cache[algo]);
+struct RxJob : HashJob {
+    int algo;
+    uint8_t seed_hash[32];
+
+    void execute(HashCtx& c) {
+        c.rx_hash(algo, seed_hash, input, size, dest());
+    }
+};
+
+struct K12Job : HashJob {
+    void execute(HashCtx&) {
+        KangarooTwelve(input, size, dest(), 32, 0, 0);
+    }
+};
+
+struct AstroBWTJob : HashJob {
+    void execute(HashCtx& c) {
+        xmrig::astrobwt::astrobwt_dero(input, size, c.scratchpad(xmrig::Algorithm::ASTROBWT_DERO), dest(), std::numeric_limits<int>::max());
+    }
+};
+
+struct C29Job {
+    int (*verify)(uint32_t edges[PROOFSIZE], siphash_keys* keys);
+    siphash_keys keys;
+    uint32_t edges[PROOFSIZE];
+    int retval;
+
+    void execute(HashCtx&) {
+        retval = verify(edges, &keys);
+    }
+
+    v8::Local<v8::Value> result() const {
+        return Nan::New<Number>(retval);
+    }
+};
+
+struct C29CycleJob : HashJob {
+    uint32_t ring[PROOFSIZE];
+
+    void execute(HashCtx&) {
+        uint8_t hashdata[116]; // PROOFSIZE*EDGEBITS/8
+        memset(hashdata, 0, 116);
+
+        int bytepos = 0;
+        int bitpos = 0;
+        for(int i = 0; i < PROOFSIZE; i++){
+
+            uint32_t node = ring[i];
+
+            for(int j = 0; j < EDGEBITS; j++) {
+
+                if((node >> j) & 1U)
+                    hashdata[bytepos] |= 1UL << bitpos;
+
+                bitpos++;
+                if(bitpos==8) {
+                    bitpos=0;bytepos++;
+                }
+            }
         }
+
+        unsigned char cyclehash[32];
+        rx_blake2b((void *)cyclehash, sizeof(cyclehash), (uint8_t *)hashdata, sizeof(hashdata), 0, 0);
+
+        uint8_t* output = dest();
+        for(int i = 0; i < 32; i++)
+            output[i] = cyclehash[31-i];
     }
+};
 
-    if (!rx_vm[algo]) {
-        int flags = RANDOMX_FLAG_LARGE_PAGES | RANDOMX_FLAG_JIT;
-#if !SOFT_AES
-        flags |= RANDOMX_FLAG_HARD_AES;
-#endif
+template<typename Job>
+class HashWorker : public Nan::AsyncWorker {
+public:
+    HashWorker(Nan::Callback* callback, Job&& job, v8::Local<v8::Value> out) : Nan::AsyncWorker(callback, "cryptonight-hashing"), m_job(std::move(job)), m_out(!out.IsEmpty()) {
+        if (m_out) SaveToPersistent("out", out);
+    }
 
-        rx_vm[algo] = randomx_create_vm(static_cast<randomx_flags>(flags), rx_cache[algo], nullptr, mem.scratchpad());
-        if (!rx_vm[algo]) {
-            rx_vm[algo] = randomx_create_vm(static_cast<randomx_flags>(flags - RANDOMX_FLAG_LARGE_PAGES), rx_cache[algo], nullptr, mem.scratchpad());
+    void Execute() override {
+        tune::Benchmarks benchmarks; // first-use tuning runs here, off the JS thread
+        try {
+            m_job.execute(HashCtx::get());
+        } catch (const std::exception &e) {
+            SetErrorMessage(e.what());
         }
     }
+
+protected:
+    void HandleOKCallback() override {
+        Nan::HandleScope scope;
+        v8::Local<v8::Value> argv[] = { Nan::Null(), m_out ? GetFromPersistent("out") : m_job.result() };
+        callback->Call(2, argv, async_resource);
+    }
+
+private:
+    Job m_job;
+    const bool m_out; // result is the caller's output buffer
+};
+
+// Callback used for *_async calls made without one: settles the Promise
+// passed as its data.
+static NAN_METHOD(settle_promise) {
+    v8::Local<v8::Promise::Resolver> resolver = info.Data().As<v8::Promise::Resolver>();
+    if (info[0]->IsNull()) {
+        resolver->Resolve(Nan::GetCurrentContext(), info[1]).FromJust();
+    } else {
+        resolver->Reject(Nan::GetCurrentContext(), info[0]).FromJust();
+    }
 }
 
-#define THROW_ERROR_EXCEPTION(x) Nan::ThrowError(x)
+// *_async methods take the same arguments as their sync versions plus a trailing
+// callback(err, result). Returns the number of arguments before the callback.
+static int arg_count(const Nan::FunctionCallbackInfo<v8::Value>& info, const bool async) {
+    const int count = info.Length();
+    return async && count > 0 && info[count - 1]->IsFunction() ? count - 1 : count;
+}
 
-void callback(char* data, void* hint) {
-    free(data);
+// Points out at offset (0 if undefined) in buffer, which must have room for
+// size bytes there. Returns an error message or nullptr.
+static const char* get_out(v8::Local<v8::Value> buffer, v8::Local<v8::Value> offset, const size_t size, uint8_t*& out) {
+    if (!Buffer::HasInstance(buffer)) return "out should be a buffer object";
+
+    size_t pos = 0;
+    if (!offset.IsEmpty() && !offset->IsUndefined()) {
+        if (!offset->IsUint32()) return "outOffset should be a non-negative integer";
+        pos = Nan::To<uint32_t>(offset).FromMaybe(0);
+    }
+    const size_t length = Buffer::Length(buffer);
+    if (pos > length || length - pos < size) return "out is too small";
+
+    out = reinterpret_cast<uint8_t*>(Buffer::Data(buffer)) + pos;
+    return nullptr;
 }
 
-using namespace node;
-using namespace v8;
-using namespace Nan;
+// Hash methods take an optional output buffer after their own arguments:
+// (..., out, [outOffset], [callback]). The hash is then written to out at
+// outOffset and out is returned instead of a new Buffer. Looks for out from
+// argument first on, and drops it and outOffset from argc if found.
+// Returns an error message or nullptr.
+static const char* parse_out(const Nan::FunctionCallbackInfo<v8::Value>& info, int& argc, const int first, uint8_t*& out, v8::Local<v8::Value>& buffer) {
+    for (int i = first; i < argc; ++i) {
+        if (!Buffer::HasInstance(info[i])) continue;
+
+        const char* error = get_out(info[i], i + 1 < argc ? info[i + 1] : v8::Local<v8::Value>(), 32, out);
+        if (error) return error;
+        buffer = info[i];
+        argc = i;
+        break;
+    }
+    return nullptr;
+}
 
-NAN_METHOD(randomx) {
-    if (info.Length() < 2) return THROW_ERROR_EXCEPTION("You must provide two arguments.");
+// Runs the job right away for sync methods. For async ones it goes to the
+// hashing pool and the result is passed to the callback, or to the returned
+// Promise if no callback was given. If out is set it is the result instead of
+// job.result(). Buffers the job points into that are not arguments themselves
+// must be passed in keep.
+template<typename Job>
+static void run(const Nan::FunctionCallbackInfo<v8::Value>& info, const bool async, Job& job, v8::Local<v8::Value> out = v8::Local<v8::Value>(), const std::vector<v8::Local<v8::Value>>& keep = {}) {
+    if (!async) {
+        try {
+            job.execute(HashCtx::get());
+        } catch (const std::exception &e) {
+            return THROW_ERROR_EXCEPTION(e.what());
+        }
+        info.GetReturnValue().Set(out.IsEmpty() ? job.result() : out);
+        return;
+    }
+
+    Nan::Callback* callback;
+    const int count = info.Length();
+    if (count > 0 && info[count - 1]->IsFunction()) {
+        callback = new Nan::Callback(info[count - 1].As<v8::Function>());
+    } else {
+        v8::Local<v8::Promise::Resolver> resolver = v8::Promise::Resolver::New(Nan::GetCurrentContext()).ToLocalChecked();
+        callback = new Nan::Callback(Nan::New<v8::Function>(settle_promise, resolver));
+        info.GetReturnValue().Set(resolver->GetPromise());
+    }
+
+    HashWorker<Job>* worker = new HashWorker<Job>(callback, std::move(job), out);
+    // The job only keeps pointers to buffer arguments, so keep them alive too
+    for (int i = 0; i < count; ++i) {
+        if (Buffer::HasInstance(info[i])) worker->SaveToPersistent(i, info[i]);
+    }
+    for (size_t i = 0; i < keep.size(); ++i) {
+        worker->SaveToPersistent(static_cast<uint32_t>(count + i), keep[i]);
+    }
+    workers::queue(worker);
+}
+
+static void randomx_method(const Nan::FunctionCallbackInfo<v8::Value>& info, const bool async) {
+    int argc = arg_count(info, async);
+    if (argc < 2) return THROW_ERROR_EXCEPTION("You must provide two arguments.");
+
+    RxJob job;
+    v8::Local<v8::Value> out;
+    const char* error = parse_out(info, argc, 2, job.out, out);
+    if (error) return THROW_ERROR_EXCEPTION(error);
 
     Local<Object> target = info[0]->ToObject();
     if (!Buffer::HasInstance(target)) return THROW_ERROR_EXCEPTION("Argument 1 should be a buffer object.");
 
     Local<Object> seed_hash = info[1]->ToObject();
     if (!Buffer::HasInstance(seed_hash)) return THROW_ERROR_EXCEPTION("Argument 2 should be a buffer object.");
-    if (Buffer::Length(seed_hash) != sizeof(rx_seed_hash[0])) return THROW_ERROR_EXCEPTION("Argument 2 size should be 32 bytes.");
+    if (Buffer::Length(seed_hash) != sizeof(RxJob::seed_hash)) return THROW_ERROR_EXCEPTION("Argument 2 size should be 32 bytes.");
 
     int algo = 0;
-    if (info.Length() >= 3) {
+    if (argc >= 3) {
         if (!info[2]->IsNumber()) return THROW_ERROR_EXCEPTION("Argument 3 should be a number");
         algo = Nan::To<int>(info[2]).FromMaybe(0);
     }
+    if (!HashCtx::rx_valid(algo)) return THROW_ERROR_EXCEPTION("Unknown RandomX algo");
+
+    job.input = reinterpret_cast<const uint8_t*>(Buffer::Data(target));
+    job.size  = Buffer::Length(target);
+    job.algo  = algo;
+    memcpy(job.seed_hash, Buffer::Data(seed_hash), sizeof(job.seed_hash));
+    run(info, async, job, out);
+}
+
+NAN_METHOD(randomx)       { randomx_method(info, false); }
+NAN_METHOD(randomx_async) { randomx_method(info, true); }
+
+struct RxPrepareJob {
+    int algo;
+    uint8_t seed_hash[32];
+
+    void execute(HashCtx&) {
+        HashCtx::rx_prepare(algo, seed_hash);
+    }
+
+    v8::Local<v8::Value> result() const {
+        return Nan::Undefined();
+    }
+};
+
+// randomx_prepare(seed_hash, [algo], [callback]): builds the cache for a seed,
+// e.g. the next epoch's, on a hashing thread. Settles once it is ready.
+NAN_METHOD(randomx_prepare) {
+    const int argc = arg_count(info, true);
+    if (argc < 1) return THROW_ERROR_EXCEPTION("You must provide one argument.");
+
+    Local<Object> seed_hash = info[0]->ToObject();
+    if (!Buffer::HasInstance(seed_hash)) return THROW_ERROR_EXCEPTION("Argument 1 should be a buffer object.");
+    if (Buffer::Length(seed_hash) != sizeof(RxPrepareJob::seed_hash)) return THROW_ERROR_EXCEPTION("Argument 1 size should be 32 bytes.");
+
+    int algo = 0;
+    if (argc >= 2) {
+        if (!info[1]->IsNumber()) return THROW_ERROR_EXCEPTION("Argument 2 should be a number");
+        algo = Nan::To<int>(info[1]).FromMaybe(0);
+    }
+    if (!HashCtx::rx_valid(algo)) return THROW_ERROR_EXCEPTION("Unknown RandomX algo");
+
+    RxPrepareJob job;
+    job.algo = algo;
+    memcpy(job.seed_hash, Buffer::Data(seed_hash), sizeof(job.seed_hash));
+    run(info, true, job);
+}
+
+// randomx_caches([count]): sets how many caches of recent seeds are kept per
+// RandomX algo and returns the current number.
+NAN_METHOD(randomx_caches) {
+    if (info.Length() >= 1) {
+        const uint32_t count = info[0]->IsUint32() ? Nan::To<uint32_t>(info[0]).FromMaybe(0) : 0;
+        if (count < 1) return THROW_ERROR_EXCEPTION("Argument 1 should be a positive integer");
+        HashCtx::set_rx_cache_size(count);
+    }
+    info.GetReturnValue().Set(Nan::New<Number>(HashCtx::get_rx_cache_size()));
+}
+
+// randomx_fast_mode(algo, [enabled], [memory]): turns fast mode on or off for a
+// RandomX algo, with the dataset limited to memory bytes if given (hybrid mode).
+// Returns {enabled, memory, dataset, building}: the dataset size and the seed
+// hashes of the dataset in use and of the one being built, or null.
+NAN_METHOD(randomx_fast_mode) {
+    if (info.Length() < 1) return THROW_ERROR_EXCEPTION("You must provide one argument.");
+    if (!info[0]->IsNumber()) return THROW_ERROR_EXCEPTION("Argument 1 should be a number");
+    const int algo = Nan::To<int>(info[0]).FromMaybe(0);
+    if (!HashCtx::rx_valid(algo)) return THROW_ERROR_EXCEPTION("Unknown RandomX algo");
+
+    if (info.Length() >= 2) {
+        if (!info[1]->IsBoolean()) return THROW_ERROR_EXCEPTION("Argument 2 should be a boolean");
+        size_t memory = SIZE_MAX;
+        if (info.Length() >= 3) {
+            const double bytes = info[2]->IsNumber() ? Nan::To<double>(info[2]).FromMaybe(-1) : -1;
+            if (!(bytes >= 0)) return THROW_ERROR_EXCEPTION("Argument 3 should be a non-negative number");
+            if (bytes < static_cast<double>(SIZE_MAX)) memory = static_cast<size_t>(bytes);
+        }
+        HashCtx::set_rx_fast(algo, Nan::To<bool>(info[1]).FromMaybe(false), memory);
+    }
 
-    try {
-        init_rx(reinterpret_cast<const uint8_t*>(Buffer::Data(seed_hash)), static_cast<xmrig::Algorithm::Id>(algo));
-    } catch (const std::domain_error &e) {
-        return THROW_ERROR_EXCEPTION(e.what());
+    static const uint8_t none[32] = {};
+    uint8_t dataset[32], building[32];
+    size_t memory;
+    const bool enabled = HashCtx::get_rx_fast(algo, dataset, building, memory);
+
+    Local<Object> status = Nan::New<Object>();
+    Nan::Set(status, Nan::New("enabled").ToLocalChecked(), Nan::New<v8::Boolean>(enabled));
+    Nan::Set(status, Nan::New("memory").ToLocalChecked(), Nan::New<Number>(static_cast<double>(memory)));
+    Nan::Set(status, Nan::New("dataset").ToLocalChecked(), memcmp(dataset, none, sizeof(none)) ?
+        Local<Value>(Nan::CopyBuffer(reinterpret_cast<char*>(dataset), sizeof(dataset)).ToLocalChecked()) : Local<Value>(Nan::Null()));
+    Nan::Set(status, Nan::New("building").ToLocalChecked(), memcmp(building, none, sizeof(none)) ?
+        Local<Value>(Nan::CopyBuffer(reinterpret_cast<char*>(building), sizeof(building)).ToLocalChecked()) : Local<Value>(Nan::Null()));
+    info.GetReturnValue().Set(status);
+}
+
+// randomx_snapshots([dir]): sets the directory RandomX cache snapshots are read
+// from and written to (null turns them off) and returns it, '' if off.
+NAN_METHOD(randomx_snapshots) {
+    if (info.Length() >= 1) {
+        if (!info[0]->IsString() && !info[0]->IsNull()) return THROW_ERROR_EXCEPTION("Argument 1 should be a string or null");
+        rx_snapshot::set_dir(info[0]->IsNull() ? std::string() : std::string(*Nan::Utf8String(info[0])));
+    }
+    info.GetReturnValue().Set(Nan::New(rx_snapshot::dir()).ToLocalChecked());
+}
+
+// randomx_shared(algo, [name], [publish]): shares the caches and datasets of a
+// RandomX algo between processes under name (null turns it off). Publishing
+// processes build them in shared memory, the others map what was published.
+// Returns {name, publish, generation, dataset}: '' if off and the generations
+// of the published cache and dataset, 0 if none.
+NAN_METHOD(randomx_shared) {
+    if (info.Length() < 1) return THROW_ERROR_EXCEPTION("You must provide one argument.");
+    if (!info[0]->IsNumber()) return THROW_ERROR_EXCEPTION("Argument 1 should be a number");
+    const int algo = Nan::To<int>(info[0]).FromMaybe(0);
+    if (!HashCtx::rx_valid(algo)) return THROW_ERROR_EXCEPTION("Unknown RandomX algo");
+
+    if (info.Length() >= 2) {
+        if (!info[1]->IsString() && !info[1]->IsNull()) return THROW_ERROR_EXCEPTION("Argument 2 should be a string or null");
+        if (info.Length() >= 3 && !info[2]->IsBoolean()) return THROW_ERROR_EXCEPTION("Argument 3 should be a boolean");
+        const bool publish = info.Length() >= 3 && Nan::To<bool>(info[2]).FromMaybe(false);
+        try {
+            HashCtx::set_rx_shared(algo, !info[1]->IsNull(), publish, info[1]->IsNull() ? std::string() : std::string(*Nan::Utf8String(info[1])));
+        } catch (const std::exception &e) {
+            return THROW_ERROR_EXCEPTION(e.what());
+        }
+    }
+
+    bool publish;
+    std::string name;
+    uint32_t generation, dataset;
+    HashCtx::get_rx_shared(algo, publish, name, generation, dataset);
+
+    Local<Object> status = Nan::New<Object>();
+    Nan::Set(status, Nan::New("name").ToLocalChecked(), Nan::New(name).ToLocalChecked());
+    Nan::Set(status, Nan::New("publish").ToLocalChecked(), Nan::New<v8::Boolean>(publish));
+    Nan::Set(status, Nan::New("generation").ToLocalChecked(), Nan::New<Number>(generation));
+    Nan::Set(status, Nan::New("dataset").ToLocalChecked(), Nan::New<Number>(dataset));
+    info.GetReturnValue().Set(status);
+}
+
+// randomx_timing([enabled]): turns timing of the RandomX hashing phases on or
+// off, turning it on clears the histograms. Returns {enabled, unit, phases}:
+// per phase the count, the total ticks and the histogram, whose element i
+// counts the runs that took [2^i, 2^(i+1)) ticks.
+NAN_METHOD(randomx_timing) {
+    if (info.Length() >= 1) {
+        if (!info[0]->IsBoolean()) return THROW_ERROR_EXCEPTION("Argument 1 should be a boolean");
+        randomx_set_timing(Nan::To<bool>(info[0]).FromMaybe(false));
     }
 
-    char output[32];
-    switch (algo) {
-      case 1:  defyx_calculate_hash  (rx_vm[algo], reinterpret_cast<const uint8_t*>(Buffer::Data(target)), Buffer::Length(target), reinterpret_cast<uint8_t*>(output));
-               break;
-      default: randomx_calculate_hash(rx_vm[algo], reinterpret_cast<const uint8_t*>(Buffer::Data(target)), Buffer::Length(target), reinterpret_cast<uint8_t*>(output));
+    randomx_phase_timing timings[16];
+    const size_t count = std::min<size_t>(randomx_get_timing(timings, 16), 16);
+
+    Local<Object> phases = Nan::New<Object>();
+    for (size_t i = 0; i < count; ++i) {
+        const randomx_phase_timing& timing = timings[i];
+        int buckets = RANDOMX_TIMING_BUCKETS;
+        while (buckets > 0 && timing.histogram[buckets - 1] == 0) --buckets;
+
+        Local<Array> histogram = Nan::New<Array>(buckets);
+        for (int j = 0; j < buckets; ++j) Nan::Set(histogram, j, Nan::New<Number>(static_cast<double>(timing.histogram[j])));
+
+        Local<Object> phase = Nan::New<Object>();
+        Nan::Set(phase, Nan::New("count").ToLocalChecked(), Nan::New<Number>(static_cast<double>(timing.count)));
+        Nan::Set(phase, Nan::New("ticks").ToLocalChecked(), Nan::New<Number>(static_cast<double>(timing.ticks)));
+        Nan::Set(phase, Nan::New("histogram").ToLocalChecked(), histogram);
+        Nan::Set(phases, Nan::New(timing.phase).ToLocalChecked(), phase);
     }
 
-    v8::Local<v8::Value> returnValue = Nan::CopyBuffer(output, 32).ToLocalChecked();
-    info.GetReturnValue().Set(returnValue);
+    Local<Object> status = Nan::New<Object>();
+    Nan::Set(status, Nan::New("enabled").ToLocalChecked(), Nan::New<v8::Boolean>(randomx_timing_enabled()));
+    Nan::Set(status, Nan::New("unit").ToLocalChecked(), Nan::New(randomx_timing_unit()).ToLocalChecked());
+    Nan::Set(status, Nan::New("phases").ToLocalChecked(), phases);
+    info.GetReturnValue().Set(status);
 }
 
 
-static xmrig::cn_hash_fun get_cn_fn(const int algo) {
+static CnFn get_cn_fn(const int algo) {
   switch (algo) {
-    case 0:  return FN(CN_0);
-    case 1:  return FN(CN_1);
-    case 4:  return FN(CN_FAST);
-    case 6:  return FN(CN_XAO);
-    case 7:  return FN(CN_RTO);
+    case 0:  return FNA(CN_0);
+    case 1:  return FNA(CN_1);
+    case 4:  return FNA(CN_FAST);
+    case 6:  return FNA(CN_XAO);
+    case 7:  return FNA(CN_RTO);
     case 8:  return FNA(CN_2);
     case 9:  return FNA(CN_HALF);
     case 11: return FN(CN_GPU);
@@ -187,34 +471,34 @@ static xmrig::cn_hash_fun get_cn_fn(const int algo) {
     case 14: return FNA(CN_RWZ);
     case 15: return FNA(CN_ZLS);
     case 16: return FNA(CN_DOUBLE);
-    default: return FN(CN_1);
+    default: return FNA(CN_1);
   }
 }
 
-static xmrig::cn_hash_fun get_cn_lite_fn(const int algo) {
+static CnFn get_cn_lite_fn(const int algo) {
   switch (algo) {
-    case 0:  return FN(CN_LITE_0);
-    case 1:  return FN(CN_LITE_1);
-    default: return FN(CN_LITE_1);
+    case 0:  return FNA(CN_LITE_0);
+    case 1:  return FNA(CN_LITE_1);
+    default: return FNA(CN_LITE_1);
   }
 }
 
-static xmrig::cn_hash_fun get_cn_heavy_fn(const int algo) {
+static CnFn get_cn_heavy_fn(const int algo) {
   switch (algo) {
-    case 0:  return FN(CN_HEAVY_0);
-    case 1:  return FN(CN_HEAVY_XHV);
+    case 0:  return FNA(CN_HEAVY_0);
+    case 1:  return FNA(CN_HEAVY_XHV);
     case 2:  return FN(CN_HEAVY_TUBE);
-    default: return FN(CN_HEAVY_0);
+    default: return FNA(CN_HEAVY_0);
   }
 }
 
-static xmrig::cn_hash_fun get_cn_pico_fn(const int algo) {
+static CnFn get_cn_pico_fn(const int algo) {
   switch (algo) {
     case 0:  return FNA(CN_PICO_0);
     default: return FNA(CN_PICO_0);
   }
 }
-static xmrig::cn_hash_fun get_argon2_fn(const int algo) {
+static CnFn get_argon2_fn(const int algo) {
   switch (algo) {
     case 0:  return FN(AR2_CHUKWA);
     case 1:  return FN(AR2_WRKZ);
@@ -222,22 +506,28 @@ static xmrig::cn_hash_fun get_argon2_fn(const int algo) {
   }
 }
 
-NAN_METHOD(cryptonight) {
-    if (info.Length() < 1) return THROW_ERROR_EXCEPTION("You must provide one argument.");
+static void cryptonight_method(const Nan::FunctionCallbackInfo<v8::Value>& info, const bool async) {
+    int argc = arg_count(info, async);
+    if (argc < 1) return THROW_ERROR_EXCEPTION("You must provide one argument.");
 
     Local<Object> target = info[0]->ToObject();
     if (!Buffer::HasInstance(target)) return THROW_ERROR_EXCEPTION("Argument 1 should be a buffer object.");
 
+    CnJob job;
+    v8::Local<v8::Value> out;
+    const char* error = parse_out(info, argc, 1, job.out, out);
+    if (error) return THROW_ERROR_EXCEPTION(error);
+
     int algo = 0;
     uint64_t height = 0;
     bool height_set = false;
 
-    if (info.Length() >= 2) {
+    if (argc >= 2) {
         if (!info[1]->IsNumber()) return THROW_ERROR_EXCEPTION("Argument 2 should be a number");
         algo = Nan::To<int>(info[1]).FromMaybe(0);
     }
 
-    if (info.Length() >= 3) {
+    if (argc >= 3) {
         if (!info[2]->IsNumber()) return THROW_ERROR_EXCEPTION("Argument 3 should be a number");
         height = Nan::To<uint32_t>(info[2]).FromMaybe(0);
         height_set = true;
@@ -245,230 +535,677 @@ NAN_METHOD(cryptonight) {
 
     if ((algo == 12 || algo == 13) && !height_set) return THROW_ERROR_EXCEPTION("CryptonightR requires block template height as Argument 3");
 
-    const xmrig::cn_hash_fun fn = get_cn_fn(algo);
-
-    char output[32];
-    fn(reinterpret_cast<const uint8_t*>(Buffer::Data(target)), Buffer::Length(target), reinterpret_cast<uint8_t*>(output), &ctx, height);
-
-    v8::Local<v8::Value> returnValue = Nan::CopyBuffer(output, 32).ToLocalChecked();
-    info.GetReturnValue().Set(returnValue);
+    job.input  = reinterpret_cast<const uint8_t*>(Buffer::Data(target));
+    job.size   = Buffer::Length(target);
+    job.fn     = get_cn_fn(algo);
+    job.height = height;
+    run(info, async, job, out);
 }
 
-NAN_METHOD(cryptonight_light) {
-    if (info.Length() < 1) return THROW_ERROR_EXCEPTION("You must provide one argument.");
+NAN_METHOD(cryptonight)       { cryptonight_method(info, false); }
+NAN_METHOD(cryptonight_async) { cryptonight_method(info, true); }
+
+// cryptonight_light, cryptonight_heavy, cryptonight_pico and argon2 all take
+// (buffer, [algo], [height]) and only differ in the function table.
+static void cn_variant_method(const Nan::FunctionCallbackInfo<v8::Value>& info, const bool async, CnFn (*get_fn)(int), const bool use_height) {
+    int argc = arg_count(info, async);
+    if (argc < 1) return THROW_ERROR_EXCEPTION("You must provide one argument.");
 
     Local<Object> target = info[0]->ToObject();
     if (!Buffer::HasInstance(target)) return THROW_ERROR_EXCEPTION("Argument 1 should be a buffer object.");
 
+    CnJob job;
+    v8::Local<v8::Value> out;
+    const char* error = parse_out(info, argc, 1, job.out, out);
+    if (error) return THROW_ERROR_EXCEPTION(error);
+
     int algo = 0;
     uint64_t height = 0;
 
-    if (info.Length() >= 2) {
+    if (argc >= 2) {
         if (!info[1]->IsNumber()) return THROW_ERROR_EXCEPTION("Argument 2 should be a number");
         algo = Nan::To<int>(info[1]).FromMaybe(0);
     }
 
-    if (info.Length() >= 3) {
+    if (use_height && argc >= 3) {
         if (!info[2]->IsNumber()) return THROW_ERROR_EXCEPTION("Argument 3 should be a number");
         height = Nan::To<unsigned int>(info[2]).FromMaybe(0);
     }
 
-    const xmrig::cn_hash_fun fn = get_cn_lite_fn(algo);
-
-    char output[32];
-    fn(reinterpret_cast<const uint8_t*>(Buffer::Data(target)), Buffer::Length(target), reinterpret_cast<uint8_t*>(output), &ctx, height);
-
-    v8::Local<v8::Value> returnValue = Nan::CopyBuffer(output, 32).ToLocalChecked();
-    info.GetReturnValue().Set(returnValue);
+    job.input  = reinterpret_cast<const uint8_t*>(Buffer::Data(target));
+    job.size   = Buffer::Length(target);
+    job.fn     = get_fn(algo);
+    job.height = height;
+    run(info, async, job, out);
 }
 
-NAN_METHOD(cryptonight_heavy) {
-    if (info.Length() < 1) return THROW_ERROR_EXCEPTION("You must provide one argument.");
+NAN_METHOD(cryptonight_light)       { cn_variant_method(info, false, get_cn_lite_fn, true); }
+NAN_METHOD(cryptonight_light_async) { cn_variant_method(info, true, get_cn_lite_fn, true); }
+NAN_METHOD(cryptonight_heavy)       { cn_variant_method(info, false, get_cn_heavy_fn, true); }
+NAN_METHOD(cryptonight_heavy_async) { cn_variant_method(info, true, get_cn_heavy_fn, true); }
+NAN_METHOD(cryptonight_pico)        { cn_variant_method(info, false, get_cn_pico_fn, false); }
+NAN_METHOD(cryptonight_pico_async)  { cn_variant_method(info, true, get_cn_pico_fn, false); }
+NAN_METHOD(argon2)                  { cn_variant_method(info, false, get_argon2_fn, false); }
+NAN_METHOD(argon2_async)            { cn_variant_method(info, true, get_argon2_fn, false); }
+
+static void k12_method(const Nan::FunctionCallbackInfo<v8::Value>& info, const bool async) {
+    int argc = arg_count(info, async);
+    if (argc < 1) return THROW_ERROR_EXCEPTION("You must provide one argument.");
 
     Local<Object> target = info[0]->ToObject();
     if (!Buffer::HasInstance(target)) return THROW_ERROR_EXCEPTION("Argument 1 should be a buffer object.");
 
-    int algo = 0;
-    uint64_t height = 0;
+    K12Job job;
+    v8::Local<v8::Value> out;
+    const char* error = parse_out(info, argc, 1, job.out, out);
+    if (error) return THROW_ERROR_EXCEPTION(error);
 
-    if (info.Length() >= 2) {
-        if (!info[1]->IsNumber()) return THROW_ERROR_EXCEPTION("Argument 2 should be a number");
-        algo = Nan::To<int>(info[1]).FromMaybe(0);
-    }
+    job.input = reinterpret_cast<const uint8_t*>(Buffer::Data(target));
+    job.size  = Buffer::Length(target);
+    run(info, async, job, out);
+}
 
-    if (info.Length() >= 3) {
-        if (!info[2]->IsNumber()) return THROW_ERROR_EXCEPTION("Argument 3 should be a number");
-        height = Nan::To<unsigned int>(info[2]).FromMaybe(0);
-    }
+NAN_METHOD(k12)       { k12_method(info, false); }
+NAN_METHOD(k12_async) { k12_method(info, true); }
 
+static void setsipkeys(const char *keybuf,siphash_keys *keys) {
+	keys->k0 = htole64(((uint64_t *)keybuf)[0]);
+	keys->k1 = htole64(((uint64_t *)keybuf)[1]);
+	keys->k2 = htole64(((uint64_t *)keybuf)[2]);
+	keys->k3 = htole64(((uint64_t *)keybuf)[3]);
+}
 
-    const xmrig::cn_hash_fun fn = get_cn_heavy_fn(algo);
+static void c29_setheader(const char *header, const uint32_t headerlen, siphash_keys *keys) {
+	char hdrkey[32];
+	rx_blake2b((void *)hdrkey, sizeof(hdrkey), (const void *)header, headerlen, 0, 0);
+	setsipkeys(hdrkey,keys);
+}
 
-    char output[32];
-    fn(reinterpret_cast<const uint8_t*>(Buffer::Data(target)), Buffer::Length(target), reinterpret_cast<uint8_t*>(output), &ctx, height);
+static void c29_method(const Nan::FunctionCallbackInfo<v8::Value>& info, const bool async, int (*verify)(uint32_t edges[PROOFSIZE], siphash_keys* keys)) {
+	if (arg_count(info, async) != 2) return THROW_ERROR_EXCEPTION("You must provide 2 arguments: header, ring");
 
-    v8::Local<v8::Value> returnValue = Nan::CopyBuffer(output, 32).ToLocalChecked();
-    info.GetReturnValue().Set(returnValue);
-}
+	char * input = Buffer::Data(info[0]);
+	uint32_t input_len = Buffer::Length(info[0]);
 
-NAN_METHOD(cryptonight_pico) {
-    if (info.Length() < 1) return THROW_ERROR_EXCEPTION("You must provide one argument.");
+	C29Job job;
+	job.verify = verify;
+	c29_setheader(input,input_len,&job.keys);
 
-    Local<Object> target = info[0]->ToObject();
-    if (!Buffer::HasInstance(target)) return THROW_ERROR_EXCEPTION("Argument 1 should be a buffer object.");
+	Local<Array> ring = Local<Array>::Cast(info[1]);
 
-    int algo = 0;
+	for (uint32_t n = 0; n < PROOFSIZE; n++)
+		job.edges[n]=ring->Get(n)->Uint32Value(Nan::GetCurrentContext()).FromJust();
 
-    if (info.Length() >= 2) {
-        if (!info[1]->IsNumber()) return THROW_ERROR_EXCEPTION("Argument 2 should be a number");
-        algo = Nan::To<int>(info[1]).FromMaybe(0);
-    }
+	run(info, async, job);
+}
+
+NAN_METHOD(c29s)       { c29_method(info, false, c29s_verify); }
+NAN_METHOD(c29s_async) { c29_method(info, true, c29s_verify); }
+NAN_METHOD(c29v)       { c29_method(info, false, c29v_verify); }
+NAN_METHOD(c29v_async) { c29_method(info, true, c29v_verify); }
+
+static void c29_cycle_hash_method(const Nan::FunctionCallbackInfo<v8::Value>& info, const bool async) {
+	int argc = arg_count(info, async);
+	C29CycleJob job;
+	v8::Local<v8::Value> out;
+	const char* error = parse_out(info, argc, 1, job.out, out);
+	if (error) return THROW_ERROR_EXCEPTION(error);
+	if (argc != 1) return THROW_ERROR_EXCEPTION("You must provide 1 argument:ring");
 
-    const xmrig::cn_hash_fun fn = get_cn_pico_fn(algo);
+	Local<Array> ring = Local<Array>::Cast(info[0]);
 
-    char output[32];
-    fn(reinterpret_cast<const uint8_t*>(Buffer::Data(target)), Buffer::Length(target), reinterpret_cast<uint8_t*>(output), &ctx, 0);
+	for (uint32_t i = 0; i < PROOFSIZE; i++)
+		job.ring[i] = ring->Get(i)->Uint32Value(Nan::GetCurrentContext()).FromJust();
 
-    v8::Local<v8::Value> returnValue = Nan::CopyBuffer(output, 32).ToLocalChecked();
-    info.GetReturnValue().Set(returnValue);
+	run(info, async, job, out);
 }
 
-NAN_METHOD(argon2) {
-    if (info.Length() < 1) return THROW_ERROR_EXCEPTION("You must provide one argument.");
+NAN_METHOD(c29_cycle_hash)       { c29_cycle_hash_method(info, false); }
+NAN_METHOD(c29_cycle_hash_async) { c29_cycle_hash_method(info, true); }
+
+static void astrobwt_method(const Nan::FunctionCallbackInfo<v8::Value>& info, const bool async) {
+    int argc = arg_count(info, async);
+    if (argc < 1) return THROW_ERROR_EXCEPTION("You must provide one argument.");
 
     Local<Object> target = info[0]->ToObject();
     if (!Buffer::HasInstance(target)) return THROW_ERROR_EXCEPTION("Argument 1 should be a buffer object.");
 
-    int algo = 0;
+    AstroBWTJob job;
+    v8::Local<v8::Value> out;
+    const char* error = parse_out(info, argc, 1, job.out, out);
+    if (error) return THROW_ERROR_EXCEPTION(error);
 
-    if (info.Length() >= 2) {
-        if (!info[1]->IsNumber()) return THROW_ERROR_EXCEPTION("Argument 2 should be a number");
-        algo = Nan::To<int>(info[1]).FromMaybe(0);
+    job.input = reinterpret_cast<const uint8_t*>(Buffer::Data(target));
+    job.size  = Buffer::Length(target);
+    run(info, async, job, out);
+}
+
+NAN_METHOD(astrobwt)       { astrobwt_method(info, false); }
+NAN_METHOD(astrobwt_async) { astrobwt_method(info, true); }
+
+// Algorithms accepted by name (xmrig naming) by the batch API
+struct AlgoSpec {
+    enum Family { CN, RX, K12, ASTROBWT };
+
+    const char* name;
+    Family family;
+    CnFn (*get_fn)(int); // CN family: lookup function and the JS algo number for it
+    int variant;         // RX family: JS algo number for randomx()
+};
+
+static const AlgoSpec algos[] = {
+    { "cn/0",          AlgoSpec::CN,       get_cn_fn,       0  },
+    { "cn/1",          AlgoSpec::CN,       get_cn_fn,       1  },
+    { "cn/2",          AlgoSpec::CN,       get_cn_fn,       8  },
+    { "cn/r",          AlgoSpec::CN,       get_cn_fn,       13 },
+    { "cn/fast",       AlgoSpec::CN,       get_cn_fn,       4  },
+    { "cn/half",       AlgoSpec::CN,       get_cn_fn,       9  },
+    { "cn/xao",        AlgoSpec::CN,       get_cn_fn,       6  },
+    { "cn/rto",        AlgoSpec::CN,       get_cn_fn,       7  },
+    { "cn/rwz",        AlgoSpec::CN,       get_cn_fn,       14 },
+    { "cn/zls",        AlgoSpec::CN,       get_cn_fn,       15 },
+    { "cn/double",     AlgoSpec::CN,       get_cn_fn,       16 },
+    { "cn/gpu",        AlgoSpec::CN,       get_cn_fn,       11 },
+    { "cn-lite/0",     AlgoSpec::CN,       get_cn_lite_fn,  0  },
+    { "cn-lite/1",     AlgoSpec::CN,       get_cn_lite_fn,  1  },
+    { "cn-heavy/0",    AlgoSpec::CN,       get_cn_heavy_fn, 0  },
+    { "cn-heavy/xhv",  AlgoSpec::CN,       get_cn_heavy_fn, 1  },
+    { "cn-heavy/tube", AlgoSpec::CN,       get_cn_heavy_fn, 2  },
+    { "cn-pico",       AlgoSpec::CN,       get_cn_pico_fn,  0  },
+    { "argon2/chukwa", AlgoSpec::CN,       get_argon2_fn,   0  },
+    { "argon2/wrkz",   AlgoSpec::CN,       get_argon2_fn,   1  },
+    { "rx/0",          AlgoSpec::RX,       nullptr,         0  },
+    { "defyx",         AlgoSpec::RX,       nullptr,         1  },
+    { "rx/arq",        AlgoSpec::RX,       nullptr,         2  },
+    { "rx/wow",        AlgoSpec::RX,       nullptr,         17 },
+    { "rx/loki",       AlgoSpec::RX,       nullptr,         18 },
+    { "rx/v",          AlgoSpec::RX,       nullptr,         19 },
+    { "k12",           AlgoSpec::K12,      nullptr,         0  },
+    { "astrobwt",      AlgoSpec::ASTROBWT, nullptr,         0  },
+};
+
+static const AlgoSpec* find_algo(v8::Local<v8::Value> name) {
+    if (!name->IsString()) return nullptr;
+    Nan::Utf8String str(name);
+    for (const AlgoSpec& algo : algos) {
+        if (strcmp(algo.name, *str) == 0) return &algo;
     }
+    return nullptr;
+}
 
-    const xmrig::cn_hash_fun fn = get_argon2_fn(algo);
+// Returns false if opts has no such property or it is undefined
+static bool get_option(v8::Local<v8::Object> opts, const char* name, v8::Local<v8::Value>& value) {
+    if (opts.IsEmpty()) return false;
+    value = Nan::Get(opts, Nan::New(name).ToLocalChecked()).ToLocalChecked();
+    return !value->IsUndefined();
+}
 
-    char output[32];
-    fn(reinterpret_cast<const uint8_t*>(Buffer::Data(target)), Buffer::Length(target), reinterpret_cast<uint8_t*>(output), &ctx, 0);
+// One algorithm with its parameters, parsed from the (algo, opts) arguments
+struct Hasher {
+    typedef std::pair<const uint8_t*, size_t> Blob;
+
+    const AlgoSpec* algo;
+    CnFn fn;
+    size_t ways; // CN family: blobs hashed at once by the multi-way kernels, 0 = tuned
+    uint64_t height;
+    uint8_t seed_hash[32];
+
+    void hash(HashCtx& c, const uint8_t* input, const size_t size, uint8_t* output) const {
+        switch (algo->family) {
+            case AlgoSpec::CN:
+                tune::cn(c, fn);
+                fn.get()(input, size, output, c.cn(fn.algo), height);
+                break;
+            case AlgoSpec::RX:
+                c.rx_hash(algo->variant, seed_hash, input, size, output);
+                break;
+            case AlgoSpec::K12:
+                KangarooTwelve(input, size, output, 32, 0, 0);
+                break;
+            case AlgoSpec::ASTROBWT:
+                xmrig::astrobwt::astrobwt_dero(input, size, c.scratchpad(xmrig::Algorithm::ASTROBWT_DERO), output, std::numeric_limits<int>::max());
+                break;
+        }
+    }
 
-    v8::Local<v8::Value> returnValue = Nan::CopyBuffer(output, 32).ToLocalChecked();
-    info.GetReturnValue().Set(returnValue);
-}
+    // Hashes count blobs to count * 32 bytes of output, grouping runs of
+    // same-size blobs for the multi-way kernels. RandomX blobs stream through
+    // one VM, each one's setup overlapping the end of the one before.
+    void hash(HashCtx& c, const Blob* blobs, const size_t count, uint8_t* output) const {
+        if (algo->family == AlgoSpec::RX) {
+            c.rx_hash(algo->variant, seed_hash, blobs, count, output);
+            return;
+        }
 
-NAN_METHOD(k12) {
-    if (info.Length() < 1) return THROW_ERROR_EXCEPTION("You must provide one argument.");
+        const size_t ways = this->ways || algo->family != AlgoSpec::CN ? this->ways : tune::cn(c, fn);
+        for (size_t i = 0; i < count;) {
+            size_t n = 1;
+            while (n < ways && i + n < count && blobs[i + n].second == blobs[i].second) ++n;
+
+            if (n == 1) {
+                hash(c, blobs[i].first, blobs[i].second, output + i * 32);
+            } else {
+                // Multi-way kernels read their blobs back to back
+                const size_t size = blobs[i].second;
+                const uint8_t* input = blobs[i].first;
+                for (size_t j = 1; j < n; ++j) {
+                    if (blobs[i + j].first != input + j * size) {
+                        input = pack(blobs + i, n);
+                        break;
+                    }
+                }
+                fn.get(n)(input, size, output + i * 32, c.cn(fn.algo, n), height);
+            }
+            i += n;
+        }
+    }
 
-    Local<Object> target = info[0]->ToObject();
-    if (!Buffer::HasInstance(target)) return THROW_ERROR_EXCEPTION("Argument 1 should be a buffer object.");
+private:
+    static const uint8_t* pack(const Blob* blobs, const size_t count) {
+        static thread_local std::vector<uint8_t> packed;
+        packed.resize(count * blobs[0].second);
+        for (size_t i = 0; i < count; ++i) {
+            memcpy(packed.data() + i * blobs[0].second, blobs[i].first, blobs[i].second);
+        }
+        return packed.data();
+    }
+};
+
+// Fills hasher from the algo name and the height / seed_hash options.
+// Returns an error message or nullptr.
+static const char* parse_hasher(v8::Local<v8::Value> name, v8::Local<v8::Object> opts, Hasher& hasher) {
+    hasher.algo = find_algo(name);
+    if (!hasher.algo) return "Unknown algo";
+
+    v8::Local<v8::Value> value;
+    hasher.ways = 1;
+    if (hasher.algo->family == AlgoSpec::CN) {
+        hasher.fn = hasher.algo->get_fn(hasher.algo->variant);
+
+        // The tuner picks the number of ways unless it is given
+        hasher.ways = 0;
+        if (get_option(opts, "ways", value)) {
+            if (!value->IsNumber()) return "ways should be a number";
+            hasher.ways = Nan::To<uint32_t>(value).FromMaybe(0);
+            if (hasher.ways < 1 || hasher.ways > CnFn::MAX_WAYS) return "ways should be 1 to 5";
+
+            // Algorithms without multi-way kernels (cn/gpu, argon2) hash one by one
+            if (!hasher.fn.get(hasher.ways)) hasher.ways = 1;
+        }
+    }
 
-    char output[32];
-    KangarooTwelve((const unsigned char *)Buffer::Data(target), Buffer::Length(target), (unsigned char *)output, 32, 0, 0);
+    hasher.height = 0;
+    if (get_option(opts, "height", value)) {
+        if (!value->IsNumber()) return "height should be a number";
+        hasher.height = Nan::To<uint32_t>(value).FromMaybe(0);
+    }
+    else if (hasher.algo->family == AlgoSpec::CN && hasher.fn.algo == xmrig::Algorithm::CN_R) {
+        return "CryptonightR requires block template height";
+    }
 
-    v8::Local<v8::Value> returnValue = Nan::CopyBuffer(output, 32).ToLocalChecked();
-    info.GetReturnValue().Set(returnValue);
+    if (hasher.algo->family == AlgoSpec::RX) {
+        if (!get_option(opts, "seed_hash", value) || !Buffer::HasInstance(value)) return "RandomX requires seed_hash buffer";
+        if (Buffer::Length(value) != sizeof(hasher.seed_hash)) return "seed_hash size should be 32 bytes.";
+        memcpy(hasher.seed_hash, Buffer::Data(value), sizeof(hasher.seed_hash));
+    }
+    return nullptr;
 }
 
-static void setsipkeys(const char *keybuf,siphash_keys *keys) {
-	keys->k0 = htole64(((uint64_t *)keybuf)[0]);
-	keys->k1 = htole64(((uint64_t *)keybuf)[1]);
-	keys->k2 = htole64(((uint64_t *)keybuf)[2]);
-	keys->k3 = htole64(((uint64_t *)keybuf)[3]);
-}
+// Hashes many blobs with one algorithm into a single count * 32 byte Buffer,
+// or into the caller's buffer
+struct BatchJob {
+    Hasher hasher;
+    std::vector<Hasher::Blob> blobs;
+    std::unique_ptr<char, void(*)(void*)> output{nullptr, free};
+    uint8_t* out = nullptr;
 
-static void c29_setheader(const char *header, const uint32_t headerlen, siphash_keys *keys) {
-	char hdrkey[32];
-	rx_blake2b((void *)hdrkey, sizeof(hdrkey), (const void *)header, headerlen, 0, 0);
-	setsipkeys(hdrkey,keys);
-}
+    void execute(HashCtx& c) {
+        hasher.hash(c, blobs.data(), blobs.size(), out ? out : reinterpret_cast<uint8_t*>(output.get()));
+    }
 
-NAN_METHOD(c29s) {
-	if (info.Length() != 2) return THROW_ERROR_EXCEPTION("You must provide 2 arguments: header, ring");
-	
-	char * input = Buffer::Data(info[0]);
-	uint32_t input_len = Buffer::Length(info[0]);
+    v8::Local<v8::Value> result() {
+        const size_t size = blobs.size() * 32;
+        return Nan::NewBuffer(output.release(), size, callback, nullptr).ToLocalChecked();
+    }
+};
+
+// Reads blobs (argument 2 of the batch methods): an array of Buffers, or one
+// Buffer with opts.offsets giving where each blob starts (each ends where the
+// next one starts). Array elements the blobs point into are added to keep.
+// Returns an error message or nullptr.
+static const char* parse_blobs(v8::Local<v8::Value> arg, v8::Local<v8::Object> opts, std::vector<Hasher::Blob>& blobs, std::vector<v8::Local<v8::Value>>& keep) {
+    if (Buffer::HasInstance(arg)) {
+        v8::Local<v8::Value> offsets;
+        if (!get_option(opts, "offsets", offsets) || !offsets->IsObject()) return "Packed blobs require opts.offsets";
+
+        const uint8_t* data = reinterpret_cast<const uint8_t*>(Buffer::Data(arg));
+        const size_t size   = Buffer::Length(arg);
+        v8::Local<v8::Value> length = Nan::Get(offsets.As<v8::Object>(), Nan::New("length").ToLocalChecked()).ToLocalChecked();
+        const uint32_t count = Nan::To<uint32_t>(length).FromMaybe(0);
+
+        for (uint32_t i = 0; i < count; ++i) {
+            const size_t end   = i + 1 < count ? Nan::To<uint32_t>(Nan::Get(offsets.As<v8::Object>(), i + 1).ToLocalChecked()).FromMaybe(0) : size;
+            const size_t begin = Nan::To<uint32_t>(Nan::Get(offsets.As<v8::Object>(), i).ToLocalChecked()).FromMaybe(0);
+            if (begin > end || end > size) return "opts.offsets should be increasing and within the buffer";
+            blobs.emplace_back(data + begin, end - begin);
+        }
+        return nullptr;
+    }
 
-	siphash_keys keys;
-	c29_setheader(input,input_len,&keys);
-	
-	Local<Array> ring = Local<Array>::Cast(info[1]);
+    if (arg->IsArray()) {
+        v8::Local<v8::Array> array = arg.As<v8::Array>();
+        for (uint32_t i = 0; i < array->Length(); ++i) {
+            v8::Local<v8::Value> blob = Nan::Get(array, i).ToLocalChecked();
+            if (!Buffer::HasInstance(blob)) return "Argument 2 should be an array of buffers";
+            blobs.emplace_back(reinterpret_cast<const uint8_t*>(Buffer::Data(blob)), Buffer::Length(blob));
+            keep.push_back(blob);
+        }
+        return nullptr;
+    }
 
-	uint32_t edges[PROOFSIZE];
-	for (uint32_t n = 0; n < PROOFSIZE; n++)
-		edges[n]=ring->Get(n)->Uint32Value(Nan::GetCurrentContext()).FromJust();
-	
-	int retval = c29s_verify(edges,&keys);
+    return "Argument 2 should be an array of buffers or a buffer";
+}
 
-	info.GetReturnValue().Set(Nan::New<Number>(retval));
+// Reads opts argument index, which may be missing or undefined.
+// Returns an error message or nullptr.
+static const char* parse_opts(const Nan::FunctionCallbackInfo<v8::Value>& info, const int argc, const int index, v8::Local<v8::Object>& opts) {
+    if (argc > index && !info[index]->IsUndefined()) {
+        if (!info[index]->IsObject()) return "opts should be an object";
+        opts = info[index].As<v8::Object>();
+    }
+    return nullptr;
 }
 
-NAN_METHOD(c29v) {
-	if (info.Length() != 2) return THROW_ERROR_EXCEPTION("You must provide 2 arguments: header, ring");
-	
-	char * input = Buffer::Data(info[0]);
-	uint32_t input_len = Buffer::Length(info[0]);
+// hash_batch(algo, blobs, [opts]): blobs is an array of Buffers, or one Buffer
+// with opts.offsets (see parse_blobs). opts.height is needed by cn/r,
+// opts.seed_hash by RandomX. Results go to opts.out at opts.outOffset if given.
+static void hash_batch_method(const Nan::FunctionCallbackInfo<v8::Value>& info, const bool async) {
+    const int argc = arg_count(info, async);
+    if (argc < 2) return THROW_ERROR_EXCEPTION("You must provide two arguments.");
+
+    v8::Local<v8::Object> opts;
+    const char* error = parse_opts(info, argc, 2, opts);
+    if (error) return THROW_ERROR_EXCEPTION(error);
+
+    BatchJob job;
+    error = parse_hasher(info[0], opts, job.hasher);
+    if (error) return THROW_ERROR_EXCEPTION(error);
+
+    std::vector<v8::Local<v8::Value>> keep;
+    error = parse_blobs(info[1], opts, job.blobs, keep);
+    if (error) return THROW_ERROR_EXCEPTION(error);
+
+    v8::Local<v8::Value> out;
+    if (get_option(opts, "out", out)) {
+        v8::Local<v8::Value> offset;
+        get_option(opts, "outOffset", offset);
+        error = get_out(out, offset, job.blobs.size() * 32, job.out);
+        if (error) return THROW_ERROR_EXCEPTION(error);
+    } else {
+        out.Clear();
+        // + 1 so an empty batch doesn't get a null pointer
+        job.output.reset(static_cast<char*>(malloc(job.blobs.size() * 32 + 1)));
+        if (!job.output) return THROW_ERROR_EXCEPTION("Out of memory");
+    }
+    run(info, async, job, out, keep);
+}
 
-	siphash_keys keys;
-	c29_setheader(input,input_len,&keys);
+NAN_METHOD(hash_batch)       { hash_batch_method(info, false); }
+NAN_METHOD(hash_batch_async) { hash_batch_method(info, true); }
+
+// Share target argument: a difficulty number, or a little-endian target Buffer
+// of 4 bytes (stratum job target), 8 bytes (checked against the top 64 bits
+// of the hash) or 32 bytes (the whole hash). Returns an error message or nullptr.
+static const char* parse_target(v8::Local<v8::Value> arg, share::Target& target) {
+    if (arg->IsNumber()) {
+        const double difficulty = Nan::To<double>(arg).FromMaybe(0);
+        if (!(difficulty >= 1)) return "difficulty should be at least 1";
+        target.type  = share::Target::DIFFICULTY;
+        target.value = difficulty >= 18446744073709551615.0 ? UINT64_MAX : static_cast<uint64_t>(difficulty);
+        return nullptr;
+    }
+    if (!Buffer::HasInstance(arg)) return "Argument 3 should be a number or a buffer object";
+
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(Buffer::Data(arg));
+    switch (Buffer::Length(arg)) {
+        case 4: {
+            // Same conversion as miners do for 32-bit stratum targets
+            uint32_t target32;
+            memcpy(&target32, data, sizeof(target32));
+            if (!target32) return "target should not be zero";
+            target.type  = share::Target::TARGET64;
+            target.value = 0xFFFFFFFFFFFFFFFFULL / (0xFFFFFFFFULL / target32);
+            return nullptr;
+        }
+        case 8:
+            target.type = share::Target::TARGET64;
+            memcpy(&target.value, data, sizeof(target.value));
+            return nullptr;
+        case 32:
+            target.type = share::Target::TARGET256;
+            memcpy(target.full, data, sizeof(target.full));
+            return nullptr;
+        default:
+            return "target size should be 4, 8 or 32 bytes";
+    }
+}
 
-	Local<Array> ring = Local<Array>::Cast(info[1]);
+// Hashes one blob and checks it against a share target
+struct VerifyJob {
+    Hasher hasher;
+    const uint8_t* input;
+    size_t size;
+    share::Target target;
+    uint8_t hash[32];
+    uint8_t* out = nullptr;
+    bool valid;
+    uint64_t difficulty;
+
+    void execute(HashCtx& c) {
+        uint8_t* output = out ? out : hash;
+        hasher.hash(c, input, size, output);
+        valid = target.check(output, difficulty);
+    }
 
-	uint32_t edges[PROOFSIZE];
-	for (uint32_t n = 0; n < PROOFSIZE; n++)
-		edges[n]=ring->Get(n)->Uint32Value(Nan::GetCurrentContext()).FromJust();
-	
-	int retval = c29v_verify(edges,&keys);
+    v8::Local<v8::Value> result() const {
+        v8::Local<v8::Object> object = Nan::New<v8::Object>();
+        Nan::Set(object, Nan::New("valid").ToLocalChecked(), Nan::New<v8::Boolean>(valid));
+        Nan::Set(object, Nan::New("difficulty").ToLocalChecked(), Nan::New<Number>(static_cast<double>(difficulty)));
+        return object;
+    }
+};
+
+// Hashes many blobs and keeps the indices of those meeting a share target
+struct VerifyBatchJob {
+    Hasher hasher;
+    std::vector<Hasher::Blob> blobs;
+    share::Target target;
+    uint8_t* out = nullptr;
+    std::vector<uint32_t> valid;
+
+    void execute(HashCtx& c) {
+        static thread_local std::vector<uint8_t> hashes;
+        uint8_t* output = out;
+        if (!output) {
+            hashes.resize(blobs.size() * 32);
+            output = hashes.data();
+        }
+
+        hasher.hash(c, blobs.data(), blobs.size(), output);
+
+        uint64_t difficulty;
+        for (size_t i = 0; i < blobs.size(); ++i) {
+            if (target.check(output + i * 32, difficulty)) valid.push_back(static_cast<uint32_t>(i));
+        }
+    }
 
-	info.GetReturnValue().Set(Nan::New<Number>(retval));
+    v8::Local<v8::Value> result() const {
+        v8::Local<v8::Array> array = Nan::New<v8::Array>(static_cast<int>(valid.size()));
+        for (size_t i = 0; i < valid.size(); ++i) {
+            Nan::Set(array, static_cast<uint32_t>(i), Nan::New<Number>(valid[i]));
+        }
+        return array;
+    }
+};
+
+// Common part of verify_share and verify_share_batch: algo, target and opts,
+// where opts takes the hash_batch options. Hashes are also written to opts.out
+// at opts.outOffset if given. Returns an error message or nullptr.
+template<typename Job>
+static const char* parse_verify(const Nan::FunctionCallbackInfo<v8::Value>& info, Job& job, v8::Local<v8::Object> opts, const size_t count, std::vector<v8::Local<v8::Value>>& keep) {
+    const char* error = parse_hasher(info[0], opts, job.hasher);
+    if (error) return error;
+
+    error = parse_target(info[2], job.target);
+    if (error) return error;
+
+    v8::Local<v8::Value> out;
+    if (get_option(opts, "out", out)) {
+        v8::Local<v8::Value> offset;
+        get_option(opts, "outOffset", offset);
+        error = get_out(out, offset, count * 32, job.out);
+        if (error) return error;
+        keep.push_back(out);
+    }
+    return nullptr;
 }
 
-NAN_METHOD(c29_cycle_hash) {
-	if (info.Length() != 1) return THROW_ERROR_EXCEPTION("You must provide 1 argument:ring");
-	
-	Local<Array> ring = Local<Array>::Cast(info[0]);
+// verify_share(algo, blob, target, [opts]): hashes blob and returns
+// { valid, difficulty } where valid tells if the hash meets target and
+// difficulty is the hash's own difficulty.
+static void verify_share_method(const Nan::FunctionCallbackInfo<v8::Value>& info, const bool async) {
+    const int argc = arg_count(info, async);
+    if (argc < 3) return THROW_ERROR_EXCEPTION("You must provide three arguments.");
+    if (!Buffer::HasInstance(info[1])) return THROW_ERROR_EXCEPTION("Argument 2 should be a buffer object.");
+
+    v8::Local<v8::Object> opts;
+    const char* error = parse_opts(info, argc, 3, opts);
+    if (error) return THROW_ERROR_EXCEPTION(error);
+
+    VerifyJob job;
+    std::vector<v8::Local<v8::Value>> keep;
+    error = parse_verify(info, job, opts, 1, keep);
+    if (error) return THROW_ERROR_EXCEPTION(error);
+
+    job.input = reinterpret_cast<const uint8_t*>(Buffer::Data(info[1]));
+    job.size  = Buffer::Length(info[1]);
+    run(info, async, job, v8::Local<v8::Value>(), keep);
+}
 
-	uint8_t hashdata[116]; // PROOFSIZE*EDGEBITS/8
-	memset(hashdata, 0, 116);
+NAN_METHOD(verify_share)       { verify_share_method(info, false); }
+NAN_METHOD(verify_share_async) { verify_share_method(info, true); }
 
-	int bytepos = 0;
-	int bitpos = 0;
-	for(int i = 0; i < PROOFSIZE; i++){
+// verify_share_batch(algo, blobs, target, [opts]): hashes blobs like hash_batch
+// and returns the indices of those meeting target.
+static void verify_share_batch_method(const Nan::FunctionCallbackInfo<v8::Value>& info, const bool async) {
+    const int argc = arg_count(info, async);
+    if (argc < 3) return THROW_ERROR_EXCEPTION("You must provide three arguments.");
 
-		uint32_t node = ring->Get(i)->Uint32Value(Nan::GetCurrentContext()).FromJust();
+    v8::Local<v8::Object> opts;
+    const char* error = parse_opts(info, argc, 3, opts);
+    if (error) return THROW_ERROR_EXCEPTION(error);
 
-		for(int j = 0; j < EDGEBITS; j++) {
-			
-			if((node >> j) & 1U)
-				hashdata[bytepos] |= 1UL << bitpos;
+    VerifyBatchJob job;
+    std::vector<v8::Local<v8::Value>> keep;
+    error = parse_blobs(info[1], opts, job.blobs, keep);
+    if (error) return THROW_ERROR_EXCEPTION(error);
 
-			bitpos++;
-			if(bitpos==8) {
-				bitpos=0;bytepos++;
-			}
-		}
-	}
+    error = parse_verify(info, job, opts, job.blobs.size(), keep);
+    if (error) return THROW_ERROR_EXCEPTION(error);
 
-	unsigned char cyclehash[32];
-	rx_blake2b((void *)cyclehash, sizeof(cyclehash), (uint8_t *)hashdata, sizeof(hashdata), 0, 0);
-	
-	unsigned char rev_cyclehash[32];
-	for(int i = 0; i < 32; i++)
-		rev_cyclehash[i] = cyclehash[31-i];
-	
-	v8::Local<v8::Value> returnValue = Nan::CopyBuffer((char*)rev_cyclehash, 32).ToLocalChecked();
-	info.GetReturnValue().Set(returnValue);
+    run(info, async, job, v8::Local<v8::Value>(), keep);
 }
 
-NAN_METHOD(astrobwt) {
-    if (info.Length() < 1) return THROW_ERROR_EXCEPTION("You must provide one argument.");
+NAN_METHOD(verify_share_batch)       { verify_share_batch_method(info, false); }
+NAN_METHOD(verify_share_batch_async) { verify_share_batch_method(info, true); }
+
+// cpu_info(): features of this CPU the hash functions are selected by
+NAN_METHOD(cpu_info) {
+    static const char* const vendors[]    = { "unknown", "intel", "amd" };
+    static const char* const assemblies[] = { "none", "auto", "intel", "ryzen", "bulldozer" };
+
+    const xmrig::ICpuInfo* cpu = xmrig::Cpu::info();
+    v8::Local<v8::Object> object = Nan::New<v8::Object>();
+    Nan::Set(object, Nan::New("brand").ToLocalChecked(), Nan::New(cpu->brand()).ToLocalChecked());
+    Nan::Set(object, Nan::New("vendor").ToLocalChecked(), Nan::New(vendors[cpu->vendor()]).ToLocalChecked());
+    Nan::Set(object, Nan::New("family").ToLocalChecked(), Nan::New<Number>(cpu->family()));
+    Nan::Set(object, Nan::New("model").ToLocalChecked(), Nan::New<Number>(cpu->model()));
+    Nan::Set(object, Nan::New("aes").ToLocalChecked(), Nan::New<v8::Boolean>(cpu->hasAES()));
+    Nan::Set(object, Nan::New("avx2").ToLocalChecked(), Nan::New<v8::Boolean>(cpu->hasAVX2()));
+    Nan::Set(object, Nan::New("avx512f").ToLocalChecked(), Nan::New<v8::Boolean>(cpu->hasAVX512F()));
+    Nan::Set(object, Nan::New("vaes").ToLocalChecked(), Nan::New<v8::Boolean>(cpu->hasVAES()));
+    Nan::Set(object, Nan::New("soft_aes").ToLocalChecked(), Nan::New<v8::Boolean>(xmrig::Cpu::isSoftAES()));
+    Nan::Set(object, Nan::New("assembly").ToLocalChecked(), Nan::New(assemblies[xmrig::Cpu::isSoftAES() ? xmrig::Assembly::NONE : cpu->assembly()]).ToLocalChecked());
+    info.GetReturnValue().Set(object);
+}
 
-    Local<Object> target = info[0]->ToObject();
-    if (!Buffer::HasInstance(target)) return THROW_ERROR_EXCEPTION("Argument 1 should be a buffer object.");
+// autotune([opts]): sets the autotuner options (enabled, profile) and returns them
+// with what was picked so far for each algorithm, by name
+NAN_METHOD(autotune) {
+    static const char* const assemblies[] = { "none", "auto", "intel", "ryzen", "bulldozer" };
+
+    if (info.Length() >= 1 && !info[0]->IsUndefined()) {
+        if (!info[0]->IsObject()) return THROW_ERROR_EXCEPTION("opts should be an object");
+        v8::Local<v8::Object> opts = info[0].As<v8::Object>();
+        v8::Local<v8::Value> value;
+        if (get_option(opts, "enabled", value)) {
+            if (!value->IsBoolean()) return THROW_ERROR_EXCEPTION("enabled should be a boolean");
+            tune::set_enabled(Nan::To<bool>(value).FromMaybe(true));
+        }
+        if (get_option(opts, "profile", value)) {
+            if (!value->IsString() && !value->IsNull()) return THROW_ERROR_EXCEPTION("profile should be a string or null");
+            tune::set_profile(value->IsNull() ? std::string() : std::string(*Nan::Utf8String(value)));
+        }
+    }
 
-    char output[32];
-    xmrig::astrobwt::astrobwt_dero(Buffer::Data(target), Buffer::Length(target), mem.scratchpad(), reinterpret_cast<uint8_t*>(output), std::numeric_limits<int>::max());
+    v8::Local<v8::Object> results = Nan::New<v8::Object>();
+    for (const AlgoSpec& algo : algos) {
+        v8::Local<v8::Object> result = Nan::New<v8::Object>();
+        bool benchmarked = false;
+        if (algo.family == AlgoSpec::CN) {
+            const CnFn fn = algo.get_fn(algo.variant);
+            tune::CnResult cn;
+            if (!tune::cn_result(fn.algo, cn)) continue;
+            if (xmrig::Algorithm::family(fn.algo) == xmrig::Algorithm::ARGON2) {
+                std::string impl;
+                if (!tune::argon2_result(impl, benchmarked)) continue;
+                Nan::Set(result, Nan::New("impl").ToLocalChecked(), Nan::New(impl).ToLocalChecked());
+            } else {
+                v8::Local<v8::Array> assembly = Nan::New<v8::Array>(CnFn::MAX_WAYS);
+                for (size_t i = 0; i < CnFn::MAX_WAYS; ++i) {
+                    Nan::Set(assembly, i, Nan::New(assemblies[cn.assembly[i]]).ToLocalChecked());
+                }
+                Nan::Set(result, Nan::New("ways").ToLocalChecked(), Nan::New<Number>(cn.ways));
+                Nan::Set(result, Nan::New("assembly").ToLocalChecked(), assembly);
+                benchmarked = cn.benchmarked;
+            }
+        } else if (algo.family == AlgoSpec::RX) {
+            bool hard_aes;
+            if (!tune::rx_result(algo.variant, hard_aes, benchmarked)) continue;
+            Nan::Set(result, Nan::New("hard_aes").ToLocalChecked(), Nan::New<v8::Boolean>(hard_aes));
+        } else {
+            continue;
+        }
+        Nan::Set(result, Nan::New("benchmarked").ToLocalChecked(), Nan::New<v8::Boolean>(benchmarked));
+        Nan::Set(results, Nan::New(algo.name).ToLocalChecked(), result);
+    }
 
-    v8::Local<v8::Value> returnValue = Nan::CopyBuffer(output, 32).ToLocalChecked();
-    info.GetReturnValue().Set(returnValue);
+    v8::Local<v8::Object> object = Nan::New<v8::Object>();
+    Nan::Set(object, Nan::New("enabled").ToLocalChecked(), Nan::New<v8::Boolean>(tune::enabled()));
+    Nan::Set(object, Nan::New("profile").ToLocalChecked(), Nan::New(tune::profile()).ToLocalChecked());
+    Nan::Set(object, Nan::New("cpu").ToLocalChecked(), Nan::New(tune::cpu()).ToLocalChecked());
+    Nan::Set(object, Nan::New("algos").ToLocalChecked(), results);
+    info.GetReturnValue().Set(object);
+}
+
+// threads([count]): sets the number of async hashing threads (0 = one per CPU)
+// and returns the current number.
+NAN_METHOD(threads) {
+    if (info.Length() >= 1) {
+        if (!info[0]->IsNumber()) return THROW_ERROR_EXCEPTION("Argument 1 should be a number");
+        workers::set_threads(Nan::To<uint32_t>(info[0]).FromMaybe(0));
+    }
+    info.GetReturnValue().Set(Nan::New<Number>(workers::threads()));
 }
 
 
@@ -484,7 +1221,34 @@ NAN_MODULE_INIT(init) {
     Nan::Set(target, Nan::New("c29v").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(c29v)).ToLocalChecked());
     Nan::Set(target, Nan::New("c29_cycle_hash").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(c29_cycle_hash)).ToLocalChecked());
     Nan::Set(target, Nan::New("astrobwt").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(astrobwt)).ToLocalChecked());
+    Nan::Set(target, Nan::New("hash_batch").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(hash_batch)).ToLocalChecked());
+    Nan::Set(target, Nan::New("verify_share").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(verify_share)).ToLocalChecked());
+    Nan::Set(target, Nan::New("verify_share_batch").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(verify_share_batch)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("cryptonight_async").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(cryptonight_async)).ToLocalChecked());
+    Nan::Set(target, Nan::New("cryptonight_light_async").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(cryptonight_light_async)).ToLocalChecked());
+    Nan::Set(target, Nan::New("cryptonight_heavy_async").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(cryptonight_heavy_async)).ToLocalChecked());
+    Nan::Set(target, Nan::New("cryptonight_pico_async").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(cryptonight_pico_async)).ToLocalChecked());
+    Nan::Set(target, Nan::New("randomx_async").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(randomx_async)).ToLocalChecked());
+    Nan::Set(target, Nan::New("argon2_async").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(argon2_async)).ToLocalChecked());
+    Nan::Set(target, Nan::New("k12_async").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(k12_async)).ToLocalChecked());
+    Nan::Set(target, Nan::New("c29s_async").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(c29s_async)).ToLocalChecked());
+    Nan::Set(target, Nan::New("c29v_async").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(c29v_async)).ToLocalChecked());
+    Nan::Set(target, Nan::New("c29_cycle_hash_async").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(c29_cycle_hash_async)).ToLocalChecked());
+    Nan::Set(target, Nan::New("astrobwt_async").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(astrobwt_async)).ToLocalChecked());
+    Nan::Set(target, Nan::New("hash_batch_async").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(hash_batch_async)).ToLocalChecked());
+    Nan::Set(target, Nan::New("verify_share_async").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(verify_share_async)).ToLocalChecked());
+    Nan::Set(target, Nan::New("verify_share_batch_async").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(verify_share_batch_async)).ToLocalChecked());
+
+    Nan::Set(target, Nan::New("randomx_prepare").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(randomx_prepare)).ToLocalChecked());
+    Nan::Set(target, Nan::New("randomx_caches").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(randomx_caches)).ToLocalChecked());
+    Nan::Set(target, Nan::New("randomx_fast_mode").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(randomx_fast_mode)).ToLocalChecked());
+    Nan::Set(target, Nan::New("randomx_snapshots").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(randomx_snapshots)).ToLocalChecked());
+    Nan::Set(target, Nan::New("randomx_shared").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(randomx_shared)).ToLocalChecked());
+    Nan::Set(target, Nan::New("randomx_timing").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(randomx_timing)).ToLocalChecked());
+    Nan::Set(target, Nan::New("cpu_info").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(cpu_info)).ToLocalChecked());
+    Nan::Set(target, Nan::New("autotune").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(autotune)).ToLocalChecked());
+    Nan::Set(target, Nan::New("threads").ToLocalChecked(), Nan::GetFunction(Nan::New<FunctionTemplate>(threads)).ToLocalChecked());
 }
 
-NODE_MODULE(cryptonight, init)
-
+NAN_MODULE_WORKER_ENABLED(cryptonight, init)
@@ -0,0 +1,353 @@
+#include "rx_shared.h"
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "crypto/common/Algorithm.h"
+#include "crypto/common/VirtualMemory.h"
+#include "rx_snapshot.h"
+
+namespace {
+
+const char CONTROL_MAGIC[8] = { 'R', 'X', 'S', 'H', 'C', 'T', 'L', '1' };
+const char SEGMENT_MAGIC[8] = { 'R', 'X', 'S', 'H', 'S', 'E', 'G', '1' };
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "shared memory needs lock free 64-bit atomics");
+
+// One per name and variant, never unmapped since any thread may be reading it
+struct Control {
+    char magic[8];             // written last by the creator
+    uint32_t variant;
+    uint32_t reserved;
+    uint8_t config[32];
+    std::atomic<uint32_t> next; // generation of the next segment
+    std::atomic<uint64_t> current;
+};
+
+const size_t CONTROL_SIZE = 4096;
+
+// Data starts at a large page boundary. Programs of a cache follow its memory.
+const size_t DATA_OFFSET   = 2 * 1024 * 1024;
+const size_t PROGRAMS_ROOM = 1024 * 1024;
+
+struct Header {
+    char magic[8];
+    uint32_t variant;
+    uint32_t generation;
+    uint8_t config[32];
+    uint8_t seed_hash[32];  // of a cache
+    uint64_t memory_size;   // cache memory or dataset items
+    uint64_t programs_size; // of a cache
+    uint32_t cache;         // generation of the cache a dataset is built from
+    uint32_t reserved;
+};
+
+std::mutex mutex;
+std::map<std::string, Control*> controls; // by segment name
+std::atomic<int> modes[xmrig::Algorithm::MAX];
+std::atomic<Control*> control_of[xmrig::Algorithm::MAX];
+std::string names[xmrig::Algorithm::MAX];
+
+std::string base_name(const std::string& name, const int variant) {
+    return "/" + name + "-rx" + std::to_string(variant);
+}
+
+std::string segment_name(const int variant, const uint32_t generation) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return base_name(names[variant], variant) + "-" + std::to_string(generation);
+}
+
+// Waits up to a second for another process to finish creating a control segment
+Control* open_control(const std::string& name) {
+    for (int i = 0; i < 1000; ++i) {
+        const int fd = shm_open(name.c_str(), O_RDWR, 0600);
+        if (fd < 0) return nullptr;
+        struct stat st;
+        void* map = nullptr;
+        if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) >= CONTROL_SIZE) {
+            map = xmrig::VirtualMemory::mapSharedMemory(fd, CONTROL_SIZE, true, false);
+        }
+        close(fd);
+
+        if (map) {
+            Control* control = static_cast<Control*>(map);
+            if (memcmp(control->magic, CONTROL_MAGIC, sizeof(CONTROL_MAGIC)) == 0) {
+                std::atomic_thread_fence(std::memory_order_acquire);
+                return control;
+            }
+            xmrig::VirtualMemory::unmapSharedMemory(map, CONTROL_SIZE);
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return nullptr;
+}
+
+Control* create_control(const std::string& name, const int variant, const uint8_t* config) {
+    const int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) return errno == EEXIST ? open_control(name) : nullptr;
+
+    void* map = ftruncate(fd, CONTROL_SIZE) == 0 ? xmrig::VirtualMemory::mapSharedMemory(fd, CONTROL_SIZE, true, false) : nullptr;
+    close(fd);
+    if (!map) {
+        shm_unlink(name.c_str());
+        return nullptr;
+    }
+
+    Control* control = static_cast<Control*>(map); // zero filled
+    control->variant = variant;
+    memcpy(control->config, config, sizeof(control->config));
+    control->next = 1;
+    std::atomic_thread_fence(std::memory_order_release);
+    memcpy(control->magic, CONTROL_MAGIC, sizeof(CONTROL_MAGIC));
+    return control;
+}
+
+Header make_header(const int variant, const RandomX_ConfigurationBase* config, const uint32_t generation) {
+    Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC));
+    header.variant = variant;
+    header.generation = generation;
+    rx_snapshot::config_hash(config, header.config);
+    return header;
+}
+
+// A dataset's config is checked by the generation of its cache
+Header make_dataset_header(const int variant, const uint32_t generation) {
+    Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, SEGMENT_MAGIC, sizeof(SEGMENT_MAGIC));
+    header.variant = variant;
+    header.generation = generation;
+    return header;
+}
+
+// New writable segment of data_size bytes after the header, with the next generation
+bool create(const int variant, const size_t data_size, rx_shared::Segment& segment) {
+    Control* control = control_of[variant];
+    if (modes[variant] != rx_shared::PUBLISH || !control) return false;
+
+    const uint32_t generation = control->next++;
+    const std::string name = segment_name(variant, generation);
+    const int fd = shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0) return false;
+
+    const size_t size = DATA_OFFSET + data_size;
+    void* map = ftruncate(fd, size) == 0 ? xmrig::VirtualMemory::mapSharedMemory(fd, size, true, true) : nullptr;
+    close(fd);
+    if (!map) {
+        shm_unlink(name.c_str());
+        return false;
+    }
+
+    segment.generation = generation;
+    segment.data = static_cast<uint8_t*>(map);
+    segment.size = size;
+    segment.name = name;
+    segment.control = control;
+    return true;
+}
+
+// Announced segment mapped read only if its header starts like header's and it
+// has data_size bytes of data, or any if data_size is 0
+bool attach(const int variant, const Header& header, const size_t data_size, rx_shared::Segment& segment) {
+    const int fd = shm_open(segment_name(variant, header.generation).c_str(), O_RDONLY, 0);
+    if (fd < 0) return false;
+
+    struct stat st;
+    size_t size = 0;
+    void* map = nullptr;
+    if (fstat(fd, &st) == 0 && static_cast<size_t>(st.st_size) > DATA_OFFSET) {
+        size = st.st_size;
+        if (data_size == 0 || size == DATA_OFFSET + data_size) map = xmrig::VirtualMemory::mapSharedMemory(fd, size, false, true);
+    }
+    close(fd);
+    if (!map) return false;
+
+    if (memcmp(map, &header, offsetof(Header, seed_hash)) != 0) {
+        xmrig::VirtualMemory::unmapSharedMemory(map, size);
+        return false;
+    }
+    segment.generation = header.generation;
+    segment.data = static_cast<uint8_t*>(map);
+    segment.size = size;
+    segment.name.clear();
+    segment.control = nullptr;
+    return true;
+}
+
+}
+
+void rx_shared::unmap(Segment& segment) {
+    if (!segment.data) return;
+
+    // A withdrawn cache takes its dataset with it
+    if (segment.control) {
+        std::atomic<uint64_t>& current = static_cast<Control*>(segment.control)->current;
+        uint64_t value = current.load(std::memory_order_relaxed);
+        for (;;) {
+            uint64_t next;
+            if (value >> 32 == segment.generation) {
+                next = 0;
+            } else if ((value & 0xFFFFFFFF) == segment.generation) {
+                next = value & ~0xFFFFFFFFULL;
+            } else {
+                break;
+            }
+            if (current.compare_exchange_weak(value, next)) break;
+        }
+    }
+
+    if (!segment.name.empty()) shm_unlink(segment.name.c_str());
+    xmrig::VirtualMemory::unmapSharedMemory(segment.data, segment.size);
+    segment = Segment();
+}
+
+void rx_shared::set(const int variant, const RandomX_ConfigurationBase* config, const Mode mode, const std::string& name) {
+    Control* control = nullptr;
+    if (mode != OFF) {
+        if (name.empty() || name.find('/') != std::string::npos || name.size() > 200) {
+            throw std::runtime_error("Invalid shared memory name");
+        }
+
+        uint8_t hash[32];
+        rx_snapshot::config_hash(config, hash);
+        const std::string base = base_name(name, variant);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        control = controls[base];
+        if (!control) control = controls[base] = create_control(base, variant, hash);
+        if (!control) {
+            controls.erase(base);
+            throw std::runtime_error("Can't open shared memory " + base);
+        }
+        if (control->variant != static_cast<uint32_t>(variant) || memcmp(control->config, hash, sizeof(hash)) != 0) {
+            throw std::runtime_error("Shared memory " + base + " is used by another RandomX config");
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    modes[variant] = OFF;
+    control_of[variant] = control;
+    names[variant] = mode != OFF ? name : std::string();
+    modes[variant] = mode;
+}
+
+rx_shared::Mode rx_shared::mode(const int variant) {
+    return static_cast<Mode>(modes[variant].load());
+}
+
+std::string rx_shared::name(const int variant) {
+    std::lock_guard<std::mutex> lock(mutex);
+    return names[variant];
+}
+
+randomx_cache* rx_shared::create_cache(const int variant, const RandomX_ConfigurationBase* config, Segment& segment) {
+    const size_t memory_size = static_cast<size_t>(config->ArgonMemory) * 1024;
+    if (!create(variant, memory_size + PROGRAMS_ROOM, segment)) return nullptr;
+
+    Header header = make_header(variant, config, segment.generation);
+    header.memory_size = memory_size;
+    memcpy(segment.data, &header, sizeof(header));
+
+    randomx_cache* cache = randomx_alloc_cache_on(RANDOMX_FLAG_JIT, config, segment.data + DATA_OFFSET);
+    if (!cache) cache = randomx_alloc_cache_on(RANDOMX_FLAG_DEFAULT, config, segment.data + DATA_OFFSET);
+    if (!cache) unmap(segment);
+    return cache;
+}
+
+void rx_shared::publish_cache(const int variant, const uint8_t* seed_hash, randomx_cache* cache, Segment& segment) {
+    Header* header = reinterpret_cast<Header*>(segment.data);
+    const size_t programs_size = randomx_get_cache_programs(cache, nullptr);
+    if (programs_size > PROGRAMS_ROOM) return;
+
+    randomx_get_cache_programs(cache, segment.data + DATA_OFFSET + header->memory_size);
+    header->programs_size = programs_size;
+    memcpy(header->seed_hash, seed_hash, sizeof(header->seed_hash));
+
+    Control* control = control_of[variant];
+    if (modes[variant] == PUBLISH && control) {
+        control->current.store(static_cast<uint64_t>(segment.generation) << 32, std::memory_order_release);
+    }
+}
+
+randomx_dataset* rx_shared::create_dataset(const int variant, const uint32_t cache, const unsigned long items, Segment& segment) {
+    const size_t memory_size = static_cast<size_t>(items) * RANDOMX_DATASET_ITEM_SIZE;
+    if (!cache || !create(variant, memory_size, segment)) return nullptr;
+
+    Header header = make_dataset_header(variant, segment.generation);
+    header.memory_size = memory_size;
+    header.cache = cache;
+    memcpy(segment.data, &header, sizeof(header));
+
+    randomx_dataset* dataset = randomx_alloc_dataset_on(nullptr, items, segment.data + DATA_OFFSET);
+    if (!dataset) unmap(segment);
+    return dataset;
+}
+
+void rx_shared::publish_dataset(const int variant, Segment& segment) {
+    const Header* header = reinterpret_cast<const Header*>(segment.data);
+    Control* control = control_of[variant];
+    if (modes[variant] != PUBLISH || !control) return;
+
+    uint64_t current = control->current.load(std::memory_order_relaxed);
+    do {
+        if (current >> 32 != header->cache) return;
+    } while (!control->current.compare_exchange_weak(current, (current & ~0xFFFFFFFFULL) | segment.generation, std::memory_order_release));
+}
+
+uint64_t rx_shared::current(const int variant) {
+    Control* control = control_of[variant];
+    if (modes[variant] == OFF || !control) return 0;
+    return control->current.load(std::memory_order_acquire);
+}
+
+randomx_cache* rx_shared::attach_cache(const int variant, const RandomX_ConfigurationBase* config, const uint32_t generation, uint8_t* seed_hash, Segment& segment) {
+    Header header = make_header(variant, config, generation);
+    header.memory_size = static_cast<size_t>(config->ArgonMemory) * 1024;
+    if (!attach(variant, header, header.memory_size + PROGRAMS_ROOM, segment)) return nullptr;
+
+    const Header* shared = reinterpret_cast<const Header*>(segment.data);
+    randomx_cache* cache = nullptr;
+    if (shared->memory_size == header.memory_size && shared->programs_size <= PROGRAMS_ROOM) {
+        cache = randomx_alloc_cache_on(RANDOMX_FLAG_JIT, config, segment.data + DATA_OFFSET);
+        if (!cache) cache = randomx_alloc_cache_on(RANDOMX_FLAG_DEFAULT, config, segment.data + DATA_OFFSET);
+    }
+    if (cache && !randomx_init_cache_programs(cache, segment.data + DATA_OFFSET + header.memory_size, shared->programs_size)) {
+        randomx_release_cache(cache);
+        cache = nullptr;
+    }
+
+    if (cache) {
+        memcpy(seed_hash, shared->seed_hash, sizeof(shared->seed_hash));
+    } else {
+        unmap(segment);
+    }
+    return cache;
+}
+
+randomx_dataset* rx_shared::attach_dataset(const int variant, const RandomX_ConfigurationBase* config, const uint32_t generation, const uint32_t cache, unsigned long& items, Segment& segment) {
+    Header header = make_dataset_header(variant, generation);
+    if (!attach(variant, header, 0, segment)) return nullptr;
+
+    const Header* shared = reinterpret_cast<const Header*>(segment.data);
+    items = shared->memory_size / RANDOMX_DATASET_ITEM_SIZE;
+    randomx_dataset* dataset = nullptr;
+    if (shared->cache == cache && shared->memory_size == segment.size - DATA_OFFSET && items > 0 &&
+        items <= randomx_dataset_item_count(config) && shared->memory_size % RANDOMX_DATASET_ITEM_SIZE == 0) {
+        dataset = randomx_alloc_dataset_on(config, items, segment.data + DATA_OFFSET);
+    }
+    if (!dataset) unmap(segment);
+    return dataset;
+}
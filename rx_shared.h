@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "crypto/randomx/randomx.h"
+
+// RandomX caches and datasets in POSIX shared memory, so processes on one host
+// build them once. A publishing process builds them in segments named after a
+// common name and announces each one in a small control segment, attached
+// processes map the announced ones read only. Announcements carry increasing
+// generations, so attached processes notice a new seed with one atomic read.
+namespace rx_shared {
+
+enum Mode { OFF, ATTACH, PUBLISH };
+
+// Segment mapped into this process. The process that created it withdraws its
+// announcement and removes its name when unmapping it, processes that attached
+// it keep their mapping.
+struct Segment {
+    uint32_t generation = 0; // 0 if none
+    uint8_t* data = nullptr;
+    size_t size = 0;
+    std::string name;        // to remove, empty if attached
+    void* control = nullptr; // announcing it, if created here
+};
+void unmap(Segment& segment);
+
+// Sets the mode of variant with the segments under name (a file name, without
+// slashes). Throws std::runtime_error if the control segment can't be opened
+// or is used by another config of the variant.
+void set(int variant, const RandomX_ConfigurationBase* config, Mode mode, const std::string& name);
+Mode mode(int variant);
+std::string name(int variant);
+
+// Publishing: a cache not initialized yet on a new segment, nullptr if there is
+// no shared memory for it. publish_cache() announces it once initialized, which
+// makes the dataset of the previous one stale.
+randomx_cache* create_cache(int variant, const RandomX_ConfigurationBase* config, Segment& segment);
+void publish_cache(int variant, const uint8_t* seed_hash, randomx_cache* cache, Segment& segment);
+
+// Publishing: a dataset of items on a new segment to build from the cache
+// announced as generation cache, announced once built unless a newer cache was.
+randomx_dataset* create_dataset(int variant, uint32_t cache, unsigned long items, Segment& segment);
+void publish_dataset(int variant, Segment& segment);
+
+// Generations of the announced cache (high 32 bits) and dataset (low 32 bits,
+// 0 if none), 0 if nothing was announced or the mode is OFF
+uint64_t current(int variant);
+
+// Attaching: maps an announced cache, or dataset built from cache, nullptr if
+// it is gone
+randomx_cache* attach_cache(int variant, const RandomX_ConfigurationBase* config, uint32_t generation, uint8_t* seed_hash, Segment& segment);
+randomx_dataset* attach_dataset(int variant, const RandomX_ConfigurationBase* config, uint32_t generation, uint32_t cache, unsigned long& items, Segment& segment);
+
+}
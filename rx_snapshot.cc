@@ -0,0 +1,206 @@
+#include "rx_snapshot.h"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "crypto/randomx/blake2/blake2.h"
+
+namespace {
+
+const char MAGIC[8] = { 'R', 'X', 'S', 'N', 'A', 'P', '0', '1' };
+
+// Cache memory starts here, page aligned for the mapping. The programs follow it.
+const size_t HEADER_SIZE = 4096;
+
+struct Header {
+    char magic[8];
+    uint32_t variant;
+    uint32_t reserved;
+    uint8_t seed_hash[32];
+    uint8_t config[32];        // hash of the config fields the cache depends on
+    uint64_t memory_size;
+    uint64_t programs_size;
+    uint64_t memory_sum;       // checksum() of the cache memory
+    uint8_t programs_hash[32];
+    uint8_t header_hash[32];   // of everything above
+};
+static_assert(sizeof(Header) <= HEADER_SIZE, "snapshot header doesn't fit");
+
+std::string default_dir() {
+    const char* dir = getenv("CRYPTONIGHT_RX_SNAPSHOTS");
+    return dir ? dir : "";
+}
+
+std::mutex mutex;
+std::string snapshot_dir = default_dir();
+
+std::string path(const int variant, const uint8_t* seed_hash) {
+    std::string dir;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        dir = snapshot_dir;
+    }
+    if (dir.empty()) return dir;
+
+    static const char hex[] = "0123456789abcdef";
+    std::string seed;
+    for (size_t i = 0; i < 32; ++i) {
+        seed += hex[seed_hash[i] >> 4];
+        seed += hex[seed_hash[i] & 15];
+    }
+    return dir + "/rx-" + std::to_string(variant) + "-" + seed + ".cache";
+}
+
+// Four multiply-rotate lanes keep up with reading the memory, and each step is
+// invertible, so changing any word changes the result
+uint64_t checksum(const uint8_t* data, const size_t size) {
+    uint64_t lanes[4] = { 1, 2, 3, 4 };
+    for (size_t i = 0; i + sizeof(lanes) <= size; i += sizeof(lanes)) {
+        for (size_t k = 0; k < 4; ++k) {
+            uint64_t word;
+            memcpy(&word, data + i + k * sizeof(word), sizeof(word));
+            const uint64_t x = (lanes[k] ^ word) * 0x9E3779B97F4A7C15ULL;
+            lanes[k] = (x << 31) | (x >> 33);
+        }
+    }
+
+    uint64_t sum;
+    rx_blake2b(&sum, sizeof(sum), lanes, sizeof(lanes), nullptr, 0);
+    return sum;
+}
+
+// Header of variant's cache for seed_hash, without the sizes and hashes of the contents
+Header make_header(const int variant, const RandomX_ConfigurationBase* config, const uint8_t* seed_hash) {
+    Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.variant = variant;
+    memcpy(header.seed_hash, seed_hash, sizeof(header.seed_hash));
+    rx_snapshot::config_hash(config, header.config);
+    header.memory_size = static_cast<uint64_t>(config->ArgonMemory) * 1024;
+    return header;
+}
+
+void hash_header(const Header& header, uint8_t* out) {
+    rx_blake2b(out, 32, &header, offsetof(Header, header_hash), nullptr, 0);
+}
+
+// Checks a mapped snapshot and creates its cache, nullptr if it doesn't check out
+randomx_cache* load_mapped(const uint8_t* data, const size_t size, const Header& expected, const RandomX_ConfigurationBase* config) {
+    Header header;
+    memcpy(&header, data, sizeof(header));
+
+    uint8_t hash[32];
+    hash_header(header, hash);
+    if (memcmp(hash, header.header_hash, sizeof(hash)) != 0) return nullptr;
+    if (memcmp(&header, &expected, offsetof(Header, programs_size)) != 0) return nullptr;
+    if (header.programs_size != size - HEADER_SIZE - header.memory_size) return nullptr;
+
+    const uint8_t* programs = data + HEADER_SIZE + header.memory_size;
+    rx_blake2b(hash, sizeof(hash), programs, header.programs_size, nullptr, 0);
+    if (memcmp(hash, header.programs_hash, sizeof(hash)) != 0) return nullptr;
+
+    uint8_t* memory = const_cast<uint8_t*>(data + HEADER_SIZE); // only ever read
+    if (checksum(memory, header.memory_size) != header.memory_sum) return nullptr;
+
+    randomx_cache* cache = randomx_alloc_cache_on(RANDOMX_FLAG_JIT, config, memory);
+    if (!cache) cache = randomx_alloc_cache_on(RANDOMX_FLAG_DEFAULT, config, memory);
+    if (cache && !randomx_init_cache_programs(cache, programs, header.programs_size)) {
+        randomx_release_cache(cache);
+        cache = nullptr;
+    }
+    return cache;
+}
+
+}
+
+bool rx_snapshot::load(const int variant, const RandomX_ConfigurationBase* config, const uint8_t* seed_hash, Mapped& mapped) {
+    const std::string file = path(variant, seed_hash);
+    if (file.empty()) return false;
+
+    const int fd = open(file.c_str(), O_RDONLY);
+    if (fd < 0) return false;
+
+    const Header expected = make_header(variant, config, seed_hash);
+    struct stat st;
+    void* map = MAP_FAILED;
+    if (fstat(fd, &st) == 0 && static_cast<uint64_t>(st.st_size) >= HEADER_SIZE + expected.memory_size) {
+        int flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+        flags |= MAP_POPULATE;
+#endif
+        map = mmap(nullptr, st.st_size, PROT_READ, flags, fd, 0);
+    }
+    close(fd);
+    if (map == MAP_FAILED) return false;
+
+    randomx_cache* cache = load_mapped(static_cast<const uint8_t*>(map), st.st_size, expected, config);
+    if (!cache) {
+        munmap(map, st.st_size);
+        return false;
+    }
+    mapped.cache = cache;
+    mapped.data  = map;
+    mapped.size  = st.st_size;
+    return true;
+}
+
+void rx_snapshot::unmap(Mapped& mapped) {
+    randomx_release_cache(mapped.cache);
+    munmap(mapped.data, mapped.size);
+    mapped = Mapped();
+}
+
+void rx_snapshot::save(const int variant, const RandomX_ConfigurationBase* config, const uint8_t* seed_hash, randomx_cache* cache) {
+    const std::string file = path(variant, seed_hash);
+    if (file.empty()) return;
+
+    std::vector<uint8_t> programs(randomx_get_cache_programs(cache, nullptr));
+    randomx_get_cache_programs(cache, programs.data());
+    const uint8_t* memory = static_cast<const uint8_t*>(randomx_get_cache_memory(cache));
+
+    Header header = make_header(variant, config, seed_hash);
+    header.programs_size = programs.size();
+    header.memory_sum = checksum(memory, header.memory_size);
+    rx_blake2b(header.programs_hash, sizeof(header.programs_hash), programs.data(), programs.size(), nullptr, 0);
+    hash_header(header, header.header_hash);
+
+    std::vector<uint8_t> head(HEADER_SIZE);
+    memcpy(head.data(), &header, sizeof(header));
+
+    // Written under another name first, so readers never see half a snapshot
+    const std::string tmp = file + "." + std::to_string(getpid()) + ".tmp";
+    FILE* out = fopen(tmp.c_str(), "wb");
+    if (!out) return;
+    bool written = fwrite(head.data(), head.size(), 1, out) == 1 &&
+                   fwrite(memory, header.memory_size, 1, out) == 1 &&
+                   fwrite(programs.data(), programs.size(), 1, out) == 1;
+    written = fclose(out) == 0 && written;
+    if (!written || rename(tmp.c_str(), file.c_str()) != 0) remove(tmp.c_str());
+}
+
+void rx_snapshot::set_dir(const std::string& dir) {
+    std::lock_guard<std::mutex> lock(mutex);
+    snapshot_dir = dir;
+}
+
+std::string rx_snapshot::dir() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return snapshot_dir;
+}
+
+void rx_snapshot::config_hash(const RandomX_ConfigurationBase* config, uint8_t* out) {
+    const std::string fields = std::to_string(config->ArgonMemory) + " " + std::to_string(config->ArgonIterations) + " " +
+        std::to_string(config->ArgonLanes) + " " + std::to_string(config->CacheAccesses) + " " +
+        std::to_string(config->SuperscalarLatency) + " " + config->ArgonSalt;
+    rx_blake2b(out, 32, fields.data(), fields.size(), nullptr, 0);
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "crypto/randomx/randomx.h"
+
+// Snapshots of initialized RandomX caches on disk, so a restarted process maps
+// them back in instead of running Argon2 again. One file per variant and seed
+// hash holds the cache memory and its SuperscalarHash programs. A file that is
+// truncated, damaged or written for another config of the variant fails its
+// checks and is rebuilt.
+namespace rx_snapshot {
+
+// Snapshot mapped read only with a cache on its memory. Processes mapping the
+// same snapshot share that memory.
+struct Mapped {
+    randomx_cache* cache = nullptr;
+    void* data = nullptr;
+    size_t size = 0;
+};
+
+// Maps the snapshot of variant's cache for seed_hash and creates the cache on
+// it. Returns false if there is none or it doesn't check out.
+bool load(int variant, const RandomX_ConfigurationBase* config, const uint8_t* seed_hash, Mapped& mapped);
+
+// Releases the cache of a loaded snapshot, then the mapping
+void unmap(Mapped& mapped);
+
+// Saves an initialized cache. Snapshots are only a cache, failing to write one
+// is not an error.
+void save(int variant, const RandomX_ConfigurationBase* config, const uint8_t* seed_hash, randomx_cache* cache);
+
+// Directory of the snapshots, CRYPTONIGHT_RX_SNAPSHOTS by default. Empty turns
+// them off, which is the default without that variable.
+void set_dir(const std::string& dir);
+std::string dir();
+
+// Hash of the config fields a cache depends on, 32 bytes
+void config_hash(const RandomX_ConfigurationBase* config, uint8_t* out);
+
+}
@@ -0,0 +1,79 @@
+#include "share.h"
+
+#include <cstring>
+
+namespace {
+
+struct U256 {
+    uint64_t w[4]; // least significant first
+
+    explicit U256(const uint8_t* data) {
+        memcpy(w, data, sizeof(w));
+    }
+
+    bool operator<(const U256& other) const {
+        for (int i = 3; i >= 0; --i) {
+            if (w[i] != other.w[i]) return w[i] < other.w[i];
+        }
+        return false;
+    }
+
+    // Shifts left by one bit with bit shifted in, returns the bit shifted out
+    bool shift_in(const bool bit) {
+        const bool out = (w[3] >> 63) != 0;
+        for (int i = 3; i > 0; --i) w[i] = (w[i] << 1) | (w[i - 1] >> 63);
+        w[0] = (w[0] << 1) | (bit ? 1 : 0);
+        return out;
+    }
+
+    void subtract(const U256& other) {
+        uint64_t borrow = 0;
+        for (int i = 0; i < 4; ++i) {
+            const uint64_t a = w[i];
+            const uint64_t b = other.w[i];
+            w[i] = a - b - borrow;
+            borrow = (a < b) || (a - b < borrow) ? 1 : 0;
+        }
+    }
+};
+
+}
+
+uint64_t share::difficulty(const uint8_t* hash) {
+    const U256 h(hash);
+
+    // Anything below 2^192 has a difficulty of at least 2^64
+    if (h.w[3] == 0) return UINT64_MAX;
+
+    // Bitwise long division of 2^256 - 1 by h. The quotient is below 2^64
+    // here, so only its low 64 bits are kept.
+    static const uint8_t zero[32] = {};
+    U256 r(zero);
+    uint64_t q = 0;
+    for (int i = 255; i >= 0; --i) {
+        const bool carry = r.shift_in(true);
+        if (carry || !(r < h)) {
+            r.subtract(h);
+            if (i < 64) q |= uint64_t(1) << i;
+        }
+    }
+    return q;
+}
+
+bool share::Target::check(const uint8_t* hash, uint64_t& difficulty) const {
+    difficulty = share::difficulty(hash);
+    switch (type) {
+        case DIFFICULTY: {
+            return difficulty >= value;
+        }
+        case TARGET64: {
+            uint64_t top;
+            memcpy(&top, hash + 24, sizeof(top));
+            return top <= value;
+        }
+        case TARGET256: {
+            return !(U256(full) < U256(hash));
+        }
+    }
+    return false;
+}
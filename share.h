@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+
+// Share checks on 32-byte hashes read as little-endian 256-bit numbers, the
+// way CryptoNote pools do it: a hash meets difficulty d if hash * d < 2^256.
+namespace share {
+
+// floor((2^256 - 1) / hash), or UINT64_MAX if that doesn't fit 64 bits
+uint64_t difficulty(const uint8_t* hash);
+
+// What a share hash is checked against
+struct Target {
+    enum Type { DIFFICULTY, TARGET64, TARGET256 };
+
+    Type type;
+    uint64_t value;    // DIFFICULTY: minimum difficulty, TARGET64: highest allowed top 64 bits of the hash
+    uint8_t full[32];  // TARGET256: highest allowed hash
+
+    // Returns true if hash meets the target, difficulty gets its difficulty
+    bool check(const uint8_t* hash, uint64_t& difficulty) const;
+};
+
+}
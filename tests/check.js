@@ -0,0 +1,66 @@
+"use strict";
+let child_process = require('child_process');
+let fs = require('fs');
+
+// Counters and assertions shared by the test scripts. done() prints the
+// summary line run.sh looks for and fails the process if any check failed.
+let testsFailed = 0, testsPassed = 0;
+
+function check(name, result, expected) {
+    if (result !== expected) {
+        console.error(name + ": " + result + " instead of " + expected);
+        testsFailed += 1;
+    } else {
+        testsPassed += 1;
+    }
+}
+
+function throws(name, fn) {
+    try {
+        fn();
+        console.error(name + ": no error");
+        testsFailed += 1;
+    } catch (e) {
+        testsPassed += 1;
+    }
+}
+
+function done(name) {
+    if (testsFailed > 0){
+        console.log(testsFailed + '/' + (testsPassed + testsFailed) + ' tests failed on: ' + name);
+        process.exitCode = 1;
+    } else {
+        console.log(testsPassed + ' tests passed on: ' + name);
+    }
+}
+
+// Runs fn(...args) in a new node process started in this directory with env
+// added to its environment, and returns what fn returned, through JSON. fn is
+// sent as source, so it can't use the caller's variables: pass them in args.
+function run_with_env(env, fn, args) {
+    const output = child_process.execFileSync(process.execPath, [__filename], {
+        cwd: __dirname, env: Object.assign({}, process.env, env), input: call(fn, args)
+    });
+    return JSON.parse(output);
+}
+
+// The same without waiting, for fn that print their results themselves as
+// they go: returns the ChildProcess
+function spawn_with_env(env, fn, args) {
+    const child = child_process.spawn(process.execPath, [__filename], { cwd: __dirname, env: Object.assign({}, process.env, env) });
+    child.stdin.end(call(fn, args));
+    return child;
+}
+
+function call(fn, args) {
+    return JSON.stringify({ fn: fn.toString(), args: args || [] });
+}
+
+// Child side of run_with_env() and spawn_with_env()
+if (require.main === module) {
+    const request = JSON.parse(fs.readFileSync(0, 'utf8'));
+    const result = eval('(' + request.fn + ')').apply(null, request.args);
+    if (result !== undefined) console.log(JSON.stringify(result));
+}
+
+module.exports = { check: check, throws: throws, done: done, run_with_env: run_with_env, spawn_with_env: spawn_with_env };
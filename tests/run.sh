@@ -8,6 +8,10 @@ node test_k12.js
 node test_sync-1.js
 node test_sync-2.js
 node test_sync-r.js
+node test_cn_r_cache.js
+node test_cn_main_loop.js
+node test_cn_vaes.js
+node test_keccak_ways.js
 node test_sync-half.js
 node test_sync-msr.js
 node test_sync-xao.js
@@ -30,9 +34,27 @@ node test_rx_wow.js
 node test_rx_loki.js
 node test_rx_v.js
 node test_rx_switch.js
+node test_rx_prepare.js
+node test_rx_fast.js
+node test_rx_snapshot.js
+node test_rx_shared.js
+node test_rx_timing.js
+node test_rx_interpreter.js
 node test_ar2_chukwa.js
 node test_ar2_wrkz.js
 node test_sync-astrobwt.js
+node test_async.js
+node test_async_light.js
+node test_async_heavy.js
+node test_async_pico.js
+node test_async_rx.js
+node test_worker_threads.js
+node test_batch.js
+node test_out.js
+node test_verify_share.js
+node test_cpu_info.js
+node test_jit_wx.js
+node test_tune.js
 
 node test_perf.js
 node test_perf_k12.js
@@ -43,6 +65,9 @@ node test_perf_rx_defyx.js
 node test_perf_rx_wow.js
 node test_perf_rx_loki.js
 node test_perf_rx_switch.js
+node test_perf_rx_fast.js
+node test_perf_rx_batch.js
+node test_perf_rx_hybrid.js
 node test_perf_pico.js
 node test_perf_double.js
 node test_perf_ar2_chukwa.js
@@ -0,0 +1,56 @@
+"use strict";
+let multiHashing = require('../build/Release/cryptonight-hashing');
+let fs = require('fs');
+
+multiHashing.threads(2);
+
+let testsFailed = 0, testsPassed = 0;
+let jobs = [];
+for (const [file, algo] of [['rx0.txt', 0], ['rx_arq.txt', 2]]) {
+     for (const line of fs.readFileSync(file, 'utf8').split('\n')) {
+          if (!line) continue;
+          const line_data0 = line.split(" ");
+          const line_data = line_data0.slice(0, 2).concat(line_data0.slice(2).join(" "));
+          jobs.push(multiHashing.randomx_async(Buffer.from(line_data[2]), Buffer.from(line_data[1]), algo).then(function(result){
+               result = result.toString('hex');
+               if (line_data[0] !== result) {
+                    console.error(line_data[1] + " '" + line_data[2] + "': " + result);
+                    testsFailed += 1;
+               } else {
+                    testsPassed += 1;
+               }
+          }));
+     }
+}
+// Variants with different configs hash side by side on the pool threads
+for (let i = 0; i < 4; ++i) {
+     for (const [seed, algo, hash] of [
+          ['0000000000000000000000000000000000000000000000000000000000000000', 17, 'dcd9efef9df794171af262df328bd2c16a6d51ae9abdcb9357ce4ab3c0c9a8ba'],
+          ['000000000000000100000000000000000000000f000000042000000000000000', 18, '3c1f6d871c8571ae74cce3c6ff7d11ed7f5848c19a26d9c5972869cfabc449a8']
+     ]) {
+          jobs.push(multiHashing.randomx_async(Buffer.from('This is a test'), Buffer.from(seed, 'hex'), algo).then(function(result){
+               result = result.toString('hex');
+               if (hash !== result) {
+                    console.error("algo " + algo + ": " + result);
+                    testsFailed += 1;
+               } else {
+                    testsPassed += 1;
+               }
+          }));
+     }
+}
+try {
+     multiHashing.randomx_async(Buffer.from("test"), Buffer.alloc(32), 3);
+     console.error("unknown algo: no error");
+     testsFailed += 1;
+} catch (e) {
+     testsPassed += 1;
+}
+
+Promise.all(jobs).then(function(){
+    if (testsFailed > 0){
+        console.log(testsFailed + '/' + (testsPassed + testsFailed) + ' tests failed on: randomx_async');
+    } else {
+        console.log(testsPassed + ' tests passed on: randomx_async');
+    }
+});
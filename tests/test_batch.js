@@ -0,0 +1,69 @@
+"use strict";
+let multiHashing = require('../build/Release/cryptonight-hashing');
+let { check, throws, done } = require('./check');
+let fs = require('fs');
+
+// cn/2 vectors hashed as an array of buffers and as one packed buffer
+let hashes = [], blobs = [];
+for (const line of fs.readFileSync('cryptonight-2.txt', 'utf8').split('\n')) {
+    if (!line) continue;
+    const line_data = line.split(/ (.+)/);
+    hashes.push(line_data[0]);
+    blobs.push(Buffer.from(line_data[1], 'hex'));
+}
+check('cn/2 array', multiHashing.hash_batch('cn/2', blobs).toString('hex'), hashes.join(''));
+
+let offsets = [], pos = 0;
+for (const blob of blobs) { offsets.push(pos); pos += blob.length; }
+check('cn/2 packed', multiHashing.hash_batch('cn/2', Buffer.concat(blobs), { offsets: Uint32Array.from(offsets) }).toString('hex'), hashes.join(''));
+
+// Other families must match their single-hash functions
+const blob = Buffer.from('This is a test');
+const seed_hash = Buffer.alloc(32, 1);
+check('cn/r', multiHashing.hash_batch('cn/r', [blob, blob], { height: 1806260 }).toString('hex'), multiHashing.cryptonight(blob, 13, 1806260).toString('hex').repeat(2));
+check('cn-heavy/xhv', multiHashing.hash_batch('cn-heavy/xhv', [blob]).toString('hex'), multiHashing.cryptonight_heavy(blob, 1).toString('hex'));
+check('argon2/wrkz', multiHashing.hash_batch('argon2/wrkz', [blob]).toString('hex'), multiHashing.argon2(blob, 1).toString('hex'));
+check('k12', multiHashing.hash_batch('k12', [blob]).toString('hex'), multiHashing.k12(blob).toString('hex'));
+check('rx/wow', multiHashing.hash_batch('rx/wow', [blob], { seed_hash: seed_hash }).toString('hex'), multiHashing.randomx(blob, seed_hash, 17).toString('hex'));
+// RandomX batches are pipelined through one VM and must match single hashing
+for (const [algo, variant] of [['rx/0', 0], ['defyx', 1], ['rx/wow', 17]]) {
+    let rx_blobs = [], single = '';
+    for (let i = 0; i < 5; ++i) {
+        rx_blobs.push(Buffer.alloc(76 + i, i + 1));
+        single += multiHashing.randomx(rx_blobs[i], seed_hash, variant).toString('hex');
+    }
+    check(algo + ' pipelined', multiHashing.hash_batch(algo, rx_blobs, { seed_hash: seed_hash }).toString('hex'), single);
+    check(algo + ' empty', multiHashing.hash_batch(algo, [], { seed_hash: seed_hash }).length, 0);
+}
+// Multi-way kernels must give the same results as single hashing, including
+// partial groups and blobs of different sizes
+let mixed = [];
+for (let i = 0; i < 7; ++i) mixed.push(Buffer.alloc(i == 5 ? 77 : 76, i + 1));
+for (const algo of ['cn/2', 'cn/r', 'cn-lite/1', 'cn-heavy/xhv', 'cn-pico']) {
+    const single = multiHashing.hash_batch(algo, mixed, { ways: 1, height: 1806260 }).toString('hex');
+    for (let ways = 2; ways <= 5; ++ways) {
+        check(algo + ' ' + ways + ' ways', multiHashing.hash_batch(algo, mixed, { ways: ways, height: 1806260 }).toString('hex'), single);
+    }
+}
+// cn-heavy/tube batches against the single hash on blobs that reach all four
+// finalizers; they once disagreed for blobs whose state selected JH
+let tube = [], tube_single = '';
+for (let i = 0; i < 40; ++i) {
+    const b = Buffer.alloc(43 + (i * 37) % 213);
+    for (let j = 0; j < b.length; ++j) b[j] = (i * 131 + j * 29) & 255;
+    tube.push(b);
+    tube_single += multiHashing.cryptonight_heavy(b, 2).toString('hex');
+}
+for (let ways = 1; ways <= 5; ++ways) {
+    check('cn-heavy/tube ' + ways + ' ways', multiHashing.hash_batch('cn-heavy/tube', tube, { ways: ways }).toString('hex'), tube_single);
+}
+check('empty', multiHashing.hash_batch('cn/0', []).length, 0);
+
+for (const args of [['cn/unknown', [blob]], ['cn/r', [blob]], ['rx/0', [blob]], ['cn/0', [blob, 'text']], ['cn/0', blob, { offsets: [0, 100] }]]) {
+    throws(args[0] + ' error', function() { multiHashing.hash_batch.apply(null, args); });
+}
+
+multiHashing.hash_batch_async('cn/2', blobs, function(err, result) {
+    check('cn/2 async', result.toString('hex'), hashes.join(''));
+    done('hash_batch');
+});
@@ -0,0 +1,52 @@
+"use strict";
+let multiHashing = require('../build/Release/cryptonight-hashing');
+let { check, done, run_with_env } = require('./check');
+let fs = require('fs');
+let os = require('os');
+let path = require('path');
+
+// Variants hashed by the generated main loops
+const algos = ['cn/0', 'cn/1', 'cn/fast', 'cn/half', 'cn/xao', 'cn/rto', 'cn/rwz', 'cn/zls', 'cn/double',
+    'cn-lite/0', 'cn-lite/1', 'cn-heavy/0', 'cn-heavy/xhv', 'cn-pico'];
+const blobs = [0, 1].map(function(i) {
+    return Buffer.from('0305a0dbd6bf05cf16e503f3a66f78007cbf34144332ecbfc22ed95c8700383b309ace1923a0964b0000000' + i + 'ba939a62724c0d7581fce5761e9d8a0e6a1c3f924fdd8493d1115649c05eb601', 'hex');
+});
+const cpu = multiHashing.autotune().cpu;
+
+// Hashes of every variant with one and two ways, and the assembly the profile
+// gave them
+function hashes_of(algos, blobs) {
+    const m = require('../build/Release/cryptonight-hashing');
+    blobs = blobs.map(function(b) { return Buffer.from(b, 'hex'); });
+    const result = {};
+    algos.forEach(function(a) {
+        m.hash_batch(a, blobs.slice(0, 1)); // reads a's profile entry
+        result[a] = [m.autotune().algos[a].assembly[1], m.hash_batch(a, blobs, { ways: 1 }).toString('hex'), m.hash_batch(a, blobs, { ways: 2 }).toString('hex')];
+    });
+    return result;
+}
+
+// The same in a process whose profile forces assembly for all of them
+function hashes(assembly) {
+    const profile = path.join(os.tmpdir(), 'cryptonight-hashing-' + process.pid + '-' + assembly + '.tune');
+    fs.writeFileSync(profile, algos.map(function(a) { return cpu + '\t' + a + '\t2 ' + Array(5).fill(assembly).join(' ') + '\n'; }).join(''));
+    const result = run_with_env({ CRYPTONIGHT_TUNE_PROFILE: profile }, hashes_of, [algos, blobs.map(function(b) { return b.toString('hex'); })]);
+    fs.unlinkSync(profile);
+    return result;
+}
+
+const reference = hashes('none');
+['intel', 'ryzen', 'bulldozer'].forEach(function(assembly) {
+    const result = hashes(assembly);
+    algos.forEach(function(a) {
+        check(a + ' ' + assembly, result[a][0], assembly);
+        check(a + ' ' + assembly + ' single', result[a][1], reference[a][1]);
+        check(a + ' ' + assembly + ' double', result[a][2], reference[a][2]);
+    });
+});
+
+algos.forEach(function(a) {
+    check(a + ' ways agree', reference[a][1], reference[a][2]);
+});
+
+done('cn_main_loop');
@@ -0,0 +1,57 @@
+"use strict";
+let multiHashing = require('../build/Release/cryptonight-hashing');
+let { check, done } = require('./check');
+
+// Reference cn/r vectors of ten consecutive heights
+const vectors = [
+    [1806260, 'f759588ad57e758467295443a9bd71490abff8e9dad1b95b6bf2f5d0d78387bc', 'This is a test This is a test This is a test'],
+    [1806261, '5bb833deca2bdd7252a9ccd7b4ce0b6a4854515794b56c207262f7a5b9bdb566', 'Lorem ipsum dolor sit amet, consectetur adipiscing'],
+    [1806262, '1ee6728da60fbd8d7d55b2b1ade487a3cf52a2c3ac6f520db12c27d8921f6cab', 'elit, sed do eiusmod tempor incididunt ut labore'],
+    [1806263, '6969fe2ddfb758438d48049f302fc2108a4fcc93e37669170e6db4b0b9b4c4cb', 'et dolore magna aliqua. Ut enim ad minim veniam,'],
+    [1806264, '7f3048b4e90d0cbe7a57c0394f37338a01fae3adfdc0e5126d863a895eb04e02', 'quis nostrud exercitation ullamco laboris nisi'],
+    [1806265, '1d290443a4b542af04a82f6b2494a6ee7f20f2754c58e0849032483a56e8e2ef', 'ut aliquip ex ea commodo consequat. Duis aute'],
+    [1806266, 'c43cc6567436a86afbd6aa9eaa7c276e9806830334b614b2bee23cc76634f6fd', 'irure dolor in reprehenderit in voluptate velit'],
+    [1806267, '87be2479c0c4e8edfdfaa5603e93f4265b3f8224c1c5946feb424819d18990a4', 'esse cillum dolore eu fugiat nulla pariatur.'],
+    [1806268, 'dd9d6a6d8e47465cceac0877ef889b93e7eba979557e3935d7f86dce11b070f3', 'Excepteur sint occaecat cupidatat non proident,'],
+    [1806269, '75c6f2ae49a20521de97285b431e717125847fb8935ed84a61e7f8d36a2c3d8e', 'sunt in culpa qui officia deserunt mollit anim id est laborum.'],
+].map(v => ({ height: v[0], hash: v[1], blob: Buffer.from(v[2]) }));
+
+// Heights interleaved like stale and current jobs around block changes
+for (let round = 0; round < 2; ++round) {
+    for (let i = 0; i < vectors.length; ++i) {
+        for (const v of [vectors[i], vectors[(i * 7) % vectors.length], vectors[0]]) {
+            check('sync ' + v.height, multiHashing.cryptonight(v.blob, 13, v.height).toString('hex'), v.hash);
+        }
+    }
+}
+
+// More heights than the cache holds, then back to the reference ones
+const blob = Buffer.from('This is a test');
+let first = {};
+for (let height = 2000000; height < 2000040; height += 2) {
+    first[height] = multiHashing.cryptonight(blob, 13, height).toString('hex');
+}
+for (const v of vectors) {
+    check('after eviction ' + v.height, multiHashing.cryptonight(v.blob, 13, v.height).toString('hex'), v.hash);
+}
+for (let height = 2000038; height >= 2000000; height -= 2) {
+    check('recompiled ' + height, multiHashing.cryptonight(blob, 13, height).toString('hex'), first[height]);
+}
+
+// Batches of each height
+for (const v of vectors) {
+    check('batch ' + v.height, multiHashing.hash_batch('cn/r', [v.blob, v.blob, v.blob], { height: v.height }).toString('hex'), v.hash.repeat(3));
+}
+
+// Contexts of several threads sharing programs
+let pending = 0;
+for (let round = 0; round < 3; ++round) {
+    for (const v of vectors) {
+        ++ pending;
+        multiHashing.cryptonight_async(v.blob, 13, v.height, function(err, result) {
+            check('async ' + v.height, result.toString('hex'), v.hash);
+            if (-- pending) return;
+            done('cryptonight-r cache');
+        });
+    }
+}
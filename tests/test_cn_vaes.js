@@ -0,0 +1,46 @@
+"use strict";
+let multiHashing = require('../build/Release/cryptonight-hashing');
+let { check, done, run_with_env } = require('./check');
+let fs = require('fs');
+
+// Vectors of variants with plain and heavy scratchpad explode/implode, and
+// how to hash a line's input: method, input encoding and variant (null if none)
+const cases = [
+    ['cryptonight.txt',            'cryptonight',       'utf8', null],
+    ['cryptonight_light-1.txt',    'cryptonight_light', 'hex',  1],
+    ['cryptonight_heavy.txt',      'cryptonight_heavy', 'hex',  0],
+    ['cryptonight_heavy-xhv.txt',  'cryptonight_heavy', 'hex',  1],
+    ['cryptonight_heavy-tube.txt', 'cryptonight_heavy', 'hex',  2],
+    ['cryptonight-gpu.txt',        'cryptonight',       'hex',  11],
+    ['cryptonight_pico.txt',       'cryptonight_pico',  'hex',  0]
+];
+const vectors = cases.map(function(c) {
+    return fs.readFileSync(c[0], 'utf8').split('\n').filter(function(l) { return l; }).map(function(l) { return l.split(/ (.*)$/); });
+});
+
+// Runs in a child: hex hashes of every case's vectors
+function hashes_of(cases, vectors) {
+    const m = require('../build/Release/cryptonight-hashing');
+    return cases.map(function(c, i) {
+        return vectors[i].map(function(v) {
+            const input = Buffer.from(v[1], c[2]);
+            return (c[3] === null ? m[c[1]](input) : m[c[1]](input, c[3])).toString('hex');
+        });
+    });
+}
+
+// Hashes of all vectors in a process with CRYPTONIGHT_VAES set to width
+function hashes(width) {
+    return run_with_env({ CRYPTONIGHT_VAES: width }, hashes_of, [cases, vectors]);
+}
+
+['512', '256', '0'].forEach(function(width) {
+    const result = hashes(width);
+    cases.forEach(function(c, i) {
+        vectors[i].forEach(function(v, j) {
+            check(c[0] + ' ' + j + ' vaes ' + width, result[i][j], v[0]);
+        });
+    });
+});
+
+done('cn_vaes');
@@ -0,0 +1,22 @@
+"use strict";
+let multiHashing = require('../build/Release/cryptonight-hashing');
+let { check, done } = require('./check');
+
+const cpu = multiHashing.cpu_info();
+check('brand', typeof cpu.brand, 'string');
+check('vendor', ['unknown', 'intel', 'amd'].indexOf(cpu.vendor) >= 0, true);
+check('family', Number.isInteger(cpu.family), true);
+for (const feature of ['aes', 'avx2', 'avx512f', 'vaes', 'soft_aes']) check(feature, typeof cpu[feature], 'boolean');
+check('assembly', ['none', 'intel', 'ryzen', 'bulldozer'].indexOf(cpu.assembly) >= 0, true);
+check('soft_aes without aes', cpu.aes || cpu.soft_aes, true);
+check('assembly needs aes', cpu.assembly === 'none' || !cpu.soft_aes, true);
+
+// Features reported by the OS should agree with cpuid
+if (process.platform === 'linux' && process.arch === 'x64') {
+    const flags = require('fs').readFileSync('/proc/cpuinfo', 'utf8').match(/^flags\s*:(.*)$/m)[1].split(' ');
+    check('aes /proc/cpuinfo', cpu.aes, flags.indexOf('aes') >= 0);
+    check('avx2 /proc/cpuinfo', cpu.avx2, flags.indexOf('avx2') >= 0);
+    check('avx512f /proc/cpuinfo', cpu.avx512f, flags.indexOf('avx512f') >= 0);
+}
+
+done('cpu_info');
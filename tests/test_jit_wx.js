@@ -0,0 +1,20 @@
+"use strict";
+let multiHashing = require('../build/Release/cryptonight-hashing');
+let { check, done } = require('./check');
+
+// JIT code is written through one mapping and run through another, so none of
+// them is writable and executable at once
+const input = Buffer.from('This is a test');
+check('cn/r', multiHashing.cryptonight(input, 13, 1806260).toString('hex').length, 64);
+check('rx/0', multiHashing.randomx(input, Buffer.alloc(32), 0).toString('hex').length, 64);
+
+if (process.platform === 'linux') {
+    const maps = require('fs').readFileSync('/proc/self/maps', 'utf8').split('\n').filter(l => l.indexOf('memfd:xmrig-jit') >= 0);
+    const modes = maps.map(l => l.split(' ')[1]);
+    check('writable views', modes.filter(m => m === 'rw-s').length > 0, true);
+    check('executable views', modes.filter(m => m === 'r-xs').length > 0, true);
+    check('views in pairs', modes.filter(m => m === 'rw-s').length, modes.filter(m => m === 'r-xs').length);
+    check('no rwx views', modes.filter(m => m.indexOf('w') >= 0 && m.indexOf('x') >= 0).length, 0);
+}
+
+done('jit_wx');
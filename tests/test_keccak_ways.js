@@ -0,0 +1,49 @@
+"use strict";
+let multiHashing = require('../build/Release/cryptonight-hashing');
+let { check, done, run_with_env } = require('./check');
+let fs = require('fs');
+
+function vectors(file) {
+    return fs.readFileSync(file, 'utf8').split('\n').filter(function(l) { return l; }).map(function(l) { return l.split(/ (.*)$/); });
+}
+
+// Blobs hashed by the multi-way kernels, whose initial keccak and final
+// permutation run several ways at once, and the cn/gpu scratchpad explode
+const cn = vectors('cryptonight.txt').map(function(v) { return [v[0], Buffer.from(v[1]).toString('hex')]; });
+const pico = Array(5).fill(vectors('cryptonight_pico.txt')[0]);
+const gpu = vectors('cryptonight-gpu.txt');
+
+// Runs in a child: hashes of cn and pico at every way count, and of gpu
+function hashes_of(cn, pico, gpu) {
+    const m = require('../build/Release/cryptonight-hashing');
+    const blobs = function(v) { return v.map(function(x) { return Buffer.from(x[1], 'hex'); }); };
+    const result = { cn: [], pico: [] };
+    for (let ways = 1; ways <= 5; ++ways) {
+        result.cn.push(m.hash_batch('cn/0', blobs(cn), { ways: ways }).toString('hex'));
+        result.pico.push(m.hash_batch('cn-pico', blobs(pico), { ways: ways }).toString('hex'));
+    }
+    result.gpu = gpu.map(function(v) { return m.cryptonight(Buffer.from(v[1], 'hex'), 11).toString('hex'); });
+    return result;
+}
+
+// Hashes in a process with CRYPTONIGHT_KECCAK_WAYS set to ways
+function hashes(ways) {
+    return run_with_env({ CRYPTONIGHT_KECCAK_WAYS: ways }, hashes_of, [cn, pico, gpu]);
+}
+
+['8', '4', '1'].forEach(function(keccak) {
+    const result = hashes(keccak);
+    for (let ways = 1; ways <= 5; ++ways) {
+        cn.forEach(function(v, i) {
+            check('cn/0 ' + i + ' ways ' + ways + ' keccak ' + keccak, result.cn[ways - 1].substr(64 * i, 64), v[0]);
+        });
+        pico.forEach(function(v, i) {
+            check('cn-pico ' + i + ' ways ' + ways + ' keccak ' + keccak, result.pico[ways - 1].substr(64 * i, 64), v[0]);
+        });
+    }
+    gpu.forEach(function(v, i) {
+        check('cn/gpu ' + i + ' keccak ' + keccak, result.gpu[i], v[0]);
+    });
+});
+
+done('keccak_ways');
@@ -0,0 +1,53 @@
+"use strict";
+let multiHashing = require('../build/Release/cryptonight-hashing');
+let { check, throws, done } = require('./check');
+
+const blob = Buffer.from('This is a test');
+const seed_hash = Buffer.alloc(32, 1);
+const out = Buffer.alloc(100);
+
+// Hashes written into out must match the returned ones, and out is returned
+const cases = [
+    ['cryptonight',       function() { return multiHashing.cryptonight(blob, 8); },                  function() { return multiHashing.cryptonight(blob, 8, out, 10); }],
+    ['cryptonight r',     function() { return multiHashing.cryptonight(blob, 13, 1806260); },        function() { return multiHashing.cryptonight(blob, 13, 1806260, out, 10); }],
+    ['cryptonight_light', function() { return multiHashing.cryptonight_light(blob, 1); },            function() { return multiHashing.cryptonight_light(blob, 1, out, 10); }],
+    ['cryptonight_pico',  function() { return multiHashing.cryptonight_pico(blob); },                function() { return multiHashing.cryptonight_pico(blob, out, 10); }],
+    ['argon2',            function() { return multiHashing.argon2(blob, 1); },                       function() { return multiHashing.argon2(blob, 1, out, 10); }],
+    ['randomx',           function() { return multiHashing.randomx(blob, seed_hash, 17); },          function() { return multiHashing.randomx(blob, seed_hash, 17, out, 10); }],
+    ['k12',               function() { return multiHashing.k12(blob); },                             function() { return multiHashing.k12(blob, out, 10); }],
+];
+for (const [name, alloc, into] of cases) {
+    out.fill(0);
+    const expected = alloc().toString('hex');
+    check(name + ' returns out', into() === out, true);
+    check(name, out.slice(10, 42).toString('hex'), expected);
+    check(name + ' untouched', out.slice(0, 10).toString('hex') + out.slice(42).toString('hex'), '00'.repeat(68));
+}
+
+// Default offset is 0, views of a SharedArrayBuffer work too
+const shared = new Uint8Array(new SharedArrayBuffer(32));
+multiHashing.k12(blob, shared);
+check('k12 shared', Buffer.from(shared.buffer).toString('hex'), multiHashing.k12(blob).toString('hex'));
+
+// Batch results go to opts.out at opts.outOffset
+const batch_out = Buffer.alloc(3 * 32 + 4);
+check('hash_batch returns out', multiHashing.hash_batch('cn/2', [blob, blob, blob], { out: batch_out, outOffset: 4 }), batch_out);
+check('hash_batch', batch_out.slice(4).toString('hex'), multiHashing.cryptonight(blob, 8).toString('hex').repeat(3));
+
+throws('out too small', function() { multiHashing.k12(blob, Buffer.alloc(31)); });
+throws('outOffset out of range', function() { multiHashing.k12(blob, out, 69); });
+throws('negative outOffset', function() { multiHashing.k12(blob, out, -1); });
+throws('hash_batch out too small', function() { multiHashing.hash_batch('k12', [blob, blob], { out: Buffer.alloc(63) }); });
+
+// Async versions write into out before calling back
+const async_out = Buffer.alloc(64);
+Promise.all([
+    multiHashing.cryptonight_async(blob, 8, async_out, 0),
+    multiHashing.hash_batch_async('k12', [blob], { out: async_out, outOffset: 32 }),
+]).then(function(results) {
+    check('cryptonight_async returns out', results[0] === async_out && results[1] === async_out, true);
+    check('cryptonight_async', async_out.slice(0, 32).toString('hex'), multiHashing.cryptonight(blob, 8).toString('hex'));
+    check('hash_batch_async', async_out.slice(32).toString('hex'), multiHashing.k12(blob).toString('hex'));
+
+    done('out');
+});
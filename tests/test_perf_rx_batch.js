@@ -0,0 +1,19 @@
+"use strict";
+let multiHashing = require('../build/Release/cryptonight-hashing');
+
+const ITER = 200;
+const seed = Buffer.from('12345678901234567890123456789012');
+
+let blobs = [];
+for (let i = ITER; i; -- i) blobs.push(Buffer.from("test" + i));
+multiHashing.randomx(blobs[0], seed, 0);
+
+let start = Date.now();
+for (const blob of blobs) multiHashing.randomx(blob, seed, 0);
+let end = Date.now();
+console.log("Single perf: " + 1000 * ITER / (end - start) + " H/s");
+
+start = Date.now();
+multiHashing.hash_batch('rx/0', blobs, { seed_hash: seed });
+end = Date.now();
+console.log("Pipelined batch perf: " + 1000 * ITER / (end - start) + " H/s");
@@ -0,0 +1,33 @@
+"use strict";
+let multiHashing = require('../build/Release/cryptonight-hashing');
+let { check, done } = require('./check');
+
+const ITER = 200;
+const seed = Buffer.from('12345678901234567890123456789012');
+
+function perf(name) {
+  let start = Date.now();
+  for (let i = ITER; i; -- i) {
+    multiHashing.randomx(Buffer.from("test" + i), seed, 0);
+  }
+  let end = Date.now();
+  console.log(name + " perf: " + 1000 * ITER / (end - start) + " H/s");
+}
+
+const light = multiHashing.randomx(Buffer.from("This is a test"), seed, 0).toString('hex');
+perf("Light");
+
+let start = Date.now();
+multiHashing.randomx_fast_mode(0, true);
+const timer = setInterval(function() {
+  if (multiHashing.randomx_fast_mode(0).dataset === null) return;
+  clearInterval(timer);
+  console.log("Dataset: " + (Date.now() - start) + " ms");
+
+  // The only place the full dataset VM is hashed through, so check it too
+  check('fast', multiHashing.randomx(Buffer.from("This is a test"), seed, 0).toString('hex'), light);
+  check('fast 2', multiHashing.randomx(Buffer.from("Lorem ipsum dolor sit amet"), seed, 0).toString('hex'), '86cb0f6306d536f373650bd196a5205a0293fba2ead85003d7aee4006afee147');
+  perf("Fast");
+  multiHashing.randomx_fast_mode(0, false);
+  done('randomx full dataset');
+}, 100);
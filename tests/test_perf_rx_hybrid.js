@@ -0,0 +1,42 @@
+"use strict";
+let multiHashing = require('../build/Release/cryptonight-hashing');
+
+// Hash rate against dataset memory, from light mode to the full dataset
+const ITER = 200;
+const MB = 1024 * 1024;
+const seed = Buffer.from('12345678901234567890123456789012');
+const budgets = [0, 256 * MB, 512 * MB, 1024 * MB, undefined];
+
+function perf() {
+  let start = Date.now();
+  for (let i = ITER; i; -- i) {
+    multiHashing.randomx(Buffer.from("test" + i), seed, 0);
+  }
+  return 1000 * ITER / (Date.now() - start);
+}
+
+const expected = multiHashing.randomx(Buffer.from("This is a test"), seed, 0).toString('hex');
+const light = perf();
+console.log("Light perf: " + light + " H/s");
+
+function next(i) {
+  if (i == budgets.length) {
+    multiHashing.randomx_fast_mode(0, false);
+    return;
+  }
+
+  let start = Date.now();
+  const status = budgets[i] === undefined ? multiHashing.randomx_fast_mode(0, true) : multiHashing.randomx_fast_mode(0, true, budgets[i]);
+  const timer = setInterval(function() {
+    if (status.memory && multiHashing.randomx_fast_mode(0).dataset === null) return;
+    clearInterval(timer);
+    const build = Date.now() - start;
+
+    const hash = multiHashing.randomx(Buffer.from("This is a test"), seed, 0).toString('hex');
+    if (hash !== expected) console.error("Dataset " + status.memory + " hash: " + hash + " instead of " + expected);
+    const rate = perf();
+    console.log("Dataset " + status.memory / MB + " MB: " + build + " ms to build, " + rate + " H/s (" + (rate / light).toFixed(2) + "x light)");
+    next(i + 1);
+  }, 100);
+}
+next(0);
@@ -0,0 +1,50 @@
+"use strict";
+let multiHashing = require('../build/Release/cryptonight-hashing');
+let { check, throws, done } = require('./check');
+
+const seed = Buffer.from('12345678901234567890123456789012');
+
+let status = multiHashing.randomx_fast_mode(0);
+check('off by default', status.enabled, false);
+check('no dataset', status.dataset, null);
+check('nothing building', status.building, null);
+
+throws('no algo', function() { multiHashing.randomx_fast_mode(); });
+throws('unknown algo', function() { multiHashing.randomx_fast_mode(3); });
+throws('enabled not a boolean', function() { multiHashing.randomx_fast_mode(0, 1); });
+
+// Hashes stay right in light mode while the dataset is built
+check('light', multiHashing.randomx(Buffer.from('This is a test'), seed, 0).toString('hex'), '38f638606c730dd6f271d037556b83988c71acc6980e22e25271b22389ecfce6');
+status = multiHashing.randomx_fast_mode(0, true);
+check('enabled', status.enabled, true);
+check('building', status.building !== null && status.building.equals(seed), true);
+check('while building', multiHashing.randomx(Buffer.from('Lorem ipsum dolor sit amet'), seed, 0).toString('hex'), '86cb0f6306d536f373650bd196a5205a0293fba2ead85003d7aee4006afee147');
+check('other algos', multiHashing.randomx_fast_mode(17).enabled, false);
+
+status = multiHashing.randomx_fast_mode(0, false);
+check('disabled', status.enabled, false);
+check('dataset dropped', status.dataset, null);
+check('no memory', status.memory, 0);
+
+throws('memory not a number', function() { multiHashing.randomx_fast_mode(0, true, '1'); });
+throws('negative memory', function() { multiHashing.randomx_fast_mode(0, true, -1); });
+
+// Hybrid mode: light VMs read the dataset items that fit in the budget
+status = multiHashing.randomx_fast_mode(0, true, 64 * 1024 * 1024 + 1000);
+check('memory rounded', status.memory, 64 * 1024 * 1024);
+check('hybrid building', status.building !== null && status.building.equals(seed), true);
+check('too small', multiHashing.randomx_fast_mode(0, true, 1024 * 1024).memory, 0);
+check('full size', multiHashing.randomx_fast_mode(0, true).memory, 2181038016);
+multiHashing.randomx_fast_mode(0, true, 64 * 1024 * 1024);
+
+const timer = setInterval(function() {
+    if (multiHashing.randomx_fast_mode(0).dataset === null) return;
+    clearInterval(timer);
+
+    check('hybrid', multiHashing.randomx(Buffer.from('This is a test'), seed, 0).toString('hex'), '38f638606c730dd6f271d037556b83988c71acc6980e22e25271b22389ecfce6');
+    check('hybrid 2', multiHashing.randomx(Buffer.from('Lorem ipsum dolor sit amet'), seed, 0).toString('hex'), '86cb0f6306d536f373650bd196a5205a0293fba2ead85003d7aee4006afee147');
+    multiHashing.randomx_fast_mode(0, false);
+    check('light again', multiHashing.randomx(Buffer.from('This is a test'), seed, 0).toString('hex'), '38f638606c730dd6f271d037556b83988c71acc6980e22e25271b22389ecfce6');
+
+    done('randomx_fast_mode');
+}, 100);
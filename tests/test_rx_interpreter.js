@@ -0,0 +1,30 @@
+"use strict";
+let multiHashing = require('../build/Release/cryptonight-hashing');
+let { check, done, run_with_env } = require('./check');
+
+// Hashes of each RandomX variant, single and pipelined in a batch
+const seed = '000000000000000100000000000000000000000f000000042000000000000000';
+const variants = [0, 1, 2, 17, 18, 19];
+const blobs = ['This is a test', 'Lorem ipsum dolor sit amet', ''];
+function hashes(seed, variants, blobs) {
+    const m = require('../build/Release/cryptonight-hashing');
+    const seed_hash = Buffer.from(seed, 'hex');
+    const result = {};
+    for (const variant of variants) {
+        result[variant] = blobs.map(blob => m.randomx(Buffer.from(blob), seed_hash, variant).toString('hex'));
+    }
+    result.batch = m.hash_batch('rx/0', blobs.map(blob => Buffer.from(blob)), { seed_hash: seed_hash }).toString('hex');
+    return result;
+}
+
+const jit = hashes(seed, variants, blobs);
+
+// CRYPTONIGHT_RX_JIT=0 runs the bytecode interpreter, which must agree with the JIT
+const interpreted = run_with_env({ CRYPTONIGHT_RX_JIT: '0' }, hashes, [seed, variants, blobs]);
+for (const variant of variants) {
+    for (let i = 0; i < blobs.length; ++i) check('variant ' + variant + ' blob ' + i, interpreted[variant][i], jit[variant][i]);
+}
+check('batch', interpreted.batch, jit.batch);
+check('batch matches single', jit.batch, jit[0].join(''));
+
+done('randomx interpreter');
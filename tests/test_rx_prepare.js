@@ -0,0 +1,45 @@
+"use strict";
+let multiHashing = require('../build/Release/cryptonight-hashing');
+let { check, throws, done } = require('./check');
+
+const blob = Buffer.from('This is a test');
+const seed_a = Buffer.alloc(32, 0xa1);
+const seed_b = Buffer.alloc(32, 0xb2);
+const seed_c = Buffer.alloc(32, 0xc3);
+
+check('default caches', multiHashing.randomx_caches(), 2);
+throws('no seed', function() { multiHashing.randomx_prepare(); });
+throws('short seed', function() { multiHashing.randomx_prepare(Buffer.alloc(31)); });
+throws('unknown algo', function() { multiHashing.randomx_prepare(seed_a, 3); });
+throws('zero caches', function() { multiHashing.randomx_caches(0); });
+
+async function main() {
+    // Seeds prepared ahead of time give the same hashes
+    let start = Date.now();
+    check('prepare resolves', await multiHashing.randomx_prepare(seed_a), undefined);
+    const build_time = Date.now() - start;
+    await new Promise(function(resolve) { multiHashing.randomx_prepare(seed_b, 0, function(err) { check('prepare callback', err, null); resolve(); }); });
+
+    // Both seeds are kept, so alternating between them doesn't rebuild
+    start = Date.now();
+    const a = multiHashing.randomx(blob, seed_a, 0).toString('hex');
+    const b = multiHashing.randomx(blob, seed_b, 0).toString('hex');
+    for (let i = 0; i < 2; ++i) {
+        check('seed a', multiHashing.randomx(blob, seed_a, 0).toString('hex'), a);
+        check('seed b', multiHashing.randomx(blob, seed_b, 0).toString('hex'), b);
+    }
+    check('no rebuild', Date.now() - start < 3 * build_time, true);
+    check('seeds differ', a !== b, true);
+
+    // A third seed evicts the oldest one, which still hashes the same
+    await multiHashing.randomx_prepare(seed_c);
+    check('seed c', (await multiHashing.randomx_async(blob, seed_c, 0)).toString('hex'), multiHashing.randomx(blob, seed_c, 0).toString('hex'));
+    check('seed a rebuilt', multiHashing.randomx(blob, seed_a, 0).toString('hex'), a);
+
+    check('set caches', multiHashing.randomx_caches(3), 3);
+    check('get caches', multiHashing.randomx_caches(), 3);
+}
+
+main().then(function() {
+    done('randomx_prepare');
+});
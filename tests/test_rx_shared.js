@@ -0,0 +1,125 @@
+"use strict";
+let multiHashing = require('../build/Release/cryptonight-hashing');
+let { check, throws, done, run_with_env, spawn_with_env } = require('./check');
+let fs = require('fs');
+
+const name = 'cryptonight-hashing-test-' + process.pid;
+const seedA = Buffer.from('12345678901234567890123456789012');
+const seedB = Buffer.alloc(32, 1);
+const hashA = '38f638606c730dd6f271d037556b83988c71acc6980e22e25271b22389ecfce6';
+const input = Buffer.from('This is a test');
+
+// Runs in a child attached to name: hashes input with the first seed and
+// returns the result and the shared memory it mapped. Given two seeds, it
+// prints that report instead, then prints the second seed's once the
+// generation changes
+function attached(name, input, seeds) {
+    const m = require('../build/Release/cryptonight-hashing');
+    const fs = require('fs');
+    function report(seed) {
+        const hash = m.randomx(Buffer.from(input, 'hex'), Buffer.from(seed, 'hex'), 0).toString('hex');
+        const maps = fs.readFileSync('/proc/self/maps', 'utf8').split('\n').filter(l => l.indexOf('/dev/shm/' + name + '-rx0-') >= 0)
+            .map(l => l.replace(/.*-rx0-(\d+).*/, '$1')).filter((g, i, a) => a.indexOf(g) == i);
+        return { hash: hash, status: m.randomx_shared(0), maps: maps };
+    }
+    m.randomx_shared(0, name);
+    if (seeds.length == 1) return report(seeds[0]);
+    console.log(JSON.stringify(report(seeds[0])));
+    const generation = m.randomx_shared(0).generation;
+    const timer = setInterval(function() {
+        if (m.randomx_shared(0).generation == generation) return;
+        clearInterval(timer);
+        console.log(JSON.stringify(report(seeds[1])));
+    }, 50);
+}
+
+function run() {
+    return run_with_env({}, attached, [name, input.toString('hex'), [seedA.toString('hex')]]);
+}
+
+function exists(generation) {
+    return fs.existsSync('/dev/shm/' + name + '-rx0' + (generation ? '-' + generation : ''));
+}
+
+check('off by default', multiHashing.randomx_shared(0).name, '');
+throws('bad name', function() { multiHashing.randomx_shared(0, 'a/b'); });
+throws('empty name', function() { multiHashing.randomx_shared(0, ''); });
+throws('name not a string', function() { multiHashing.randomx_shared(0, 1); });
+throws('publish not a boolean', function() { multiHashing.randomx_shared(0, name, 1); });
+throws('unknown algo', function() { multiHashing.randomx_shared(3, name); });
+
+// Nothing published yet: attached processes build their own cache
+let status = multiHashing.randomx_shared(0, name, true);
+check('publish', status.publish, true);
+check('name', status.name, name);
+check('nothing published', status.generation, 0);
+let result = run();
+check('unpublished hash', result.hash, hashA);
+check('unpublished status', result.status.generation, 0);
+check('unpublished maps', result.maps.length, 0);
+
+// Caches built by the publisher are mapped by attached processes
+check('published hash', multiHashing.randomx(input, seedA, 0).toString('hex'), hashA);
+const cacheA = multiHashing.randomx_shared(0).generation;
+check('cache published', cacheA > 0, true);
+check('cache segment', exists(cacheA), true);
+result = run();
+check('attached hash', result.hash, hashA);
+check('attached generation', result.status.generation, cacheA);
+check('attached publish', result.status.publish, false);
+check('attached cache', result.maps.join(), '' + cacheA);
+
+// So are datasets, here a hybrid one
+multiHashing.randomx_fast_mode(0, true, 64 * 1024 * 1024);
+const timer = setInterval(function() {
+    if (multiHashing.randomx_fast_mode(0).dataset === null) return;
+    clearInterval(timer);
+
+    const datasetA = multiHashing.randomx_shared(0).dataset;
+    check('dataset published', datasetA > cacheA, true);
+    result = run();
+    check('dataset hash', result.hash, hashA);
+    check('dataset generation', result.status.dataset, datasetA);
+    check('attached dataset', result.maps.sort().join(), [cacheA, datasetA].join());
+
+    // The publisher dropping it withdraws it
+    multiHashing.randomx_fast_mode(0, false);
+    check('dataset withdrawn', multiHashing.randomx_shared(0).dataset, 0);
+    check('dataset removed', exists(datasetA), false);
+
+    // A running attached process switches to the next seed's cache once it is published
+    const child = spawn_with_env({}, attached, [name, input.toString('hex'), [seedA.toString('hex'), seedB.toString('hex')]]);
+    let output = '';
+    child.stdout.on('data', function(data) {
+        if (!output) {
+            const hashB = multiHashing.randomx(input, seedB, 0).toString('hex');
+            const cacheB = multiHashing.randomx_shared(0).generation;
+            check('next cache published', cacheB > datasetA, true);
+            check('stale dataset', multiHashing.randomx_shared(0).dataset, 0);
+            child.on('close', function() {
+                const results = output.trim().split('\n').map(JSON.parse);
+                check('before switch', results[0].hash, hashA);
+                check('after switch', results[1].hash, hashB);
+                check('switched generation', results[1].status.generation, cacheB);
+                check('switched cache', results[1].maps.indexOf('' + cacheB) >= 0, true);
+                finish(cacheB);
+            });
+        }
+        output += data;
+    });
+}, 100);
+
+function finish(cacheB) {
+    // Segments go away with the publisher's last use of them
+    multiHashing.randomx_caches(1);
+    multiHashing.randomx(input, seedB, 0);
+    check('old cache removed', exists(cacheA), false);
+    check('new cache kept', exists(cacheB), true);
+
+    check('off', multiHashing.randomx_shared(0, null).name, '');
+    check('off generation', multiHashing.randomx_shared(0).generation, 0);
+    multiHashing.randomx_caches(2);
+    fs.unlinkSync('/dev/shm/' + name + '-rx0');
+
+    done('randomx_shared');
+}
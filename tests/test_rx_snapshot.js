@@ -0,0 +1,84 @@
+"use strict";
+let multiHashing = require('../build/Release/cryptonight-hashing');
+let { check, throws, done, run_with_env } = require('./check');
+let fs = require('fs');
+let os = require('os');
+let path = require('path');
+
+const dir = path.join(os.tmpdir(), 'cryptonight-hashing-rx-' + process.pid);
+const seed = Buffer.from('12345678901234567890123456789012');
+const hash = '38f638606c730dd6f271d037556b83988c71acc6980e22e25271b22389ecfce6';
+const file = path.join(dir, 'rx-0-' + seed.toString('hex') + '.cache');
+const memory = 4096 + 256 * 1024 * 1024;
+
+// Runs in a child: the hash of the test input with seed
+function hash_of(seed) {
+    const m = require('../build/Release/cryptonight-hashing');
+    return m.randomx(Buffer.from('This is a test'), Buffer.from(seed, 'hex'), 0).toString('hex');
+}
+
+// Hash in a new process reading snapshots from dir
+function restart() {
+    return run_with_env({ CRYPTONIGHT_RX_SNAPSHOTS: dir }, hash_of, [seed.toString('hex')]);
+}
+
+function patch(offset, value) {
+    const fd = fs.openSync(file, 'r+');
+    fs.writeSync(fd, Buffer.from([value]), 0, 1, offset);
+    fs.closeSync(fd);
+}
+
+function byte(offset) {
+    const b = Buffer.alloc(1);
+    const fd = fs.openSync(file, 'r');
+    fs.readSync(fd, b, 0, 1, offset);
+    fs.closeSync(fd);
+    return b[0];
+}
+
+fs.mkdirSync(dir);
+check('off by default', multiHashing.randomx_snapshots(), '');
+check('set', multiHashing.randomx_snapshots(dir), dir);
+
+// The first process builds the cache and writes its snapshot
+check('hash', multiHashing.randomx(Buffer.from('This is a test'), seed, 0).toString('hex'), hash);
+check('written', fs.existsSync(file), true);
+const size = fs.statSync(file).size;
+check('size', size > memory, true);
+check('no temporary files', fs.readdirSync(dir).length, 1);
+
+// The next one reads it back without rewriting it
+const ino = fs.statSync(file).ino;
+check('restart', restart(), hash);
+check('not rewritten', fs.statSync(file).ino, ino);
+
+// Damaged snapshots are rebuilt
+const good = byte(4096 + 1000);
+patch(4096 + 1000, good ^ 1);
+check('damaged memory', restart(), hash);
+check('memory rebuilt', byte(4096 + 1000), good);
+
+const last = byte(size - 1);
+patch(size - 1, last ^ 0x80);
+check('damaged programs', restart(), hash);
+check('programs rebuilt', byte(size - 1), last);
+
+patch(8, 2); // variant
+check('other variant', restart(), hash);
+check('header rebuilt', byte(8), 0);
+
+fs.truncateSync(file, 1024 * 1024);
+check('truncated', restart(), hash);
+check('size rebuilt', fs.statSync(file).size, size);
+
+// Each variant has its own snapshot
+check('wow', multiHashing.randomx(Buffer.from('This is a test'), Buffer.alloc(32), 17).toString('hex'), 'dcd9efef9df794171af262df328bd2c16a6d51ae9abdcb9357ce4ab3c0c9a8ba');
+check('wow written', fs.existsSync(path.join(dir, 'rx-17-' + Buffer.alloc(32).toString('hex') + '.cache')), true);
+
+check('off', multiHashing.randomx_snapshots(null), '');
+throws('dir not a string', function() { multiHashing.randomx_snapshots(1); });
+
+fs.readdirSync(dir).forEach(function(name) { fs.unlinkSync(path.join(dir, name)); });
+fs.rmdirSync(dir);
+
+done('randomx_snapshots');
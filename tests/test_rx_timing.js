@@ -0,0 +1,59 @@
+"use strict";
+let multiHashing = require('../build/Release/cryptonight-hashing');
+let { check, throws, done } = require('./check');
+
+const phases = ['blake2b', 'fill_scratchpad', 'generate_program', 'compile_program', 'execute_program', 'finalize', 'cache_init', 'superscalar_generate', 'superscalar_compile', 'superscalar_vm'];
+function sum(histogram) {
+    return histogram.reduce((a, b) => a + b, 0);
+}
+
+throws('enabled not a boolean', function() { multiHashing.randomx_timing(1); });
+
+// Off by default, nothing is recorded
+const input = Buffer.from('This is a test');
+multiHashing.randomx(input, Buffer.alloc(32, 3), 0);
+let timing = multiHashing.randomx_timing();
+check('off by default', timing.enabled, false);
+check('unit', ['cycles', 'ns'].indexOf(timing.unit) >= 0, true);
+for (const phase of phases) check(phase + ' off', timing.phases[phase].count, 0);
+
+// A new seed, then 3 hashes of 8 programs each (rx/0)
+timing = multiHashing.randomx_timing(true);
+check('on', timing.enabled, true);
+const seed = Buffer.alloc(32, 4);
+const hash = multiHashing.randomx(input, seed, 0).toString('hex');
+check('same hash', multiHashing.randomx(input, seed, 0).toString('hex'), hash);
+multiHashing.randomx(input, seed, 0);
+timing = multiHashing.randomx_timing();
+check('cache_init', timing.phases.cache_init.count, 1);
+// Generated and compiled once for the new cache, compiled again by the light VM
+check('superscalar_generate', timing.phases.superscalar_generate.count, 1);
+check('superscalar_compile', timing.phases.superscalar_compile.count, 1);
+check('superscalar_vm', timing.phases.superscalar_vm.count, 1);
+check('blake2b', timing.phases.blake2b.count, 3 * 8);
+check('fill_scratchpad', timing.phases.fill_scratchpad.count, 3);
+check('generate_program', timing.phases.generate_program.count, 3 * 8);
+check('compile_program', timing.phases.compile_program.count, 3 * 8);
+check('execute_program', timing.phases.execute_program.count, 3 * 8);
+check('finalize', timing.phases.finalize.count, 3);
+for (const phase of phases) {
+    const p = timing.phases[phase];
+    check(phase + ' histogram', sum(p.histogram), p.count);
+    check(phase + ' ticks', p.ticks > 0, true);
+    check(phase + ' at least a tick per run', p.ticks >= p.count, true);
+}
+
+// Execution dominates a light mode hash
+check('execute slowest', timing.phases.execute_program.ticks > timing.phases.generate_program.ticks + timing.phases.compile_program.ticks, true);
+
+// Histograms are cumulative, and cleared when turned on again
+multiHashing.randomx(input, seed, 0);
+check('cumulative', multiHashing.randomx_timing().phases.finalize.count, 4);
+timing = multiHashing.randomx_timing(false);
+check('off', timing.enabled, false);
+multiHashing.randomx(input, seed, 0);
+check('kept when off', multiHashing.randomx_timing().phases.finalize.count, 4);
+check('cleared when on', multiHashing.randomx_timing(true).phases.finalize.count, 0);
+multiHashing.randomx_timing(false);
+
+done('randomx_timing');
@@ -0,0 +1,94 @@
+"use strict";
+let multiHashing = require('../build/Release/cryptonight-hashing');
+let { check, throws, done, run_with_env } = require('./check');
+let fs = require('fs');
+let os = require('os');
+let path = require('path');
+
+const profile = path.join(os.tmpdir(), 'cryptonight-hashing-' + process.pid + '.tune');
+const blob = Buffer.from('0305a0dbd6bf05cf16e503f3a66f78007cbf34144332ecbfc22ed95c8700383b309ace1923a0964b00000008ba939a62724c0d7581fce5761e9d8a0e6a1c3f924fdd8493d1115649c05eb601', 'hex');
+const assemblies = ['none', 'intel', 'ryzen', 'bulldozer'];
+
+let info = multiHashing.autotune({ profile: profile });
+check('enabled by default', info.enabled, true);
+check('profile', info.profile, profile);
+check('cpu', info.cpu.indexOf(multiHashing.cpu_info().brand) === 0, true);
+check('nothing tuned yet', Object.keys(info.algos).length, 0);
+
+// Sync calls don't benchmark, they hash with the defaults until tuned
+const cn2 = multiHashing.cryptonight(Buffer.from('5468697320697320612074657374205468697320697320612074657374205468697320697320612074657374', 'hex'), 8).toString('hex');
+check('cn/2', cn2, '353fdc068fd47b03c04b9431e005e00b68c2168a3cc7335c8b9b308156591a4f');
+check('argon2', multiHashing.argon2(blob, 0).toString('hex'), 'c158a105ae75c7561cfd029083a47a87653d51f914128e21c1971d8b10c49034');
+check('nothing tuned by sync calls', Object.keys(multiHashing.autotune().algos).length, 0);
+
+// Sync batches don't either
+const blobs = [0, 1, 2, 3, 4, 5, 6].map(function(i) { return Buffer.from('This is test ' + i); });
+const hashes = blobs.map(function(b) { return multiHashing.cryptonight(b, 8).toString('hex'); }).join('');
+check('cn/2 batch', multiHashing.hash_batch('cn/2', blobs).toString('hex'), hashes);
+check('nothing tuned by sync batches', Object.keys(multiHashing.autotune().algos).length, 0);
+
+// Async calls tune on the hashing pool, and tuned kernels give the same hashes
+let cn;
+Promise.all([
+    multiHashing.hash_batch_async('cn/2', blobs),
+    multiHashing.hash_batch_async('argon2/chukwa', [blob]),
+]).then(function(results) {
+    check('cn/2 async batch', results[0].toString('hex'), hashes);
+    check('argon2 async batch', results[1].toString('hex'), 'c158a105ae75c7561cfd029083a47a87653d51f914128e21c1971d8b10c49034');
+
+    info = multiHashing.autotune();
+    cn = info.algos['cn/2'];
+    check('cn/2 tuned', cn !== undefined, true);
+    check('cn/2 ways', cn.ways >= 1 && cn.ways <= 5, true);
+    check('cn/2 assembly', cn.assembly.length, 5);
+    check('cn/2 assembly names', cn.assembly.every(function(a) { return assemblies.indexOf(a) >= 0; }), true);
+    check('cn/2 benchmarked', cn.benchmarked, true);
+    check('argon2 impl', typeof info.algos['argon2/chukwa'].impl, 'string');
+    check('cn/1 not tuned', info.algos['cn/1'], undefined);
+
+    // Winners are saved for this CPU
+    const lines = fs.readFileSync(profile, 'utf8').trim().split('\n');
+    check('profile cn/2', lines.some(function(l) { return l === info.cpu + '\tcn/2\t' + cn.ways + ' ' + cn.assembly.join(' '); }), true);
+    check('profile argon2', lines.some(function(l) { return l === info.cpu + '\targon2\t' + info.algos['argon2/chukwa'].impl; }), true);
+
+    // Another process reads them back instead of benchmarking
+    const other = run_with_env({ CRYPTONIGHT_TUNE_PROFILE: profile }, function() {
+        const m = require('../build/Release/cryptonight-hashing');
+        m.cryptonight(Buffer.from('This is a test'), 8);
+        return m.autotune().algos['cn/2'];
+    });
+    check('profile read back', JSON.stringify(other), JSON.stringify(Object.assign({}, cn, { benchmarked: false })));
+
+    // Every algorithm with multi-way kernels may be given several ways, cn-heavy/tube too
+    const tube = path.join(os.tmpdir(), 'cryptonight-hashing-' + process.pid + '-tube.tune');
+    fs.writeFileSync(tube, info.cpu + '\tcn-heavy/tube\t2 none none none none none\n');
+    const tube_ways = run_with_env({ CRYPTONIGHT_TUNE_PROFILE: tube }, function() {
+        const m = require('../build/Release/cryptonight-hashing');
+        m.hash_batch('cn-heavy/tube', [Buffer.from('This is a test')]);
+        return m.autotune().algos['cn-heavy/tube'].ways;
+    });
+    check('cn-heavy/tube profile ways', tube_ways, 2);
+    fs.unlinkSync(tube);
+
+    return multiHashing.cryptonight_async(Buffer.from('This is a test'), 1);
+}).then(function(hash) {
+    check('cn/1 async', hash.toString('hex'), multiHashing.cryptonight(Buffer.from('This is a test'), 1).toString('hex'));
+    check('cn/1 tuned', multiHashing.autotune().algos['cn/1'].benchmarked, true);
+
+    // Disabled tuning uses the defaults without recording anything
+    multiHashing.autotune({ enabled: false, profile: null });
+    check('cn/half', multiHashing.cryptonight(Buffer.from('This is a test'), 9).toString('hex'), multiHashing.hash_batch('cn/half', [Buffer.from('This is a test')], { ways: 1 }).toString('hex'));
+    info = multiHashing.autotune();
+    check('disabled', info.enabled, false);
+    check('no profile', info.profile, '');
+    check('cn/half not tuned', info.algos['cn/half'], undefined);
+    check('cn/2 kept', info.algos['cn/2'].ways, cn.ways);
+
+    throws('opts not an object', function() { multiHashing.autotune(1); });
+    throws('enabled not a boolean', function() { multiHashing.autotune({ enabled: 1 }); });
+    throws('profile not a string', function() { multiHashing.autotune({ profile: 1 }); });
+
+    fs.unlinkSync(profile);
+
+    done('autotune');
+});
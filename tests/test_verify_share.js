@@ -0,0 +1,68 @@
+"use strict";
+let multiHashing = require('../build/Release/cryptonight-hashing');
+let { check, throws, done } = require('./check');
+
+// Reference difficulty the way pools compute it in JS
+const base_diff = (1n << 256n) - 1n;
+function hash_num(hash) {
+    return BigInt('0x' + Buffer.from(hash).reverse().toString('hex'));
+}
+function hash_diff(hash) {
+    const diff = base_diff / hash_num(hash);
+    return diff > 0xFFFFFFFFFFFFFFFFn ? 0xFFFFFFFFFFFFFFFFn : diff;
+}
+function target_buffer(value, size) {
+    return Buffer.from(value.toString(16).padStart(size * 2, '0'), 'hex').reverse();
+}
+
+let blobs = [];
+for (let i = 0; i < 64; ++i) blobs.push(Buffer.from('share ' + i));
+const hashes = blobs.map(function(blob) { return multiHashing.cryptonight(blob, 8); });
+const diffs = hashes.map(hash_diff);
+
+for (let i = 0; i < blobs.length; ++i) {
+    const diff = diffs[i];
+    const share = multiHashing.verify_share('cn/2', blobs[i], Number(diff));
+    check('difficulty ' + i, share.difficulty, Number(diff));
+    check('valid at own difficulty ' + i, share.valid, true);
+    check('invalid above own difficulty ' + i, multiHashing.verify_share('cn/2', blobs[i], Number(diff) + 1).valid, false);
+
+    // 256-bit target: the hash itself passes, one less doesn't
+    const num = hash_num(hashes[i]);
+    check('256-bit target ' + i, multiHashing.verify_share('cn/2', blobs[i], target_buffer(num, 32)).valid, true);
+    check('256-bit target - 1 ' + i, multiHashing.verify_share('cn/2', blobs[i], target_buffer(num - 1n, 32)).valid, false);
+
+    // 64-bit target compares the top 64 bits
+    const top = num >> 192n;
+    check('64-bit target ' + i, multiHashing.verify_share('cn/2', blobs[i], target_buffer(top, 8)).valid, true);
+    if (top > 0n) check('64-bit target - 1 ' + i, multiHashing.verify_share('cn/2', blobs[i], target_buffer(top - 1n, 8)).valid, false);
+}
+
+// Batch mode reports the indices meeting the target
+const pool_diff = 3;
+let expected = [];
+for (let i = 0; i < diffs.length; ++i) if (diffs[i] >= BigInt(pool_diff)) expected.push(i);
+check('batch', JSON.stringify(multiHashing.verify_share_batch('cn/2', blobs, pool_diff)), JSON.stringify(expected));
+
+// opts are the hash_batch ones, hashes can be written to opts.out
+const out = Buffer.alloc(32);
+const seed_hash = Buffer.alloc(32, 1);
+const rx = multiHashing.verify_share('rx/wow', blobs[0], 1, { seed_hash: seed_hash, out: out });
+check('rx/wow', rx.difficulty, Number(hash_diff(out)));
+check('rx/wow out', out.toString('hex'), multiHashing.randomx(blobs[0], seed_hash, 17).toString('hex'));
+const rx_out = Buffer.alloc(32 * blobs.length);
+const rx_batch = multiHashing.verify_share_batch('rx/wow', blobs, 1, { seed_hash: seed_hash, out: rx_out });
+check('rx/wow batch', JSON.stringify(rx_batch), JSON.stringify(blobs.map((b, i) => i)));
+check('rx/wow batch out', rx_out.slice(32, 64).toString('hex'), multiHashing.randomx(blobs[1], seed_hash, 17).toString('hex'));
+
+throws('bad target size', function() { multiHashing.verify_share('cn/2', blobs[0], Buffer.alloc(16)); });
+
+Promise.all([
+    multiHashing.verify_share_async('cn/2', blobs[1], 1),
+    multiHashing.verify_share_batch_async('cn/2', blobs, pool_diff),
+]).then(function(results) {
+    check('verify_share_async', results[0].difficulty, Number(diffs[1]));
+    check('verify_share_batch_async', JSON.stringify(results[1]), JSON.stringify(expected));
+
+    done('verify_share');
+});
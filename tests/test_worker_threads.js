@@ -0,0 +1,40 @@
+"use strict";
+let multiHashing = require('../build/Release/cryptonight-hashing');
+let { check, done } = require('./check');
+let worker_threads;
+try {
+    worker_threads = require('worker_threads');
+} catch (e) {
+    console.log('worker_threads are not available, skipped');
+    process.exit(0);
+}
+
+const seed = Buffer.from('0000000000000000000000000000000000000000000000000000000000000001', 'hex');
+const blob = Buffer.from('This is a test');
+
+function hashes(multiHashing) {
+    return [
+        multiHashing.cryptonight(blob, 8).toString('hex'),
+        multiHashing.cryptonight_heavy(blob, 0).toString('hex'),
+        multiHashing.randomx(blob, seed, 0).toString('hex'),
+    ];
+}
+
+if (!worker_threads.isMainThread) {
+    const result = hashes(multiHashing);
+    multiHashing.cryptonight_async(blob, 8, function(err, hash) {
+        result.push(hash.toString('hex'));
+        worker_threads.parentPort.postMessage(result);
+    });
+} else {
+    const expected = hashes(multiHashing);
+    expected.push(expected[0]);
+
+    let workers = 2, finished = 0;
+    for (let i = 0; i < workers; ++i) {
+        new worker_threads.Worker(__filename).on('message', function(result) {
+            check('worker ' + i, result.join(' '), expected.join(' '));
+            if (++finished === workers) done('worker_threads');
+        });
+    }
+}
@@ -0,0 +1,454 @@
+#include "tune.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <sstream>
+
+#include "3rdparty/argon2.h"
+#include "backend/cpu/Cpu.h"
+#include "crypto/cn/CryptoNight.h"
+#include "crypto/defyx/defyx.h"
+#include "hash_ctx.h"
+
+extern "C" {
+#include "3rdparty/argon2/lib/impl-select.h"
+}
+
+namespace {
+
+const char* const assemblies[] = { "none", "auto", "intel", "ryzen", "bulldozer" };
+
+// Candidates are timed for at least this long each
+const std::chrono::milliseconds BENCH_TIME(100);
+const size_t BLOB_SIZE = 76;
+
+struct CnState {
+    std::atomic<bool> tuned;
+    tune::CnResult result;
+};
+
+struct RxState {
+    std::atomic<bool> tuned;
+    bool hard_aes;
+    bool benchmarked;
+};
+
+std::atomic<bool> is_enabled(true);
+thread_local bool may_benchmark = false;
+
+// Guards everything below and runs one benchmark at a time, so candidates
+// aren't timed against each other
+std::mutex mutex;
+std::string profile_path;
+bool profile_loaded = false;
+std::map<std::string, std::string> saved; // profile entries of this CPU
+
+CnState cn_state[xmrig::Algorithm::MAX];
+RxState rx_state[xmrig::Algorithm::MAX]; // by JS variant number
+std::atomic<bool> argon2_tuned(false);
+bool argon2_benchmarked = false;
+bool argon2_widest = false; // the default implementation was replaced
+
+std::string default_profile() {
+    const char* path = getenv("CRYPTONIGHT_TUNE_PROFILE");
+    if (path) return path;
+    const char* dir = getenv("XDG_CACHE_HOME");
+    if (dir && *dir) return std::string(dir) + "/cryptonight-hashing.tune";
+    dir = getenv("HOME");
+    if (dir && *dir) return std::string(dir) + "/.cache/cryptonight-hashing.tune";
+    return "";
+}
+
+struct InitProfile {
+    InitProfile() {
+        profile_path = default_profile();
+    }
+} s;
+
+// CRYPTONIGHT_RX_JIT=0 runs RandomX on the bytecode interpreter, like hosts
+// that can't map executable memory
+const bool rx_jit = !getenv("CRYPTONIGHT_RX_JIT") || strcmp(getenv("CRYPTONIGHT_RX_JIT"), "0") != 0;
+
+const char* cn_name(const xmrig::Algorithm::Id algo) {
+    static const char* const names[] = {
+        "cn/0", "cn/1", "cn/2", "cn/r", "cn/fast", "cn/half", "cn/xao", "cn/rto", "cn/rwz", "cn/zls", "cn/double", "cn/gpu",
+        "cn-lite/0", "cn-lite/1", "cn-heavy/0", "cn-heavy/tube", "cn-heavy/xhv", "cn-pico"
+    };
+    return static_cast<size_t>(algo) < sizeof(names) / sizeof(names[0]) ? names[algo] : nullptr;
+}
+
+const char* rx_name(const int variant) {
+    switch (variant) {
+        case 0:  return "rx/0";
+        case 1:  return "defyx";
+        case 2:  return "rx/arq";
+        case 17: return "rx/wow";
+        case 18: return "rx/loki";
+        case 19: return "rx/v";
+        default: return nullptr;
+    }
+}
+
+// Profile lines are "<cpu>\t<name>\t<choice>", later lines win. Must be called under mutex.
+void load_profile() {
+    if (profile_loaded) return;
+    profile_loaded = true;
+    saved.clear();
+    if (profile_path.empty()) return;
+
+    FILE* file = fopen(profile_path.c_str(), "r");
+    if (!file) return;
+
+    const std::string cpu = tune::cpu();
+    char line[512];
+    while (fgets(line, sizeof(line), file)) {
+        line[strcspn(line, "\r\n")] = '\0';
+        char* name = strchr(line, '\t');
+        if (!name) continue;
+        *name++ = '\0';
+        char* choice = strchr(name, '\t');
+        if (!choice) continue;
+        *choice++ = '\0';
+        if (cpu == line) saved[name] = choice;
+    }
+    fclose(file);
+}
+
+// The profile is only a cache, so failing to write it is not an error
+void save(const std::string& name, const std::string& choice) {
+    saved[name] = choice;
+    if (profile_path.empty()) return;
+
+    FILE* file = fopen(profile_path.c_str(), "a");
+    if (!file) return;
+    fprintf(file, "%s\t%s\t%s\n", tune::cpu().c_str(), name.c_str(), choice.c_str());
+    fclose(file);
+}
+
+double seconds_since(const std::chrono::steady_clock::time_point& start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Algorithms without multi-way kernels hash one blob at a time
+size_t max_ways(const CnFn& fn) {
+    size_t ways = 1;
+    while (ways < CnFn::MAX_WAYS && fn.get(ways + 1)) ++ways;
+    return ways;
+}
+
+// Batch default when not tuned: two ways help every CN variant but cn/r,
+// whose double kernel is slower than the single one with generated code
+size_t default_ways(const CnFn& fn) {
+    return fn.algo == xmrig::Algorithm::CN_R ? 1 : std::min<size_t>(2, max_ways(fn));
+}
+
+// Hashes per second of kernel hashing ways copies of one blob, 0 if any of
+// them doesn't give reference (which is set on the first call)
+double bench_cn(HashCtx& c, const CnFn& fn, xmrig::cn_hash_fun kernel, const size_t ways, uint8_t* reference, bool& have_reference) {
+    uint8_t input[BLOB_SIZE * CnFn::MAX_WAYS];
+    uint8_t output[32 * CnFn::MAX_WAYS];
+    for (size_t i = 0; i < sizeof(input); ++i) input[i] = static_cast<uint8_t>(i % BLOB_SIZE);
+
+    cryptonight_ctx** ctx = c.cn(fn.algo, ways);
+    ctx[0]->generated_code_data.algo = xmrig::Algorithm::INVALID; // CN-R code differs by assembly
+
+    size_t hashes = 0;
+    const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    do {
+        kernel(input, BLOB_SIZE, output, ctx, 0);
+        hashes += ways;
+    } while (std::chrono::steady_clock::now() - start < BENCH_TIME);
+    const double time = seconds_since(start);
+
+    if (!have_reference) {
+        memcpy(reference, output, 32);
+        have_reference = true;
+    }
+    for (size_t i = 0; i < ways; ++i) {
+        if (memcmp(output + i * 32, reference, 32) != 0) return 0;
+    }
+    return hashes / time;
+}
+
+void tune_cn(HashCtx& c, const CnFn& fn, tune::CnResult& result) {
+    static const xmrig::Assembly::Id candidates[] = { xmrig::Assembly::NONE, xmrig::Assembly::INTEL, xmrig::Assembly::RYZEN, xmrig::Assembly::BULLDOZER };
+
+    const size_t ways = max_ways(fn);
+    result.ways = default_ways(fn);
+    for (size_t i = 0; i < CnFn::MAX_WAYS; ++i) result.assembly[i] = xmrig::Assembly::NONE;
+    result.benchmarked = false;
+    if (ways == 1 && (fn.assembly != xmrig::Assembly::AUTO || xmrig::Cpu::isSoftAES())) return; // nothing to choose from
+
+    // Touch the whole scratchpad first so page faults aren't timed
+    cryptonight_ctx** ctx = c.cn(fn.algo, ways);
+    for (size_t i = 0; i < ways; ++i) memset(ctx[i]->memory, 0, HashCtx::scratchpad_size(fn.algo));
+
+    uint8_t reference[32];
+    bool have_reference = false;
+    double best = 0;
+    for (size_t n = 1; n <= ways; ++n) {
+        double best_n = 0;
+        for (const xmrig::Assembly::Id assembly : candidates) {
+            if (fn.assembly != xmrig::Assembly::AUTO && assembly != fn.assembly) continue;
+
+            const xmrig::cn_hash_fun kernel = CnFn{ fn.algo, assembly }.get(n);
+            if (!kernel || (assembly != xmrig::Assembly::NONE && kernel == CnFn{ fn.algo, xmrig::Assembly::NONE }.get(n))) continue;
+
+            const double speed = bench_cn(c, fn, kernel, n, reference, have_reference);
+            if (speed > best_n) {
+                best_n = speed;
+                result.assembly[n - 1] = assembly;
+            }
+        }
+        if (best_n > best) {
+            best = best_n;
+            result.ways = n;
+        }
+    }
+    result.benchmarked = true;
+}
+
+bool parse_cn(const std::string& choice, const CnFn& fn, tune::CnResult& result) {
+    std::istringstream stream(choice);
+    if (!(stream >> result.ways) || result.ways < 1 || result.ways > max_ways(fn)) return false;
+
+    for (size_t i = 0; i < CnFn::MAX_WAYS; ++i) {
+        std::string name;
+        if (!(stream >> name)) return false;
+        size_t j = 0;
+        while (j < sizeof(assemblies) / sizeof(assemblies[0]) && name != assemblies[j]) ++j;
+        if (j == sizeof(assemblies) / sizeof(assemblies[0]) || j == xmrig::Assembly::AUTO) return false;
+        result.assembly[i] = static_cast<xmrig::Assembly::Id>(j);
+    }
+    result.benchmarked = false;
+    return true;
+}
+
+std::string format_cn(const tune::CnResult& result) {
+    std::string choice = std::to_string(result.ways);
+    for (size_t i = 0; i < CnFn::MAX_WAYS; ++i) {
+        choice += ' ';
+        choice += assemblies[result.assembly[i]];
+    }
+    return choice;
+}
+
+// Argon2 implementations are process wide: the one in the profile, or the
+// fastest one by argon2_select_impl(). Until then, or without tuning, the widest
+// one this CPU runs is used. Must be called under mutex.
+void tune_argon2() {
+    if (argon2_tuned) return;
+
+    if (is_enabled) {
+        load_profile();
+        std::map<std::string, std::string>::const_iterator it = saved.find("argon2");
+        if (it != saved.end() && argon2_select_impl_by_name(it->second.c_str())) {
+            argon2_tuned.store(true, std::memory_order_release);
+            return;
+        }
+        if (may_benchmark) {
+            argon2_select_impl();
+            argon2_benchmarked = true;
+            save("argon2", argon2_get_impl_name());
+            argon2_tuned.store(true, std::memory_order_release);
+            return;
+        }
+    }
+
+    if (!argon2_widest) {
+        argon2_impl_list impls;
+        argon2_get_impl_list(&impls);
+        for (size_t i = impls.count; i > 0; --i) {
+            const argon2_impl& impl = impls.entries[i - 1];
+            if (!impl.check || impl.check()) {
+                argon2_select_impl_by_name(impl.name);
+                break;
+            }
+        }
+        argon2_widest = true;
+    }
+    if (!is_enabled) argon2_tuned.store(true, std::memory_order_release);
+}
+
+// Locks mutex, or only tries to where benchmarks aren't allowed: a benchmark
+// holds it for seconds and the caller can use the defaults meanwhile
+bool lock_mutex(std::unique_lock<std::mutex>& lock) {
+    if (!may_benchmark) return lock.try_lock();
+    lock.lock();
+    return true;
+}
+
+double bench_rx(const int variant, const int flags, randomx_cache* cache, uint8_t* scratchpad) {
+    randomx_vm* vm = randomx_create_vm(static_cast<randomx_flags>(flags), cache, nullptr, scratchpad);
+    if (!vm) vm = randomx_create_vm(static_cast<randomx_flags>(flags & ~RANDOMX_FLAG_LARGE_PAGES), cache, nullptr, scratchpad);
+    if (!vm) return 0;
+
+    uint8_t input[BLOB_SIZE] = {};
+    uint8_t output[32];
+    size_t hashes = 0;
+    std::chrono::steady_clock::time_point start;
+    do {
+        if (hashes == 1) start = std::chrono::steady_clock::now(); // the first hash warms up the VM
+        switch (variant) {
+          case 1:  defyx_calculate_hash  (vm, input, sizeof(input), output);
+                   break;
+          default: randomx_calculate_hash(vm, input, sizeof(input), output);
+        }
+        ++input[0];
+        ++hashes;
+    } while (hashes < 2 || std::chrono::steady_clock::now() - start < BENCH_TIME);
+    const double time = seconds_since(start);
+
+    randomx_destroy_vm(vm);
+    return (hashes - 1) / time;
+}
+
+}
+
+xmrig::cn_hash_fun CnFn::get(const size_t ways) const {
+    static const xmrig::CnHash::AlgoVariant av[2][MAX_WAYS] = {
+        { xmrig::CnHash::AV_SINGLE,      xmrig::CnHash::AV_DOUBLE,      xmrig::CnHash::AV_TRIPLE,      xmrig::CnHash::AV_QUAD,      xmrig::CnHash::AV_PENTA },
+        { xmrig::CnHash::AV_SINGLE_SOFT, xmrig::CnHash::AV_DOUBLE_SOFT, xmrig::CnHash::AV_TRIPLE_SOFT, xmrig::CnHash::AV_QUAD_SOFT, xmrig::CnHash::AV_PENTA_SOFT },
+    };
+
+    xmrig::Assembly::Id id = assembly;
+    if (id == xmrig::Assembly::AUTO && cn_state[algo].tuned.load(std::memory_order_acquire)) {
+        id = cn_state[algo].result.assembly[ways - 1];
+    }
+    return xmrig::CnHash::fn(algo, av[xmrig::Cpu::isSoftAES() ? 1 : 0][ways - 1], id);
+}
+
+tune::Benchmarks::Benchmarks() : m_previous(may_benchmark) {
+    may_benchmark = true;
+}
+
+tune::Benchmarks::~Benchmarks() {
+    may_benchmark = m_previous;
+}
+
+size_t tune::cn(HashCtx& c, const CnFn& fn) {
+    CnState& state = cn_state[fn.algo];
+    if (state.tuned.load(std::memory_order_acquire)) return state.result.ways;
+    if (!is_enabled) {
+        if (xmrig::Algorithm::family(fn.algo) == xmrig::Algorithm::ARGON2) tune::argon2();
+        return default_ways(fn);
+    }
+
+    std::unique_lock<std::mutex> lock(mutex, std::defer_lock);
+    if (!lock_mutex(lock)) return default_ways(fn);
+    if (state.tuned.load(std::memory_order_relaxed)) return state.result.ways;
+    load_profile();
+
+    if (xmrig::Algorithm::family(fn.algo) == xmrig::Algorithm::ARGON2) {
+        tune_argon2();
+        if (!argon2_tuned) return 1;
+        state.result.ways = 1;
+        for (size_t i = 0; i < CnFn::MAX_WAYS; ++i) state.result.assembly[i] = xmrig::Assembly::NONE;
+        state.result.benchmarked = argon2_benchmarked;
+    }
+    else {
+        const char* name = cn_name(fn.algo);
+        std::map<std::string, std::string>::const_iterator it = name ? saved.find(name) : saved.end();
+        if (it == saved.end() || !parse_cn(it->second, fn, state.result)) {
+            if (!may_benchmark) return default_ways(fn);
+            tune_cn(c, fn, state.result);
+            if (name) save(name, format_cn(state.result));
+            // The last candidate's CN-R code is still in ctx[0]
+            c.cn(fn.algo)[0]->generated_code_data.algo = xmrig::Algorithm::INVALID;
+        }
+    }
+
+    state.tuned.store(true, std::memory_order_release);
+    return state.result.ways;
+}
+
+int tune::rx_flags(const int variant, randomx_cache* cache, uint8_t* scratchpad) {
+    const int flags = RANDOMX_FLAG_LARGE_PAGES | (rx_jit ? RANDOMX_FLAG_JIT : 0);
+    if (xmrig::Cpu::isSoftAES()) return flags;
+
+    RxState& state = rx_state[variant];
+    if (!state.tuned.load(std::memory_order_acquire)) {
+        if (!is_enabled) return flags | RANDOMX_FLAG_HARD_AES;
+
+        std::unique_lock<std::mutex> lock(mutex, std::defer_lock);
+        if (!lock_mutex(lock)) return flags | RANDOMX_FLAG_HARD_AES;
+        if (!state.tuned.load(std::memory_order_relaxed)) {
+            load_profile();
+
+            const std::string name = rx_name(variant);
+            std::map<std::string, std::string>::const_iterator it = saved.find(name);
+            if (it != saved.end() && (it->second == "hard_aes" || it->second == "soft_aes")) {
+                state.hard_aes = it->second == "hard_aes";
+                state.benchmarked = false;
+            }
+            else if (!may_benchmark) {
+                return flags | RANDOMX_FLAG_HARD_AES;
+            }
+            else {
+                state.hard_aes = bench_rx(variant, flags | RANDOMX_FLAG_HARD_AES, cache, scratchpad) >= bench_rx(variant, flags, cache, scratchpad);
+                state.benchmarked = true;
+                save(name, state.hard_aes ? "hard_aes" : "soft_aes");
+            }
+            state.tuned.store(true, std::memory_order_release);
+        }
+    }
+    return state.hard_aes ? flags | RANDOMX_FLAG_HARD_AES : flags;
+}
+
+void tune::argon2() {
+    if (argon2_tuned.load(std::memory_order_acquire)) return;
+
+    std::unique_lock<std::mutex> lock(mutex, std::defer_lock);
+    if (lock_mutex(lock)) tune_argon2();
+}
+
+bool tune::cn_result(const xmrig::Algorithm::Id algo, CnResult& result) {
+    if (!cn_state[algo].tuned.load(std::memory_order_acquire)) return false;
+    result = cn_state[algo].result;
+    return true;
+}
+
+bool tune::rx_result(const int variant, bool& hard_aes, bool& benchmarked) {
+    if (xmrig::Cpu::isSoftAES() || !rx_state[variant].tuned.load(std::memory_order_acquire)) return false;
+    hard_aes    = rx_state[variant].hard_aes;
+    benchmarked = rx_state[variant].benchmarked;
+    return true;
+}
+
+bool tune::argon2_result(std::string& impl, bool& benchmarked) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!argon2_tuned) return false;
+    impl        = argon2_get_impl_name();
+    benchmarked = argon2_benchmarked;
+    return true;
+}
+
+void tune::set_enabled(const bool enabled) {
+    is_enabled = enabled;
+}
+
+bool tune::enabled() {
+    return is_enabled;
+}
+
+void tune::set_profile(const std::string& path) {
+    std::lock_guard<std::mutex> lock(mutex);
+    profile_path   = path;
+    profile_loaded = false;
+}
+
+std::string tune::profile() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return profile_path;
+}
+
+std::string tune::cpu() {
+    const xmrig::ICpuInfo* info = xmrig::Cpu::info();
+    return std::string(*info->brand() ? info->brand() : "unknown") + " [" + std::to_string(info->family()) + "/" + std::to_string(info->model()) + "]";
+}
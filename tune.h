@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "crypto/cn/CnHash.h"
+#include "crypto/randomx/randomx.h"
+
+class HashCtx;
+
+// CryptoNight family algorithm and the assembly to use for it (AUTO: the tuned
+// one, or the one for this CPU if it has AES-NI). get() returns the hash
+// function processing ways blobs at once (1-5) or nullptr if there is none,
+// soft AES if the CPU needs it.
+struct CnFn {
+    static const size_t MAX_WAYS = 5;
+
+    xmrig::Algorithm::Id algo;
+    xmrig::Assembly::Id assembly;
+
+    xmrig::cn_hash_fun get(size_t ways = 1) const;
+};
+
+// Autotuner: the first time an algorithm is used, its kernel variants are timed
+// on this CPU and the fastest one is used from then on. Winners are appended to
+// a profile file keyed by CPU brand, so later processes skip the benchmark.
+namespace tune {
+
+// Benchmarks only run on a thread inside a Benchmarks scope, which the hashing
+// pool opens around each job. Elsewhere an algorithm not tuned yet is read from
+// the profile if it's there, else hashed with the CPU defaults without waiting,
+// so sync calls, batches included, never block the event loop on a benchmark.
+class Benchmarks {
+public:
+    Benchmarks();
+    ~Benchmarks();
+
+private:
+    const bool m_previous;
+};
+
+// Tunes fn.algo on c unless that was done: CnHash assembly for 1-5 ways and the
+// fastest number of ways, or the Argon2 implementation. Returns the number of
+// ways batches should use by default.
+size_t cn(HashCtx& c, const CnFn& fn);
+
+// RandomX VM flags for variant, timing hard against soft AES VMs on cache and
+// scratchpad the first time. No JIT if CRYPTONIGHT_RX_JIT is 0.
+int rx_flags(int variant, randomx_cache* cache, uint8_t* scratchpad);
+
+// Selects the Argon2 implementation used by argon2 algorithms and RandomX
+// cache init, timing them the first time
+void argon2();
+
+// What was picked for an algorithm, false if it wasn't tuned yet
+struct CnResult {
+    size_t ways;
+    xmrig::Assembly::Id assembly[CnFn::MAX_WAYS];
+    bool benchmarked; // false if read from the profile
+};
+bool cn_result(xmrig::Algorithm::Id algo, CnResult& result);
+bool rx_result(int variant, bool& hard_aes, bool& benchmarked);
+bool argon2_result(std::string& impl, bool& benchmarked);
+
+// Tuning is on by default. When off, algorithms not tuned yet use the CPU
+// defaults. The profile is CRYPTONIGHT_TUNE_PROFILE or cryptonight-hashing.tune
+// in the user's cache directory, an empty path keeps results in memory only.
+void set_enabled(bool enabled);
+bool enabled();
+void set_profile(const std::string& path);
+std::string profile();
+
+// Profile key of this CPU: brand [family/model]
+std::string cpu();
+
+}
@@ -0,0 +1,182 @@
+#include "workers.h"
+
+#include <deque>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Completion side of one JS thread (main thread or worker_threads Worker):
+// finished jobs are handed back to the event loop that queued them.
+struct Loop {
+    uv_async_t async;
+    std::deque<Nan::AsyncWorker*> finished; // waiting for WorkComplete(), guarded by mutex
+    unsigned active = 0;                    // queued but not completed yet, only touched on its JS thread
+    bool closing = false;
+};
+
+struct Job {
+    Nan::AsyncWorker* worker;
+    Loop* loop;
+};
+
+uv_mutex_t mutex;
+uv_mutex_t resize_mutex; // serializes set_threads(), which drops mutex while joining
+uv_cond_t cond;    // signalled when pending gets a job or the pool is stopping
+uv_cond_t drained; // signalled when a closing loop gets a finished job
+uv_once_t once = UV_ONCE_INIT;
+bool stopping = false;
+
+std::deque<Job> pending; // waiting for a pool thread
+std::vector<uv_thread_t> pool;
+unsigned pool_size = 0;
+
+thread_local Loop* current = nullptr;
+
+unsigned wanted_threads() {
+    if (pool_size) return pool_size;
+    const unsigned cpus = std::thread::hardware_concurrency();
+    return cpus ? cpus : 1;
+}
+
+void init() {
+    uv_mutex_init(&mutex);
+    uv_mutex_init(&resize_mutex);
+    uv_cond_init(&cond);
+    uv_cond_init(&drained);
+}
+
+void thread_main(void*) {
+    uv_mutex_lock(&mutex);
+    while (!stopping) {
+        if (pending.empty()) {
+            uv_cond_wait(&cond, &mutex);
+            continue;
+        }
+
+        const Job job = pending.front();
+        pending.pop_front();
+        uv_mutex_unlock(&mutex);
+
+        job.worker->Execute();
+
+        uv_mutex_lock(&mutex);
+        job.loop->finished.push_back(job.worker);
+        if (job.loop->closing) {
+            uv_cond_broadcast(&drained);
+        } else {
+            uv_async_send(&job.loop->async);
+        }
+    }
+    uv_mutex_unlock(&mutex);
+}
+
+void on_finished(uv_async_t* handle) {
+    Loop* loop = static_cast<Loop*>(handle->data);
+    std::deque<Nan::AsyncWorker*> done;
+    uv_mutex_lock(&mutex);
+    done.swap(loop->finished);
+    uv_mutex_unlock(&mutex);
+
+    for (Nan::AsyncWorker* worker : done) {
+        // Callbacks may queue more work, so release the loop before running them
+        if (--loop->active == 0) uv_unref(reinterpret_cast<uv_handle_t*>(&loop->async));
+        worker->WorkComplete();
+        worker->Destroy();
+    }
+}
+
+void on_closed(uv_handle_t* handle) {
+    delete static_cast<Loop*>(handle->data);
+}
+
+// Runs when the environment of a JS thread goes away (process exit or a Worker
+// being terminated): waits for its jobs still running on the pool and drops
+// them without calling back into JS.
+void cleanup(void*) {
+    Loop* loop = current;
+    current = nullptr;
+
+    uv_mutex_lock(&mutex);
+    loop->closing = true;
+    for (auto it = pending.begin(); it != pending.end();) {
+        if (it->loop == loop) {
+            loop->finished.push_back(it->worker);
+            it = pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    while (loop->finished.size() < loop->active) uv_cond_wait(&drained, &mutex);
+    std::deque<Nan::AsyncWorker*> done;
+    done.swap(loop->finished);
+    uv_mutex_unlock(&mutex);
+
+    for (Nan::AsyncWorker* worker : done) worker->Destroy();
+    uv_close(reinterpret_cast<uv_handle_t*>(&loop->async), on_closed);
+}
+
+Loop* current_loop() {
+    if (!current) {
+        current = new Loop;
+        current->async.data = current;
+        uv_async_init(Nan::GetCurrentEventLoop(), &current->async, on_finished);
+        uv_unref(reinterpret_cast<uv_handle_t*>(&current->async));
+        node::AddEnvironmentCleanupHook(v8::Isolate::GetCurrent(), cleanup, nullptr);
+    }
+    return current;
+}
+
+// Must be called with mutex held
+void start() {
+    pool.resize(wanted_threads());
+    for (uv_thread_t& thread : pool) uv_thread_create(&thread, thread_main, nullptr);
+}
+
+// Must be called with mutex held, returns with it held
+void stop() {
+    stopping = true;
+    uv_cond_broadcast(&cond);
+    uv_mutex_unlock(&mutex);
+
+    for (uv_thread_t& thread : pool) uv_thread_join(&thread);
+
+    uv_mutex_lock(&mutex);
+    pool.clear();
+    stopping = false;
+}
+
+}
+
+void workers::queue(Nan::AsyncWorker* worker) {
+    uv_once(&once, init);
+    Loop* loop = current_loop();
+    if (loop->active++ == 0) uv_ref(reinterpret_cast<uv_handle_t*>(&loop->async));
+
+    uv_mutex_lock(&mutex);
+    if (pool.empty()) start();
+    pending.push_back(Job{ worker, loop });
+    uv_cond_signal(&cond);
+    uv_mutex_unlock(&mutex);
+}
+
+void workers::set_threads(const unsigned count) {
+    uv_once(&once, init);
+    uv_mutex_lock(&resize_mutex);
+    uv_mutex_lock(&mutex);
+    pool_size = count;
+    if (!pool.empty() && pool.size() != wanted_threads()) {
+        stop();
+        start();
+    }
+    uv_mutex_unlock(&mutex);
+    uv_mutex_unlock(&resize_mutex);
+}
+
+unsigned workers::threads() {
+    uv_once(&once, init);
+    uv_mutex_lock(&mutex);
+    const unsigned count = pool.empty() ? wanted_threads() : static_cast<unsigned>(pool.size());
+    uv_mutex_unlock(&mutex);
+    return count;
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+#include <nan.h>
+
+// Hashing thread pool behind all *_async methods. It is separate from the libuv
+// threadpool so long hashes can't starve fs/dns work, and its threads live long
+// enough to keep their hashing contexts (scratchpads, RandomX VMs) between jobs.
+namespace workers {
+
+// Runs worker->Execute() on a pool thread, then WorkComplete() and Destroy() on
+// the calling JS thread, like Nan::AsyncQueueWorker does with the libuv
+// threadpool. The pool is shared by the main thread and all worker_threads.
+void queue(Nan::AsyncWorker *worker);
+
+// Changes the pool size (0 = one thread per CPU). Queued jobs are kept.
+void set_threads(unsigned count);
+unsigned threads();
+
+}
@@ -0,0 +1,199 @@
+/* XMRig
+ * Copyright 2010      Jeff Garzik <jgarzik@pobox.com>
+ * Copyright 2012-2014 pooler      <pooler@litecoinpool.org>
+ * Copyright 2014      Lucas Jones <https://github.com/lucasjones>
+ * Copyright 2014-2016 Wolf9466    <https://github.com/OhGodAPet>
+ * Copyright 2016      Jay D Dee   <jayddee246@gmail.com>
+ * Copyright 2017-2018 XMR-Stak    <https://github.com/fireice-uk>, <https://github.com/psychocrypt>
+ * Copyright 2018-2019 SChernykh   <https://github.com/SChernykh>
+ * Copyright 2016-2019 XMRig       <https://github.com/xmrig>, <support@xmrig.com>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+
+#if !defined(__ARM_ARCH)
+#   ifdef _MSC_VER
+#       include <intrin.h>
+#   else
+#       include <cpuid.h>
+#   endif
+#endif
+
+
+#include "backend/cpu/Cpu.h"
+
+
+namespace {
+
+
+#if !defined(__ARM_ARCH)
+enum Register { EAX, EBX, ECX, EDX };
+
+
+static inline void cpuid(uint32_t level, uint32_t subleaf, uint32_t output[4])
+{
+#   ifdef _MSC_VER
+    __cpuidex(reinterpret_cast<int *>(output), static_cast<int>(level), static_cast<int>(subleaf));
+#   else
+    __cpuid_count(level, subleaf, output[EAX], output[EBX], output[ECX], output[EDX]);
+#   endif
+}
+
+
+// Register state enabled by the OS, AVX and AVX-512 can't be used without it
+static inline uint64_t xgetbv()
+{
+#   ifdef _MSC_VER
+    return _xgetbv(0);
+#   else
+    uint32_t eax, edx;
+    __asm__ __volatile__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+    return (static_cast<uint64_t>(edx) << 32) | eax;
+#   endif
+}
+#endif
+
+
+} // namespace
+
+
+xmrig::ICpuInfo::ICpuInfo()
+{
+#   if defined(__ARM_ARCH)
+    strcpy(m_brand, "ARM");
+#   if defined(__ARM_FEATURE_CRYPTO)
+    m_aes = true;
+#   endif
+#   else
+    uint32_t regs[4] = {};
+    cpuid(0, 0, regs);
+    const uint32_t max_level = regs[EAX];
+
+    char vendor[13] = {};
+    memcpy(vendor + 0, &regs[EBX], 4);
+    memcpy(vendor + 4, &regs[EDX], 4);
+    memcpy(vendor + 8, &regs[ECX], 4);
+
+    if (strcmp(vendor, "GenuineIntel") == 0) {
+        m_vendor = VENDOR_INTEL;
+    }
+    else if (strcmp(vendor, "AuthenticAMD") == 0 || strcmp(vendor, "HygonGenuine") == 0) {
+        m_vendor = VENDOR_AMD;
+    }
+
+    bool os_avx    = false;
+    bool os_avx512 = false;
+
+    if (max_level >= 1) {
+        cpuid(1, 0, regs);
+
+        m_family = (regs[EAX] >> 8) & 0xF;
+        m_model  = (regs[EAX] >> 4) & 0xF;
+        if (m_family == 0xF) {
+            m_family += (regs[EAX] >> 20) & 0xFF;
+        }
+        if (m_family >= 6) {
+            m_model |= ((regs[EAX] >> 16) & 0xF) << 4;
+        }
+
+        m_aes = (regs[ECX] & (1 << 25)) != 0;
+
+        const bool osxsave = (regs[ECX] & (1 << 27)) != 0;
+        const bool avx     = (regs[ECX] & (1 << 28)) != 0;
+        if (osxsave && avx) {
+            const uint64_t xcr0 = xgetbv();
+            os_avx    = (xcr0 & 0x06) == 0x06;
+            os_avx512 = (xcr0 & 0xE6) == 0xE6;
+        }
+    }
+
+    if (max_level >= 7) {
+        cpuid(7, 0, regs);
+
+        m_avx2    = os_avx    && (regs[EBX] & (1 << 5)) != 0;
+        m_avx512f = os_avx512 && (regs[EBX] & (1 << 16)) != 0;
+        m_vaes    = os_avx    && (regs[ECX] & (1 << 9)) != 0;
+    }
+
+    cpuid(0x80000000, 0, regs);
+    if (regs[EAX] >= 0x80000004) {
+        for (uint32_t i = 0; i < 3; ++i) {
+            cpuid(0x80000002 + i, 0, regs);
+            memcpy(m_brand + i * 16, regs, 16);
+        }
+
+        // Intel pads the brand string with spaces
+        const char *start = m_brand;
+        while (*start == ' ') {
+            ++start;
+        }
+        memmove(m_brand, start, strlen(start) + 1);
+        for (size_t len = strlen(m_brand); len > 0 && m_brand[len - 1] == ' '; --len) {
+            m_brand[len - 1] = '\0';
+        }
+    }
+
+    if (m_aes) {
+        if (m_vendor == VENDOR_AMD) {
+            m_assembly = m_family >= 0x17 ? Assembly::RYZEN : Assembly::BULLDOZER;
+        }
+        else {
+            m_assembly = Assembly::INTEL;
+        }
+    }
+#   endif
+}
+
+
+xmrig::ICpuInfo *xmrig::Cpu::info()
+{
+    static ICpuInfo info;
+    return &info;
+}
+
+
+bool xmrig::Cpu::isSoftAES()
+{
+#   if (defined(__AES__) && (__AES__ == 1)) || (defined(__ARM_FEATURE_CRYPTO) && (__ARM_FEATURE_CRYPTO == 1))
+    return !info()->hasAES();
+#   else
+    return true;
+#   endif
+}
+
+
+unsigned xmrig::Cpu::vaes()
+{
+    static const unsigned width = [] {
+        unsigned width = 0;
+        if (!isSoftAES() && info()->hasVAES()) {
+            width = info()->hasAVX512F() ? 512 : info()->hasAVX2() ? 256 : 0;
+        }
+
+        const char *env = getenv("CRYPTONIGHT_VAES");
+        if (env && static_cast<unsigned>(atoi(env)) < width) {
+            width = atoi(env) >= 256 ? 256 : 0;
+        }
+
+        return width;
+    }();
+
+    return width;
+}
@@ -31,24 +31,56 @@
 
 namespace xmrig {
 
+
+// Features of the CPU we are running on, detected with cpuid once at startup
 class ICpuInfo
 {
 public:
-    bool hasAVX2() const {
-#ifdef __AVX2__
-        return true;
-#else
-        return false;
-#endif
-    }
+    enum Vendor {
+        VENDOR_UNKNOWN,
+        VENDOR_INTEL,
+        VENDOR_AMD
+    };
+
+    ICpuInfo();
+
+    inline Assembly::Id assembly() const { return m_assembly; }
+    inline bool hasAES() const           { return m_aes; }
+    inline bool hasAVX2() const          { return m_avx2; }
+    inline bool hasAVX512F() const       { return m_avx512f; }
+    inline bool hasVAES() const          { return m_vaes; }
+    inline const char *brand() const     { return m_brand; }
+    inline unsigned family() const       { return m_family; }
+    inline unsigned model() const        { return m_model; }
+    inline Vendor vendor() const         { return m_vendor; }
+
+private:
+    Assembly::Id m_assembly = Assembly::NONE;
+    bool m_aes              = false;
+    bool m_avx2             = false;
+    bool m_avx512f          = false;
+    bool m_vaes             = false;
+    char m_brand[64 + 1]    = {};
+    unsigned m_family       = 0;
+    unsigned m_model        = 0;
+    Vendor m_vendor         = VENDOR_UNKNOWN;
 };
 
 
 class Cpu
 {
 public:
-    static ICpuInfo *info() { static ICpuInfo info; return &info; }
-    inline static Assembly::Id assembly(Assembly::Id hint) { return hint; }
+    static ICpuInfo *info();
+
+    // Hardware AES kernels are only usable if the CPU has AES-NI and they
+    // were compiled with AES support, otherwise the soft AES ones must be used
+    static bool isSoftAES();
+
+    // Width in bits of the VAES scratchpad kernels to use, 512, 256 or 0 if the
+    // CPU has none. CRYPTONIGHT_VAES=256 or 0 lowers it.
+    static unsigned vaes();
+
+    inline static Assembly::Id assembly(Assembly::Id hint) { return hint == Assembly::AUTO ? info()->assembly() : hint; }
 };
 
 
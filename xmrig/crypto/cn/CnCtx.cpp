@@ -27,6 +27,7 @@
 
 
 #include "crypto/cn/CnCtx.h"
+#include "crypto/cn/CnRCache.h"
 #include "crypto/cn/CryptoNight.h"
 #include "crypto/common/Algorithm.h"
 #include "crypto/common/portable/mm_malloc.h"
@@ -39,7 +40,9 @@ void xmrig::CnCtx::create(cryptonight_ctx **ctx, uint8_t *memory, size_t size, s
         cryptonight_ctx *c = static_cast<cryptonight_ctx *>(_mm_malloc(sizeof(cryptonight_ctx), 4096));
         c->memory          = memory + (i * size);
 
-        c->generated_code              = reinterpret_cast<cn_mainloop_fun_ms_abi>(VirtualMemory::allocateExecutableMemory(0x4000));
+        c->generated_code_buffer       = VirtualMemory::allocateDualMappedMemory(0x4000, &c->generated_code_writable);
+        c->generated_code              = reinterpret_cast<cn_mainloop_fun_ms_abi>(c->generated_code_buffer);
+        c->generated_code_slot         = -1;
         c->generated_code_data.algo    = Algorithm::INVALID;
         c->generated_code_data.height  = std::numeric_limits<uint64_t>::max();
 
@@ -55,6 +58,8 @@ void xmrig::CnCtx::release(cryptonight_ctx **ctx, size_t count)
     }
 
     for (size_t i = 0; i < count; ++i) {
+        CnRCache::release(ctx[i]);
+        VirtualMemory::freeDualMappedMemory(ctx[i]->generated_code_buffer, ctx[i]->generated_code_writable, 0x4000);
         _mm_free(ctx[i]);
     }
 }
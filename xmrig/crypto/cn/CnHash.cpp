@@ -28,7 +28,6 @@
 
 #include "backend/cpu/Cpu.h"
 #include "crypto/cn/CnHash.h"
-#include "crypto/common/VirtualMemory.h"
 
 
 #if defined(XMRIG_ARM)
@@ -64,138 +63,10 @@
     m_map[algo][AV_DOUBLE][Assembly::INTEL]     = cryptonight_double_hash_asm<algo, Assembly::INTEL>;     \
     m_map[algo][AV_DOUBLE][Assembly::RYZEN]     = cryptonight_double_hash_asm<algo, Assembly::RYZEN>;     \
     m_map[algo][AV_DOUBLE][Assembly::BULLDOZER] = cryptonight_double_hash_asm<algo, Assembly::BULLDOZER>;
-
-
-namespace xmrig {
-
-
-cn_mainloop_fun        cn_half_mainloop_ivybridge_asm             = nullptr;
-cn_mainloop_fun        cn_half_mainloop_ryzen_asm                 = nullptr;
-cn_mainloop_fun        cn_half_mainloop_bulldozer_asm             = nullptr;
-cn_mainloop_fun        cn_half_double_mainloop_sandybridge_asm    = nullptr;
-
-cn_mainloop_fun        cn_trtl_mainloop_ivybridge_asm             = nullptr;
-cn_mainloop_fun        cn_trtl_mainloop_ryzen_asm                 = nullptr;
-cn_mainloop_fun        cn_trtl_mainloop_bulldozer_asm             = nullptr;
-cn_mainloop_fun        cn_trtl_double_mainloop_sandybridge_asm    = nullptr;
-
-cn_mainloop_fun        cn_zls_mainloop_ivybridge_asm              = nullptr;
-cn_mainloop_fun        cn_zls_mainloop_ryzen_asm                  = nullptr;
-cn_mainloop_fun        cn_zls_mainloop_bulldozer_asm              = nullptr;
-cn_mainloop_fun        cn_zls_double_mainloop_sandybridge_asm     = nullptr;
-
-cn_mainloop_fun        cn_double_mainloop_ivybridge_asm           = nullptr;
-cn_mainloop_fun        cn_double_mainloop_ryzen_asm               = nullptr;
-cn_mainloop_fun        cn_double_mainloop_bulldozer_asm           = nullptr;
-cn_mainloop_fun        cn_double_double_mainloop_sandybridge_asm  = nullptr;
-
-
-template<typename T, typename U>
-static void patchCode(T dst, U src, const uint32_t iterations, const uint32_t mask = CnAlgo<Algorithm::CN_HALF>().mask())
-{
-    auto p = reinterpret_cast<const uint8_t*>(src);
-
-    // Workaround for Visual Studio placing trampoline in debug builds.
-#   if defined(_MSC_VER)
-    if (p[0] == 0xE9) {
-        p += *(int32_t*)(p + 1) + 5;
-    }
-#   endif
-
-    size_t size = 0;
-    while (*(uint32_t*)(p + size) != 0xDEADC0DE) {
-        ++size;
-    }
-
-    size += sizeof(uint32_t);
-
-    memcpy((void*) dst, (const void*) src, size);
-
-    auto patched_data = reinterpret_cast<uint8_t*>(dst);
-    for (size_t i = 0; i + sizeof(uint32_t) <= size; ++i) {
-        switch (*(uint32_t*)(patched_data + i)) {
-        case CnAlgo<Algorithm::CN_2>().iterations():
-            *(uint32_t*)(patched_data + i) = iterations;
-            break;
-
-        case CnAlgo<Algorithm::CN_2>().mask():
-            *(uint32_t*)(patched_data + i) = mask;
-            break;
-        }
-    }
-}
-
-
-static void patchAsmVariants()
-{
-    const int allocation_size = 65536;
-    auto base = static_cast<uint8_t *>(VirtualMemory::allocateExecutableMemory(allocation_size));
-
-    cn_half_mainloop_ivybridge_asm              = reinterpret_cast<cn_mainloop_fun>         (base + 0x0000);
-    cn_half_mainloop_ryzen_asm                  = reinterpret_cast<cn_mainloop_fun>         (base + 0x1000);
-    cn_half_mainloop_bulldozer_asm              = reinterpret_cast<cn_mainloop_fun>         (base + 0x2000);
-    cn_half_double_mainloop_sandybridge_asm     = reinterpret_cast<cn_mainloop_fun>         (base + 0x3000);
-
-#   ifdef XMRIG_ALGO_CN_PICO
-    cn_trtl_mainloop_ivybridge_asm              = reinterpret_cast<cn_mainloop_fun>         (base + 0x4000);
-    cn_trtl_mainloop_ryzen_asm                  = reinterpret_cast<cn_mainloop_fun>         (base + 0x5000);
-    cn_trtl_mainloop_bulldozer_asm              = reinterpret_cast<cn_mainloop_fun>         (base + 0x6000);
-    cn_trtl_double_mainloop_sandybridge_asm     = reinterpret_cast<cn_mainloop_fun>         (base + 0x7000);
-#   endif
-
-    cn_zls_mainloop_ivybridge_asm               = reinterpret_cast<cn_mainloop_fun>         (base + 0x8000);
-    cn_zls_mainloop_ryzen_asm                   = reinterpret_cast<cn_mainloop_fun>         (base + 0x9000);
-    cn_zls_mainloop_bulldozer_asm               = reinterpret_cast<cn_mainloop_fun>         (base + 0xA000);
-    cn_zls_double_mainloop_sandybridge_asm      = reinterpret_cast<cn_mainloop_fun>         (base + 0xB000);
-
-    cn_double_mainloop_ivybridge_asm            = reinterpret_cast<cn_mainloop_fun>         (base + 0xC000);
-    cn_double_mainloop_ryzen_asm                = reinterpret_cast<cn_mainloop_fun>         (base + 0xD000);
-    cn_double_mainloop_bulldozer_asm            = reinterpret_cast<cn_mainloop_fun>         (base + 0xE000);
-    cn_double_double_mainloop_sandybridge_asm   = reinterpret_cast<cn_mainloop_fun>         (base + 0xF000);
-
-    {
-        constexpr uint32_t ITER = CnAlgo<Algorithm::CN_HALF>().iterations();
-
-        patchCode(cn_half_mainloop_ivybridge_asm,            cnv2_mainloop_ivybridge_asm,           ITER);
-        patchCode(cn_half_mainloop_ryzen_asm,                cnv2_mainloop_ryzen_asm,               ITER);
-        patchCode(cn_half_mainloop_bulldozer_asm,            cnv2_mainloop_bulldozer_asm,           ITER);
-        patchCode(cn_half_double_mainloop_sandybridge_asm,   cnv2_double_mainloop_sandybridge_asm,  ITER);
-    }
-
-#   ifdef XMRIG_ALGO_CN_PICO
-    {
-        constexpr uint32_t ITER = CnAlgo<Algorithm::CN_PICO_0>().iterations();
-        constexpr uint32_t MASK = CnAlgo<Algorithm::CN_PICO_0>().mask();
-
-        patchCode(cn_trtl_mainloop_ivybridge_asm,            cnv2_mainloop_ivybridge_asm,           ITER,   MASK);
-        patchCode(cn_trtl_mainloop_ryzen_asm,                cnv2_mainloop_ryzen_asm,               ITER,   MASK);
-        patchCode(cn_trtl_mainloop_bulldozer_asm,            cnv2_mainloop_bulldozer_asm,           ITER,   MASK);
-        patchCode(cn_trtl_double_mainloop_sandybridge_asm,   cnv2_double_mainloop_sandybridge_asm,  ITER,   MASK);
+#   define ADD_FN_ASM_GEN(algo)   \
+    if (CnMainLoop::has(algo)) {   \
+        ADD_FN_ASM(algo)           \
     }
-#   endif
-
-    {
-        constexpr uint32_t ITER = CnAlgo<Algorithm::CN_ZLS>().iterations();
-
-        patchCode(cn_zls_mainloop_ivybridge_asm,             cnv2_mainloop_ivybridge_asm,           ITER);
-        patchCode(cn_zls_mainloop_ryzen_asm,                 cnv2_mainloop_ryzen_asm,               ITER);
-        patchCode(cn_zls_mainloop_bulldozer_asm,             cnv2_mainloop_bulldozer_asm,           ITER);
-        patchCode(cn_zls_double_mainloop_sandybridge_asm,    cnv2_double_mainloop_sandybridge_asm,  ITER);
-    }
-
-    {
-        constexpr uint32_t ITER = CnAlgo<Algorithm::CN_DOUBLE>().iterations();
-
-        patchCode(cn_double_mainloop_ivybridge_asm,          cnv2_mainloop_ivybridge_asm,           ITER);
-        patchCode(cn_double_mainloop_ryzen_asm,              cnv2_mainloop_ryzen_asm,               ITER);
-        patchCode(cn_double_mainloop_bulldozer_asm,          cnv2_mainloop_bulldozer_asm,           ITER);
-        patchCode(cn_double_double_mainloop_sandybridge_asm, cnv2_double_mainloop_sandybridge_asm,  ITER);
-    }
-
-    VirtualMemory::protectExecutableMemory(base, allocation_size);
-    VirtualMemory::flushInstructionCache(base, allocation_size);
-}
-} // namespace xmrig
 #else
 #   define ADD_FN_ASM(algo)
 #endif
@@ -219,11 +90,7 @@ xmrig::CnHash::CnHash()
     ADD_FN(Algorithm::CN_DOUBLE);
 
     ADD_FN_ASM(Algorithm::CN_2);
-    ADD_FN_ASM(Algorithm::CN_HALF);
     ADD_FN_ASM(Algorithm::CN_R);
-    ADD_FN_ASM(Algorithm::CN_RWZ);
-    ADD_FN_ASM(Algorithm::CN_ZLS);
-    ADD_FN_ASM(Algorithm::CN_DOUBLE);
 
 #   ifdef XMRIG_ALGO_CN_GPU
     m_map[Algorithm::CN_GPU][AV_SINGLE][Assembly::NONE]      = cryptonight_single_hash_gpu<Algorithm::CN_GPU, false>;
@@ -243,7 +110,6 @@ xmrig::CnHash::CnHash()
 
 #   ifdef XMRIG_ALGO_CN_PICO
     ADD_FN(Algorithm::CN_PICO_0);
-    ADD_FN_ASM(Algorithm::CN_PICO_0);
 #   endif
 
 #   ifdef XMRIG_ALGO_ARGON2
@@ -254,7 +120,32 @@ xmrig::CnHash::CnHash()
 #   endif
 
 #   ifdef XMRIG_FEATURE_ASM
-    patchAsmVariants();
+    // An algorithm gets generated asm kernels only if all its loops fit
+    CnMainLoop::init();
+
+    ADD_FN_ASM_GEN(Algorithm::CN_0);
+    ADD_FN_ASM_GEN(Algorithm::CN_1);
+    ADD_FN_ASM_GEN(Algorithm::CN_FAST);
+    ADD_FN_ASM_GEN(Algorithm::CN_HALF);
+    ADD_FN_ASM_GEN(Algorithm::CN_XAO);
+    ADD_FN_ASM_GEN(Algorithm::CN_RTO);
+    ADD_FN_ASM_GEN(Algorithm::CN_RWZ);
+    ADD_FN_ASM_GEN(Algorithm::CN_ZLS);
+    ADD_FN_ASM_GEN(Algorithm::CN_DOUBLE);
+
+#   ifdef XMRIG_ALGO_CN_LITE
+    ADD_FN_ASM_GEN(Algorithm::CN_LITE_0);
+    ADD_FN_ASM_GEN(Algorithm::CN_LITE_1);
+#   endif
+
+#   ifdef XMRIG_ALGO_CN_HEAVY
+    ADD_FN_ASM_GEN(Algorithm::CN_HEAVY_0);
+    ADD_FN_ASM_GEN(Algorithm::CN_HEAVY_XHV);
+#   endif
+
+#   ifdef XMRIG_ALGO_CN_PICO
+    ADD_FN_ASM_GEN(Algorithm::CN_PICO_0);
+#   endif
 #   endif
 }
 
@@ -0,0 +1,796 @@
+/* XMRig
+ * Copyright 2010      Jeff Garzik <jgarzik@pobox.com>
+ * Copyright 2012-2014 pooler      <pooler@litecoinpool.org>
+ * Copyright 2014      Lucas Jones <https://github.com/lucasjones>
+ * Copyright 2014-2016 Wolf9466    <https://github.com/OhGodAPet>
+ * Copyright 2016      Jay D Dee   <jayddee246@gmail.com>
+ * Copyright 2017-2019 XMR-Stak    <https://github.com/fireice-uk>, <https://github.com/psychocrypt>
+ * Copyright 2018      Lee Clagett <https://github.com/vtnerd>
+ * Copyright 2018-2019 SChernykh   <https://github.com/SChernykh>
+ * Copyright 2016-2019 XMRig       <https://github.com/xmrig>, <support@xmrig.com>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+
+
+#include "crypto/cn/CnAlgo.h"
+#include "crypto/cn/CnMainLoop.h"
+#include "crypto/common/VirtualMemory.h"
+
+
+namespace xmrig {
+
+
+namespace {
+
+
+enum Gp { RAX, RCX, RDX, RBX, RSP, RBP, RSI, RDI, R8, R9, R10, R11, R12, R13, R14, R15 };
+enum Cond { CC_Z = 4, CC_NZ = 5 };
+enum Alu { ADD = 0, OR = 1, ADC = 2, AND = 4, SUB = 5, XOR = 6 };
+enum Shift { SHL = 4, SHR = 5 };
+
+
+struct Mem
+{
+    int base;
+    int index;
+    int scale;
+    int32_t disp;
+};
+
+
+inline Mem ptr(int base, int32_t disp = 0)             { return { base, -1, 1, disp }; }
+inline Mem ptrIndex(int base, int index, int32_t disp = 0) { return { base, index, 1, disp }; }
+
+
+// Just the x86-64 encodings the loops need, Intel operand order
+class Emitter
+{
+public:
+    inline Emitter(uint8_t *code, size_t size) : m_code(code), m_size(size) {}
+
+    inline bool fits() const      { return m_pos <= m_size; }
+    inline size_t pos() const     { return m_pos; }
+
+    void byte(uint8_t b)          { if (m_pos < m_size) { m_code[m_pos] = b; } ++m_pos; }
+    void u32(uint32_t v)          { for (int i = 0; i < 4; ++i) { byte(static_cast<uint8_t>(v >> (i * 8))); } }
+    void u64(uint64_t v)          { u32(static_cast<uint32_t>(v)); u32(static_cast<uint32_t>(v >> 32)); }
+
+    void align(size_t n)          { while (m_pos % n) { byte(0x90); } }
+
+    // Register to register and memory forms, reg in ModRM.reg
+    void rr(uint8_t prefix, bool w, std::initializer_list<uint8_t> op, int reg, int rm)
+    {
+        start(prefix, w, reg, -1, rm, op);
+        byte(static_cast<uint8_t>(0xC0 | ((reg & 7) << 3) | (rm & 7)));
+    }
+
+    void rm(uint8_t prefix, bool w, std::initializer_list<uint8_t> op, int reg, const Mem &m)
+    {
+        start(prefix, w, reg, m.index, m.base, op);
+
+        const uint8_t mod = (m.disp == 0 && (m.base & 7) != RBP) ? 0x00 : (m.disp >= -128 && m.disp <= 127 ? 0x40 : 0x80);
+        if (m.index < 0 && (m.base & 7) != RSP) {
+            byte(static_cast<uint8_t>(mod | ((reg & 7) << 3) | (m.base & 7)));
+        }
+        else {
+            const uint8_t scale = m.scale == 8 ? 3 : (m.scale == 4 ? 2 : (m.scale == 2 ? 1 : 0));
+            byte(static_cast<uint8_t>(mod | ((reg & 7) << 3) | 4));
+            byte(static_cast<uint8_t>((scale << 6) | ((m.index < 0 ? RSP : m.index) & 7) << 3 | (m.base & 7)));
+        }
+
+        if (mod == 0x40) {
+            byte(static_cast<uint8_t>(m.disp));
+        }
+        else if (mod == 0x80) {
+            u32(static_cast<uint32_t>(m.disp));
+        }
+    }
+
+    // General purpose
+    void mov(int dst, int src, bool w = true)               { rr(0, w, { 0x8B }, dst, src); }
+    void mov(int dst, const Mem &src)                       { rm(0, true, { 0x8B }, dst, src); }
+    void mov(const Mem &dst, int src)                       { rm(0, true, { 0x89 }, src, dst); }
+    void mov32(const Mem &dst, uint32_t imm)                { rm(0, false, { 0xC7 }, 0, dst); u32(imm); }
+    void movsxd(int dst, const Mem &src)                    { rm(0, true, { 0x63 }, dst, src); }
+    void lea(int dst, const Mem &src, bool w = true)        { rm(0, w, { 0x8D }, dst, src); }
+    void alu(Alu op, int dst, int src, bool w = true)       { rr(0, w, { static_cast<uint8_t>((op << 3) | 3) }, dst, src); }
+    void alu(Alu op, int dst, const Mem &src)               { rm(0, true, { static_cast<uint8_t>((op << 3) | 3) }, dst, src); }
+    void shift(Shift op, int dst, uint8_t n, bool w = true) { rr(0, w, { 0xC1 }, op, dst); byte(n); }
+    void shiftCl(Shift op, int dst, bool w = true)          { rr(0, w, { 0xD3 }, op, dst); }
+    void mul(int src)                                       { rr(0, true, { 0xF7 }, 4, src); }
+    void div(int src)                                       { rr(0, true, { 0xF7 }, 6, src); }
+    void idiv(int src)                                      { rr(0, true, { 0xF7 }, 7, src); }
+    void not32(int dst)                                     { rr(0, false, { 0xF7 }, 2, dst); }
+    void imul(int dst, int src)                             { rr(0, true, { 0x0F, 0xAF }, dst, src); }
+    void cqo()                                              { byte(0x48); byte(0x99); }
+    void ret()                                              { byte(0xC3); }
+
+    void alu(Alu op, int dst, uint32_t imm, bool w = true)
+    {
+        if (static_cast<int32_t>(imm) >= -128 && static_cast<int32_t>(imm) <= 127) {
+            rr(0, w, { 0x83 }, op, dst);
+            byte(static_cast<uint8_t>(imm));
+        }
+        else {
+            rr(0, w, { 0x81 }, op, dst);
+            u32(imm);
+        }
+    }
+
+    void sub32(const Mem &dst, uint8_t imm)                 { rm(0, false, { 0x83 }, SUB, dst); byte(imm); }
+    void test32(int dst, uint32_t imm)                      { rr(0, false, { 0xF7 }, 0, dst); u32(imm); }
+
+    void mov(int dst, uint64_t imm)
+    {
+        if (imm <= 0xFFFFFFFFULL) {
+            if (dst >= 8) {
+                byte(0x41);
+            }
+
+            byte(static_cast<uint8_t>(0xB8 | (dst & 7)));
+            u32(static_cast<uint32_t>(imm));
+        }
+        else {
+            byte(static_cast<uint8_t>(0x48 | (dst >> 3)));
+            byte(static_cast<uint8_t>(0xB8 | (dst & 7)));
+            u64(imm);
+        }
+    }
+
+    void push(int r)                                        { if (r >= 8) { byte(0x41); } byte(static_cast<uint8_t>(0x50 | (r & 7))); }
+    void pop(int r)                                         { if (r >= 8) { byte(0x41); } byte(static_cast<uint8_t>(0x58 | (r & 7))); }
+
+    // Jumps: forward ones are patched by bind()
+    size_t jcc(Cond cc)                                     { byte(0x0F); byte(static_cast<uint8_t>(0x80 | cc)); u32(0); return m_pos; }
+    size_t jmp()                                            { byte(0xE9); u32(0); return m_pos; }
+    void jcc(Cond cc, size_t target)                        { bind(jcc(cc), target); }
+    void jmp(size_t target)                                 { bind(jmp(), target); }
+
+    void bind(size_t jump, size_t target)
+    {
+        const uint32_t rel = static_cast<uint32_t>(static_cast<int32_t>(target - jump));
+        for (int i = 0; i < 4; ++i) {
+            if (jump - 4 + i < m_size) {
+                m_code[jump - 4 + i] = static_cast<uint8_t>(rel >> (i * 8));
+            }
+        }
+    }
+
+    // SSE
+    void movdqa(int dst, const Mem &src)                    { rm(0x66, false, { 0x0F, 0x6F }, dst, src); }
+    void movdqa(const Mem &dst, int src)                    { rm(0x66, false, { 0x0F, 0x7F }, src, dst); }
+    void movdqa(int dst, int src)                           { rr(0x66, false, { 0x0F, 0x6F }, dst, src); }
+    void movdqu(int dst, const Mem &src)                    { rm(0xF3, false, { 0x0F, 0x6F }, dst, src); }
+    void movdqu(const Mem &dst, int src)                    { rm(0xF3, false, { 0x0F, 0x7F }, src, dst); }
+    void movq(int xmm, const Mem &src)                      { rm(0xF3, false, { 0x0F, 0x7E }, xmm, src); }
+    void movq(const Mem &dst, int xmm)                      { rm(0x66, false, { 0x0F, 0xD6 }, xmm, dst); }
+    void movqToXmm(int xmm, int gp)                         { rr(0x66, true, { 0x0F, 0x6E }, xmm, gp); }
+    void movqToGp(int gp, int xmm)                          { rr(0x66, true, { 0x0F, 0x7E }, xmm, gp); }
+    void pinsrq(int xmm, int gp, uint8_t i)                 { rr(0x66, true, { 0x0F, 0x3A, 0x22 }, xmm, gp); byte(i); }
+    void pextrq(int gp, int xmm, uint8_t i)                 { rr(0x66, true, { 0x0F, 0x3A, 0x16 }, xmm, gp); byte(i); }
+    void punpcklqdq(int dst, int src)                       { rr(0x66, false, { 0x0F, 0x6C }, dst, src); }
+    void psrldq(int dst, uint8_t n)                         { rr(0x66, false, { 0x0F, 0x73 }, 3, dst); byte(n); }
+    void paddq(int dst, int src)                            { rr(0x66, false, { 0x0F, 0xD4 }, dst, src); }
+    void pxor(int dst, int src)                             { rr(0x66, false, { 0x0F, 0xEF }, dst, src); }
+    void pxor(int dst, const Mem &src)                      { rm(0x66, false, { 0x0F, 0xEF }, dst, src); }
+    void aesenc(int dst, int src)                           { rr(0x66, false, { 0x0F, 0x38, 0xDC }, dst, src); }
+    void sqrtsd(int dst, int src)                           { rr(0xF2, false, { 0x0F, 0x51 }, dst, src); }
+    void stmxcsr(const Mem &dst)                            { rm(0, false, { 0x0F, 0xAE }, 3, dst); }
+    void ldmxcsr(const Mem &src)                            { rm(0, false, { 0x0F, 0xAE }, 2, src); }
+
+private:
+    void start(uint8_t prefix, bool w, int reg, int index, int base, std::initializer_list<uint8_t> op)
+    {
+        if (prefix) {
+            byte(prefix);
+        }
+
+        const uint8_t rex = static_cast<uint8_t>(0x40 | (w ? 8 : 0) | ((reg >> 3) & 1) << 2 | (index > 0 ? (index >> 3) & 1 : 0) << 1 | ((base >> 3) & 1));
+        if (rex != 0x40) {
+            byte(rex);
+        }
+
+        for (uint8_t b : op) {
+            byte(b);
+        }
+    }
+
+    uint8_t *m_code;
+    size_t m_pos = 0;
+    size_t m_size;
+};
+
+
+// Where a lane keeps the variant 2 division and square root results, registers of
+// their own when there's one lane, xmm registers when there are two
+struct Loc
+{
+    bool xmm;
+    int reg;
+};
+
+
+struct Lane
+{
+    int memory;
+    int al;
+    int ah;
+    int idx;   // al & mask, or the cn-heavy index
+    int b0;    // xmm
+    int b1;    // xmm
+    Loc division;
+    Loc sqrt;
+};
+
+
+// Temporaries shared by the lanes: iterations of the lanes follow each other and
+// out of order execution overlaps them
+constexpr int T_CX0     = R8;  // low half of cx, also an offset
+constexpr int T_IDX     = R9;  // cx index
+constexpr int T_CL      = R10; // cl, variant 2 modified
+constexpr int T_DIV     = R11; // divisor, then square root input, then ch
+constexpr int T_OFF     = RCX; // third shuffle offset, shift count
+
+constexpr int X_CX      = 0;
+constexpr int X_AX      = 1;
+constexpr int X_TMP     = 2;
+constexpr int X_CHUNK1  = 3;
+constexpr int X_CHUNK2  = 4;
+constexpr int X_CHUNK3  = 5;
+constexpr int X_SQRT_K  = 6;   // 1023 << 52, the exponent of 1.0
+
+constexpr int32_t STACK_MXCSR   = 0;
+constexpr int32_t STACK_COUNTER = 8;
+constexpr int32_t STACK_TWEAK   = 16;
+constexpr int32_t STACK_XMM     = 32;
+constexpr int32_t STACK_SIZE    = STACK_XMM + 10 * 16 + 8; // rsp stays 16 byte aligned
+
+static const int savedGp[] = { RBX, RBP, RSI, RDI, R12, R13, R14, R15 };
+
+
+class Generator
+{
+public:
+    Generator(const CnMainLoop::Params &p, Emitter &e) : m_p(p), a(e) {}
+
+    void generate()
+    {
+        prologue();
+
+        a.align(64);
+        const size_t loop = a.pos();
+        for (size_t i = 0; i < m_p.ways; ++i) {
+            iteration(m_lanes[i], i);
+        }
+
+        if (m_p.ways == 1) {
+            a.alu(SUB, R14, 1u, false);
+        }
+        else {
+            a.sub32(ptr(RSP, STACK_COUNTER), 1);
+        }
+        a.jcc(CC_NZ, loop);
+
+        epilogue();
+
+        for (size_t i = 0; i < m_p.ways; ++i) {
+            if (m_fixup[i]) {
+                sqrtFixup(i);
+            }
+        }
+    }
+
+private:
+    inline bool cn1() const { return m_p.base == Algorithm::CN_1; }
+    inline bool cn2() const { return m_p.base == Algorithm::CN_2; }
+
+    void prologue()
+    {
+        for (int r : savedGp) {
+            a.push(r);
+        }
+
+        a.alu(SUB, RSP, static_cast<uint32_t>(STACK_SIZE));
+        for (int i = 0; i < 10; ++i) {
+            a.movdqu(ptr(RSP, STACK_XMM + i * 16), 6 + i);
+        }
+
+        if (m_p.ways == 1) {
+            m_lanes[0] = { RBX, RSI, RDI, RBP, 7, 8, { false, R12 }, { false, R13 } };
+            a.mov(R14, static_cast<uint64_t>(m_p.iterations));
+        }
+        else {
+            m_lanes[0] = { RBX, RSI, RDI, RBP, 7,  8,  { true, 9 },  { true, 10 } };
+            m_lanes[1] = { R12, R13, R14, R15, 11, 12, { true, 13 }, { true, 14 } };
+            a.mov32(ptr(RSP, STACK_COUNTER), m_p.iterations);
+        }
+
+        // rcx is the cryptonight_ctx ** argument
+        for (size_t i = 0; i < m_p.ways; ++i) {
+            const Lane &l = m_lanes[i];
+
+            a.mov(RAX, ptr(RCX, static_cast<int32_t>(i * sizeof(void *))));
+            a.mov(l.memory, ptr(RAX, offsetof(cryptonight_ctx, memory)));
+            a.mov(l.al, ptr(RAX, 0));
+            a.alu(XOR, l.al, ptr(RAX, 32));
+            a.mov(l.ah, ptr(RAX, 8));
+            a.alu(XOR, l.ah, ptr(RAX, 40));
+            a.mov(l.idx, l.al, false);
+            a.alu(AND, l.idx, m_p.mask, false);
+            a.movdqa(l.b0, ptr(RAX, 16));
+            a.pxor(l.b0, ptr(RAX, 48));
+
+            if (cn1()) {
+                a.mov(RDX, ptr(RAX, offsetof(cryptonight_ctx, tweak1_2)));
+                a.mov(ptr(RSP, STACK_TWEAK + static_cast<int32_t>(i * 8)), RDX);
+            }
+
+            if (cn2()) {
+                a.movdqa(l.b1, ptr(RAX, 64));
+                a.pxor(l.b1, ptr(RAX, 80));
+                load(l.division, ptr(RAX, 96));
+                load(l.sqrt, ptr(RAX, 104));
+            }
+        }
+
+        if (cn2()) {
+            a.stmxcsr(ptr(RSP, STACK_MXCSR));
+            a.mov32(ptr(RSP, STACK_MXCSR + 4), 0x5F80); // rounding up, the square root below relies on it
+            a.ldmxcsr(ptr(RSP, STACK_MXCSR + 4));
+            a.mov(RAX, static_cast<uint64_t>(1023) << 52);
+            a.movqToXmm(X_SQRT_K, RAX);
+        }
+    }
+
+    void epilogue()
+    {
+        if (cn2()) {
+            a.ldmxcsr(ptr(RSP, STACK_MXCSR));
+        }
+
+        for (int i = 0; i < 10; ++i) {
+            a.movdqu(6 + i, ptr(RSP, STACK_XMM + i * 16));
+        }
+
+        a.alu(ADD, RSP, static_cast<uint32_t>(STACK_SIZE));
+        for (size_t i = sizeof(savedGp) / sizeof(savedGp[0]); i > 0; --i) {
+            a.pop(savedGp[i - 1]);
+        }
+
+        a.ret();
+    }
+
+    void load(const Loc &loc, const Mem &src)
+    {
+        if (loc.xmm) {
+            a.movq(loc.reg, src);
+        }
+        else {
+            a.mov(loc.reg, src);
+        }
+    }
+
+    void get(int dst, const Loc &loc)
+    {
+        if (loc.xmm) {
+            a.movqToGp(dst, loc.reg);
+        }
+        else {
+            a.mov(dst, loc.reg);
+        }
+    }
+
+    void set(const Loc &loc, int src)
+    {
+        if (loc.xmm) {
+            a.movqToXmm(loc.reg, src);
+        }
+        else {
+            a.mov(loc.reg, src);
+        }
+    }
+
+    // High half of an xmm register to a general purpose one
+    void high(int dst, int xmm)
+    {
+        if (m_p.assembly == Assembly::INTEL) {
+            a.movdqa(X_TMP, xmm);
+            a.psrldq(X_TMP, 8);
+            a.movqToGp(dst, X_TMP);
+        }
+        else {
+            a.pextrq(dst, xmm, 1);
+        }
+    }
+
+    void iteration(const Lane &l, size_t lane)
+    {
+        // cx = aesenc(memory[idx], a)
+        a.movdqa(X_CX, ptrIndex(l.memory, l.idx));
+        a.movqToXmm(X_AX, l.al);
+        if (m_p.assembly == Assembly::BULLDOZER) {
+            a.pinsrq(X_AX, l.ah, 1);
+        }
+        else {
+            a.movqToXmm(X_TMP, l.ah);
+            a.punpcklqdq(X_AX, X_TMP);
+        }
+        a.aesenc(X_CX, X_AX);
+
+        if (cn2()) {
+            shuffle(l);
+        }
+
+        // memory[idx] = b ^ cx
+        a.movdqa(X_TMP, l.b0);
+        a.pxor(X_TMP, X_CX);
+        if (cn1()) {
+            tweak1(l);
+        }
+        else {
+            a.movdqa(ptrIndex(l.memory, l.idx), X_TMP);
+        }
+
+        a.movqToGp(T_CX0, X_CX);
+        a.mov(T_IDX, T_CX0, false);
+        a.alu(AND, T_IDX, m_p.mask, false);
+
+        if (cn2()) {
+            integerMath(l, lane);
+        }
+        else {
+            a.mov(RAX, ptrIndex(l.memory, T_IDX));
+            a.mov(T_CL, RAX);
+        }
+
+        // hi:lo = cx * cl
+        a.mul(T_CX0);
+
+        if (cn2()) {
+            shuffle2(l);
+        }
+
+        a.alu(ADD, l.al, RDX);
+        a.alu(ADD, l.ah, RAX);
+        a.mov(T_DIV, ptrIndex(l.memory, T_IDX, 8));
+        a.mov(ptrIndex(l.memory, T_IDX), l.al);
+
+        if (cn1()) {
+            a.mov(RAX, l.ah);
+            a.alu(XOR, RAX, ptr(RSP, STACK_TWEAK + static_cast<int32_t>(lane * 8)));
+            if (m_p.rto) {
+                a.alu(XOR, RAX, l.al);
+            }
+            a.mov(ptrIndex(l.memory, T_IDX, 8), RAX);
+        }
+        else {
+            a.mov(ptrIndex(l.memory, T_IDX, 8), l.ah);
+        }
+
+        a.alu(XOR, l.al, T_CL);
+        a.alu(XOR, l.ah, T_DIV);
+        a.mov(l.idx, l.al, false);
+        a.alu(AND, l.idx, m_p.mask, false);
+
+        if (m_p.heavy) {
+            heavy(l);
+        }
+
+        if (cn2()) {
+            a.movdqa(l.b1, l.b0);
+        }
+        a.movdqa(l.b0, X_CX);
+    }
+
+    // Variant 1: memory[idx] = b ^ cx with bits 28-29 of the high half changed by bits of its byte 11
+    void tweak1(const Lane &l)
+    {
+        a.movq(ptrIndex(l.memory, l.idx), X_TMP);
+        high(T_CX0, X_TMP);
+
+        a.mov(T_IDX, T_CX0, false);
+        a.shift(SHR, T_IDX, 24, false);
+        a.mov(T_OFF, T_IDX, false);
+        a.shift(SHR, T_OFF, 3, false);
+        a.alu(AND, T_OFF, 6u, false);
+        a.alu(AND, T_IDX, 1u, false);
+        a.alu(OR, T_OFF, T_IDX, false);
+        a.alu(ADD, T_OFF, T_OFF, false);
+        a.mov(T_IDX, static_cast<uint64_t>(0x7531));
+        a.shiftCl(SHR, T_IDX, false);
+        a.alu(AND, T_IDX, 3u, false);
+        a.shift(SHL, T_IDX, 28, false);
+        a.alu(XOR, T_CX0, T_IDX);
+        a.mov(ptrIndex(l.memory, l.idx, 8), T_CX0);
+    }
+
+    // Variant 2: the other three 16 byte chunks of idx's 64 byte line move around
+    void shuffle(const Lane &l)
+    {
+        a.mov(T_CX0, l.idx, false);
+        a.alu(XOR, T_CX0, 0x10u, false);
+        a.mov(T_IDX, l.idx, false);
+        a.alu(XOR, T_IDX, 0x20u, false);
+        a.mov(T_CL, l.idx, false);
+        a.alu(XOR, T_CL, 0x30u, false);
+
+        a.movdqa(X_CHUNK1, ptrIndex(l.memory, m_p.reverse ? T_CL : T_CX0));
+        a.movdqa(X_CHUNK2, ptrIndex(l.memory, T_IDX));
+        a.movdqa(X_CHUNK3, ptrIndex(l.memory, m_p.reverse ? T_CX0 : T_CL));
+        a.paddq(X_CHUNK3, l.b1);
+        a.paddq(X_CHUNK1, l.b0);
+        a.paddq(X_CHUNK2, X_AX);
+        a.movdqa(ptrIndex(l.memory, T_CX0), X_CHUNK3);
+        a.movdqa(ptrIndex(l.memory, T_IDX), X_CHUNK1);
+        a.movdqa(ptrIndex(l.memory, T_CL), X_CHUNK2);
+    }
+
+    // Variant 2 after the multiplication, hi:lo in rdx:rax
+    void shuffle2(const Lane &l)
+    {
+        a.mov(T_DIV, T_IDX, false);
+        a.alu(XOR, T_DIV, 0x10u, false);
+        a.mov(T_CX0, T_IDX, false);
+        a.alu(XOR, T_CX0, 0x20u, false);
+        a.mov(T_OFF, T_IDX, false);
+        a.alu(XOR, T_OFF, 0x30u, false);
+
+        a.movqToXmm(X_CHUNK1, RDX);
+        a.movqToXmm(X_TMP, RAX);
+        a.punpcklqdq(X_CHUNK1, X_TMP);
+        a.pxor(X_CHUNK1, ptrIndex(l.memory, T_DIV));
+        a.movdqa(X_CHUNK2, ptrIndex(l.memory, T_CX0));
+        a.alu(XOR, RDX, ptrIndex(l.memory, T_CX0));
+        a.alu(XOR, RAX, ptrIndex(l.memory, T_CX0, 8));
+        a.movdqa(X_CHUNK3, ptrIndex(l.memory, T_OFF));
+
+        if (m_p.reverse) {
+            a.paddq(X_CHUNK1, l.b1);
+            a.paddq(X_CHUNK3, l.b0);
+            a.movdqa(ptrIndex(l.memory, T_DIV), X_CHUNK1);
+            a.movdqa(ptrIndex(l.memory, T_CX0), X_CHUNK3);
+        }
+        else {
+            a.paddq(X_CHUNK3, l.b1);
+            a.paddq(X_CHUNK1, l.b0);
+            a.movdqa(ptrIndex(l.memory, T_DIV), X_CHUNK3);
+            a.movdqa(ptrIndex(l.memory, T_CX0), X_CHUNK1);
+        }
+
+        a.paddq(X_CHUNK2, X_AX);
+        a.movdqa(ptrIndex(l.memory, T_OFF), X_CHUNK2);
+    }
+
+    // Variant 2 division and square root, leaves the modified cl in rax
+    void integerMath(const Lane &l, size_t lane)
+    {
+        get(T_DIV, l.sqrt);
+        a.mov(T_CL, T_DIV);
+        a.shift(SHL, T_CL, 32);
+        if (l.division.xmm) {
+            a.movqToGp(RAX, l.division.reg);
+            a.alu(XOR, T_CL, RAX);
+        }
+        else {
+            a.alu(XOR, T_CL, l.division.reg);
+        }
+        a.alu(XOR, T_CL, ptrIndex(l.memory, T_IDX));
+
+        // divisor = (cx + (sqrt << 1)) | 0x80000001, 32 bits
+        a.lea(T_DIV, { T_CX0, T_DIV, 2, 0 }, false);
+        a.alu(OR, T_DIV, 0x80000001u, false);
+
+        high(RAX, X_CX);
+        a.alu(XOR, RDX, RDX, false);
+        a.div(T_DIV);
+        a.mov(RAX, RAX, false);
+        a.shift(SHL, RDX, 32);
+        a.alu(ADD, RDX, RAX);
+        set(l.division, RDX);
+
+        // sqrt of cx + division, from the double sqrt of its top bits
+        a.lea(T_DIV, ptrIndex(T_CX0, RDX));
+        a.mov(RAX, T_DIV);
+        a.shift(SHR, RAX, 12);
+        a.movqToXmm(X_TMP, RAX);
+        a.paddq(X_TMP, X_SQRT_K);
+        a.sqrtsd(X_TMP, X_TMP);
+        a.movqToGp(RDX, X_TMP);
+        a.test32(RDX, 0x7FFFF);
+        m_fixup[lane] = a.jcc(CC_Z);
+        a.shift(SHR, RDX, 19);
+        m_fixupRet[lane] = a.pos();
+        set(l.sqrt, RDX);
+
+        a.mov(RAX, T_CL);
+    }
+
+    // Rare case of integerMath(): the double result is exact and may be one too big
+    void sqrtFixup(size_t lane)
+    {
+        a.bind(m_fixup[lane], a.pos());
+
+        a.alu(SUB, RDX, 1u);
+        a.mov(RAX, RDX);
+        a.shift(SHR, RAX, 20);
+        a.shift(SHR, RDX, 19);
+        a.mov(T_OFF, RDX);
+        a.alu(SUB, T_OFF, RAX);
+        a.push(T_CX0);
+        a.mov(T_CX0, static_cast<uint64_t>(-(1022LL << 32)));
+        a.alu(ADD, RAX, T_CX0);
+        a.lea(T_OFF, ptrIndex(T_OFF, T_CX0, 1));
+        a.pop(T_CX0);
+        a.imul(T_OFF, RAX);
+        a.alu(SUB, T_OFF, T_DIV);
+        a.alu(ADC, RDX, 0u);
+
+        a.jmp(m_fixupRet[lane]);
+    }
+
+    // cn-heavy: memory[idx] ^= n / (d | 5) and the quotient picks the next index
+    void heavy(const Lane &l)
+    {
+        a.mov(RAX, ptrIndex(l.memory, l.idx));
+        a.mov(T_CX0, RAX);
+        a.movsxd(T_DIV, ptrIndex(l.memory, l.idx, 8));
+        a.mov(T_CL, T_DIV);
+        a.alu(OR, T_CL, 5u);
+        a.cqo();
+        a.idiv(T_CL);
+        a.alu(XOR, T_CX0, RAX);
+        a.mov(ptrIndex(l.memory, l.idx), T_CX0);
+
+        if (m_p.xhv) {
+            a.not32(T_DIV);
+        }
+
+        a.alu(XOR, T_DIV, RAX, false);
+        a.alu(AND, T_DIV, m_p.mask, false);
+        a.mov(l.idx, T_DIV, false);
+    }
+
+    const CnMainLoop::Params &m_p;
+    Emitter &a;
+    Lane m_lanes[2];
+    size_t m_fixup[2]    = { 0, 0 };
+    size_t m_fixupRet[2] = { 0, 0 };
+};
+
+
+constexpr size_t kMaxWays  = 2;
+constexpr size_t kCodeSize = 0x80000;
+
+static cn_mainloop_fun_ms_abi loops[Algorithm::MAX][kMaxWays][Assembly::MAX] = {};
+
+
+} // namespace
+
+
+} // namespace xmrig
+
+
+xmrig::CnMainLoop::Params xmrig::CnMainLoop::params(Algorithm::Id algo, size_t ways, Assembly::Id assembly)
+{
+    Params p;
+
+    switch (algo) {
+    case Algorithm::CN_0:
+    case Algorithm::CN_1:
+    case Algorithm::CN_FAST:
+    case Algorithm::CN_HALF:
+    case Algorithm::CN_XAO:
+    case Algorithm::CN_RTO:
+    case Algorithm::CN_RWZ:
+    case Algorithm::CN_ZLS:
+    case Algorithm::CN_DOUBLE:
+#   ifdef XMRIG_ALGO_CN_LITE
+    case Algorithm::CN_LITE_0:
+    case Algorithm::CN_LITE_1:
+#   endif
+#   ifdef XMRIG_ALGO_CN_HEAVY
+    case Algorithm::CN_HEAVY_0:
+    case Algorithm::CN_HEAVY_XHV:
+#   endif
+#   ifdef XMRIG_ALGO_CN_PICO
+    case Algorithm::CN_PICO_0:
+#   endif
+        break;
+
+    default:
+        return p; // CN_2 and CN_R have their own, cn/gpu and cn-heavy/tube change AES
+    }
+
+    if ((ways != 1 && ways != kMaxWays) || assembly <= Assembly::AUTO || assembly >= Assembly::MAX) {
+        return p;
+    }
+
+    p.base       = CnAlgo<>::base(algo);
+    p.iterations = CnAlgo<>::iterations(algo);
+    p.mask       = CnAlgo<>::mask(algo);
+    p.heavy      = CnAlgo<>::memory(algo) == CnAlgo<Algorithm::CN_HEAVY_0>().memory();
+    p.xhv        = algo == Algorithm::CN_HEAVY_XHV;
+    p.rto        = algo == Algorithm::CN_RTO;
+    p.reverse    = algo == Algorithm::CN_RWZ;
+    p.ways       = ways;
+    p.assembly   = assembly;
+
+    return p;
+}
+
+
+size_t xmrig::CnMainLoop::generate(const Params &params, uint8_t *code, size_t size)
+{
+    if (params.base != Algorithm::CN_0 && params.base != Algorithm::CN_1 && params.base != Algorithm::CN_2) {
+        return 0;
+    }
+
+    Emitter emitter(code, size);
+    Generator(params, emitter).generate();
+
+    return emitter.fits() ? emitter.pos() : 0;
+}
+
+
+bool xmrig::CnMainLoop::init()
+{
+    auto code = static_cast<uint8_t *>(VirtualMemory::allocateExecutableMemory(kCodeSize));
+    if (!code) {
+        return false;
+    }
+
+    size_t pos = 0;
+    for (int algo = 0; algo < Algorithm::MAX; ++algo) {
+        for (size_t ways = 1; ways <= kMaxWays; ++ways) {
+            for (int assembly = Assembly::INTEL; assembly < Assembly::MAX; ++assembly) {
+                const Params p = params(static_cast<Algorithm::Id>(algo), ways, static_cast<Assembly::Id>(assembly));
+                const size_t size = generate(p, code + pos, kCodeSize - pos);
+                if (size) {
+                    loops[algo][ways - 1][assembly] = reinterpret_cast<cn_mainloop_fun_ms_abi>(code + pos);
+                    pos = (pos + size + 63) & ~static_cast<size_t>(63);
+                }
+            }
+        }
+    }
+
+    VirtualMemory::protectExecutableMemory(code, kCodeSize);
+    VirtualMemory::flushInstructionCache(code, kCodeSize);
+
+    return true;
+}
+
+
+cn_mainloop_fun_ms_abi xmrig::CnMainLoop::get(Algorithm::Id algo, size_t ways, Assembly::Id assembly)
+{
+    return loops[algo][ways - 1][assembly];
+}
+
+
+bool xmrig::CnMainLoop::has(Algorithm::Id algo)
+{
+    for (size_t ways = 1; ways <= kMaxWays; ++ways) {
+        for (int assembly = Assembly::INTEL; assembly < Assembly::MAX; ++assembly) {
+            if (!loops[algo][ways - 1][assembly]) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
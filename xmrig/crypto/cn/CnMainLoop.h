@@ -0,0 +1,84 @@
+/* XMRig
+ * Copyright 2010      Jeff Garzik <jgarzik@pobox.com>
+ * Copyright 2012-2014 pooler      <pooler@litecoinpool.org>
+ * Copyright 2014      Lucas Jones <https://github.com/lucasjones>
+ * Copyright 2014-2016 Wolf9466    <https://github.com/OhGodAPet>
+ * Copyright 2016      Jay D Dee   <jayddee246@gmail.com>
+ * Copyright 2017-2019 XMR-Stak    <https://github.com/fireice-uk>, <https://github.com/psychocrypt>
+ * Copyright 2018      Lee Clagett <https://github.com/vtnerd>
+ * Copyright 2018-2019 SChernykh   <https://github.com/SChernykh>
+ * Copyright 2016-2019 XMRig       <https://github.com/xmrig>, <support@xmrig.com>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef XMRIG_CN_MAIN_LOOP_H
+#define XMRIG_CN_MAIN_LOOP_H
+
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+#include "crypto/cn/CryptoNight.h"
+#include "crypto/common/Algorithm.h"
+#include "crypto/common/Assembly.h"
+
+
+namespace xmrig
+{
+
+
+// Generates the memory-hard main loop of CryptoNight variants as x86-64 code, with
+// hardware AES, for one or two hashes at a time. Loops are generated from what the
+// variant changes rather than hand written per variant, so every algorithm below
+// gets one without new assembly.
+class CnMainLoop
+{
+public:
+    struct Params
+    {
+        Algorithm::Id base      = Algorithm::INVALID; // CN_0, CN_1 or CN_2 tweaks
+        uint32_t iterations     = 0;
+        uint32_t mask           = 0;
+        bool heavy              = false;              // cn-heavy division after each iteration
+        bool xhv                = false;              // which inverts the divisor for the next index
+        bool rto                = false;              // variant 1 tweak also xors in the low half
+        bool reverse            = false;              // variant 2 shuffle reversed
+        size_t ways             = 1;                  // 1 or 2
+        Assembly::Id assembly   = Assembly::INTEL;    // target microarchitecture
+    };
+
+    // Parameters of algo's loop, base is INVALID if it can't be generated
+    static Params params(Algorithm::Id algo, size_t ways, Assembly::Id assembly);
+
+    // Writes the loop to code, returns its size or 0 if it doesn't fit in size bytes
+    static size_t generate(const Params &params, uint8_t *code, size_t size);
+
+    // Generates the loops of all algorithms, false if there's no memory for them
+    static bool init();
+
+    // Loop generated by init(), nullptr if none
+    static cn_mainloop_fun_ms_abi get(Algorithm::Id algo, size_t ways, Assembly::Id assembly);
+
+    // True if init() generated algo's loops for every number of ways and assembly,
+    // so its asm kernels can be registered
+    static bool has(Algorithm::Id algo);
+};
+
+
+} /* namespace xmrig */
+
+
+#endif /* XMRIG_CN_MAIN_LOOP_H */
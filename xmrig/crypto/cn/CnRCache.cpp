@@ -0,0 +1,164 @@
+/* XMRig
+ * Copyright 2010      Jeff Garzik <jgarzik@pobox.com>
+ * Copyright 2012-2014 pooler      <pooler@litecoinpool.org>
+ * Copyright 2014      Lucas Jones <https://github.com/lucasjones>
+ * Copyright 2014-2016 Wolf9466    <https://github.com/OhGodAPet>
+ * Copyright 2016      Jay D Dee   <jayddee246@gmail.com>
+ * Copyright 2017-2019 XMR-Stak    <https://github.com/fireice-uk>, <https://github.com/psychocrypt>
+ * Copyright 2018      Lee Clagett <https://github.com/vtnerd>
+ * Copyright 2018-2019 SChernykh   <https://github.com/SChernykh>
+ * Copyright 2016-2019 XMRig       <https://github.com/xmrig>, <support@xmrig.com>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <mutex>
+
+
+#include "crypto/cn/CnRCache.h"
+#include "crypto/cn/CryptoNight.h"
+#include "crypto/cn/CryptoNight_monero.h"
+#include "crypto/common/VirtualMemory.h"
+
+
+namespace xmrig {
+
+
+constexpr static size_t kSlots    = 16;
+constexpr static size_t kSlotSize = 0x4000;
+
+
+struct CnRProgram
+{
+    int algo                  = Algorithm::INVALID;
+    uint64_t height           = 0;
+    CnRCache::Compile compile = nullptr;
+    int assembly              = Assembly::NONE;
+    size_t users              = 0; // contexts running it, it stays while there are any
+    uint64_t used             = 0; // when last selected, the oldest unused program is evicted first
+
+    inline bool match(int a, uint64_t h, CnRCache::Compile c, int asm_) const { return algo == a && height == h && compile == c && assembly == asm_; }
+};
+
+
+static std::mutex mutex;
+static CnRProgram programs[kSlots];
+static uint8_t *code        = nullptr; // executable view of the slots
+static void *codeWritable   = nullptr;
+static bool allocated       = false;
+static uint64_t selections  = 0;
+
+
+static int find(int algo, uint64_t height, CnRCache::Compile compile, int assembly)
+{
+    for (size_t i = 0; i < kSlots; ++i) {
+        if (programs[i].match(algo, height, compile, assembly)) {
+            return static_cast<int>(i);
+        }
+    }
+
+    return -1;
+}
+
+
+// Compiles a program into the slot of the oldest one no context runs, -1 if all are in use
+static int add(Algorithm::Id algo, uint64_t height, CnRCache::Init init, CnRCache::Compile compile, Assembly::Id assembly)
+{
+    if (!allocated) {
+        allocated = true;
+        code      = static_cast<uint8_t *>(VirtualMemory::allocateDualMappedMemory(kSlots * kSlotSize, &codeWritable));
+    }
+
+    if (code == nullptr) {
+        return -1;
+    }
+
+    int slot = -1;
+    for (size_t i = 0; i < kSlots; ++i) {
+        if (programs[i].users == 0 && (slot < 0 || programs[i].used < programs[slot].used)) {
+            slot = static_cast<int>(i);
+        }
+    }
+
+    if (slot < 0) {
+        return -1;
+    }
+
+    V4_Instruction instructions[256];
+    const int size = init(instructions, height);
+    compile(instructions, size, static_cast<uint8_t *>(codeWritable) + slot * kSlotSize, assembly);
+
+    CnRProgram &p = programs[slot];
+    p.algo        = algo;
+    p.height      = height;
+    p.compile     = compile;
+    p.assembly    = assembly;
+    p.used        = selections;
+
+    return slot;
+}
+
+
+static void releaseLocked(cryptonight_ctx *ctx)
+{
+    if (ctx->generated_code_slot >= 0) {
+        --programs[ctx->generated_code_slot].users;
+        ctx->generated_code_slot = -1;
+    }
+}
+
+
+} // namespace xmrig
+
+
+void xmrig::CnRCache::select(cryptonight_ctx *ctx, Algorithm::Id algo, uint64_t height, Init init, Compile compile, Assembly::Id assembly)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    releaseLocked(ctx);
+    ++selections;
+
+    int slot = find(algo, height, compile, assembly);
+    if (slot < 0) {
+        slot = add(algo, height, init, compile, assembly);
+    }
+
+    if (slot >= 0) {
+        programs[slot].users++;
+        programs[slot].used      = selections;
+        ctx->generated_code      = reinterpret_cast<cn_mainloop_fun_ms_abi>(code + slot * kSlotSize);
+        ctx->generated_code_slot = slot;
+    }
+    else {
+        V4_Instruction instructions[256];
+        const int size = init(instructions, height);
+        compile(instructions, size, ctx->generated_code_writable, assembly);
+
+        ctx->generated_code = reinterpret_cast<cn_mainloop_fun_ms_abi>(ctx->generated_code_buffer);
+    }
+
+    ctx->generated_code_data = { algo, height };
+
+    if (find(algo, height + 1, compile, assembly) < 0) {
+        add(algo, height + 1, init, compile, assembly);
+    }
+}
+
+
+void xmrig::CnRCache::release(cryptonight_ctx *ctx)
+{
+    std::lock_guard<std::mutex> lock(mutex);
+
+    releaseLocked(ctx);
+}
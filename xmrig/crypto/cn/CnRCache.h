@@ -0,0 +1,67 @@
+/* XMRig
+ * Copyright 2010      Jeff Garzik <jgarzik@pobox.com>
+ * Copyright 2012-2014 pooler      <pooler@litecoinpool.org>
+ * Copyright 2014      Lucas Jones <https://github.com/lucasjones>
+ * Copyright 2014-2016 Wolf9466    <https://github.com/OhGodAPet>
+ * Copyright 2016      Jay D Dee   <jayddee246@gmail.com>
+ * Copyright 2017-2019 XMR-Stak    <https://github.com/fireice-uk>, <https://github.com/psychocrypt>
+ * Copyright 2018      Lee Clagett <https://github.com/vtnerd>
+ * Copyright 2018-2019 SChernykh   <https://github.com/SChernykh>
+ * Copyright 2016-2019 XMRig       <https://github.com/xmrig>, <support@xmrig.com>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef XMRIG_CN_R_CACHE_H
+#define XMRIG_CN_R_CACHE_H
+
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+#include "crypto/common/Algorithm.h"
+#include "crypto/common/Assembly.h"
+
+
+struct cryptonight_ctx;
+struct V4_Instruction;
+
+
+namespace xmrig
+{
+
+
+// CryptonightR programs compiled once for all contexts, keyed by algorithm, height,
+// compiler and assembly. Programs no context runs are evicted oldest first; while
+// every slot is in use contexts compile into their own buffer instead.
+class CnRCache
+{
+public:
+    using Init    = int (*)(V4_Instruction *code, uint64_t height);
+    using Compile = void (*)(const V4_Instruction *code, int code_size, void *machine_code, Assembly ASM);
+
+    // Points ctx->generated_code at the program for height, compiling it and the one
+    // for height + 1 if they aren't cached yet, so the next block starts compiled.
+    static void select(cryptonight_ctx *ctx, Algorithm::Id algo, uint64_t height, Init init, Compile compile, Assembly::Id assembly);
+
+    // Lets go of the program ctx runs, before releasing ctx
+    static void release(cryptonight_ctx *ctx);
+};
+
+
+} /* namespace xmrig */
+
+
+#endif /* XMRIG_CN_R_CACHE_H */
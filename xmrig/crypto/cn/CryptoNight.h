@@ -58,6 +58,10 @@ struct cryptonight_ctx {
 
     cn_mainloop_fun_ms_abi generated_code;
     cryptonight_r_data generated_code_data;
+    void *generated_code_writable; // the context's own buffer, written through this view
+    void *generated_code_buffer;   // and executed through this one, unless generated_code is in CnRCache
+    int generated_code_slot;       // CnRCache slot generated_code is in, -1 if none
+    uint64_t tweak1_2;             // variant 1 tweak of the input, for CnMainLoop code
 };
 
 
@@ -37,6 +37,8 @@
 
 #include "backend/cpu/Cpu.h"
 #include "crypto/cn/CnAlgo.h"
+#include "crypto/cn/CnMainLoop.h"
+#include "crypto/cn/CnRCache.h"
 #include "crypto/cn/CryptoNight_monero.h"
 #include "crypto/cn/CryptoNight.h"
 #include "crypto/cn/soft_aes.h"
@@ -58,17 +60,31 @@ extern "C"
 #endif
 
 static inline void do_blake_hash(const uint8_t *input, size_t len, uint8_t *output) {
+#   if defined(__SSSE3__)
+    blake256_hash_ssse3(output, input, len);
+#   else
     blake256_hash(output, input, len);
+#   endif
 }
 
 
 static inline void do_groestl_hash(const uint8_t *input, size_t len, uint8_t *output) {
+#   if defined(__AES__) && defined(__SSSE3__)
+    if (!xmrig::Cpu::isSoftAES()) {
+        groestl_aesni(input, len, output);
+        return;
+    }
+#   endif
     groestl(input, len * 8, output);
 }
 
 
 static inline void do_jh_hash(const uint8_t *input, size_t len, uint8_t *output) {
+#   if defined(__SSE2__)
+    jh256_sse2(input, len, output);
+#   else
     jh_hash(32 * 8, input, 8 * len, output);
+#   endif
 }
 
 
@@ -308,9 +324,42 @@ inline void mix_and_propagate(__m128i& x0, __m128i& x1, __m128i& x2, __m128i& x3
 }
 
 
+// Explode and implode over the eight lanes of state, vaes/cn_vaes_avx2.cpp and
+// vaes/cn_vaes_avx512.cpp, see Cpu::vaes()
+void cn_explode_scratchpad_vaes256(const __m128i *keys, const __m128i *state, __m128i *output, size_t memory, bool heavy);
+void cn_implode_scratchpad_vaes256(const __m128i *keys, const __m128i *input, __m128i *state, size_t memory, bool heavy);
+void cn_explode_scratchpad_vaes512(const __m128i *keys, const __m128i *state, __m128i *output, size_t memory, bool heavy);
+void cn_implode_scratchpad_vaes512(const __m128i *keys, const __m128i *input, __m128i *state, size_t memory, bool heavy);
+
+
 namespace xmrig {
 
 
+// Initial keccak and final permutation of the N hash states, N ways at once
+template<size_t N>
+static inline void cn_keccak(const uint8_t *input, size_t size, cryptonight_ctx **ctx)
+{
+    uint8_t *states[N];
+    for (size_t i = 0; i < N; i++) {
+        states[i] = ctx[i]->state;
+    }
+
+    keccak(input, size, states, N);
+}
+
+
+template<size_t N>
+static inline void cn_keccakf(cryptonight_ctx **ctx)
+{
+    uint64_t *states[N];
+    for (size_t i = 0; i < N; i++) {
+        states[i] = reinterpret_cast<uint64_t*>(ctx[i]->state);
+    }
+
+    keccakf(states, N);
+}
+
+
 template<Algorithm::Id ALGO, bool SOFT_AES>
 static inline void cn_explode_scratchpad(const __m128i *input, __m128i *output)
 {
@@ -321,6 +370,18 @@ static inline void cn_explode_scratchpad(const __m128i *input, __m128i *output)
 
     aes_genkey<SOFT_AES>(input, &k0, &k1, &k2, &k3, &k4, &k5, &k6, &k7, &k8, &k9);
 
+    if (!SOFT_AES && Cpu::vaes()) {
+        const __m128i keys[10] = { k0, k1, k2, k3, k4, k5, k6, k7, k8, k9 };
+        if (Cpu::vaes() == 512) {
+            cn_explode_scratchpad_vaes512(keys, input + 4, output, props.memory(), props.isHeavy());
+        }
+        else {
+            cn_explode_scratchpad_vaes256(keys, input + 4, output, props.memory(), props.isHeavy());
+        }
+
+        return;
+    }
+
     xin0 = _mm_load_si128(input + 4);
     xin1 = _mm_load_si128(input + 5);
     xin2 = _mm_load_si128(input + 6);
@@ -387,6 +448,18 @@ static inline void cn_implode_scratchpad(const __m128i *input, __m128i *output)
 
     aes_genkey<SOFT_AES>(output + 2, &k0, &k1, &k2, &k3, &k4, &k5, &k6, &k7, &k8, &k9);
 
+    if (!SOFT_AES && Cpu::vaes()) {
+        const __m128i keys[10] = { k0, k1, k2, k3, k4, k5, k6, k7, k8, k9 };
+        if (Cpu::vaes() == 512) {
+            cn_implode_scratchpad_vaes512(keys, input, output + 4, props.memory(), IS_HEAVY);
+        }
+        else {
+            cn_implode_scratchpad_vaes256(keys, input, output + 4, props.memory(), IS_HEAVY);
+        }
+
+        return;
+    }
+
     xout0 = _mm_load_si128(output + 4);
     xout1 = _mm_load_si128(output + 5);
     xout2 = _mm_load_si128(output + 6);
@@ -577,14 +650,7 @@ inline void cryptonight_single_hash(const uint8_t *__restrict__ input, size_t si
 #   ifdef XMRIG_FEATURE_ASM
     if (SOFT_AES && props.isR()) {
         if (!ctx[0]->generated_code_data.match(ALGO, height)) {
-            V4_Instruction code[256];
-            const int code_size = v4_random_math_init<ALGO>(code, height);
-
-            if (ALGO == Algorithm::CN_R) {
-                v4_soft_aes_compile_code(code, code_size, reinterpret_cast<void*>(ctx[0]->generated_code), Assembly::NONE);
-            }
-
-            ctx[0]->generated_code_data = { ALGO, height };
+            CnRCache::select(ctx[0], ALGO, height, v4_random_math_init<ALGO>, v4_soft_aes_compile_code, Assembly::NONE);
         }
 
         ctx[0]->saes_table = reinterpret_cast<const uint32_t*>(saes_table);
@@ -723,23 +789,36 @@ template<size_t MEM>
 void cn_explode_scratchpad_gpu(const uint8_t *input, uint8_t *output)
 {
     constexpr size_t hash_size = 200; // 25x8 bytes
-    alignas(16) uint64_t hash[25];
+    constexpr size_t ways      = 8;   // independent 512-byte chunks permuted together
+    alignas(64) uint64_t hash[ways][25];
+    uint64_t *states[ways];
+
+    for (size_t k = 0; k < ways; k++) {
+        states[k] = hash[k];
+    }
 
-    for (uint64_t i = 0; i < MEM / 512; i++) {
-        memcpy(hash, input, hash_size);
-        hash[0] ^= i;
+    for (uint64_t i = 0; i < MEM / 512; i += ways) {
+        for (size_t k = 0; k < ways; k++) {
+            memcpy(hash[k], input, hash_size);
+            hash[k][0] ^= i + k;
+        }
 
-        xmrig::keccakf(hash, 24);
-        memcpy(output, hash, 160);
-        output += 160;
+        xmrig::keccakf(states, ways);
+        for (size_t k = 0; k < ways; k++) {
+            memcpy(output + k * 512, hash[k], 160);
+        }
+
+        xmrig::keccakf(states, ways);
+        for (size_t k = 0; k < ways; k++) {
+            memcpy(output + k * 512 + 160, hash[k], 176);
+        }
 
-        xmrig::keccakf(hash, 24);
-        memcpy(output, hash, 176);
-        output += 176;
+        xmrig::keccakf(states, ways);
+        for (size_t k = 0; k < ways; k++) {
+            memcpy(output + k * 512 + 336, hash[k], 176);
+        }
 
-        xmrig::keccakf(hash, 24);
-        memcpy(output, hash, 176);
-        output += 176;
+        output += ways * 512;
     }
 }
 
@@ -779,8 +858,6 @@ extern "C" void cnv2_mainloop_ivybridge_asm(cryptonight_ctx **ctx);
 extern "C" void cnv2_mainloop_ryzen_asm(cryptonight_ctx **ctx);
 extern "C" void cnv2_mainloop_bulldozer_asm(cryptonight_ctx **ctx);
 extern "C" void cnv2_double_mainloop_sandybridge_asm(cryptonight_ctx **ctx);
-extern "C" void cnv2_rwz_mainloop_asm(cryptonight_ctx **ctx);
-extern "C" void cnv2_rwz_double_mainloop_asm(cryptonight_ctx **ctx);
 
 
 namespace xmrig {
@@ -789,27 +866,6 @@ namespace xmrig {
 typedef void (*cn_mainloop_fun)(cryptonight_ctx **ctx);
 
 
-extern cn_mainloop_fun cn_half_mainloop_ivybridge_asm;
-extern cn_mainloop_fun cn_half_mainloop_ryzen_asm;
-extern cn_mainloop_fun cn_half_mainloop_bulldozer_asm;
-extern cn_mainloop_fun cn_half_double_mainloop_sandybridge_asm;
-
-extern cn_mainloop_fun cn_trtl_mainloop_ivybridge_asm;
-extern cn_mainloop_fun cn_trtl_mainloop_ryzen_asm;
-extern cn_mainloop_fun cn_trtl_mainloop_bulldozer_asm;
-extern cn_mainloop_fun cn_trtl_double_mainloop_sandybridge_asm;
-
-extern cn_mainloop_fun cn_zls_mainloop_ivybridge_asm;
-extern cn_mainloop_fun cn_zls_mainloop_ryzen_asm;
-extern cn_mainloop_fun cn_zls_mainloop_bulldozer_asm;
-extern cn_mainloop_fun cn_zls_double_mainloop_sandybridge_asm;
-
-extern cn_mainloop_fun cn_double_mainloop_ivybridge_asm;
-extern cn_mainloop_fun cn_double_mainloop_ryzen_asm;
-extern cn_mainloop_fun cn_double_mainloop_bulldozer_asm;
-extern cn_mainloop_fun cn_double_double_mainloop_sandybridge_asm;
-
-
 } // namespace xmrig
 
 
@@ -839,12 +895,13 @@ inline void cryptonight_single_hash_asm(const uint8_t *__restrict__ input, size_
 {
     constexpr CnAlgo<ALGO> props;
 
-    if (props.isR() && !ctx[0]->generated_code_data.match(ALGO, height)) {
-        V4_Instruction code[256];
-        const int code_size = v4_random_math_init<ALGO>(code, height);
-        cn_r_compile_code<ALGO>(code, code_size, reinterpret_cast<void*>(ctx[0]->generated_code), ASM);
+    if (props.base() == Algorithm::CN_1 && size < 43) {
+        memset(output, 0, 32);
+        return;
+    }
 
-        ctx[0]->generated_code_data = { ALGO, height };
+    if (props.isR() && !ctx[0]->generated_code_data.match(ALGO, height)) {
+        CnRCache::select(ctx[0], ALGO, height, v4_random_math_init<ALGO>, cn_r_compile_code<ALGO>, ASM);
     }
 
     keccak(input, size, ctx[0]->state);
@@ -861,58 +918,16 @@ inline void cryptonight_single_hash_asm(const uint8_t *__restrict__ input, size_
             cnv2_mainloop_bulldozer_asm(ctx);
         }
     }
-    else if (ALGO == Algorithm::CN_HALF) {
-        if (ASM == Assembly::INTEL) {
-            cn_half_mainloop_ivybridge_asm(ctx);
-        }
-        else if (ASM == Assembly::RYZEN) {
-            cn_half_mainloop_ryzen_asm(ctx);
-        }
-        else {
-            cn_half_mainloop_bulldozer_asm(ctx);
-        }
-    }
-#   ifdef XMRIG_ALGO_CN_PICO
-    else if (ALGO == Algorithm::CN_PICO_0) {
-        if (ASM == Assembly::INTEL) {
-            cn_trtl_mainloop_ivybridge_asm(ctx);
-        }
-        else if (ASM == Assembly::RYZEN) {
-            cn_trtl_mainloop_ryzen_asm(ctx);
-        }
-        else {
-            cn_trtl_mainloop_bulldozer_asm(ctx);
-        }
-    }
-#   endif
-    else if (ALGO == Algorithm::CN_RWZ) {
-        cnv2_rwz_mainloop_asm(ctx);
-    }
-    else if (ALGO == Algorithm::CN_ZLS) {
-        if (ASM == Assembly::INTEL) {
-            cn_zls_mainloop_ivybridge_asm(ctx);
-        }
-        else if (ASM == Assembly::RYZEN) {
-            cn_zls_mainloop_ryzen_asm(ctx);
-        }
-        else {
-            cn_zls_mainloop_bulldozer_asm(ctx);
-        }
-    }
-    else if (ALGO == Algorithm::CN_DOUBLE) {
-        if (ASM == Assembly::INTEL) {
-            cn_double_mainloop_ivybridge_asm(ctx);
-        }
-        else if (ASM == Assembly::RYZEN) {
-            cn_double_mainloop_ryzen_asm(ctx);
-        }
-        else {
-            cn_double_mainloop_bulldozer_asm(ctx);
-        }
-    }
     else if (props.isR()) {
         ctx[0]->generated_code(ctx);
     }
+    else {
+        if (props.base() == Algorithm::CN_1) {
+            ctx[0]->tweak1_2 = *reinterpret_cast<const uint64_t*>(input + 35) ^ *(reinterpret_cast<const uint64_t*>(ctx[0]->state) + 24);
+        }
+
+        CnMainLoop::get(ALGO, 1, ASM)(ctx);
+    }
 
     cn_implode_scratchpad<ALGO, false>(reinterpret_cast<const __m128i*>(ctx[0]->memory), reinterpret_cast<__m128i*>(ctx[0]->state));
     keccakf(reinterpret_cast<uint64_t*>(ctx[0]->state), 24);
@@ -925,16 +940,16 @@ inline void cryptonight_double_hash_asm(const uint8_t *__restrict__ input, size_
 {
     constexpr CnAlgo<ALGO> props;
 
-    if (props.isR() && !ctx[0]->generated_code_data.match(ALGO, height)) {
-        V4_Instruction code[256];
-        const int code_size = v4_random_math_init<ALGO>(code, height);
-        cn_r_compile_code_double<ALGO>(code, code_size, reinterpret_cast<void*>(ctx[0]->generated_code), ASM);
+    if (props.base() == Algorithm::CN_1 && size < 43) {
+        memset(output, 0, 64);
+        return;
+    }
 
-        ctx[0]->generated_code_data = { ALGO, height };
+    if (props.isR() && !ctx[0]->generated_code_data.match(ALGO, height)) {
+        CnRCache::select(ctx[0], ALGO, height, v4_random_math_init<ALGO>, cn_r_compile_code_double<ALGO>, ASM);
     }
 
-    keccak(input,        size, ctx[0]->state);
-    keccak(input + size, size, ctx[1]->state);
+    cn_keccak<2>(input, size, ctx);
 
     cn_explode_scratchpad<ALGO, false>(reinterpret_cast<const __m128i*>(ctx[0]->state), reinterpret_cast<__m128i*>(ctx[0]->memory));
     cn_explode_scratchpad<ALGO, false>(reinterpret_cast<const __m128i*>(ctx[1]->state), reinterpret_cast<__m128i*>(ctx[1]->memory));
@@ -942,32 +957,22 @@ inline void cryptonight_double_hash_asm(const uint8_t *__restrict__ input, size_
     if (ALGO == Algorithm::CN_2) {
         cnv2_double_mainloop_sandybridge_asm(ctx);
     }
-    else if (ALGO == Algorithm::CN_HALF) {
-        cn_half_double_mainloop_sandybridge_asm(ctx);
-    }
-#   ifdef XMRIG_ALGO_CN_PICO
-    else if (ALGO == Algorithm::CN_PICO_0) {
-        cn_trtl_double_mainloop_sandybridge_asm(ctx);
-    }
-#   endif
-    else if (ALGO == Algorithm::CN_RWZ) {
-        cnv2_rwz_double_mainloop_asm(ctx);
-    }
-    else if (ALGO == Algorithm::CN_ZLS) {
-        cn_zls_double_mainloop_sandybridge_asm(ctx);
-    }
-    else if (ALGO == Algorithm::CN_DOUBLE) {
-        cn_double_double_mainloop_sandybridge_asm(ctx);
-    }
     else if (props.isR()) {
         ctx[0]->generated_code(ctx);
     }
+    else {
+        if (props.base() == Algorithm::CN_1) {
+            ctx[0]->tweak1_2 = *reinterpret_cast<const uint64_t*>(input + 35)        ^ *(reinterpret_cast<const uint64_t*>(ctx[0]->state) + 24);
+            ctx[1]->tweak1_2 = *reinterpret_cast<const uint64_t*>(input + size + 35) ^ *(reinterpret_cast<const uint64_t*>(ctx[1]->state) + 24);
+        }
+
+        CnMainLoop::get(ALGO, 2, ASM)(ctx);
+    }
 
     cn_implode_scratchpad<ALGO, false>(reinterpret_cast<const __m128i*>(ctx[0]->memory), reinterpret_cast<__m128i*>(ctx[0]->state));
     cn_implode_scratchpad<ALGO, false>(reinterpret_cast<const __m128i*>(ctx[1]->memory), reinterpret_cast<__m128i*>(ctx[1]->state));
 
-    keccakf(reinterpret_cast<uint64_t*>(ctx[0]->state), 24);
-    keccakf(reinterpret_cast<uint64_t*>(ctx[1]->state), 24);
+    cn_keccakf<2>(ctx);
 
     extra_hashes[ctx[0]->state[0] & 3](ctx[0]->state, 200, output);
     extra_hashes[ctx[1]->state[0] & 3](ctx[1]->state, 200, output + 32);
@@ -999,8 +1004,7 @@ inline void cryptonight_double_hash(const uint8_t *__restrict__ input, size_t si
         return;
     }
 
-    keccak(input,        size, ctx[0]->state);
-    keccak(input + size, size, ctx[1]->state);
+    cn_keccak<2>(input, size, ctx);
 
     uint8_t *l0  = ctx[0]->memory;
     uint8_t *l1  = ctx[1]->memory;
@@ -1193,8 +1197,7 @@ inline void cryptonight_double_hash(const uint8_t *__restrict__ input, size_t si
     cn_implode_scratchpad<ALGO, SOFT_AES>(reinterpret_cast<const __m128i *>(l0), reinterpret_cast<__m128i *>(h0));
     cn_implode_scratchpad<ALGO, SOFT_AES>(reinterpret_cast<const __m128i *>(l1), reinterpret_cast<__m128i *>(h1));
 
-    keccakf(h0, 24);
-    keccakf(h1, 24);
+    cn_keccakf<2>(ctx);
 
     extra_hashes[ctx[0]->state[0] & 3](ctx[0]->state, 200, output);
     extra_hashes[ctx[1]->state[0] & 3](ctx[1]->state, 200, output + 32);
@@ -1326,8 +1329,9 @@ inline void cryptonight_triple_hash(const uint8_t *__restrict__ input, size_t si
         return;
     }
 
+    cn_keccak<3>(input, size, ctx);
+
     for (size_t i = 0; i < 3; i++) {
-        keccak(input + size * i, size, ctx[i]->state);
         cn_explode_scratchpad<ALGO, SOFT_AES>(reinterpret_cast<const __m128i*>(ctx[i]->state), reinterpret_cast<__m128i*>(ctx[i]->memory));
     }
 
@@ -1371,7 +1375,11 @@ inline void cryptonight_triple_hash(const uint8_t *__restrict__ input, size_t si
 
     for (size_t i = 0; i < 3; i++) {
         cn_implode_scratchpad<ALGO, SOFT_AES>(reinterpret_cast<const __m128i*>(ctx[i]->memory), reinterpret_cast<__m128i*>(ctx[i]->state));
-        keccakf(reinterpret_cast<uint64_t*>(ctx[i]->state), 24);
+    }
+
+    cn_keccakf<3>(ctx);
+
+    for (size_t i = 0; i < 3; i++) {
         extra_hashes[ctx[i]->state[0] & 3](ctx[i]->state, 200, output + 32 * i);
     }
 }
@@ -1397,8 +1405,9 @@ inline void cryptonight_quad_hash(const uint8_t *__restrict__ input, size_t size
         return;
     }
 
+    cn_keccak<4>(input, size, ctx);
+
     for (size_t i = 0; i < 4; i++) {
-        keccak(input + size * i, size, ctx[i]->state);
         cn_explode_scratchpad<ALGO, SOFT_AES>(reinterpret_cast<const __m128i*>(ctx[i]->state), reinterpret_cast<__m128i*>(ctx[i]->memory));
     }
 
@@ -1450,7 +1459,11 @@ inline void cryptonight_quad_hash(const uint8_t *__restrict__ input, size_t size
 
     for (size_t i = 0; i < 4; i++) {
         cn_implode_scratchpad<ALGO, SOFT_AES>(reinterpret_cast<const __m128i*>(ctx[i]->memory), reinterpret_cast<__m128i*>(ctx[i]->state));
-        keccakf(reinterpret_cast<uint64_t*>(ctx[i]->state), 24);
+    }
+
+    cn_keccakf<4>(ctx);
+
+    for (size_t i = 0; i < 4; i++) {
         extra_hashes[ctx[i]->state[0] & 3](ctx[i]->state, 200, output + 32 * i);
     }
 }
@@ -1476,8 +1489,9 @@ inline void cryptonight_penta_hash(const uint8_t *__restrict__ input, size_t siz
         return;
     }
 
+    cn_keccak<5>(input, size, ctx);
+
     for (size_t i = 0; i < 5; i++) {
-        keccak(input + size * i, size, ctx[i]->state);
         cn_explode_scratchpad<ALGO, SOFT_AES>(reinterpret_cast<const __m128i*>(ctx[i]->state), reinterpret_cast<__m128i*>(ctx[i]->memory));
     }
 
@@ -1537,7 +1551,11 @@ inline void cryptonight_penta_hash(const uint8_t *__restrict__ input, size_t siz
 
     for (size_t i = 0; i < 5; i++) {
         cn_implode_scratchpad<ALGO, SOFT_AES>(reinterpret_cast<const __m128i*>(ctx[i]->memory), reinterpret_cast<__m128i*>(ctx[i]->state));
-        keccakf(reinterpret_cast<uint64_t*>(ctx[i]->state), 24);
+    }
+
+    cn_keccakf<5>(ctx);
+
+    for (size_t i = 0; i < 5; i++) {
         extra_hashes[ctx[i]->state[0] & 3](ctx[i]->state, 200, output + 32 * i);
     }
 }
@@ -324,3 +324,109 @@ void hmac_blake224_hash(uint8_t *out, const uint8_t *key, uint64_t keylen, const
     hmac_blake224_update(&S, in, inlen * 8);
     hmac_blake224_final(&S, out);
 }
+
+#if defined(__SSSE3__)
+#include <tmmintrin.h>
+
+// SSSE3 version of BLAKE-256: the rows of v are kept in four registers, so
+// the four G functions of a column or diagonal step run side by side
+#define ROT16_SSSE3(x) _mm_shuffle_epi8((x), _mm_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13))
+#define ROT8_SSSE3(x)  _mm_shuffle_epi8((x), _mm_setr_epi8(1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12))
+#define ROTN_SSSE3(x, n) _mm_or_si128(_mm_srli_epi32((x), (n)), _mm_slli_epi32((x), 32 - (n)))
+#define BSWAP32_SSSE3(x) _mm_shuffle_epi8((x), _mm_setr_epi8(3, 2, 1, 0, 7, 6, 5, 4, 11, 10, 9, 8, 15, 14, 13, 12))
+
+// m[sigma[e + 2k + o]] ^ cst[sigma[e + 2k + 1 - o]] in lane k
+#define MSG_SSSE3(r, e, o) _mm_xor_si128(                                              \
+    _mm_set_epi32(m[sigma[r][e + 6 + o]], m[sigma[r][e + 4 + o]],                      \
+                  m[sigma[r][e + 2 + o]], m[sigma[r][e + o]]),                         \
+    _mm_set_epi32(cst[sigma[r][e + 7 - o]], cst[sigma[r][e + 5 - o]],                  \
+                  cst[sigma[r][e + 3 - o]], cst[sigma[r][e + 1 - o]]))
+
+#define G_SSSE3(r, e)                                                    \
+    row0 = _mm_add_epi32(_mm_add_epi32(row0, MSG_SSSE3(r, e, 0)), row1); \
+    row3 = ROT16_SSSE3(_mm_xor_si128(row3, row0));                       \
+    row2 = _mm_add_epi32(row2, row3);                                    \
+    row1 = ROTN_SSSE3(_mm_xor_si128(row1, row2), 12);                    \
+    row0 = _mm_add_epi32(_mm_add_epi32(row0, MSG_SSSE3(r, e, 1)), row1); \
+    row3 = ROT8_SSSE3(_mm_xor_si128(row3, row0));                        \
+    row2 = _mm_add_epi32(row2, row3);                                    \
+    row1 = ROTN_SSSE3(_mm_xor_si128(row1, row2), 7);
+
+#define ROUND_SSSE3(r)                                              \
+    G_SSSE3(r, 0);                                                  \
+    row1 = _mm_shuffle_epi32(row1, _MM_SHUFFLE(0, 3, 2, 1));        \
+    row2 = _mm_shuffle_epi32(row2, _MM_SHUFFLE(1, 0, 3, 2));        \
+    row3 = _mm_shuffle_epi32(row3, _MM_SHUFFLE(2, 1, 0, 3));        \
+    G_SSSE3(r, 8);                                                  \
+    row1 = _mm_shuffle_epi32(row1, _MM_SHUFFLE(2, 1, 0, 3));        \
+    row2 = _mm_shuffle_epi32(row2, _MM_SHUFFLE(1, 0, 3, 2));        \
+    row3 = _mm_shuffle_epi32(row3, _MM_SHUFFLE(0, 3, 2, 1));
+
+// t = number of message bits up to the end of the block, 0 for blocks of padding only
+static inline void blake256_compress_ssse3(__m128i h[2], const uint8_t *block, uint64_t t) {
+    uint32_t m[16];
+    __m128i row0 = h[0], row1 = h[1], row2, row3;
+    int i;
+
+    for (i = 0; i < 4; ++i) {
+        _mm_storeu_si128((__m128i *) m + i, BSWAP32_SSSE3(_mm_loadu_si128((const __m128i *) block + i)));
+    }
+
+    row2 = _mm_loadu_si128((const __m128i *) cst);
+    row3 = _mm_xor_si128(_mm_loadu_si128((const __m128i *) cst + 1),
+                         _mm_set_epi32((uint32_t) (t >> 32), (uint32_t) (t >> 32), (uint32_t) t, (uint32_t) t));
+
+    ROUND_SSSE3(0);
+    ROUND_SSSE3(1);
+    ROUND_SSSE3(2);
+    ROUND_SSSE3(3);
+    ROUND_SSSE3(4);
+    ROUND_SSSE3(5);
+    ROUND_SSSE3(6);
+    ROUND_SSSE3(7);
+    ROUND_SSSE3(8);
+    ROUND_SSSE3(9);
+    ROUND_SSSE3(10);
+    ROUND_SSSE3(11);
+    ROUND_SSSE3(12);
+    ROUND_SSSE3(13);
+
+    h[0] = _mm_xor_si128(h[0], _mm_xor_si128(row0, row2));
+    h[1] = _mm_xor_si128(h[1], _mm_xor_si128(row1, row3));
+}
+
+// inlen = number of bytes
+void blake256_hash_ssse3(uint8_t *out, const uint8_t *in, uint64_t inlen) {
+    const uint64_t bits = inlen * 8;
+    uint8_t buf[128];
+    uint64_t t = 0;
+    __m128i h[2];
+    int i;
+
+    h[0] = _mm_setr_epi32(0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A);
+    h[1] = _mm_setr_epi32(0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19);
+
+    for (; inlen >= 64; in += 64, inlen -= 64) {
+        t += 512;
+        blake256_compress_ssse3(h, in, t);
+    }
+
+    // 0x80, zeros, 0x01 and the 64-bit big-endian message length
+    memset(buf, 0, sizeof(buf));
+    memcpy(buf, in, inlen);
+    buf[inlen] = 0x80;
+    if (inlen < 56) {
+        buf[55] |= 0x01;
+        for (i = 0; i < 8; ++i) buf[63 - i] = (uint8_t) (bits >> (8 * i));
+        blake256_compress_ssse3(h, buf, inlen ? t + inlen * 8 : 0);
+    } else {
+        buf[64 + 55] = 0x01;
+        for (i = 0; i < 8; ++i) buf[127 - i] = (uint8_t) (bits >> (8 * i));
+        blake256_compress_ssse3(h, buf, t + inlen * 8);
+        blake256_compress_ssse3(h, buf + 64, 0);
+    }
+
+    _mm_storeu_si128((__m128i *) out, BSWAP32_SSSE3(h[0]));
+    _mm_storeu_si128((__m128i *) out + 1, BSWAP32_SSSE3(h[1]));
+}
+#endif
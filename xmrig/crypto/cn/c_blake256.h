@@ -26,6 +26,10 @@ void blake224_final(state *, uint8_t *);
 void blake256_hash(uint8_t *, const uint8_t *, uint64_t);
 void blake224_hash(uint8_t *, const uint8_t *, uint64_t);
 
+#if defined(__SSSE3__)
+void blake256_hash_ssse3(uint8_t *, const uint8_t *, uint64_t);
+#endif
+
 /* HMAC functions: */
 
 void hmac_blake256_init(hmac_state *, const uint8_t *, uint64_t);
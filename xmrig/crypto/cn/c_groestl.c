@@ -358,3 +358,162 @@ static int crypto_hash(unsigned char *out,
 }
 
 */
+
+#if defined(__AES__) && defined(__SSSE3__)
+#include <string.h>
+#include <tmmintrin.h>
+#include <wmmintrin.h>
+
+/* AES-NI version of Groestl-256. P and Q run side by side: register i holds
+ * row i of the P state in its low half and row i of the Q state in its high
+ * half. Groestl uses the AES S-box, so SubBytes is AESENCLAST with a zero key
+ * after a byte shuffle that undoes AES ShiftRows and does ShiftBytes. */
+
+/* ShiftBytes of P (low half) and Q (high half) row i, composed with the
+ * inverse of AES ShiftRows */
+static const uint8_t shuffle_aesni[ROWS][16] = {
+  { 0, 14, 11,  7,  4,  1, 15, 12,  9,  5,  2,  8, 13, 10,  6,  3},
+  { 1,  8, 13,  0,  5,  2,  9, 14, 11,  6,  3, 10, 15, 12,  7,  4},
+  { 2, 10, 15,  1,  6,  3, 11,  8, 13,  7,  4, 12,  9, 14,  0,  5},
+  { 3, 12,  9,  2,  7,  4, 13, 10, 15,  0,  5, 14, 11,  8,  1,  6},
+  { 4, 13, 10,  3,  0,  5, 14, 11,  8,  1,  6, 15, 12,  9,  2,  7},
+  { 5, 15, 12,  4,  1,  6,  8, 13, 10,  2,  7,  9, 14, 11,  3,  0},
+  { 6,  9, 14,  5,  2,  7, 10, 15, 12,  3,  0, 11,  8, 13,  4,  1},
+  { 7, 11,  8,  6,  3,  0, 12,  9, 14,  4,  1, 13, 10, 15,  5,  2}
+};
+
+/* round constants of P row 0 and Q row 7 without the round number */
+static const uint8_t constant_aesni[2][16] = {
+  {0x00, 0x10, 0x20, 0x30, 0x40, 0x50, 0x60, 0x70, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff},
+  {0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0xff, 0xef, 0xdf, 0xcf, 0xbf, 0xaf, 0x9f, 0x8f}
+};
+
+static inline __m128i mul2_aesni(__m128i a) {
+  const __m128i carry = _mm_cmplt_epi8(a, _mm_setzero_si128());
+  return _mm_xor_si128(_mm_add_epi8(a, a), _mm_and_si128(carry, _mm_set1_epi8(0x1b)));
+}
+
+/* 8x8 byte transpose of the columns (two per register) into rows */
+static inline void transpose_aesni(__m128i a[4]) {
+  const __m128i interleave = _mm_setr_epi8(0, 8, 1, 9, 2, 10, 3, 11, 4, 12, 5, 13, 6, 14, 7, 15);
+  __m128i b0, b1, b2, b3, c0, c1, c2, c3;
+
+  b0 = _mm_shuffle_epi8(a[0], interleave);
+  b1 = _mm_shuffle_epi8(a[1], interleave);
+  b2 = _mm_shuffle_epi8(a[2], interleave);
+  b3 = _mm_shuffle_epi8(a[3], interleave);
+
+  c0 = _mm_unpacklo_epi16(b0, b1);
+  c1 = _mm_unpackhi_epi16(b0, b1);
+  c2 = _mm_unpacklo_epi16(b2, b3);
+  c3 = _mm_unpackhi_epi16(b2, b3);
+
+  a[0] = _mm_unpacklo_epi32(c0, c2);
+  a[1] = _mm_unpackhi_epi32(c0, c2);
+  a[2] = _mm_unpacklo_epi32(c1, c3);
+  a[3] = _mm_unpackhi_epi32(c1, c3);
+}
+
+static inline void round_aesni(__m128i x[ROWS], int r) {
+  const __m128i zero = _mm_setzero_si128();
+  const __m128i rc = _mm_set1_epi8((char) r);
+  const __m128i q = _mm_unpacklo_epi64(zero, _mm_set1_epi32(-1));
+  __m128i t[ROWS], y[ROWS];
+  int i;
+
+  /* AddRoundConstant */
+  x[0] = _mm_xor_si128(x[0], _mm_xor_si128(_mm_loadu_si128((const __m128i*) constant_aesni[0]), _mm_unpacklo_epi64(rc, zero)));
+  for (i = 1; i < ROWS - 1; i++) {
+    x[i] = _mm_xor_si128(x[i], q);
+  }
+  x[7] = _mm_xor_si128(x[7], _mm_xor_si128(_mm_loadu_si128((const __m128i*) constant_aesni[1]), _mm_unpacklo_epi64(zero, rc)));
+
+  /* ShiftBytes and SubBytes */
+  for (i = 0; i < ROWS; i++) {
+    x[i] = _mm_aesenclast_si128(_mm_shuffle_epi8(x[i], _mm_loadu_si128((const __m128i*) shuffle_aesni[i])), zero);
+  }
+
+  /* MixBytes: b_i = 2*a_i ^ 2*a_i+1 ^ 3*a_i+2 ^ 4*a_i+3 ^ 5*a_i+4 ^ 3*a_i+5 ^ 5*a_i+6 ^ 7*a_i+7
+   * with shared sums t_i = a_i ^ a_i+1, x_i = t_i ^ t_i+3, y_i = t_i ^ t_i+2 ^ a_i+6,
+   * b_i = 2*(2*x_i+3 ^ y_i+7) ^ y_i+4 */
+  for (i = 0; i < ROWS; i++) {
+    t[i] = _mm_xor_si128(x[i], x[(i + 1) & 7]);
+  }
+  for (i = 0; i < ROWS; i++) {
+    y[i] = _mm_xor_si128(_mm_xor_si128(t[i], t[(i + 2) & 7]), x[(i + 6) & 7]);
+  }
+  for (i = 0; i < ROWS; i++) {
+    x[i] = _mm_xor_si128(mul2_aesni(_mm_xor_si128(mul2_aesni(_mm_xor_si128(t[(i + 3) & 7], t[(i + 6) & 7])), y[(i + 7) & 7])), y[(i + 4) & 7]);
+  }
+}
+
+/* h = P(h ^ m) ^ Q(m) ^ h, h is kept in the low halves */
+static inline void F512_aesni(__m128i h[ROWS], const BitSequence *block) {
+  __m128i m[4], x[ROWS];
+  int i;
+
+  for (i = 0; i < 4; i++) {
+    m[i] = _mm_loadu_si128((const __m128i*) block + i);
+  }
+  transpose_aesni(m);
+
+  for (i = 0; i < ROWS; i++) {
+    const __m128i row = (i & 1) ? _mm_srli_si128(m[i >> 1], 8) : m[i >> 1];
+    x[i] = _mm_unpacklo_epi64(_mm_xor_si128(h[i], row), row);
+  }
+
+  for (i = 0; i < ROUNDS512; i++) {
+    round_aesni(x, i);
+  }
+
+  for (i = 0; i < ROWS; i++) {
+    h[i] = _mm_xor_si128(h[i], _mm_xor_si128(x[i], _mm_srli_si128(x[i], 8)));
+  }
+}
+
+/* hash a whole number of bytes */
+void groestl_aesni(const BitSequence *data, size_t len, BitSequence *hashval) {
+  __m128i h[ROWS], x[ROWS], out[4];
+  uint8_t buffer[2 * SIZE512];
+  uint64_t blocks = 0;
+  int i, n;
+
+  for (i = 0; i < ROWS; i++) {
+    h[i] = _mm_setzero_si128();
+  }
+  /* HASH_BIT_LEN as the big-endian last bytes of the chaining value */
+  h[6] = _mm_set_epi32(0, 0, 0x01000000, 0);
+
+  for ( ; len >= SIZE512; data += SIZE512, len -= SIZE512, blocks++) {
+    F512_aesni(h, data);
+  }
+
+  /* 0x80, zeros and the 64-bit big-endian number of blocks */
+  n = len < SIZE512 - LENGTHFIELDLEN ? 1 : 2;
+  blocks += n;
+  memset(buffer, 0, sizeof(buffer));
+  memcpy(buffer, data, len);
+  buffer[len] = 0x80;
+  for (i = 0; i < LENGTHFIELDLEN; i++) {
+    buffer[n * SIZE512 - 1 - i] = (uint8_t) (blocks >> (8 * i));
+  }
+  for (i = 0; i < n; i++) {
+    F512_aesni(h, buffer + i * SIZE512);
+  }
+
+  /* output transformation, trunc(P(h) ^ h) */
+  for (i = 0; i < ROWS; i++) {
+    x[i] = h[i];
+  }
+  for (i = 0; i < ROUNDS512; i++) {
+    round_aesni(x, i);
+  }
+  for (i = 0; i < 4; i++) {
+    out[i] = _mm_unpacklo_epi64(_mm_xor_si128(x[2 * i], h[2 * i]), _mm_xor_si128(x[2 * i + 1], h[2 * i + 1]));
+  }
+  transpose_aesni(out);
+
+  _mm_storeu_si128((__m128i*) hashval, out[2]);
+  _mm_storeu_si128((__m128i*) hashval + 1, out[3]);
+}
+#endif
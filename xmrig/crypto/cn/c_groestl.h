@@ -51,6 +51,13 @@ void Final(hashState*, BitSequence*); */
 void groestl(const BitSequence*, DataLength, BitSequence*);
 /* NIST API end   */
 
+#if defined(__AES__) && defined(__SSSE3__)
+#include <stddef.h>
+
+/* AES-NI Groestl-256 of len bytes */
+void groestl_aesni(const BitSequence*, size_t, BitSequence*);
+#endif
+
 /*
 int crypto_hash(unsigned char *out,
 		const unsigned char *in,
@@ -214,15 +214,20 @@ static void E8(hashState *state)
 static void F8(hashState *state)
 {
       uint64  i;
+      uint64  m[8];
+
+      /*copy the message block out: reading buffer through a uint64 pointer breaks
+        strict aliasing and gives wrong hashes with GCC 12 at -O3*/
+      memcpy(m, state->buffer, sizeof(m));
 
       /*xor the 512-bit message with the fist half of the 1024-bit hash state*/
-      for (i = 0; i < 8; i++)  state->x[i >> 1][i & 1] ^= ((uint64*)state->buffer)[i];
+      for (i = 0; i < 8; i++)  state->x[i >> 1][i & 1] ^= m[i];
 
       /*the bijective function E8 */
       E8(state);
 
       /*xor the 512-bit message with the second half of the 1024-bit hash state*/
-      for (i = 0; i < 8; i++)  state->x[(8+i) >> 1][(8+i) & 1] ^= ((uint64*)state->buffer)[i];
+      for (i = 0; i < 8; i++)  state->x[(8+i) >> 1][(8+i) & 1] ^= m[i];
 }
 
 /*before hashing a message, initialize the hash state as H0 */
@@ -365,3 +370,114 @@ HashReturn jh_hash(int hashbitlen, const BitSequence *data,DataLength databitlen
       else
             return(BAD_HASHLEN);
 }
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+
+/*SSE2 version of JH-256: row i of the state ( x[i][0] || x[i][1] ) is kept in one register,
+  so both 64-bit halves go through the Sbox, MDS and swapping layers with the same instructions*/
+
+#define SWAP_SSE2(x,mask,n) \
+      (x) = _mm_or_si128(_mm_slli_epi64(_mm_and_si128((x), (mask)), (n)), _mm_and_si128(_mm_srli_epi64((x), (n)), (mask)));
+
+#define SWAP1_SSE2(x)  SWAP_SSE2(x, _mm_set1_epi8(0x55), 1)
+#define SWAP2_SSE2(x)  SWAP_SSE2(x, _mm_set1_epi8(0x33), 2)
+#define SWAP4_SSE2(x)  SWAP_SSE2(x, _mm_set1_epi8(0x0f), 4)
+#define SWAP8_SSE2(x)  (x) = _mm_or_si128(_mm_slli_epi16((x), 8), _mm_srli_epi16((x), 8));
+#define SWAP16_SSE2(x) (x) = _mm_shufflehi_epi16(_mm_shufflelo_epi16((x), 0xb1), 0xb1);
+#define SWAP32_SSE2(x) (x) = _mm_shuffle_epi32((x), 0xb1);
+#define SWAP64_SSE2(x) (x) = _mm_shuffle_epi32((x), 0x4e);
+
+#define SS_SSE2(m0,m1,m2,m3,m4,m5,m6,m7,cc0,cc1)  \
+      m3  = _mm_xor_si128(m3, ones);                           \
+      m7  = _mm_xor_si128(m7, ones);                           \
+      m0  = _mm_xor_si128(m0, _mm_andnot_si128(m2, cc0));      \
+      m4  = _mm_xor_si128(m4, _mm_andnot_si128(m6, cc1));      \
+      temp0 = _mm_xor_si128(cc0, _mm_and_si128(m0, m1));       \
+      temp1 = _mm_xor_si128(cc1, _mm_and_si128(m4, m5));       \
+      m0  = _mm_xor_si128(m0, _mm_and_si128(m2, m3));          \
+      m4  = _mm_xor_si128(m4, _mm_and_si128(m6, m7));          \
+      m3  = _mm_xor_si128(m3, _mm_andnot_si128(m1, m2));       \
+      m7  = _mm_xor_si128(m7, _mm_andnot_si128(m5, m6));       \
+      m1  = _mm_xor_si128(m1, _mm_and_si128(m0, m2));          \
+      m5  = _mm_xor_si128(m5, _mm_and_si128(m4, m6));          \
+      m2  = _mm_xor_si128(m2, _mm_andnot_si128(m3, m0));       \
+      m6  = _mm_xor_si128(m6, _mm_andnot_si128(m7, m4));       \
+      m0  = _mm_xor_si128(m0, _mm_or_si128(m1, m3));           \
+      m4  = _mm_xor_si128(m4, _mm_or_si128(m5, m7));           \
+      m3  = _mm_xor_si128(m3, _mm_and_si128(m1, m2));          \
+      m7  = _mm_xor_si128(m7, _mm_and_si128(m5, m6));          \
+      m1  = _mm_xor_si128(m1, _mm_and_si128(temp0, m0));       \
+      m5  = _mm_xor_si128(m5, _mm_and_si128(temp1, m4));       \
+      m2  = _mm_xor_si128(m2, temp0);                          \
+      m6  = _mm_xor_si128(m6, temp1);
+
+#define L_SSE2(m0,m1,m2,m3,m4,m5,m6,m7) \
+      m4 = _mm_xor_si128(m4, m1);                  \
+      m5 = _mm_xor_si128(m5, m2);                  \
+      m6 = _mm_xor_si128(m6, _mm_xor_si128(m0, m3)); \
+      m7 = _mm_xor_si128(m7, m0);                  \
+      m0 = _mm_xor_si128(m0, m5);                  \
+      m1 = _mm_xor_si128(m1, m6);                  \
+      m2 = _mm_xor_si128(m2, _mm_xor_si128(m4, m7)); \
+      m3 = _mm_xor_si128(m3, m4);
+
+#define ROUND_SSE2(r,SWAP) \
+      SS_SSE2(x[0],x[2],x[4],x[6],x[1],x[3],x[5],x[7], \
+              _mm_loadu_si128((const __m128i*)E8_bitslice_roundconstant[r]), \
+              _mm_loadu_si128((const __m128i*)E8_bitslice_roundconstant[r] + 1)); \
+      L_SSE2(x[0],x[2],x[4],x[6],x[1],x[3],x[5],x[7]); \
+      SWAP(x[1]) SWAP(x[3]) SWAP(x[5]) SWAP(x[7])
+
+#define SWAP0_SSE2(x)
+
+static inline void F8_sse2(__m128i x[8], const BitSequence *block)
+{
+      const __m128i ones = _mm_set1_epi32(-1);
+      __m128i m[4], temp0, temp1;
+      unsigned int i, r;
+
+      for (i = 0; i < 4; i++) {
+            m[i] = _mm_loadu_si128((const __m128i*)block + i);
+            x[i] = _mm_xor_si128(x[i], m[i]);
+      }
+
+      for (r = 0; r < 42; r = r+7) {
+            ROUND_SSE2(r+0, SWAP1_SSE2)
+            ROUND_SSE2(r+1, SWAP2_SSE2)
+            ROUND_SSE2(r+2, SWAP4_SSE2)
+            ROUND_SSE2(r+3, SWAP8_SSE2)
+            ROUND_SSE2(r+4, SWAP16_SSE2)
+            ROUND_SSE2(r+5, SWAP32_SSE2)
+            ROUND_SSE2(r+6, SWAP64_SSE2)
+      }
+
+      for (i = 0; i < 4; i++)  x[4+i] = _mm_xor_si128(x[4+i], m[i]);
+}
+
+/*JH-256 of a whole number of bytes*/
+void jh256_sse2(const BitSequence *data, size_t len, BitSequence *hashval)
+{
+      const uint64 databitlen = (uint64)len << 3;
+      unsigned char buffer[64];
+      __m128i x[8];
+      unsigned int i;
+
+      for (i = 0; i < 8; i++)  x[i] = _mm_loadu_si128((const __m128i*)JH256_H0 + i);
+
+      for ( ; len >= 64; data = data+64, len = len-64)  F8_sse2(x, data);
+
+      memset(buffer, 0, 64);
+      memcpy(buffer, data, len);
+      buffer[len] = 0x80;
+      if (len > 0) {
+            F8_sse2(x, buffer);
+            memset(buffer, 0, 64);
+      }
+      for (i = 0; i < 8; i++)  buffer[63-i] = (unsigned char)(databitlen >> (8*i));
+      F8_sse2(x, buffer);
+
+      _mm_storeu_si128((__m128i*)hashval, x[6]);
+      _mm_storeu_si128((__m128i*)hashval + 1, x[7]);
+}
+#endif
@@ -17,3 +17,9 @@
 #include "hash.h"
 
 HashReturn jh_hash(int hashbitlen, const BitSequence *data, DataLength databitlen, BitSequence *hashval);
+
+#if defined(__SSE2__)
+#include <stddef.h>
+
+void jh256_sse2(const BitSequence *data, size_t len, BitSequence *hashval);
+#endif
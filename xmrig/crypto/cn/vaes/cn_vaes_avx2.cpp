@@ -0,0 +1,151 @@
+/* XMRig
+ * Copyright 2010      Jeff Garzik <jgarzik@pobox.com>
+ * Copyright 2012-2014 pooler      <pooler@litecoinpool.org>
+ * Copyright 2014      Lucas Jones <https://github.com/lucasjones>
+ * Copyright 2014-2016 Wolf9466    <https://github.com/OhGodAPet>
+ * Copyright 2016      Jay D Dee   <jayddee246@gmail.com>
+ * Copyright 2017-2019 XMR-Stak    <https://github.com/fireice-uk>, <https://github.com/psychocrypt>
+ * Copyright 2018      Lee Clagett <https://github.com/vtnerd>
+ * Copyright 2018-2019 SChernykh   <https://github.com/SChernykh>
+ * Copyright 2016-2019 XMRig       <https://github.com/xmrig>, <support@xmrig.com>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+#ifdef __GNUC__
+#   include <x86intrin.h>
+#else
+#   include <intrin.h>
+#endif
+
+
+// Scratchpad explode and implode with VAES, two of the eight 128-bit lanes per
+// instruction: y0 holds lanes 0-1, y1 lanes 2-3 and so on
+namespace {
+
+
+static inline void aes_round(const __m256i &key, __m256i &y0, __m256i &y1, __m256i &y2, __m256i &y3)
+{
+    y0 = _mm256_aesenc_epi128(y0, key);
+    y1 = _mm256_aesenc_epi128(y1, key);
+    y2 = _mm256_aesenc_epi128(y2, key);
+    y3 = _mm256_aesenc_epi128(y3, key);
+}
+
+
+static inline void aes_rounds(const __m256i *k, __m256i &y0, __m256i &y1, __m256i &y2, __m256i &y3)
+{
+    for (int i = 0; i < 10; ++i) {
+        aes_round(k[i], y0, y1, y2, y3);
+    }
+}
+
+
+// Lane i ^= lane i + 1, lane 7 ^= lane 0
+static inline void mix_and_propagate(__m256i &y0, __m256i &y1, __m256i &y2, __m256i &y3)
+{
+    const __m256i tmp0 = y0;
+    y0 = _mm256_xor_si256(y0, _mm256_permute2x128_si256(y0, y1, 0x21));
+    y1 = _mm256_xor_si256(y1, _mm256_permute2x128_si256(y1, y2, 0x21));
+    y2 = _mm256_xor_si256(y2, _mm256_permute2x128_si256(y2, y3, 0x21));
+    y3 = _mm256_xor_si256(y3, _mm256_permute2x128_si256(y3, tmp0, 0x21));
+}
+
+
+static inline void xor_input(const __m128i *input, __m256i &y0, __m256i &y1, __m256i &y2, __m256i &y3)
+{
+    y0 = _mm256_xor_si256(y0, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input + 0)));
+    y1 = _mm256_xor_si256(y1, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input + 2)));
+    y2 = _mm256_xor_si256(y2, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input + 4)));
+    y3 = _mm256_xor_si256(y3, _mm256_loadu_si256(reinterpret_cast<const __m256i *>(input + 6)));
+}
+
+
+} // namespace
+
+
+void cn_explode_scratchpad_vaes256(const __m128i *keys, const __m128i *state, __m128i *output, size_t memory, bool heavy)
+{
+    __m256i k[10];
+    for (int i = 0; i < 10; ++i) {
+        k[i] = _mm256_broadcastsi128_si256(keys[i]);
+    }
+
+    __m256i y0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(state + 0));
+    __m256i y1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(state + 2));
+    __m256i y2 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(state + 4));
+    __m256i y3 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(state + 6));
+
+    if (heavy) {
+        for (size_t i = 0; i < 16; i++) {
+            aes_rounds(k, y0, y1, y2, y3);
+            mix_and_propagate(y0, y1, y2, y3);
+        }
+    }
+
+    for (size_t i = 0; i < memory / sizeof(__m128i); i += 8) {
+        aes_rounds(k, y0, y1, y2, y3);
+
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + i + 0), y0);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + i + 2), y1);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + i + 4), y2);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(output + i + 6), y3);
+    }
+}
+
+
+void cn_implode_scratchpad_vaes256(const __m128i *keys, const __m128i *input, __m128i *state, size_t memory, bool heavy)
+{
+    __m256i k[10];
+    for (int i = 0; i < 10; ++i) {
+        k[i] = _mm256_broadcastsi128_si256(keys[i]);
+    }
+
+    __m256i y0 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(state + 0));
+    __m256i y1 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(state + 2));
+    __m256i y2 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(state + 4));
+    __m256i y3 = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(state + 6));
+
+    for (size_t i = 0; i < memory / sizeof(__m128i); i += 8) {
+        xor_input(input + i, y0, y1, y2, y3);
+        aes_rounds(k, y0, y1, y2, y3);
+
+        if (heavy) {
+            mix_and_propagate(y0, y1, y2, y3);
+        }
+    }
+
+    if (heavy) {
+        for (size_t i = 0; i < memory / sizeof(__m128i); i += 8) {
+            xor_input(input + i, y0, y1, y2, y3);
+            aes_rounds(k, y0, y1, y2, y3);
+            mix_and_propagate(y0, y1, y2, y3);
+        }
+
+        for (size_t i = 0; i < 16; i++) {
+            aes_rounds(k, y0, y1, y2, y3);
+            mix_and_propagate(y0, y1, y2, y3);
+        }
+    }
+
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(state + 0), y0);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(state + 2), y1);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(state + 4), y2);
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(state + 6), y3);
+}
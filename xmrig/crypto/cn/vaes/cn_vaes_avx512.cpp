@@ -0,0 +1,133 @@
+/* XMRig
+ * Copyright 2010      Jeff Garzik <jgarzik@pobox.com>
+ * Copyright 2012-2014 pooler      <pooler@litecoinpool.org>
+ * Copyright 2014      Lucas Jones <https://github.com/lucasjones>
+ * Copyright 2014-2016 Wolf9466    <https://github.com/OhGodAPet>
+ * Copyright 2016      Jay D Dee   <jayddee246@gmail.com>
+ * Copyright 2017-2019 XMR-Stak    <https://github.com/fireice-uk>, <https://github.com/psychocrypt>
+ * Copyright 2018      Lee Clagett <https://github.com/vtnerd>
+ * Copyright 2018-2019 SChernykh   <https://github.com/SChernykh>
+ * Copyright 2016-2019 XMRig       <https://github.com/xmrig>, <support@xmrig.com>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stddef.h>
+#include <stdint.h>
+
+
+#ifdef __GNUC__
+#   include <x86intrin.h>
+#else
+#   include <intrin.h>
+#endif
+
+
+// Scratchpad explode and implode with 512-bit VAES, four of the eight 128-bit
+// lanes per instruction: z0 holds lanes 0-3, z1 lanes 4-7
+namespace {
+
+
+static inline void aes_rounds(const __m512i *k, __m512i &z0, __m512i &z1)
+{
+    for (int i = 0; i < 10; ++i) {
+        z0 = _mm512_aesenc_epi128(z0, k[i]);
+        z1 = _mm512_aesenc_epi128(z1, k[i]);
+    }
+}
+
+
+// Lane i ^= lane i + 1, lane 7 ^= lane 0
+static inline void mix_and_propagate(__m512i &z0, __m512i &z1)
+{
+    const __m512i next0 = _mm512_alignr_epi64(z1, z0, 2);
+    const __m512i next1 = _mm512_alignr_epi64(z0, z1, 2);
+
+    z0 = _mm512_xor_si512(z0, next0);
+    z1 = _mm512_xor_si512(z1, next1);
+}
+
+
+static inline void xor_input(const __m128i *input, __m512i &z0, __m512i &z1)
+{
+    z0 = _mm512_xor_si512(z0, _mm512_loadu_si512(input + 0));
+    z1 = _mm512_xor_si512(z1, _mm512_loadu_si512(input + 4));
+}
+
+
+} // namespace
+
+
+void cn_explode_scratchpad_vaes512(const __m128i *keys, const __m128i *state, __m128i *output, size_t memory, bool heavy)
+{
+    __m512i k[10];
+    for (int i = 0; i < 10; ++i) {
+        k[i] = _mm512_broadcast_i32x4(keys[i]);
+    }
+
+    __m512i z0 = _mm512_loadu_si512(state + 0);
+    __m512i z1 = _mm512_loadu_si512(state + 4);
+
+    if (heavy) {
+        for (size_t i = 0; i < 16; i++) {
+            aes_rounds(k, z0, z1);
+            mix_and_propagate(z0, z1);
+        }
+    }
+
+    for (size_t i = 0; i < memory / sizeof(__m128i); i += 8) {
+        aes_rounds(k, z0, z1);
+
+        _mm512_storeu_si512(output + i + 0, z0);
+        _mm512_storeu_si512(output + i + 4, z1);
+    }
+}
+
+
+void cn_implode_scratchpad_vaes512(const __m128i *keys, const __m128i *input, __m128i *state, size_t memory, bool heavy)
+{
+    __m512i k[10];
+    for (int i = 0; i < 10; ++i) {
+        k[i] = _mm512_broadcast_i32x4(keys[i]);
+    }
+
+    __m512i z0 = _mm512_loadu_si512(state + 0);
+    __m512i z1 = _mm512_loadu_si512(state + 4);
+
+    for (size_t i = 0; i < memory / sizeof(__m128i); i += 8) {
+        xor_input(input + i, z0, z1);
+        aes_rounds(k, z0, z1);
+
+        if (heavy) {
+            mix_and_propagate(z0, z1);
+        }
+    }
+
+    if (heavy) {
+        for (size_t i = 0; i < memory / sizeof(__m128i); i += 8) {
+            xor_input(input + i, z0, z1);
+            aes_rounds(k, z0, z1);
+            mix_and_propagate(z0, z1);
+        }
+
+        for (size_t i = 0; i < 16; i++) {
+            aes_rounds(k, z0, z1);
+            mix_and_propagate(z0, z1);
+        }
+    }
+
+    _mm512_storeu_si512(state + 0, z0);
+    _mm512_storeu_si512(state + 4, z1);
+}
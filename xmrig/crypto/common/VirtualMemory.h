@@ -59,13 +59,17 @@ public:
 
     static bool isHugepagesAvailable();
     static uint32_t bindToNUMANode(int64_t affinity);
+    static void *allocateDualMappedMemory(size_t size, void **writable);
     static void *allocateExecutableMemory(size_t size);
     static void *allocateLargePagesMemory(size_t size);
     static void destroy();
     static void flushInstructionCache(void *p, size_t size);
+    static void freeDualMappedMemory(void *p, void *writable, size_t size);
     static void freeLargePagesMemory(void *p, size_t size);
     static void init(size_t poolSize, bool hugePages);
+    static void *mapSharedMemory(int fd, size_t size, bool writable, bool hugePages);
     static void protectExecutableMemory(void *p, size_t size);
+    static void unmapSharedMemory(void *p, size_t size);
     static void unprotectExecutableMemory(void *p, size_t size);
 
     static inline constexpr size_t align(size_t pos, size_t align = 2097152) { return ((pos - 1) / align + 1) * align; }
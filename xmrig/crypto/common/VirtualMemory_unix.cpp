@@ -27,6 +27,15 @@
 
 #include <cstdlib>
 #include <sys/mman.h>
+#include <unistd.h>
+
+
+#if defined(__linux__)
+#   include <sys/syscall.h>
+#   ifndef MFD_CLOEXEC
+#       define MFD_CLOEXEC 1U
+#   endif
+#endif
 
 
 #include "crypto/common/portable/mm_malloc.h"
@@ -44,6 +53,45 @@ bool xmrig::VirtualMemory::isHugepagesAvailable()
 }
 
 
+// JIT memory mapped twice from one memfd, written through the RW view and run
+// through the RX view, so no page is ever writable and executable. The views
+// are shared, children forked afterwards would share the code too. Falls back
+// to one RWX mapping where memfds or executable shared mappings aren't allowed.
+void *xmrig::VirtualMemory::allocateDualMappedMemory(size_t size, void **writable)
+{
+#   if defined(__linux__) && defined(SYS_memfd_create)
+    const int fd = static_cast<int>(syscall(SYS_memfd_create, "xmrig-jit", MFD_CLOEXEC));
+    if (fd >= 0) {
+        void *rw = MAP_FAILED;
+        void *rx = MAP_FAILED;
+        if (ftruncate(fd, static_cast<off_t>(size)) == 0) {
+            rw = mmap(0, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+            rx = mmap(0, size, PROT_READ | PROT_EXEC, MAP_SHARED, fd, 0);
+        }
+        close(fd);
+
+        if (rw != MAP_FAILED && rx != MAP_FAILED) {
+            *writable = rw;
+            return rx;
+        }
+
+        if (rw != MAP_FAILED) {
+            munmap(rw, size);
+        }
+
+        if (rx != MAP_FAILED) {
+            munmap(rx, size);
+        }
+    }
+#   endif
+
+    void *mem = allocateExecutableMemory(size);
+    *writable = mem;
+
+    return mem;
+}
+
+
 void *xmrig::VirtualMemory::allocateExecutableMemory(size_t size)
 {
 #   if defined(__APPLE__)
@@ -70,6 +118,23 @@ void *xmrig::VirtualMemory::allocateLargePagesMemory(size_t size)
 }
 
 
+void *xmrig::VirtualMemory::mapSharedMemory(int fd, size_t size, bool writable, bool hugePages)
+{
+    void *mem = mmap(0, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+    if (mem == MAP_FAILED) {
+        return nullptr;
+    }
+
+#   ifdef MADV_HUGEPAGE
+    if (hugePages) {
+        madvise(mem, size, MADV_HUGEPAGE);
+    }
+#   endif
+
+    return mem;
+}
+
+
 void xmrig::VirtualMemory::flushInstructionCache(void *p, size_t size)
 {
 #   ifdef HAVE_BUILTIN_CLEAR_CACHE
@@ -78,6 +143,16 @@ void xmrig::VirtualMemory::flushInstructionCache(void *p, size_t size)
 }
 
 
+void xmrig::VirtualMemory::freeDualMappedMemory(void *p, void *writable, size_t size)
+{
+    if (writable != p) {
+        munmap(writable, size);
+    }
+
+    munmap(p, size);
+}
+
+
 void xmrig::VirtualMemory::freeLargePagesMemory(void *p, size_t size)
 {
     munmap(p, size);
@@ -90,6 +165,12 @@ void xmrig::VirtualMemory::protectExecutableMemory(void *p, size_t size)
 }
 
 
+void xmrig::VirtualMemory::unmapSharedMemory(void *p, size_t size)
+{
+    munmap(p, size);
+}
+
+
 void xmrig::VirtualMemory::unprotectExecutableMemory(void *p, size_t size)
 {
     mprotect(p, size, PROT_WRITE | PROT_EXEC);
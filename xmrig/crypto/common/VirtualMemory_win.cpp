@@ -156,6 +156,35 @@ bool xmrig::VirtualMemory::isHugepagesAvailable()
 }
 
 
+void *xmrig::VirtualMemory::allocateDualMappedMemory(size_t size, void **writable)
+{
+    HANDLE section = CreateFileMapping(INVALID_HANDLE_VALUE, nullptr, PAGE_EXECUTE_READWRITE, static_cast<DWORD>(static_cast<uint64_t>(size) >> 32), static_cast<DWORD>(size), nullptr);
+    if (section) {
+        void *rw = MapViewOfFile(section, FILE_MAP_WRITE, 0, 0, size);
+        void *rx = MapViewOfFile(section, FILE_MAP_READ | FILE_MAP_EXECUTE, 0, 0, size);
+        CloseHandle(section);
+
+        if (rw && rx) {
+            *writable = rw;
+            return rx;
+        }
+
+        if (rw) {
+            UnmapViewOfFile(rw);
+        }
+
+        if (rx) {
+            UnmapViewOfFile(rx);
+        }
+    }
+
+    void *mem = allocateExecutableMemory(size);
+    *writable = mem;
+
+    return mem;
+}
+
+
 void *xmrig::VirtualMemory::allocateExecutableMemory(size_t size)
 {
     return VirtualAlloc(nullptr, size, MEM_COMMIT | MEM_RESERVE, PAGE_EXECUTE_READWRITE);
@@ -181,12 +210,30 @@ void xmrig::VirtualMemory::flushInstructionCache(void *p, size_t size)
 }
 
 
+void xmrig::VirtualMemory::freeDualMappedMemory(void *p, void *writable, size_t)
+{
+    if (writable == p) {
+        VirtualFree(p, 0, MEM_RELEASE);
+        return;
+    }
+
+    UnmapViewOfFile(writable);
+    UnmapViewOfFile(p);
+}
+
+
 void xmrig::VirtualMemory::freeLargePagesMemory(void *p, size_t)
 {
     VirtualFree(p, 0, MEM_RELEASE);
 }
 
 
+void *xmrig::VirtualMemory::mapSharedMemory(int, size_t, bool, bool)
+{
+    return nullptr;
+}
+
+
 void xmrig::VirtualMemory::protectExecutableMemory(void *p, size_t size)
 {
     DWORD oldProtect;
@@ -194,6 +241,11 @@ void xmrig::VirtualMemory::protectExecutableMemory(void *p, size_t size)
 }
 
 
+void xmrig::VirtualMemory::unmapSharedMemory(void *, size_t)
+{
+}
+
+
 void xmrig::VirtualMemory::unprotectExecutableMemory(void *p, size_t size)
 {
     DWORD oldProtect;
@@ -24,12 +24,22 @@
 
 
 #include <stdint.h>
+#include <stdlib.h>
 #include <memory.h>
 
 
+#include "backend/cpu/Cpu.h"
 #include "crypto/common/keccak.h"
 
 
+#if defined(__x86_64__)
+// Multi-way permutations on word-major states, built with the instruction sets
+// they need in keccak_avx2.cpp and keccak_avx512.cpp
+void keccakf_avx2_x4(uint64_t st[25][4]);
+void keccakf_avx512_x8(uint64_t st[25][8]);
+#endif
+
+
 #define HASH_DATA_AREA 136
 #define KECCAK_ROUNDS 24
 
@@ -198,3 +208,116 @@ void xmrig::keccak(const uint8_t *in, int inlen, uint8_t *md, int mdlen)
 
     memcpy(md, st, mdlen);
 }
+
+
+#if defined(__x86_64__)
+namespace {
+
+
+// States permuted together: 8 with AVX-512, 4 with AVX2, capped by CRYPTONIGHT_KECCAK_WAYS
+static size_t keccakf_width()
+{
+    static const size_t width = [] {
+        size_t width = xmrig::Cpu::info()->hasAVX512F() ? 8 : xmrig::Cpu::info()->hasAVX2() ? 4 : 1;
+
+        const char *env = getenv("CRYPTONIGHT_KECCAK_WAYS");
+        if (env && static_cast<size_t>(atoi(env)) < width) {
+            width = atoi(env) >= 4 ? 4 : 1;
+        }
+
+        return width;
+    }();
+
+    return width;
+}
+
+
+template<size_t WAYS>
+static inline void keccakf_lanes(uint64_t *const *st, size_t count, void (*fn)(uint64_t [25][WAYS]))
+{
+    alignas(64) uint64_t lanes[25][WAYS] = {};
+
+    for (size_t w = 0; w < 25; ++w) {
+        for (size_t i = 0; i < count; ++i) {
+            lanes[w][i] = st[i][w];
+        }
+    }
+
+    fn(lanes);
+
+    for (size_t w = 0; w < 25; ++w) {
+        for (size_t i = 0; i < count; ++i) {
+            st[i][w] = lanes[w][i];
+        }
+    }
+}
+
+
+} // namespace
+#endif
+
+
+// a multi-way pass costs about one scalar permutation with AVX-512 and two with AVX2,
+// so it pays off from two states on
+void xmrig::keccakf(uint64_t *const *st, size_t count)
+{
+#   if defined(__x86_64__)
+    const size_t width = keccakf_width();
+
+    while (width > 1 && count > 1) {
+        const size_t n = count < width ? count : width;
+        if (width == 8) {
+            keccakf_lanes<8>(st, n, keccakf_avx512_x8);
+        }
+        else {
+            keccakf_lanes<4>(st, n, keccakf_avx2_x4);
+        }
+
+        st    += n;
+        count -= n;
+    }
+#   endif
+
+    for (; count > 0; --count, ++st) {
+        keccakf(*st, KECCAK_ROUNDS);
+    }
+}
+
+
+void xmrig::keccak(const uint8_t *in, size_t inlen, uint8_t *const *md, size_t count)
+{
+    uint64_t *st[8];
+    uint8_t temp[HASH_DATA_AREA];
+    size_t i, j, k, n, done;
+
+    for (; count > 0; count -= n, md += n, in += inlen * n) {
+        n = count < 8 ? count : 8;
+
+        for (i = 0; i < n; i++) {
+            st[i] = reinterpret_cast<uint64_t *>(md[i]);
+            memset(st[i], 0, sizeof(state_t));
+        }
+
+        // full blocks, then the last block and padding
+        for (done = 0; done <= inlen; done += HASH_DATA_AREA) {
+            const size_t size = inlen - done < HASH_DATA_AREA ? inlen - done : HASH_DATA_AREA;
+
+            for (i = 0; i < n; i++) {
+                memcpy(temp, in + inlen * i + done, size);
+                if (size < HASH_DATA_AREA) {
+                    memset(temp + size, 0, HASH_DATA_AREA - size);
+                    temp[size] = 1;
+                    temp[HASH_DATA_AREA - 1] |= 0x80;
+                }
+
+                for (j = 0, k = 0; j < HASH_DATA_AREA; j += 8, k++) {
+                    uint64_t word;
+                    memcpy(&word, temp + j, 8);
+                    st[i][k] ^= word;
+                }
+            }
+
+            keccakf(st, n);
+        }
+    }
+}
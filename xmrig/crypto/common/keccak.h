@@ -26,6 +26,7 @@
 #ifndef XMRIG_KECCAK_H
 #define XMRIG_KECCAK_H
 
+#include <stddef.h>
 #include <stdint.h>
 #include <string.h>
 
@@ -50,6 +51,13 @@ inline void keccak(const char *in, size_t inlen, uint8_t *md)
 // update the state
 void keccakf(uint64_t st[25], int norounds);
 
+// update count states at once with AVX2 or AVX-512 where available, 24 rounds
+void keccakf(uint64_t *const *st, size_t count);
+
+// keccak of count inputs of inlen bytes each (in + inlen * i) into the 200-byte
+// states md[i], permuting them together
+void keccak(const uint8_t *in, size_t inlen, uint8_t *const *md, size_t count);
+
 } /* namespace xmrig */
 
 #endif /* XMRIG_KECCAK_H */
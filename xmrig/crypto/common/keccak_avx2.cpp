@@ -0,0 +1,145 @@
+/* XMRig
+ * Copyright 2010      Jeff Garzik               <jgarzik@pobox.com>
+ * Copyright 2011      Markku-Juhani O. Saarinen <mjos@iki.fi>
+ * Copyright 2012-2014 pooler                    <pooler@litecoinpool.org>
+ * Copyright 2014      Lucas Jones               <https://github.com/lucasjones>
+ * Copyright 2014-2016 Wolf9466                  <https://github.com/OhGodAPet>
+ * Copyright 2016      Jay D Dee                 <jayddee246@gmail.com>
+ * Copyright 2017-2018 XMR-Stak                  <https://github.com/fireice-uk>, <https://github.com/psychocrypt>
+ * Copyright 2016-2018 XMRig                     <https://github.com/xmrig>, <support@xmrig.com>
+ *
+ *   This program is free software: you can redistribute it and/or modify
+ *   it under the terms of the GNU General Public License as published by
+ *   the Free Software Foundation, either version 3 of the License, or
+ *   (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <stdint.h>
+
+
+#ifdef __GNUC__
+#   include <x86intrin.h>
+#else
+#   include <intrin.h>
+#endif
+
+
+// Keccak-f[1600] of four states at once: lane i of register w holds word w of
+// state i, so st is stored word-major (st[w][i])
+namespace {
+
+
+static const uint64_t rndc[24] =
+{
+    0x0000000000000001, 0x0000000000008082, 0x800000000000808a,
+    0x8000000080008000, 0x000000000000808b, 0x0000000080000001,
+    0x8000000080008081, 0x8000000000008009, 0x000000000000008a,
+    0x0000000000000088, 0x0000000080008009, 0x000000008000000a,
+    0x000000008000808b, 0x800000000000008b, 0x8000000000008089,
+    0x8000000000008003, 0x8000000000008002, 0x8000000000000080,
+    0x000000000000800a, 0x800000008000000a, 0x8000000080008081,
+    0x8000000000008080, 0x0000000080000001, 0x8000000080008008
+};
+
+
+template<int N>
+static inline __m256i rotl(__m256i x)
+{
+    return _mm256_or_si256(_mm256_slli_epi64(x, N), _mm256_srli_epi64(x, 64 - N));
+}
+
+
+static inline __m256i xor5(__m256i a, __m256i b, __m256i c, __m256i d, __m256i e)
+{
+    return _mm256_xor_si256(_mm256_xor_si256(_mm256_xor_si256(a, b), _mm256_xor_si256(c, d)), e);
+}
+
+
+// a ^ (~b & c)
+static inline __m256i chi(__m256i a, __m256i b, __m256i c)
+{
+    return _mm256_xor_si256(a, _mm256_andnot_si256(b, c));
+}
+
+
+} // namespace
+
+
+void keccakf_avx2_x4(uint64_t st[25][4])
+{
+    __m256i a[25], bc[5], t;
+
+    for (int i = 0; i < 25; ++i) {
+        a[i] = _mm256_load_si256(reinterpret_cast<const __m256i *>(st[i]));
+    }
+
+    for (int round = 0; round < 24; ++round) {
+        // Theta
+        for (int i = 0; i < 5; ++i) {
+            bc[i] = xor5(a[i], a[i + 5], a[i + 10], a[i + 15], a[i + 20]);
+        }
+
+        for (int i = 0; i < 5; ++i) {
+            t = _mm256_xor_si256(bc[(i + 4) % 5], rotl<1>(bc[(i + 1) % 5]));
+            a[i     ] = _mm256_xor_si256(a[i     ], t);
+            a[i +  5] = _mm256_xor_si256(a[i +  5], t);
+            a[i + 10] = _mm256_xor_si256(a[i + 10], t);
+            a[i + 15] = _mm256_xor_si256(a[i + 15], t);
+            a[i + 20] = _mm256_xor_si256(a[i + 20], t);
+        }
+
+        // Rho Pi
+        t = a[1];
+        a[ 1] = rotl<44>(a[ 6]);
+        a[ 6] = rotl<20>(a[ 9]);
+        a[ 9] = rotl<61>(a[22]);
+        a[22] = rotl<39>(a[14]);
+        a[14] = rotl<18>(a[20]);
+        a[20] = rotl<62>(a[ 2]);
+        a[ 2] = rotl<43>(a[12]);
+        a[12] = rotl<25>(a[13]);
+        a[13] = rotl< 8>(a[19]);
+        a[19] = rotl<56>(a[23]);
+        a[23] = rotl<41>(a[15]);
+        a[15] = rotl<27>(a[ 4]);
+        a[ 4] = rotl<14>(a[24]);
+        a[24] = rotl< 2>(a[21]);
+        a[21] = rotl<55>(a[ 8]);
+        a[ 8] = rotl<45>(a[16]);
+        a[16] = rotl<36>(a[ 5]);
+        a[ 5] = rotl<28>(a[ 3]);
+        a[ 3] = rotl<21>(a[18]);
+        a[18] = rotl<15>(a[17]);
+        a[17] = rotl<10>(a[11]);
+        a[11] = rotl< 6>(a[ 7]);
+        a[ 7] = rotl< 3>(a[10]);
+        a[10] = rotl< 1>(t);
+
+        // Chi
+        for (int j = 0; j < 25; j += 5) {
+            for (int i = 0; i < 5; ++i) {
+                bc[i] = a[j + i];
+            }
+
+            for (int i = 0; i < 5; ++i) {
+                a[j + i] = chi(bc[i], bc[(i + 1) % 5], bc[(i + 2) % 5]);
+            }
+        }
+
+        // Iota
+        a[0] = _mm256_xor_si256(a[0], _mm256_set1_epi64x(static_cast<int64_t>(rndc[round])));
+    }
+
+    for (int i = 0; i < 25; ++i) {
+        _mm256_store_si256(reinterpret_cast<__m256i *>(st[i]), a[i]);
+    }
+}
@@ -33,6 +33,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "crypto/randomx/vm_compiled.hpp"
 #include "crypto/randomx/vm_compiled_light.hpp"
 #include "crypto/randomx/jit_compiler_x86_static.hpp"
+#include "crypto/randomx/timing.hpp"
 
 #include <cassert>
 
@@ -97,16 +98,41 @@ extern "C" {
 		assert(output != nullptr);
 		alignas(16) uint64_t tempHash[8];
 		//rx_blake2b(tempHash, sizeof(tempHash), input, inputSize, nullptr, 0);
-		sipesh(tempHash, sizeof(tempHash), input, inputSize, input, inputSize, 0, 0);
-		k12(input, inputSize, tempHash);
-		machine->initScratchpad(&tempHash);
+		RANDOMX_TIMED(TimingBlake2b, sipesh(tempHash, sizeof(tempHash), input, inputSize, input, inputSize, 0, 0), k12(input, inputSize, tempHash));
+		RANDOMX_TIMED(TimingFillScratchpad, machine->initScratchpad(&tempHash));
 		machine->resetRoundingMode();
-		for (uint32_t chain = 0; chain < RandomX_CurrentConfig.ProgramCount - 1; ++chain) {
+		for (uint32_t chain = 0; chain < machine->getConfig().ProgramCount - 1; ++chain) {
 			machine->run(&tempHash);
-			rx_blake2b(tempHash, sizeof(tempHash), machine->getRegisterFile(), sizeof(randomx::RegisterFile), nullptr, 0);
+			RANDOMX_TIMED(TimingBlake2b, rx_blake2b(tempHash, sizeof(tempHash), machine->getRegisterFile(), sizeof(randomx::RegisterFile), nullptr, 0));
 		}
 		machine->run(&tempHash);
-		machine->getFinalResult(output, RANDOMX_HASH_SIZE);
+		RANDOMX_TIMED(TimingFinalize, machine->getFinalResult(output, RANDOMX_HASH_SIZE));
+	}
+
+	void defyx_calculate_hash_first(randomx_vm *machine, const void *input, size_t inputSize) {
+		assert(machine != nullptr);
+		assert(inputSize == 0 || input != nullptr);
+		RANDOMX_TIMED(TimingBlake2b, sipesh(machine->tempHash, sizeof(machine->tempHash), input, inputSize, input, inputSize, 0, 0), k12(input, inputSize, machine->tempHash));
+		RANDOMX_TIMED(TimingFillScratchpad, machine->initScratchpad(machine->tempHash));
+	}
+
+	void defyx_calculate_hash_next(randomx_vm *machine, const void *nextInput, size_t nextInputSize, void *output) {
+		assert(machine != nullptr);
+		assert(nextInputSize == 0 || nextInput != nullptr);
+		assert(output != nullptr);
+		machine->resetRoundingMode();
+		for (uint32_t chain = 0; chain < machine->getConfig().ProgramCount - 1; ++chain) {
+			machine->run(machine->tempHash);
+			RANDOMX_TIMED(TimingBlake2b, rx_blake2b(machine->tempHash, sizeof(machine->tempHash), machine->getRegisterFile(), sizeof(randomx::RegisterFile), nullptr, 0));
+		}
+		machine->run(machine->tempHash);
+
+		RANDOMX_TIMED(TimingBlake2b, sipesh(machine->tempHash, sizeof(machine->tempHash), nextInput, nextInputSize, nextInput, nextInputSize, 0, 0), k12(nextInput, nextInputSize, machine->tempHash));
+		RANDOMX_TIMED(TimingFinalize, machine->hashAndFill(output, RANDOMX_HASH_SIZE, machine->tempHash));
+	}
+
+	void defyx_calculate_hash_last(randomx_vm *machine, void *output) {
+		randomx_calculate_hash_last(machine, output);
 	}
 
 }
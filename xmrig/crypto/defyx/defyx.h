@@ -50,6 +50,13 @@ extern "C" {
 */
 RANDOMX_EXPORT void defyx_calculate_hash(randomx_vm *machine, const void *input, size_t inputSize, void *output);
 
+/**
+ * Pipelined hashing of a sequence of inputs, see randomx_calculate_hash_first.
+*/
+RANDOMX_EXPORT void defyx_calculate_hash_first(randomx_vm *machine, const void *input, size_t inputSize);
+RANDOMX_EXPORT void defyx_calculate_hash_next(randomx_vm *machine, const void *nextInput, size_t nextInputSize, void *output);
+RANDOMX_EXPORT void defyx_calculate_hash_last(randomx_vm *machine, void *output);
+
 #if defined(__cplusplus)
 }
 #endif
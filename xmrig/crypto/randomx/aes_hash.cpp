@@ -158,22 +158,105 @@ void fillAes1Rx4(void *state, size_t outputSize, void *buffer) {
 template void fillAes1Rx4<true>(void *state, size_t outputSize, void *buffer);
 template void fillAes1Rx4<false>(void *state, size_t outputSize, void *buffer);
 
+/*
+	hashAes1Rx4 of the scratchpad and fillAes1Rx4 of it from 'fill_state'
+	in a single pass: each 64 bytes are hashed, then overwritten. This
+	finishes one hash and starts the next one with one read of the
+	scratchpad, and the two AES chains run in parallel.
+
+	'scratchpadSize' must be a multiple of 64. The modified fill state is
+	written back to 'fill_state'.
+*/
+template<bool softAes>
+void hashAndFillAes1Rx4(void *scratchpad, size_t scratchpadSize, void *hash, void* fill_state) {
+	uint8_t* scratchpadPtr = (uint8_t*)scratchpad;
+	const uint8_t* scratchpadEnd = scratchpadPtr + scratchpadSize;
+
+	rx_vec_i128 hash_state0, hash_state1, hash_state2, hash_state3;
+	rx_vec_i128 fill_state0, fill_state1, fill_state2, fill_state3;
+	rx_vec_i128 key0, key1, key2, key3;
+
+	//intial state
+	hash_state0 = rx_set_int_vec_i128(AES_HASH_1R_STATE0);
+	hash_state1 = rx_set_int_vec_i128(AES_HASH_1R_STATE1);
+	hash_state2 = rx_set_int_vec_i128(AES_HASH_1R_STATE2);
+	hash_state3 = rx_set_int_vec_i128(AES_HASH_1R_STATE3);
+
+	key0 = rx_set_int_vec_i128(AES_GEN_1R_KEY0);
+	key1 = rx_set_int_vec_i128(AES_GEN_1R_KEY1);
+	key2 = rx_set_int_vec_i128(AES_GEN_1R_KEY2);
+	key3 = rx_set_int_vec_i128(AES_GEN_1R_KEY3);
+
+	fill_state0 = rx_load_vec_i128((rx_vec_i128*)fill_state + 0);
+	fill_state1 = rx_load_vec_i128((rx_vec_i128*)fill_state + 1);
+	fill_state2 = rx_load_vec_i128((rx_vec_i128*)fill_state + 2);
+	fill_state3 = rx_load_vec_i128((rx_vec_i128*)fill_state + 3);
+
+	//process 64 bytes at a time in 4 lanes
+	while (scratchpadPtr < scratchpadEnd) {
+		hash_state0 = aesenc<softAes>(hash_state0, rx_load_vec_i128((rx_vec_i128*)scratchpadPtr + 0));
+		hash_state1 = aesdec<softAes>(hash_state1, rx_load_vec_i128((rx_vec_i128*)scratchpadPtr + 1));
+		hash_state2 = aesenc<softAes>(hash_state2, rx_load_vec_i128((rx_vec_i128*)scratchpadPtr + 2));
+		hash_state3 = aesdec<softAes>(hash_state3, rx_load_vec_i128((rx_vec_i128*)scratchpadPtr + 3));
+
+		fill_state0 = aesdec<softAes>(fill_state0, key0);
+		fill_state1 = aesenc<softAes>(fill_state1, key1);
+		fill_state2 = aesdec<softAes>(fill_state2, key2);
+		fill_state3 = aesenc<softAes>(fill_state3, key3);
+
+		rx_store_vec_i128((rx_vec_i128*)scratchpadPtr + 0, fill_state0);
+		rx_store_vec_i128((rx_vec_i128*)scratchpadPtr + 1, fill_state1);
+		rx_store_vec_i128((rx_vec_i128*)scratchpadPtr + 2, fill_state2);
+		rx_store_vec_i128((rx_vec_i128*)scratchpadPtr + 3, fill_state3);
+
+		scratchpadPtr += 64;
+	}
+
+	//two extra rounds to achieve full diffusion
+	rx_vec_i128 xkey0 = rx_set_int_vec_i128(AES_HASH_1R_XKEY0);
+	rx_vec_i128 xkey1 = rx_set_int_vec_i128(AES_HASH_1R_XKEY1);
+
+	hash_state0 = aesenc<softAes>(hash_state0, xkey0);
+	hash_state1 = aesdec<softAes>(hash_state1, xkey0);
+	hash_state2 = aesenc<softAes>(hash_state2, xkey0);
+	hash_state3 = aesdec<softAes>(hash_state3, xkey0);
+
+	hash_state0 = aesenc<softAes>(hash_state0, xkey1);
+	hash_state1 = aesdec<softAes>(hash_state1, xkey1);
+	hash_state2 = aesenc<softAes>(hash_state2, xkey1);
+	hash_state3 = aesdec<softAes>(hash_state3, xkey1);
+
+	//output hash
+	rx_store_vec_i128((rx_vec_i128*)hash + 0, hash_state0);
+	rx_store_vec_i128((rx_vec_i128*)hash + 1, hash_state1);
+	rx_store_vec_i128((rx_vec_i128*)hash + 2, hash_state2);
+	rx_store_vec_i128((rx_vec_i128*)hash + 3, hash_state3);
+
+	rx_store_vec_i128((rx_vec_i128*)fill_state + 0, fill_state0);
+	rx_store_vec_i128((rx_vec_i128*)fill_state + 1, fill_state1);
+	rx_store_vec_i128((rx_vec_i128*)fill_state + 2, fill_state2);
+	rx_store_vec_i128((rx_vec_i128*)fill_state + 3, fill_state3);
+}
+
+template void hashAndFillAes1Rx4<false>(void *scratchpad, size_t scratchpadSize, void *hash, void* fill_state);
+template void hashAndFillAes1Rx4<true>(void *scratchpad, size_t scratchpadSize, void *hash, void* fill_state);
+
 template<bool softAes>
-void fillAes4Rx4(void *state, size_t outputSize, void *buffer) {
+void fillAes4Rx4(void *state, size_t outputSize, void *buffer, const rx_vec_i128 (&keys)[8]) {
 	const uint8_t* outptr = (uint8_t*)buffer;
 	const uint8_t* outputEnd = outptr + outputSize;
 
 	rx_vec_i128 state0, state1, state2, state3;
 	rx_vec_i128 key0, key1, key2, key3, key4, key5, key6, key7;
 
-	key0 = RandomX_CurrentConfig.fillAes4Rx4_Key[0];
-	key1 = RandomX_CurrentConfig.fillAes4Rx4_Key[1];
-	key2 = RandomX_CurrentConfig.fillAes4Rx4_Key[2];
-	key3 = RandomX_CurrentConfig.fillAes4Rx4_Key[3];
-	key4 = RandomX_CurrentConfig.fillAes4Rx4_Key[4];
-	key5 = RandomX_CurrentConfig.fillAes4Rx4_Key[5];
-	key6 = RandomX_CurrentConfig.fillAes4Rx4_Key[6];
-	key7 = RandomX_CurrentConfig.fillAes4Rx4_Key[7];
+	key0 = keys[0];
+	key1 = keys[1];
+	key2 = keys[2];
+	key3 = keys[3];
+	key4 = keys[4];
+	key5 = keys[5];
+	key6 = keys[6];
+	key7 = keys[7];
 
 	state0 = rx_load_vec_i128((rx_vec_i128*)state + 0);
 	state1 = rx_load_vec_i128((rx_vec_i128*)state + 1);
@@ -210,5 +293,5 @@ void fillAes4Rx4(void *state, size_t outputSize, void *buffer) {
 	}
 }
 
-template void fillAes4Rx4<true>(void *state, size_t outputSize, void *buffer);
-template void fillAes4Rx4<false>(void *state, size_t outputSize, void *buffer);
+template void fillAes4Rx4<true>(void *state, size_t outputSize, void *buffer, const rx_vec_i128 (&keys)[8]);
+template void fillAes4Rx4<false>(void *state, size_t outputSize, void *buffer, const rx_vec_i128 (&keys)[8]);
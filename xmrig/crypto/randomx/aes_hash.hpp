@@ -29,6 +29,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #pragma once
 
 #include <cstddef>
+#include "crypto/randomx/intrin_portable.h"
 
 template<bool softAes>
 void hashAes1Rx4(const void *input, size_t inputSize, void *hash);
@@ -37,4 +38,7 @@ template<bool softAes>
 void fillAes1Rx4(void *state, size_t outputSize, void *buffer);
 
 template<bool softAes>
-void fillAes4Rx4(void *state, size_t outputSize, void *buffer);
+void hashAndFillAes1Rx4(void *scratchpad, size_t scratchpadSize, void *hash, void* fill_state);
+
+template<bool softAes>
+void fillAes4Rx4(void *state, size_t outputSize, void *buffer, const rx_vec_i128 (&keys)[8]);
@@ -0,0 +1,63 @@
+#include <algorithm>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+#include "crypto/randomx/argon2_cache.hpp"
+#include "crypto/randomx/common.hpp"
+
+extern "C" {
+#include "3rdparty/argon2/lib/core.h"
+}
+
+static_assert(ARGON2_BLOCK_SIZE == randomx::ArgonBlockSize, "Unpexpected value of ARGON2_BLOCK_SIZE");
+
+namespace randomx {
+
+	void argon2FillCache(void* memory, const void* key, size_t keySize, const char* salt, uint32_t iterations, uint32_t memoryBlocks, uint32_t lanes) {
+		argon2_context context = {};
+		context.pwd = static_cast<uint8_t*>(const_cast<void*>(key));
+		context.pwdlen = static_cast<uint32_t>(keySize);
+		context.salt = reinterpret_cast<uint8_t*>(const_cast<char*>(salt));
+		context.saltlen = static_cast<uint32_t>(strlen(salt));
+		context.t_cost = iterations;
+		context.m_cost = memoryBlocks;
+		context.lanes = lanes;
+		context.threads = lanes;
+		context.flags = ARGON2_DEFAULT_FLAGS;
+		context.version = ARGON2_VERSION_NUMBER;
+
+		argon2_instance_t instance = {};
+		instance.version = context.version;
+		instance.memory = static_cast<block*>(memory);
+		instance.passes = iterations;
+		instance.segment_length = memoryBlocks / (lanes * ARGON2_SYNC_POINTS);
+		instance.lane_length = instance.segment_length * ARGON2_SYNC_POINTS;
+		instance.memory_blocks = instance.lane_length * lanes;
+		instance.lanes = lanes;
+		instance.threads = std::min(lanes, std::max(std::thread::hardware_concurrency(), 1u));
+		instance.type = Argon2_d;
+		instance.keep_memory = 1;
+
+		// Hashes the inputs and fills the first blocks of each lane, memory is ours
+		initialize(&instance, &context);
+
+		// Segments of one slice only reference blocks of earlier slices, so
+		// the lanes can be filled at the same time
+		std::vector<std::thread> threads;
+		for (uint32_t r = 0; r < instance.passes; ++r) {
+			for (uint8_t s = 0; s < ARGON2_SYNC_POINTS; ++s) {
+				for (uint32_t first = 0; first < lanes; first += instance.threads) {
+					const uint32_t last = std::min(lanes, first + instance.threads);
+					for (uint32_t l = first + 1; l < last; ++l) {
+						threads.emplace_back([&instance, r, l, s]() { fill_segment(&instance, { r, l, s, 0 }); });
+					}
+					fill_segment(&instance, { r, first, s, 0 });
+					for (std::thread& thread : threads) thread.join();
+					threads.clear();
+				}
+			}
+		}
+	}
+
+}
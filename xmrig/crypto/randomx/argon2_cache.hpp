@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace randomx {
+
+	// Argon2d fill of the cache memory (memoryBlocks KiB), same as the reference
+	// implementation but with the block kernel picked by argon2_select_impl()
+	// and the lanes of each slice filled on separate threads
+	void argon2FillCache(void* memory, const void* key, size_t keySize, const char* salt, uint32_t iterations, uint32_t memoryBlocks, uint32_t lanes);
+
+}
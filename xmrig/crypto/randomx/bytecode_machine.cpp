@@ -78,10 +78,103 @@ namespace randomx {
 		}
 	}
 
+#ifdef RANDOMX_THREADED_BYTECODE
+	//handler table indices past the instruction types
+	static constexpr int HandlerEnd = static_cast<int>(InstructionType::NOP) + 1;
+
+	void BytecodeMachine::threadBytecode(InstructionByteCode* bytecode, uint32_t programSize) {
+		const void* const* handlers = executeThreaded(nullptr, nullptr, nullptr);
+		for (uint32_t i = 0; i < programSize; ++i) {
+			bytecode[i].handler = handlers[static_cast<int>(bytecode[i].type)];
+		}
+		bytecode[programSize].handler = handlers[HandlerEnd];
+	}
+
+#define INSTR_HANDLER(x) x: \
+	exe_ ## x(*ibc, pc, scratchpad, *config); \
+	goto *(++ibc)->handler;
+
+	const void* const* BytecodeMachine::executeThreaded(InstructionByteCode* bytecode, uint8_t* scratchpad, ProgramConfiguration* config) {
+		static const void* const handlers[] = {
+			&&IADD_RS, &&IADD_M, &&ISUB_R, &&ISUB_M, &&IMUL_R, &&IMUL_M, &&IMULH_R, &&IMULH_M,
+			&&ISMULH_R, &&ISMULH_M, &&NOP, &&INEG_R, &&IXOR_R, &&IXOR_M, &&IROR_R, &&IROL_R,
+			&&ISWAP_R, &&FSWAP_R, &&FADD_R, &&FADD_M, &&FSUB_R, &&FSUB_M, &&FSCAL_R, &&FMUL_R,
+			&&FDIV_M, &&FSQRT_R, &&CBRANCH, &&CFROUND, &&ISTORE, &&NOP,
+			&&END
+		};
+		static_assert(sizeof(handlers) / sizeof(handlers[0]) == HandlerEnd + 1, "Handler table doesn't match InstructionType");
+
+		if (bytecode == nullptr)
+			return handlers;
+
+		//kept in registers across the whole program
+		const rx_vec_f128 scaleMask = rx_set1_vec_f128(0x80F0000000000000);
+		const rx_vec_f128 mantissaMask = rx_set_vec_f128(dynamicMantissaMask, dynamicMantissaMask);
+		const rx_vec_f128 exponentMask = rx_load_vec_f128((const double*)&config->eMask);
+		InstructionByteCode* ibc = bytecode;
+		int pc = 0;
+		goto *ibc->handler;
+
+		INSTR_HANDLER(IADD_RS)
+		INSTR_HANDLER(IADD_M)
+		INSTR_HANDLER(ISUB_R)
+		INSTR_HANDLER(ISUB_M)
+		INSTR_HANDLER(IMUL_R)
+		INSTR_HANDLER(IMUL_M)
+		INSTR_HANDLER(IMULH_R)
+		INSTR_HANDLER(IMULH_M)
+		INSTR_HANDLER(ISMULH_R)
+		INSTR_HANDLER(ISMULH_M)
+		INSTR_HANDLER(INEG_R)
+		INSTR_HANDLER(IXOR_R)
+		INSTR_HANDLER(IXOR_M)
+		INSTR_HANDLER(IROR_R)
+		INSTR_HANDLER(IROL_R)
+		INSTR_HANDLER(ISWAP_R)
+		INSTR_HANDLER(FSWAP_R)
+		INSTR_HANDLER(FADD_R)
+		INSTR_HANDLER(FADD_M)
+		INSTR_HANDLER(FSUB_R)
+		INSTR_HANDLER(FSUB_M)
+		INSTR_HANDLER(FMUL_R)
+		INSTR_HANDLER(FSQRT_R)
+		INSTR_HANDLER(CFROUND)
+		INSTR_HANDLER(ISTORE)
+
+	FSCAL_R:
+		*ibc->fdst = rx_xor_vec_f128(*ibc->fdst, scaleMask);
+		goto *(++ibc)->handler;
+
+	FDIV_M:
+		{
+			rx_vec_f128 fsrc = rx_cvt_packed_int_vec_f128(getScratchpadAddress(*ibc, scratchpad));
+			fsrc = rx_or_vec_f128(rx_and_vec_f128(fsrc, mantissaMask), exponentMask);
+			*ibc->fdst = rx_div_vec_f128(*ibc->fdst, fsrc);
+		}
+		goto *(++ibc)->handler;
+
+	CBRANCH:
+		*ibc->idst += ibc->imm;
+		if ((*ibc->idst & ibc->memMask) == 0) {
+			ibc = bytecode + ibc->target;
+		}
+		goto *(++ibc)->handler;
+
+	NOP:
+		goto *(++ibc)->handler;
+
+	END:
+		return nullptr;
+	}
+#else
+	void BytecodeMachine::threadBytecode(InstructionByteCode*, uint32_t) {
+	}
+#endif
+
 	void BytecodeMachine::compileInstruction(RANDOMX_GEN_ARGS) {
 		int opcode = instr.opcode;
 
-		if (opcode < RandomX_CurrentConfig.CEIL_IADD_RS) {
+		if (opcode < compileConfig->CEIL_IADD_RS) {
 			auto dst = instr.dst % RegistersCount;
 			auto src = instr.src % RegistersCount;
 			ibc.type = InstructionType::IADD_RS;
@@ -100,7 +193,7 @@ namespace randomx {
 			return;
 		}
 
-		if (opcode < RandomX_CurrentConfig.CEIL_IADD_M) {
+		if (opcode < compileConfig->CEIL_IADD_M) {
 			auto dst = instr.dst % RegistersCount;
 			auto src = instr.src % RegistersCount;
 			ibc.type = InstructionType::IADD_M;
@@ -108,17 +201,17 @@ namespace randomx {
 			ibc.imm = signExtend2sCompl(instr.getImm32());
 			if (src != dst) {
 				ibc.isrc = &nreg->r[src];
-				ibc.memMask = (instr.getModMem() ? ScratchpadL1Mask : ScratchpadL2Mask);
+				ibc.memMask = (instr.getModMem() ? compileConfig->ScratchpadL1Mask_Calculated : compileConfig->ScratchpadL2Mask_Calculated);
 			}
 			else {
 				ibc.isrc = &zero;
-				ibc.memMask = ScratchpadL3Mask;
+				ibc.memMask = compileConfig->ScratchpadL3Mask_Calculated;
 			}
 			registerUsage[dst] = i;
 			return;
 		}
 
-		if (opcode < RandomX_CurrentConfig.CEIL_ISUB_R) {
+		if (opcode < compileConfig->CEIL_ISUB_R) {
 			auto dst = instr.dst % RegistersCount;
 			auto src = instr.src % RegistersCount;
 			ibc.type = InstructionType::ISUB_R;
@@ -134,7 +227,7 @@ namespace randomx {
 			return;
 		}
 
-		if (opcode < RandomX_CurrentConfig.CEIL_ISUB_M) {
+		if (opcode < compileConfig->CEIL_ISUB_M) {
 			auto dst = instr.dst % RegistersCount;
 			auto src = instr.src % RegistersCount;
 			ibc.type = InstructionType::ISUB_M;
@@ -142,17 +235,17 @@ namespace randomx {
 			ibc.imm = signExtend2sCompl(instr.getImm32());
 			if (src != dst) {
 				ibc.isrc = &nreg->r[src];
-				ibc.memMask = (instr.getModMem() ? ScratchpadL1Mask : ScratchpadL2Mask);
+				ibc.memMask = (instr.getModMem() ? compileConfig->ScratchpadL1Mask_Calculated : compileConfig->ScratchpadL2Mask_Calculated);
 			}
 			else {
 				ibc.isrc = &zero;
-				ibc.memMask = ScratchpadL3Mask;
+				ibc.memMask = compileConfig->ScratchpadL3Mask_Calculated;
 			}
 			registerUsage[dst] = i;
 			return;
 		}
 
-		if (opcode < RandomX_CurrentConfig.CEIL_IMUL_R) {
+		if (opcode < compileConfig->CEIL_IMUL_R) {
 			auto dst = instr.dst % RegistersCount;
 			auto src = instr.src % RegistersCount;
 			ibc.type = InstructionType::IMUL_R;
@@ -168,7 +261,7 @@ namespace randomx {
 			return;
 		}
 
-		if (opcode < RandomX_CurrentConfig.CEIL_IMUL_M) {
+		if (opcode < compileConfig->CEIL_IMUL_M) {
 			auto dst = instr.dst % RegistersCount;
 			auto src = instr.src % RegistersCount;
 			ibc.type = InstructionType::IMUL_M;
@@ -176,17 +269,17 @@ namespace randomx {
 			ibc.imm = signExtend2sCompl(instr.getImm32());
 			if (src != dst) {
 				ibc.isrc = &nreg->r[src];
-				ibc.memMask = (instr.getModMem() ? ScratchpadL1Mask : ScratchpadL2Mask);
+				ibc.memMask = (instr.getModMem() ? compileConfig->ScratchpadL1Mask_Calculated : compileConfig->ScratchpadL2Mask_Calculated);
 			}
 			else {
 				ibc.isrc = &zero;
-				ibc.memMask = ScratchpadL3Mask;
+				ibc.memMask = compileConfig->ScratchpadL3Mask_Calculated;
 			}
 			registerUsage[dst] = i;
 			return;
 		}
 
-		if (opcode < RandomX_CurrentConfig.CEIL_IMULH_R) {
+		if (opcode < compileConfig->CEIL_IMULH_R) {
 			auto dst = instr.dst % RegistersCount;
 			auto src = instr.src % RegistersCount;
 			ibc.type = InstructionType::IMULH_R;
@@ -196,7 +289,7 @@ namespace randomx {
 			return;
 		}
 
-		if (opcode < RandomX_CurrentConfig.CEIL_IMULH_M) {
+		if (opcode < compileConfig->CEIL_IMULH_M) {
 			auto dst = instr.dst % RegistersCount;
 			auto src = instr.src % RegistersCount;
 			ibc.type = InstructionType::IMULH_M;
@@ -204,17 +297,17 @@ namespace randomx {
 			ibc.imm = signExtend2sCompl(instr.getImm32());
 			if (src != dst) {
 				ibc.isrc = &nreg->r[src];
-				ibc.memMask = (instr.getModMem() ? ScratchpadL1Mask : ScratchpadL2Mask);
+				ibc.memMask = (instr.getModMem() ? compileConfig->ScratchpadL1Mask_Calculated : compileConfig->ScratchpadL2Mask_Calculated);
 			}
 			else {
 				ibc.isrc = &zero;
-				ibc.memMask = ScratchpadL3Mask;
+				ibc.memMask = compileConfig->ScratchpadL3Mask_Calculated;
 			}
 			registerUsage[dst] = i;
 			return;
 		}
 
-		if (opcode < RandomX_CurrentConfig.CEIL_ISMULH_R) {
+		if (opcode < compileConfig->CEIL_ISMULH_R) {
 			auto dst = instr.dst % RegistersCount;
 			auto src = instr.src % RegistersCount;
 			ibc.type = InstructionType::ISMULH_R;
@@ -224,7 +317,7 @@ namespace randomx {
 			return;
 		}
 
-		if (opcode < RandomX_CurrentConfig.CEIL_ISMULH_M) {
+		if (opcode < compileConfig->CEIL_ISMULH_M) {
 			auto dst = instr.dst % RegistersCount;
 			auto src = instr.src % RegistersCount;
 			ibc.type = InstructionType::ISMULH_M;
@@ -232,17 +325,17 @@ namespace randomx {
 			ibc.imm = signExtend2sCompl(instr.getImm32());
 			if (src != dst) {
 				ibc.isrc = &nreg->r[src];
-				ibc.memMask = (instr.getModMem() ? ScratchpadL1Mask : ScratchpadL2Mask);
+				ibc.memMask = (instr.getModMem() ? compileConfig->ScratchpadL1Mask_Calculated : compileConfig->ScratchpadL2Mask_Calculated);
 			}
 			else {
 				ibc.isrc = &zero;
-				ibc.memMask = ScratchpadL3Mask;
+				ibc.memMask = compileConfig->ScratchpadL3Mask_Calculated;
 			}
 			registerUsage[dst] = i;
 			return;
 		}
 
-		if (opcode < RandomX_CurrentConfig.CEIL_IMUL_RCP) {
+		if (opcode < compileConfig->CEIL_IMUL_RCP) {
 			uint64_t divisor = instr.getImm32();
 			if (!isZeroOrPowerOf2(divisor)) {
 				auto dst = instr.dst % RegistersCount;
@@ -258,7 +351,7 @@ namespace randomx {
 			return;
 		}
 
-		if (opcode < RandomX_CurrentConfig.CEIL_INEG_R) {
+		if (opcode < compileConfig->CEIL_INEG_R) {
 			auto dst = instr.dst % RegistersCount;
 			ibc.type = InstructionType::INEG_R;
 			ibc.idst = &nreg->r[dst];
@@ -266,7 +359,7 @@ namespace randomx {
 			return;
 		}
 
-		if (opcode < RandomX_CurrentConfig.CEIL_IXOR_R) {
+		if (opcode < compileConfig->CEIL_IXOR_R) {
 			auto dst = instr.dst % RegistersCount;
 			auto src = instr.src % RegistersCount;
 			ibc.type = InstructionType::IXOR_R;
@@ -282,7 +375,7 @@ namespace randomx {
 			return;
 		}
 
-		if (opcode < RandomX_CurrentConfig.CEIL_IXOR_M) {
+		if (opcode < compileConfig->CEIL_IXOR_M) {
 			auto dst = instr.dst % RegistersCount;
 			auto src = instr.src % RegistersCount;
 			ibc.type = InstructionType::IXOR_M;
@@ -290,17 +383,17 @@ namespace randomx {
 			ibc.imm = signExtend2sCompl(instr.getImm32());
 			if (src != dst) {
 				ibc.isrc = &nreg->r[src];
-				ibc.memMask = (instr.getModMem() ? ScratchpadL1Mask : ScratchpadL2Mask);
+				ibc.memMask = (instr.getModMem() ? compileConfig->ScratchpadL1Mask_Calculated : compileConfig->ScratchpadL2Mask_Calculated);
 			}
 			else {
 				ibc.isrc = &zero;
-				ibc.memMask = ScratchpadL3Mask;
+				ibc.memMask = compileConfig->ScratchpadL3Mask_Calculated;
 			}
 			registerUsage[dst] = i;
 			return;
 		}
 
-		if (opcode < RandomX_CurrentConfig.CEIL_IROR_R) {
+		if (opcode < compileConfig->CEIL_IROR_R) {
 			auto dst = instr.dst % RegistersCount;
 			auto src = instr.src % RegistersCount;
 			ibc.type = InstructionType::IROR_R;
@@ -316,7 +409,7 @@ namespace randomx {
 			return;
 		}
 
-		if (opcode < RandomX_CurrentConfig.CEIL_IROL_R) {
+		if (opcode < compileConfig->CEIL_IROL_R) {
 			auto dst = instr.dst % RegistersCount;
 			auto src = instr.src % RegistersCount;
 			ibc.type = InstructionType::IROL_R;
@@ -332,7 +425,7 @@ namespace randomx {
 			return;
 		}
 
-		if (opcode < RandomX_CurrentConfig.CEIL_ISWAP_R) {
+		if (opcode < compileConfig->CEIL_ISWAP_R) {
 			auto dst = instr.dst % RegistersCount;
 			auto src = instr.src % RegistersCount;
 			if (src != dst) {
@@ -348,7 +441,7 @@ namespace randomx {
 			return;
 		}
 
-		if (opcode < RandomX_CurrentConfig.CEIL_FSWAP_R) {
+		if (opcode < compileConfig->CEIL_FSWAP_R) {
 			auto dst = instr.dst % RegistersCount;
 			ibc.type = InstructionType::FSWAP_R;
 			if (dst < RegisterCountFlt)
@@ -358,7 +451,7 @@ namespace randomx {
 			return;
 		}
 
-		if (opcode < RandomX_CurrentConfig.CEIL_FADD_R) {
+		if (opcode < compileConfig->CEIL_FADD_R) {
 			auto dst = instr.dst % RegisterCountFlt;
 			auto src = instr.src % RegisterCountFlt;
 			ibc.type = InstructionType::FADD_R;
@@ -367,18 +460,18 @@ namespace randomx {
 			return;
 		}
 
-		if (opcode < RandomX_CurrentConfig.CEIL_FADD_M) {
+		if (opcode < compileConfig->CEIL_FADD_M) {
 			auto dst = instr.dst % RegisterCountFlt;
 			auto src = instr.src % RegistersCount;
 			ibc.type = InstructionType::FADD_M;
 			ibc.fdst = &nreg->f[dst];
 			ibc.isrc = &nreg->r[src];
-			ibc.memMask = (instr.getModMem() ? ScratchpadL1Mask : ScratchpadL2Mask);
+			ibc.memMask = (instr.getModMem() ? compileConfig->ScratchpadL1Mask_Calculated : compileConfig->ScratchpadL2Mask_Calculated);
 			ibc.imm = signExtend2sCompl(instr.getImm32());
 			return;
 		}
 
-		if (opcode < RandomX_CurrentConfig.CEIL_FSUB_R) {
+		if (opcode < compileConfig->CEIL_FSUB_R) {
 			auto dst = instr.dst % RegisterCountFlt;
 			auto src = instr.src % RegisterCountFlt;
 			ibc.type = InstructionType::FSUB_R;
@@ -387,25 +480,25 @@ namespace randomx {
 			return;
 		}
 
-		if (opcode < RandomX_CurrentConfig.CEIL_FSUB_M) {
+		if (opcode < compileConfig->CEIL_FSUB_M) {
 			auto dst = instr.dst % RegisterCountFlt;
 			auto src = instr.src % RegistersCount;
 			ibc.type = InstructionType::FSUB_M;
 			ibc.fdst = &nreg->f[dst];
 			ibc.isrc = &nreg->r[src];
-			ibc.memMask = (instr.getModMem() ? ScratchpadL1Mask : ScratchpadL2Mask);
+			ibc.memMask = (instr.getModMem() ? compileConfig->ScratchpadL1Mask_Calculated : compileConfig->ScratchpadL2Mask_Calculated);
 			ibc.imm = signExtend2sCompl(instr.getImm32());
 			return;
 		}
 
-		if (opcode < RandomX_CurrentConfig.CEIL_FSCAL_R) {
+		if (opcode < compileConfig->CEIL_FSCAL_R) {
 			auto dst = instr.dst % RegisterCountFlt;
 			ibc.fdst = &nreg->f[dst];
 			ibc.type = InstructionType::FSCAL_R;
 			return;
 		}
 
-		if (opcode < RandomX_CurrentConfig.CEIL_FMUL_R) {
+		if (opcode < compileConfig->CEIL_FMUL_R) {
 			auto dst = instr.dst % RegisterCountFlt;
 			auto src = instr.src % RegisterCountFlt;
 			ibc.type = InstructionType::FMUL_R;
@@ -414,35 +507,35 @@ namespace randomx {
 			return;
 		}
 
-		if (opcode < RandomX_CurrentConfig.CEIL_FDIV_M) {
+		if (opcode < compileConfig->CEIL_FDIV_M) {
 			auto dst = instr.dst % RegisterCountFlt;
 			auto src = instr.src % RegistersCount;
 			ibc.type = InstructionType::FDIV_M;
 			ibc.fdst = &nreg->e[dst];
 			ibc.isrc = &nreg->r[src];
-			ibc.memMask = (instr.getModMem() ? ScratchpadL1Mask : ScratchpadL2Mask);
+			ibc.memMask = (instr.getModMem() ? compileConfig->ScratchpadL1Mask_Calculated : compileConfig->ScratchpadL2Mask_Calculated);
 			ibc.imm = signExtend2sCompl(instr.getImm32());
 			return;
 		}
 
-		if (opcode < RandomX_CurrentConfig.CEIL_FSQRT_R) {
+		if (opcode < compileConfig->CEIL_FSQRT_R) {
 			auto dst = instr.dst % RegisterCountFlt;
 			ibc.type = InstructionType::FSQRT_R;
 			ibc.fdst = &nreg->e[dst];
 			return;
 		}
 
-		if (opcode < RandomX_CurrentConfig.CEIL_CBRANCH) {
+		if (opcode < compileConfig->CEIL_CBRANCH) {
 			ibc.type = InstructionType::CBRANCH;
 			//jump condition
 			int creg = instr.dst % RegistersCount;
 			ibc.idst = &nreg->r[creg];
 			ibc.target = registerUsage[creg];
-			int shift = instr.getModCond() + RandomX_CurrentConfig.JumpOffset;
+			int shift = instr.getModCond() + compileConfig->JumpOffset;
 			ibc.imm = signExtend2sCompl(instr.getImm32()) | (1ULL << shift);
-			if (RandomX_CurrentConfig.JumpOffset > 0 || shift > 0) //clear the bit below the condition mask - this limits the number of successive jumps to 2
+			if (compileConfig->JumpOffset > 0 || shift > 0) //clear the bit below the condition mask - this limits the number of successive jumps to 2
 				ibc.imm &= ~(1ULL << (shift - 1));
-			ibc.memMask = RandomX_CurrentConfig.ConditionMask_Calculated << shift;
+			ibc.memMask = compileConfig->ConditionMask_Calculated << shift;
 			//mark all registers as used
 			for (unsigned j = 0; j < RegistersCount; ++j) {
 				registerUsage[j] = i;
@@ -450,7 +543,7 @@ namespace randomx {
 			return;
 		}
 
-		if (opcode < RandomX_CurrentConfig.CEIL_CFROUND) {
+		if (opcode < compileConfig->CEIL_CFROUND) {
 			auto src = instr.src % RegistersCount;
 			ibc.isrc = &nreg->r[src];
 			ibc.type = InstructionType::CFROUND;
@@ -458,7 +551,7 @@ namespace randomx {
 			return;
 		}
 
-		if (opcode < RandomX_CurrentConfig.CEIL_ISTORE) {
+		if (opcode < compileConfig->CEIL_ISTORE) {
 			auto dst = instr.dst % RegistersCount;
 			auto src = instr.src % RegistersCount;
 			ibc.type = InstructionType::ISTORE;
@@ -466,13 +559,13 @@ namespace randomx {
 			ibc.isrc = &nreg->r[src];
 			ibc.imm = signExtend2sCompl(instr.getImm32());
 			if (instr.getModCond() < StoreL3Condition)
-				ibc.memMask = (instr.getModMem() ? ScratchpadL1Mask : ScratchpadL2Mask);
+				ibc.memMask = (instr.getModMem() ? compileConfig->ScratchpadL1Mask_Calculated : compileConfig->ScratchpadL2Mask_Calculated);
 			else
-				ibc.memMask = ScratchpadL3Mask;
+				ibc.memMask = compileConfig->ScratchpadL3Mask_Calculated;
 			return;
 		}
 
-		if (opcode < RandomX_CurrentConfig.CEIL_NOP) {
+		if (opcode < compileConfig->CEIL_NOP) {
 			ibc.type = InstructionType::NOP;
 			return;
 		}
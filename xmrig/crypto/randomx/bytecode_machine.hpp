@@ -33,6 +33,11 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "crypto/randomx/instruction.hpp"
 #include "crypto/randomx/program.hpp"
 
+//GCC and Clang run the bytecode direct threaded, with computed gotos
+#if defined(__GNUC__) && !defined(RANDOMX_NO_THREADED_BYTECODE)
+#define RANDOMX_THREADED_BYTECODE
+#endif
+
 namespace randomx {
 
 	//register file in machine byte order
@@ -62,6 +67,7 @@ namespace randomx {
 			uint16_t shift;
 		};
 		uint32_t memMask;
+		const void* handler; //set by threadBytecode
 	};
 
 #define RANDOMX_EXE_ARGS InstructionByteCode& ibc, int& pc, uint8_t* scratchpad, ProgramConfiguration& config
@@ -80,20 +86,29 @@ namespace randomx {
 			nreg = &regFile;
 		}
 
-		void compileProgram(Program& program, InstructionByteCode* bytecode, NativeRegisterFile& regFile) {
+		void compileProgram(Program& program, InstructionByteCode* bytecode, NativeRegisterFile& regFile, const RandomX_ConfigurationBase& config) {
 			beginCompilation(regFile);
-			for (unsigned i = 0; i < RandomX_CurrentConfig.ProgramSize; ++i) {
+			compileConfig = &config;
+			for (unsigned i = 0; i < config.ProgramSize; ++i) {
 				auto& instr = program(i);
 				auto& ibc = bytecode[i];
 				compileInstruction(instr, i, ibc);
 			}
+			threadBytecode(bytecode, config.ProgramSize);
 		}
 
-		static void executeBytecode(InstructionByteCode* bytecode, uint8_t* scratchpad, ProgramConfiguration& config) {
-			for (int pc = 0; pc < static_cast<int>(RandomX_CurrentConfig.ProgramSize); ++pc) {
+		//bytecode must have room for programSize + 1 instructions when threaded
+		static void threadBytecode(InstructionByteCode* bytecode, uint32_t programSize);
+
+		static void executeBytecode(InstructionByteCode* bytecode, uint8_t* scratchpad, ProgramConfiguration& config, uint32_t programSize) {
+#ifdef RANDOMX_THREADED_BYTECODE
+			executeThreaded(bytecode, scratchpad, &config);
+#else
+			for (int pc = 0; pc < static_cast<int>(programSize); ++pc) {
 				auto& ibc = bytecode[pc];
 				executeInstruction(ibc, pc, scratchpad, config);
 			}
+#endif
 		}
 
 		void compileInstruction(RANDOMX_GEN_ARGS)
@@ -244,12 +259,18 @@ namespace randomx {
 		static const int_reg_t zero;
 		int registerUsage[RegistersCount];
 		NativeRegisterFile* nreg;
+		const RandomX_ConfigurationBase* compileConfig;
 
 		static void* getScratchpadAddress(InstructionByteCode& ibc, uint8_t* scratchpad) {
 			uint32_t addr = (*ibc.isrc + ibc.imm) & ibc.memMask;
 			return scratchpad + addr;
 		}
 
+#ifdef RANDOMX_THREADED_BYTECODE
+		//returns the handler table if bytecode is nullptr
+		static const void* const* executeThreaded(InstructionByteCode* bytecode, uint8_t* scratchpad, ProgramConfiguration* config);
+#endif
+
 #ifdef RANDOMX_GEN_TABLE
 		static InstructionGenBytecode genTable[256];
 
@@ -47,12 +47,12 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "crypto/randomx/reciprocal.h"
 #include "crypto/randomx/blake2/endian.h"
 #include "crypto/randomx/argon2.h"
-#include "crypto/randomx/argon2_core.h"
+#include "crypto/randomx/argon2_cache.hpp"
 #include "crypto/randomx/jit_compiler.hpp"
 #include "crypto/randomx/intrin_portable.h"
+#include "crypto/randomx/timing.hpp"
 
 //static_assert(RANDOMX_ARGON_MEMORY % (RANDOMX_ARGON_LANES * ARGON2_SYNC_POINTS) == 0, "RANDOMX_ARGON_MEMORY - invalid value");
-static_assert(ARGON2_BLOCK_SIZE == randomx::ArgonBlockSize, "Unpexpected value of ARGON2_BLOCK_SIZE");
 
 namespace randomx {
 
@@ -67,62 +67,20 @@ namespace randomx {
 	template void deallocCache<DefaultAllocator>(randomx_cache* cache);
 	template void deallocCache<LargePageAllocator>(randomx_cache* cache);
 
-	void initCache(randomx_cache* cache, const void* key, size_t keySize) {
-		uint32_t memory_blocks, segment_length;
-		argon2_instance_t instance;
-		argon2_context context;
-
-		context.out = nullptr;
-		context.outlen = 0;
-		context.pwd = CONST_CAST(uint8_t *)key;
-		context.pwdlen = (uint32_t)keySize;
-		context.salt = CONST_CAST(uint8_t *)RandomX_CurrentConfig.ArgonSalt;
-		context.saltlen = (uint32_t)strlen(RandomX_CurrentConfig.ArgonSalt);
-		context.secret = NULL;
-		context.secretlen = 0;
-		context.ad = NULL;
-		context.adlen = 0;
-		context.t_cost = RandomX_CurrentConfig.ArgonIterations;
-		context.m_cost = RandomX_CurrentConfig.ArgonMemory;
-		context.lanes = RandomX_CurrentConfig.ArgonLanes;
-		context.threads = 1;
-		context.allocate_cbk = NULL;
-		context.free_cbk = NULL;
-		context.flags = ARGON2_DEFAULT_FLAGS;
-		context.version = ARGON2_VERSION_NUMBER;
-
-		/* 2. Align memory size */
-		/* Minimum memory_blocks = 8L blocks, where L is the number of lanes */
-		memory_blocks = context.m_cost;
-
-		segment_length = memory_blocks / (context.lanes * ARGON2_SYNC_POINTS);
-
-		instance.version = context.version;
-		instance.memory = NULL;
-		instance.passes = context.t_cost;
-		instance.memory_blocks = memory_blocks;
-		instance.segment_length = segment_length;
-		instance.lane_length = segment_length * ARGON2_SYNC_POINTS;
-		instance.lanes = context.lanes;
-		instance.threads = context.threads;
-		instance.type = Argon2_d;
-		instance.memory = (block*)cache->memory;
-
-		if (instance.threads > instance.lanes) {
-			instance.threads = instance.lanes;
-		}
-
-		/* 3. Initialization: Hashing inputs, allocating memory, filling first
-		 * blocks
-		 */
-		rxa2_argon_initialize(&instance, &context);
+	void deallocCacheExternal(randomx_cache* cache) {
+		if (cache->jit != nullptr)
+			delete cache->jit;
+	}
 
-		rxa2_fill_memory_blocks(&instance);
+	void initCache(randomx_cache* cache, const void* key, size_t keySize) {
+		const RandomX_ConfigurationBase& config = *cache->config;
+		RANDOMX_TIMED(TimingCacheInit, argon2FillCache(cache->memory, key, keySize, config.ArgonSalt, config.ArgonIterations, config.ArgonMemory, config.ArgonLanes));
 
+		TimingScope timing(TimingSuperscalarGenerate);
 		cache->reciprocalCache.clear();
 		randomx::Blake2Generator gen(key, keySize);
-		for (uint32_t i = 0; i < RandomX_CurrentConfig.CacheAccesses; ++i) {
-			randomx::generateSuperscalar(cache->programs[i], gen);
+		for (uint32_t i = 0; i < config.CacheAccesses; ++i) {
+			randomx::generateSuperscalar(cache->programs[i], gen, config);
 			for (unsigned j = 0; j < cache->programs[i].getSize(); ++j) {
 				auto& instr = cache->programs[i](j);
 				if ((SuperscalarInstructionType)instr.opcode == SuperscalarInstructionType::IMUL_RCP) {
@@ -136,10 +94,77 @@ namespace randomx {
 
 	void initCacheCompile(randomx_cache* cache, const void* key, size_t keySize) {
 		initCache(cache, key, keySize);
-		cache->jit->generateSuperscalarHash(cache->programs, cache->reciprocalCache);
+		cache->jit->setConfig(*cache->config);
+		RANDOMX_TIMED(TimingSuperscalarCompile, cache->jit->generateSuperscalarHash(cache->programs, cache->reciprocalCache));
 		cache->jit->generateDatasetInitCode();
 	}
 
+	//Programs are saved as size, address register and instructions each, then the reciprocals
+	size_t saveCachePrograms(randomx_cache* cache, uint8_t* out) {
+		size_t pos = 0;
+		auto save = [out, &pos](const void* data, size_t size) {
+			if (out != nullptr)
+				memcpy(out + pos, data, size);
+			pos += size;
+		};
+		for (uint32_t i = 0; i < cache->config->CacheAccesses; ++i) {
+			SuperscalarProgram& prog = cache->programs[i];
+			const uint32_t header[2] = { prog.getSize(), (uint32_t)prog.getAddressRegister() };
+			save(header, sizeof(header));
+			save(prog.programBuffer, prog.getSize() * sizeof(Instruction));
+		}
+		const uint32_t count = cache->reciprocalCache.size();
+		save(&count, sizeof(count));
+		save(cache->reciprocalCache.data(), count * sizeof(uint64_t));
+		return pos;
+	}
+
+	bool loadCachePrograms(randomx_cache* cache, const uint8_t* data, size_t size) {
+		size_t pos = 0;
+		auto load = [data, size, &pos](void* out, size_t count) {
+			if (count > size - pos)
+				return false;
+			memcpy(out, data + pos, count);
+			pos += count;
+			return true;
+		};
+		for (uint32_t i = 0; i < cache->config->CacheAccesses; ++i) {
+			SuperscalarProgram& prog = cache->programs[i];
+			uint32_t header[2];
+			if (!load(header, sizeof(header)) || header[0] == 0 || header[0] > SuperscalarMaxSize || header[1] >= RegistersCount)
+				return false;
+			if (!load(prog.programBuffer, header[0] * sizeof(Instruction)))
+				return false;
+			prog.setSize(header[0]);
+			prog.setAddressRegister(header[1]);
+		}
+		uint32_t count;
+		if (!load(&count, sizeof(count)) || count > size / sizeof(uint64_t))
+			return false;
+		cache->reciprocalCache.resize(count);
+		if (!load(cache->reciprocalCache.data(), count * sizeof(uint64_t)) || pos != size)
+			return false;
+
+		//the JIT compiler trusts register numbers and reciprocal indices
+		for (uint32_t i = 0; i < cache->config->CacheAccesses; ++i) {
+			SuperscalarProgram& prog = cache->programs[i];
+			for (unsigned j = 0; j < prog.getSize(); ++j) {
+				Instruction& instr = prog(j);
+				if (instr.opcode >= (uint8_t)SuperscalarInstructionType::COUNT || instr.dst >= RegistersCount || instr.src >= RegistersCount)
+					return false;
+				if ((SuperscalarInstructionType)instr.opcode == SuperscalarInstructionType::IMUL_RCP && instr.getImm32() >= count)
+					return false;
+			}
+		}
+
+		if (cache->jit != nullptr) {
+			cache->jit->setConfig(*cache->config);
+			RANDOMX_TIMED(TimingSuperscalarCompile, cache->jit->generateSuperscalarHash(cache->programs, cache->reciprocalCache));
+			cache->jit->generateDatasetInitCode();
+		}
+		return true;
+	}
+
 	constexpr uint64_t superscalarMul0 = 6364136223846793005ULL;
 	constexpr uint64_t superscalarAdd1 = 9298411001130361340ULL;
 	constexpr uint64_t superscalarAdd2 = 12065312585734608966ULL;
@@ -149,8 +174,8 @@ namespace randomx {
 	constexpr uint64_t superscalarAdd6 = 3398623926847679864ULL;
 	constexpr uint64_t superscalarAdd7 = 9549104520008361294ULL;
 
-	static inline uint8_t* getMixBlock(uint64_t registerValue, uint8_t *memory) {
-		const uint32_t mask = (RandomX_CurrentConfig.ArgonMemory * randomx::ArgonBlockSize) / CacheLineSize - 1;
+	static inline uint8_t* getMixBlock(uint64_t registerValue, uint8_t *memory, uint32_t argonMemory) {
+		const uint32_t mask = (argonMemory * randomx::ArgonBlockSize) / CacheLineSize - 1;
 		return memory + (registerValue & mask) * CacheLineSize;
 	}
 
@@ -166,8 +191,8 @@ namespace randomx {
 		rl[5] = rl[0] ^ superscalarAdd5;
 		rl[6] = rl[0] ^ superscalarAdd6;
 		rl[7] = rl[0] ^ superscalarAdd7;
-		for (unsigned i = 0; i < RandomX_CurrentConfig.CacheAccesses; ++i) {
-			mixBlock = getMixBlock(registerValue, cache->memory);
+		for (unsigned i = 0; i < cache->config->CacheAccesses; ++i) {
+			mixBlock = getMixBlock(registerValue, cache->memory, cache->config->ArgonMemory);
 			rx_prefetch_nta(mixBlock);
 			SuperscalarProgram& prog = cache->programs[i];
 
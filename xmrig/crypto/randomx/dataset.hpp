@@ -39,6 +39,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 struct randomx_dataset {
 	uint8_t* memory = nullptr;
 	randomx::DatasetDeallocFunc* dealloc;
+	const RandomX_ConfigurationBase* config = nullptr;
+	unsigned long itemCount = 0; //items there is memory for
 };
 
 /* Global scope for C binding */
@@ -50,6 +52,7 @@ struct randomx_cache {
 	randomx::DatasetInitFunc* datasetInit;
 	randomx::SuperscalarProgram programs[RANDOMX_CACHE_MAX_ACCESSES];
 	std::vector<uint64_t> reciprocalCache;
+	const RandomX_ConfigurationBase* config;
 
 	bool isInitialized() {
 		return programs[0].getSize() != 0;
@@ -67,14 +70,20 @@ namespace randomx {
 	template<class Allocator>
 	void deallocDataset(randomx_dataset* dataset) {
 		if (dataset->memory != nullptr)
-			Allocator::freeMemory(dataset->memory, RANDOMX_DATASET_MAX_SIZE);
+			Allocator::freeMemory(dataset->memory, dataset->itemCount * CacheLineSize);
 	}
 
+	inline void deallocDatasetExternal(randomx_dataset*) {} //memory is the caller's
+
 	template<class Allocator>
 	void deallocCache(randomx_cache* cache);
 
+	void deallocCacheExternal(randomx_cache* cache); //memory is the caller's
+
 	void initCache(randomx_cache*, const void*, size_t);
 	void initCacheCompile(randomx_cache*, const void*, size_t);
+	size_t saveCachePrograms(randomx_cache* cache, uint8_t* out);
+	bool loadCachePrograms(randomx_cache* cache, const uint8_t* data, size_t size);
 	void initDatasetItem(randomx_cache* cache, uint8_t* out, uint64_t blockNumber);
 	void initDataset(randomx_cache* cache, uint8_t* dataset, uint32_t startBlock, uint32_t endBlock);
 }
@@ -69,17 +69,18 @@ static const size_t MainLoopBegin = ((uint8_t*)randomx_program_aarch64_main_loop
 static const size_t PrologueSize = ((uint8_t*)randomx_program_aarch64_vm_instructions) - ((uint8_t*)randomx_program_aarch64);
 static const size_t ImulRcpLiteralsEnd = ((uint8_t*)randomx_program_aarch64_imul_rcp_literals_end) - ((uint8_t*)randomx_program_aarch64);
 
+// Sized for the largest configuration, so the code buffer fits any of them
 static size_t CalcDatasetItemSize()
 {
 	return
 	// Prologue
 	((uint8_t*)randomx_calc_dataset_item_aarch64_prefetch - (uint8_t*)randomx_calc_dataset_item_aarch64) + 
 	// Main loop
-	RandomX_CurrentConfig.CacheAccesses * (
+	RANDOMX_CACHE_MAX_ACCESSES * (
 		// Main loop prologue
 		((uint8_t*)randomx_calc_dataset_item_aarch64_mix - ((uint8_t*)randomx_calc_dataset_item_aarch64_prefetch)) + 4 +
 		// Inner main loop (instructions)
-		((RandomX_CurrentConfig.SuperscalarLatency * 3) + 2) * 16 +
+		((RANDOMX_SUPERSCALAR_MAX_LATENCY * 3) + 2) * 16 +
 		// Main loop epilogue
 		((uint8_t*)randomx_calc_dataset_item_aarch64_store_result - (uint8_t*)randomx_calc_dataset_item_aarch64_mix) + 4
 	) + 
@@ -108,10 +109,10 @@ void JitCompilerA64::generateProgram(Program& program, ProgramConfiguration& con
 	uint32_t codePos = MainLoopBegin + 4;
 
 	// and w16, w10, ScratchpadL3Mask64
-	emit32(0x121A0000 | 16 | (10 << 5) | ((RandomX_CurrentConfig.Log2_ScratchpadL3 - 7) << 10), code, codePos);
+	emit32(0x121A0000 | 16 | (10 << 5) | ((rxConfig->Log2_ScratchpadL3 - 7) << 10), code, codePos);
 
 	// and w17, w18, ScratchpadL3Mask64
-	emit32(0x121A0000 | 17 | (18 << 5) | ((RandomX_CurrentConfig.Log2_ScratchpadL3 - 7) << 10), code, codePos);
+	emit32(0x121A0000 | 17 | (18 << 5) | ((rxConfig->Log2_ScratchpadL3 - 7) << 10), code, codePos);
 
 	codePos = PrologueSize;
 	literalPos = ImulRcpLiteralsEnd;
@@ -120,7 +121,7 @@ void JitCompilerA64::generateProgram(Program& program, ProgramConfiguration& con
 	for (uint32_t i = 0; i < RegistersCount; ++i)
 		reg_changed_offset[i] = codePos;
 
-	for (uint32_t i = 0; i < program.getSize(); ++i)
+	for (uint32_t i = 0; i < rxConfig->ProgramSize; ++i)
 	{
 		Instruction& instr = program(i);
 		instr.src %= RegistersCount;
@@ -138,11 +139,11 @@ void JitCompilerA64::generateProgram(Program& program, ProgramConfiguration& con
 
 	// and w18, w18, CacheLineAlignMask
 	codePos = (((uint8_t*)randomx_program_aarch64_cacheline_align_mask1) - ((uint8_t*)randomx_program_aarch64));
-	emit32(0x121A0000 | 18 | (18 << 5) | ((RandomX_CurrentConfig.Log2_DatasetBaseSize - 7) << 10), code, codePos);
+	emit32(0x121A0000 | 18 | (18 << 5) | ((rxConfig->Log2_DatasetBaseSize - 7) << 10), code, codePos);
 
 	// and w10, w10, CacheLineAlignMask
 	codePos = (((uint8_t*)randomx_program_aarch64_cacheline_align_mask2) - ((uint8_t*)randomx_program_aarch64));
-	emit32(0x121A0000 | 10 | (10 << 5) | ((RandomX_CurrentConfig.Log2_DatasetBaseSize - 7) << 10), code, codePos);
+	emit32(0x121A0000 | 10 | (10 << 5) | ((rxConfig->Log2_DatasetBaseSize - 7) << 10), code, codePos);
 
 	// Update spMix1
 	// eor x10, config.readReg0, config.readReg1
@@ -154,15 +155,15 @@ void JitCompilerA64::generateProgram(Program& program, ProgramConfiguration& con
 #endif
 }
 
-void JitCompilerA64::generateProgramLight(Program& program, ProgramConfiguration& config, uint32_t datasetOffset)
+void JitCompilerA64::generateProgramLight(Program& program, ProgramConfiguration& config, uint32_t datasetOffset, const uint8_t*, uint32_t)
 {
 	uint32_t codePos = MainLoopBegin + 4;
 
 	// and w16, w10, ScratchpadL3Mask64
-	emit32(0x121A0000 | 16 | (10 << 5) | ((RandomX_CurrentConfig.Log2_ScratchpadL3 - 7) << 10), code, codePos);
+	emit32(0x121A0000 | 16 | (10 << 5) | ((rxConfig->Log2_ScratchpadL3 - 7) << 10), code, codePos);
 
 	// and w17, w18, ScratchpadL3Mask64
-	emit32(0x121A0000 | 17 | (18 << 5) | ((RandomX_CurrentConfig.Log2_ScratchpadL3 - 7) << 10), code, codePos);
+	emit32(0x121A0000 | 17 | (18 << 5) | ((rxConfig->Log2_ScratchpadL3 - 7) << 10), code, codePos);
 
 	codePos = PrologueSize;
 	literalPos = ImulRcpLiteralsEnd;
@@ -171,7 +172,7 @@ void JitCompilerA64::generateProgramLight(Program& program, ProgramConfiguration
 	for (uint32_t i = 0; i < RegistersCount; ++i)
 		reg_changed_offset[i] = codePos;
 
-	for (uint32_t i = 0; i < program.getSize(); ++i)
+	for (uint32_t i = 0; i < rxConfig->ProgramSize; ++i)
 	{
 		Instruction& instr = program(i);
 		instr.src %= RegistersCount;
@@ -189,7 +190,7 @@ void JitCompilerA64::generateProgramLight(Program& program, ProgramConfiguration
 
 	// and w2, w9, CacheLineAlignMask
 	codePos = (((uint8_t*)randomx_program_aarch64_light_cacheline_align_mask) - ((uint8_t*)randomx_program_aarch64));
-	emit32(0x121A0000 | 2 | (9 << 5) | ((RandomX_CurrentConfig.Log2_DatasetBaseSize - 7) << 10), code, codePos);
+	emit32(0x121A0000 | 2 | (9 << 5) | ((rxConfig->Log2_DatasetBaseSize - 7) << 10), code, codePos);
 
 	// Update spMix1
 	// eor x10, config.readReg0, config.readReg1
@@ -224,10 +225,10 @@ void JitCompilerA64::generateSuperscalarHash(SuperscalarProgram(&programs)[N], s
 	num32bitLiterals = 64;
 	constexpr uint32_t tmp_reg = 12;
 
-	for (size_t i = 0; i < RandomX_CurrentConfig.CacheAccesses; ++i)
+	for (size_t i = 0; i < rxConfig->CacheAccesses; ++i)
 	{
 		// and x11, x10, CacheSize / CacheLineSize - 1
-		emit32(0x92400000 | 11 | (10 << 5) | ((RandomX_CurrentConfig.Log2_CacheSize - 1) << 10), code, codePos);
+		emit32(0x92400000 | 11 | (10 << 5) | ((rxConfig->Log2_CacheSize - 1) << 10), code, codePos);
 
 		p1 = ((uint8_t*)randomx_calc_dataset_item_aarch64_prefetch) + 4;
 		p2 = (uint8_t*)randomx_calc_dataset_item_aarch64_mix;
@@ -433,12 +434,12 @@ void JitCompilerA64::emitMemLoad(uint32_t dst, uint32_t src, Instruction& instr,
 
 	if (src != dst)
 	{
-		imm &= instr.getModMem() ? (RandomX_CurrentConfig.ScratchpadL1_Size - 1) : (RandomX_CurrentConfig.ScratchpadL2_Size - 1);
+		imm &= instr.getModMem() ? (rxConfig->ScratchpadL1_Size - 1) : (rxConfig->ScratchpadL2_Size - 1);
 		emitAddImmediate(tmp_reg, src, imm, code, k);
 
 		constexpr uint32_t t = 0x927d0000 | tmp_reg | (tmp_reg << 5);
-		const uint32_t andInstrL1 = t | ((RandomX_CurrentConfig.Log2_ScratchpadL1 - 4) << 10);
-		const uint32_t andInstrL2 = t | ((RandomX_CurrentConfig.Log2_ScratchpadL2 - 4) << 10);
+		const uint32_t andInstrL1 = t | ((rxConfig->Log2_ScratchpadL1 - 4) << 10);
+		const uint32_t andInstrL2 = t | ((rxConfig->Log2_ScratchpadL2 - 4) << 10);
 
 		emit32(instr.getModMem() ? andInstrL1 : andInstrL2, code, k);
 
@@ -465,12 +466,12 @@ void JitCompilerA64::emitMemLoadFP(uint32_t src, Instruction& instr, uint8_t* co
 	uint32_t imm = instr.getImm32();
 	constexpr uint32_t tmp_reg = 18;
 
-	imm &= instr.getModMem() ? (RandomX_CurrentConfig.ScratchpadL1_Size - 1) : (RandomX_CurrentConfig.ScratchpadL2_Size - 1);
+	imm &= instr.getModMem() ? (rxConfig->ScratchpadL1_Size - 1) : (rxConfig->ScratchpadL2_Size - 1);
 	emitAddImmediate(tmp_reg, src, imm, code, k);
 
 	constexpr uint32_t t = 0x927d0000 | tmp_reg | (tmp_reg << 5);
-	const uint32_t andInstrL1 = t | ((RandomX_CurrentConfig.Log2_ScratchpadL1 - 4) << 10);
-	const uint32_t andInstrL2 = t | ((RandomX_CurrentConfig.Log2_ScratchpadL2 - 4) << 10);
+	const uint32_t andInstrL1 = t | ((rxConfig->Log2_ScratchpadL1 - 4) << 10);
+	const uint32_t andInstrL2 = t | ((rxConfig->Log2_ScratchpadL2 - 4) << 10);
 
 	emit32(instr.getModMem() ? andInstrL1 : andInstrL2, code, k);
 
@@ -937,7 +938,7 @@ void JitCompilerA64::h_CBRANCH(Instruction& instr, uint32_t& codePos)
 
 	const uint32_t dst = IntRegMap[instr.dst];
 	const uint32_t modCond = instr.getModCond();
-	const uint32_t shift = modCond + RandomX_CurrentConfig.JumpOffset;
+	const uint32_t shift = modCond + rxConfig->JumpOffset;
 	const uint32_t imm = (instr.getImm32() | (1U << shift)) & ~(1U << (shift - 1));
 
 	emitAddImmediate(dst, dst, imm, code, k);
@@ -992,16 +993,16 @@ void JitCompilerA64::h_ISTORE(Instruction& instr, uint32_t& codePos)
 	uint32_t imm = instr.getImm32();
 
 	if (instr.getModCond() < StoreL3Condition)
-		imm &= instr.getModMem() ? (RandomX_CurrentConfig.ScratchpadL1_Size - 1) : (RandomX_CurrentConfig.ScratchpadL2_Size - 1);
+		imm &= instr.getModMem() ? (rxConfig->ScratchpadL1_Size - 1) : (rxConfig->ScratchpadL2_Size - 1);
 	else
-		imm &= RandomX_CurrentConfig.ScratchpadL3_Size - 1;
+		imm &= rxConfig->ScratchpadL3_Size - 1;
 
 	emitAddImmediate(tmp_reg, dst, imm, code, k);
 
 	constexpr uint32_t t = 0x927d0000 | tmp_reg | (tmp_reg << 5);
-	const uint32_t andInstrL1 = t | ((RandomX_CurrentConfig.Log2_ScratchpadL1 - 4) << 10);
-	const uint32_t andInstrL2 = t | ((RandomX_CurrentConfig.Log2_ScratchpadL2 - 4) << 10);
-	const uint32_t andInstrL3 = t | ((RandomX_CurrentConfig.Log2_ScratchpadL3 - 4) << 10);
+	const uint32_t andInstrL1 = t | ((rxConfig->Log2_ScratchpadL1 - 4) << 10);
+	const uint32_t andInstrL2 = t | ((rxConfig->Log2_ScratchpadL2 - 4) << 10);
+	const uint32_t andInstrL3 = t | ((rxConfig->Log2_ScratchpadL3 - 4) << 10);
 
 	emit32((instr.getModCond() < StoreL3Condition) ? (instr.getModMem() ? andInstrL1 : andInstrL2) : andInstrL3, code, k);
 
@@ -1015,6 +1016,45 @@ void JitCompilerA64::h_NOP(Instruction& instr, uint32_t& codePos)
 {
 }
 
-InstructionGeneratorA64 JitCompilerA64::engine[256] = {};
+void JitCompilerA64::setConfig(const RandomX_ConfigurationBase& config)
+{
+	if (rxConfig == &config)
+		return;
+	rxConfig = &config;
+
+	int k = 0;
+#define INST_HANDLE(x) for (; k < config.CEIL_##x; ++k) engine[k] = &JitCompilerA64::h_##x;
+	INST_HANDLE(IADD_RS);
+	INST_HANDLE(IADD_M);
+	INST_HANDLE(ISUB_R);
+	INST_HANDLE(ISUB_M);
+	INST_HANDLE(IMUL_R);
+	INST_HANDLE(IMUL_M);
+	INST_HANDLE(IMULH_R);
+	INST_HANDLE(IMULH_M);
+	INST_HANDLE(ISMULH_R);
+	INST_HANDLE(ISMULH_M);
+	INST_HANDLE(IMUL_RCP);
+	INST_HANDLE(INEG_R);
+	INST_HANDLE(IXOR_R);
+	INST_HANDLE(IXOR_M);
+	INST_HANDLE(IROR_R);
+	INST_HANDLE(IROL_R);
+	INST_HANDLE(ISWAP_R);
+	INST_HANDLE(FSWAP_R);
+	INST_HANDLE(FADD_R);
+	INST_HANDLE(FADD_M);
+	INST_HANDLE(FSUB_R);
+	INST_HANDLE(FSUB_M);
+	INST_HANDLE(FSCAL_R);
+	INST_HANDLE(FMUL_R);
+	INST_HANDLE(FDIV_M);
+	INST_HANDLE(FSQRT_R);
+	INST_HANDLE(CBRANCH);
+	INST_HANDLE(CFROUND);
+	INST_HANDLE(ISTORE);
+	INST_HANDLE(NOP);
+#undef INST_HANDLE
+}
 
 }
@@ -50,19 +50,21 @@ namespace randomx {
 		~JitCompilerA64();
 
 		void generateProgram(Program&, ProgramConfiguration&);
-		void generateProgramLight(Program&, ProgramConfiguration&, uint32_t);
+		void generateProgramLight(Program&, ProgramConfiguration&, uint32_t, const uint8_t*, uint32_t);
 
 		template<size_t N>
 		void generateSuperscalarHash(SuperscalarProgram(&programs)[N], std::vector<uint64_t> &);
 
 		void generateDatasetInitCode() {}
+		void setConfig(const RandomX_ConfigurationBase& config);
 
 		ProgramFunc* getProgramFunc() { return reinterpret_cast<ProgramFunc*>(code); }
 		DatasetInitFunc* getDatasetInitFunc();
 		uint8_t* getCode() { return code; }
 		size_t getCodeSize();
 
-		static InstructionGeneratorA64 engine[256];
+		const RandomX_ConfigurationBase* rxConfig = nullptr;
+		InstructionGeneratorA64 engine[256];
 		uint32_t reg_changed_offset[8];
 		uint8_t* code;
 		uint32_t literalPos;
@@ -47,7 +47,7 @@ namespace randomx {
 		void generateProgram(Program&, ProgramConfiguration&) {
 
 		}
-		void generateProgramLight(Program&, ProgramConfiguration&, uint32_t) {
+		void generateProgramLight(Program&, ProgramConfiguration&, uint32_t, const uint8_t*, uint32_t) {
 
 		}
 		template<size_t N>
@@ -56,6 +56,9 @@ namespace randomx {
 		}
 		void generateDatasetInitCode() {
 
+		}
+		void setConfig(const RandomX_ConfigurationBase&) {
+
 		}
 		ProgramFunc* getProgramFunc() {
 			return nullptr;
@@ -111,6 +111,17 @@ namespace randomx {
 	const int32_t epilogueOffset = CodeSize - epilogueSize;
 	constexpr int32_t superScalarHashOffset = 32768;
 
+	// the light pipeline computes the item number itself instead of the tail of
+	// randomx_program_read_dataset_sshash_init (mov ebx, ebp; and ebx, mask; shr ebx, 6)
+	constexpr int32_t readDatasetLightItemSize = 11;
+
+	// Stack slots of the light pipeline: the parked state (r0-r7 and the cache
+	// line of its next load) of the item carried over to the next iteration, the
+	// number of the item to start and the parked state of the item to finish
+	constexpr int32_t laneCarried = 0;
+	constexpr int32_t laneFinished = 80;
+	constexpr int32_t pipelineFrameSize = 160;
+
 	static const uint8_t REX_ADD_RR[] = { 0x4d, 0x03 };
 	static const uint8_t REX_ADD_RM[] = { 0x4c, 0x03 };
 	static const uint8_t REX_SUB_RR[] = { 0x4d, 0x2b };
@@ -187,7 +198,38 @@ namespace randomx {
 	static const uint8_t LEA_32[] = { 0x41, 0x8d };
 	static const uint8_t MOVNTI[] = { 0x4c, 0x0f, 0xc3 };
 	static const uint8_t ADD_EBX_I[] = { 0x81, 0xc3 };
+	static const uint8_t CMP_EBX_I[] = { 0x81, 0xfb };
+	static const uint8_t JAE_SHORT = 0x73;
+	static const uint8_t JMP_SHORT = 0xeb;
+	static const uint8_t SHL_RBX_6[] = { 0x48, 0xc1, 0xe3, 0x06 };
+	static const uint8_t MOV_RCX_I64[] = { 0x48, 0xb9 };
+	static const uint8_t MOV_RDX_MX_AND_EDX_I[] = { 0x48, 0x89, 0xea, 0x48, 0xc1, 0xea, 0x20, 0x81, 0xe2 };
+	static const uint8_t PREFETCHNTA_RCX_RDX[] = { 0x0f, 0x18, 0x04, 0x11 };
+	// add rbx, rcx; mov r8-r15, [rbx+0..56]
+	static const uint8_t LOAD_DATASET_LINE_RBX[] = {
+		0x48, 0x01, 0xcb,
+		0x4c, 0x8b, 0x03, 0x4c, 0x8b, 0x4b, 0x08, 0x4c, 0x8b, 0x53, 0x10, 0x4c, 0x8b, 0x5b, 0x18,
+		0x4c, 0x8b, 0x63, 0x20, 0x4c, 0x8b, 0x6b, 0x28, 0x4c, 0x8b, 0x73, 0x30, 0x4c, 0x8b, 0x7b, 0x38
+	};
 
+	static const uint8_t SUB_RSP_I[] = { 0x48, 0x81, 0xec };
+	static const uint8_t ADD_RSP_I[] = { 0x48, 0x81, 0xc4 };
+	static const uint8_t PUSH_RAX_RDX_RBX[] = { 0x50, 0x52, 0x53 };
+	static const uint8_t POP_RBX_RDX_RAX[] = { 0x5b, 0x5a, 0x58 };
+	static const uint8_t LEA_RCX_RSP_I8[] = { 0x48, 0x8d, 0x4c, 0x24 };
+	static const uint8_t MOV_RBX_RBP_HI_AND_EBX_I[] = { 0x48, 0x89, 0xeb, 0x48, 0xc1, 0xeb, 0x20, 0x81, 0xe3 };
+	static const uint8_t SHR_EBX_6[] = { 0xc1, 0xeb, 0x06 };
+	static const uint8_t MOV_EDX_EBP_AND_EDX_I[] = { 0x89, 0xea, 0x81, 0xe2 };
+	static const uint8_t SHR_EDX_6[] = { 0xc1, 0xea, 0x06 };
+	static const uint8_t ADD_EDX_I[] = { 0x81, 0xc2 };
+	static const uint8_t CMP_EDX_I[] = { 0x81, 0xfa };
+	static const uint8_t MOV_EBX_EDX[] = { 0x89, 0xd3 };
+	static const uint8_t PUSH_RDX = 0x52;
+	static const uint8_t POP_RDX = 0x5a;
+	static const uint8_t JB_SHORT = 0x72;
+	static const uint8_t MOV_RCX_72_RBX[] = { 0x48, 0x89, 0x59, 0x48 };
+	static const uint8_t MOV_RBX_RCX_72[] = { 0x48, 0x8b, 0x59, 0x48 };
+	static const uint8_t XOR_R8_R15[] = { 0x4d, 0x31, 0xc0, 0x4d, 0x31, 0xc9, 0x4d, 0x31, 0xd2, 0x4d, 0x31, 0xdb, 0x4d, 0x31, 0xe4, 0x4d, 0x31, 0xed, 0x4d, 0x31, 0xf6, 0x4d, 0x31, 0xff };
 	static const uint8_t NOP1[] = { 0x90 };
 	static const uint8_t NOP2[] = { 0x66, 0x90 };
 	static const uint8_t NOP3[] = { 0x66, 0x66, 0x90 };
@@ -204,65 +246,316 @@ namespace randomx {
 	}
 
 	JitCompilerX86::JitCompilerX86() {
-		code = (uint8_t*)allocExecutableMemory(CodeSize);
+		//code is emitted through a writable view of the memory and run through an executable one
+		void* writable;
+		codeExec = (uint8_t*)allocDualMappedMemory(CodeSize, &writable);
+		code = (uint8_t*)writable;
 		memcpy(code, codePrologue, prologueSize);
 		memcpy(code + epilogueOffset, codeEpilogue, epilogueSize);
 	}
 
 	JitCompilerX86::~JitCompilerX86() {
-		freePagedMemory(code, CodeSize);
+		freeDualMappedMemory(codeExec, code, CodeSize);
 	}
 
 	void JitCompilerX86::generateProgram(Program& prog, ProgramConfiguration& pcfg) {
+		loopBegin = prologueSize;
 		generateProgramPrologue(prog, pcfg);
-		memcpy(code + codePos, RandomX_CurrentConfig.codeReadDatasetTweaked, readDatasetSize);
+		memcpy(code + codePos, rxConfig->codeReadDatasetTweaked, readDatasetSize);
 		codePos += readDatasetSize;
 		generateProgramEpilogue(prog, pcfg);
 	}
 
-	void JitCompilerX86::generateProgramLight(Program& prog, ProgramConfiguration& pcfg, uint32_t datasetOffset) {
+	void JitCompilerX86::generateProgramLight(Program& prog, ProgramConfiguration& pcfg, uint32_t datasetOffset, const uint8_t* datasetMemory, uint32_t datasetItems) {
+		loopBegin = prologueSize;
+		if (superScalarHashPipelinedOffset > 0) {
+			generateProgramLightPipelined(prog, pcfg, datasetOffset, datasetMemory, datasetItems);
+			return;
+		}
 		generateProgramPrologue(prog, pcfg);
-		emit(RandomX_CurrentConfig.codeReadDatasetLightSshInitTweaked, readDatasetLightInitSize, code, codePos);
+		emit(rxConfig->codeReadDatasetLightSshInitTweaked, readDatasetLightInitSize, code, codePos);
 		emit(ADD_EBX_I, code, codePos);
 		emit32(datasetOffset / CacheLineSize, code, codePos);
+		if (datasetItems > 0) {
+			//items of the partial dataset are loaded instead of computed, the next one prefetched
+			emit(MOV_RCX_I64, code, codePos);
+			emit64((uint64_t)(datasetMemory + datasetOffset), code, codePos);
+			emit(MOV_RDX_MX_AND_EDX_I, code, codePos);
+			emit32(rxConfig->DatasetBaseSize - RANDOMX_DATASET_ITEM_SIZE, code, codePos);
+			emit(PREFETCHNTA_RCX_RDX, code, codePos);
+			emit(CMP_EBX_I, code, codePos);
+			emit32(datasetItems, code, codePos);
+			emitByte(JAE_SHORT, code, codePos);
+			emitByte(sizeof(SHL_RBX_6) + sizeof(MOV_RCX_I64) + 8 + sizeof(LOAD_DATASET_LINE_RBX) + 2, code, codePos);
+			emit(SHL_RBX_6, code, codePos);
+			emit(MOV_RCX_I64, code, codePos);
+			emit64((uint64_t)datasetMemory, code, codePos);
+			emit(LOAD_DATASET_LINE_RBX, code, codePos);
+			emitByte(JMP_SHORT, code, codePos);
+			emitByte(5, code, codePos);
+		}
 		emitByte(CALL, code, codePos);
 		emit32(superScalarHashOffset - (codePos + 4), code, codePos);
 		emit(codeReadDatasetLightSshFin, readDatasetLightFinSize, code, codePos);
 		generateProgramEpilogue(prog, pcfg);
 	}
 
+	// Light mode with the SuperscalarHash pipelined. The item read at the end of
+	// an iteration is the one whose address ("mx") the iteration before computed,
+	// so its hash is started one iteration early: every iteration finishes the
+	// second half of its own item interleaved with the first half of the next
+	// one, which keeps two independent dependency chains and cache misses in
+	// flight. Items of a partial dataset are loaded instead, the items next to
+	// them only started or finished.
+	void JitCompilerX86::generateProgramLightPipelined(Program& prog, ProgramConfiguration& pcfg, uint32_t datasetOffset, const uint8_t* datasetMemory, uint32_t datasetItems) {
+		const uint32_t datasetBaseMask = rxConfig->DatasetBaseSize - RANDOMX_DATASET_ITEM_SIZE;
+		const uint32_t itemOffset = datasetOffset / CacheLineSize;
+
+		//stack slots of the lanes, then the item of the first iteration ("ma") started
+		codePos = prologueSize;
+		emit(SUB_RSP_I, code, codePos);
+		emit32(pipelineFrameSize, code, codePos);
+		emit(PUSH_RAX_RDX_RBX, code, codePos);
+		emit(LEA_RCX_RSP_I8, code, codePos);
+		emitByte(24, code, codePos);
+		emit(MOV_RBX_RBP_HI_AND_EBX_I, code, codePos);
+		emit32(datasetBaseMask, code, codePos);
+		emit(SHR_EBX_6, code, codePos);
+		emit(ADD_EBX_I, code, codePos);
+		emit32(itemOffset, code, codePos);
+		int32_t skipStart = 0;
+		if (datasetItems > 0) {
+			emit(CMP_EBX_I, code, codePos);
+			emit32(datasetItems, code, codePos);
+			skipStart = emitJumpShort(JB_SHORT);
+		}
+		emitCall(superScalarHashStartOffset);
+		if (datasetItems > 0)
+			patchJumpShort(skipStart);
+		emit(POP_RBX_RDX_RAX, code, codePos);
+		emit(XOR_R8_R15, code, codePos);
+		loopBegin = codePos;
+
+		generateProgramPrologue(prog, pcfg);
+		emit(rxConfig->codeReadDatasetLightSshInitTweaked, readDatasetLightInitSize - readDatasetLightItemSize, code, codePos);
+		if (datasetItems > 0) {
+			emit(MOV_RCX_I64, code, codePos);
+			emit64((uint64_t)(datasetMemory + datasetOffset), code, codePos);
+			emit(MOV_RDX_MX_AND_EDX_I, code, codePos);
+			emit32(datasetBaseMask, code, codePos);
+			emit(PREFETCHNTA_RCX_RDX, code, codePos);
+		}
+
+		//after swapping "ma" and "mx", "mx" is the item of the next iteration
+		emit(MOV_RBX_RBP_HI_AND_EBX_I, code, codePos);
+		emit32(datasetBaseMask, code, codePos);
+		emit(SHR_EBX_6, code, codePos);
+		emit(ADD_EBX_I, code, codePos);
+		emit32(itemOffset, code, codePos);
+		emit(LEA_RCX_RSP_I8, code, codePos);
+		emitByte(72 + 16, code, codePos);
+		if (datasetItems == 0) {
+			emitCall(superScalarHashPipelinedOffset);
+		}
+		else {
+			emit(MOV_EDX_EBP_AND_EDX_I, code, codePos);
+			emit32(datasetBaseMask, code, codePos);
+			emit(SHR_EDX_6, code, codePos);
+			emit(ADD_EDX_I, code, codePos);
+			emit32(itemOffset, code, codePos);
+			emit(CMP_EDX_I, code, codePos);
+			emit32(datasetItems, code, codePos);
+			const int32_t computed = emitJumpShort(JAE_SHORT);
+
+			//this iteration's item is loaded, the next one started unless it is loaded too
+			emit(CMP_EBX_I, code, codePos);
+			emit32(datasetItems, code, codePos);
+			skipStart = emitJumpShort(JB_SHORT);
+			emitByte(PUSH_RDX, code, codePos);
+			emitCall(superScalarHashStartOffset);
+			emitByte(POP_RDX, code, codePos);
+			patchJumpShort(skipStart);
+			emit(MOV_EBX_EDX, code, codePos);
+			emit(SHL_RBX_6, code, codePos);
+			emit(MOV_RCX_I64, code, codePos);
+			emit64((uint64_t)datasetMemory, code, codePos);
+			emit(LOAD_DATASET_LINE_RBX, code, codePos);
+			const int32_t loaded = emitJumpShort(JMP_SHORT);
+
+			//this iteration's item is finished, interleaved with the next one unless that is loaded
+			patchJumpShort(computed);
+			emit(CMP_EBX_I, code, codePos);
+			emit32(datasetItems, code, codePos);
+			const int32_t both = emitJumpShort(JAE_SHORT);
+			emitCall(superScalarHashFinishOffset);
+			const int32_t finished = emitJumpShort(JMP_SHORT);
+			patchJumpShort(both);
+			emitCall(superScalarHashPipelinedOffset);
+			patchJumpShort(loaded);
+			patchJumpShort(finished);
+		}
+		emit(codeReadDatasetLightSshFin, readDatasetLightFinSize, code, codePos);
+		generateProgramEpilogue(prog, pcfg);
+	}
+
 	template<size_t N>
 	void JitCompilerX86::generateSuperscalarHash(SuperscalarProgram(&programs)[N], std::vector<uint64_t> &reciprocalCache) {
+		const unsigned n = rxConfig->CacheAccesses;
 		memcpy(code + superScalarHashOffset, codeShhInit, codeSshInitSize);
 		codePos = superScalarHashOffset + codeSshInitSize;
-		for (unsigned j = 0; j < RandomX_CurrentConfig.CacheAccesses; ++j) {
-			SuperscalarProgram& prog = programs[j];
-			for (unsigned i = 0; i < prog.getSize(); ++i) {
-				Instruction& instr = prog(i);
-				generateSuperscalarCode(instr, reciprocalCache);
+		for (unsigned j = 0; j < n; ++j) {
+			generateSuperscalarProgram(programs[j], j == n - 1, reciprocalCache);
+		}
+		emitByte(RET, code, codePos);
+
+		superScalarHashPipelinedOffset = 0;
+		if (n < 2)
+			return;
+		superScalarHashStartOffset = generateSuperscalarHashPipelined(programs, false, true, reciprocalCache);
+		superScalarHashFinishOffset = generateSuperscalarHashPipelined(programs, true, false, reciprocalCache);
+		superScalarHashPipelinedOffset = generateSuperscalarHashPipelined(programs, true, true, reciprocalCache);
+	}
+
+	// Pipelined SuperscalarHash of light mode, split after h = n / 2 programs. It
+	// finishes the item parked in the carried slot (programs h to n - 1) and/or
+	// runs the first h programs of item rbx, which it parks there in turn. Both
+	// lanes are swapped through the slots rcx points to after every program.
+	int32_t JitCompilerX86::generateSuperscalarHashPipelined(SuperscalarProgram* programs, bool finish, bool start, std::vector<uint64_t> &reciprocalCache) {
+		const unsigned n = rxConfig->CacheAccesses;
+		const unsigned h = n / 2;
+		codePos = (codePos + 63) & ~63;
+		const int32_t offset = codePos;
+		if (finish) {
+			if (start)
+				emit(MOV_RCX_72_RBX, code, codePos);
+			emitLaneMove(false, laneCarried);
+		}
+		for (unsigned k = 0; k < n - h; ++k) {
+			if (finish)
+				generateSuperscalarProgram(programs[h + k], h + k == n - 1, reciprocalCache);
+			if (!start || k >= h)
+				continue;
+			if (finish)
+				emitLaneMove(true, laneFinished);
+			if (k == 0) {
+				if (finish)
+					emit(MOV_RBX_RCX_72, code, codePos);
+				emit(codeShhInit, codeSshInitSize, code, codePos);
 			}
-			emit(codeShhLoad, codeSshLoadSize, code, codePos);
-			if (j < RandomX_CurrentConfig.CacheAccesses - 1) {
-				emit(REX_MOV_RR64, code, codePos);
-				emitByte(0xd8 + prog.getAddressRegister(), code, codePos);
-				emit(RandomX_CurrentConfig.codeShhPrefetchTweaked, codeSshPrefetchSize, code, codePos);
+			else if (finish) {
+				emitLaneMove(false, laneCarried);
+			}
+			generateSuperscalarProgram(programs[k], false, reciprocalCache);
+			if (finish) {
+				emitLaneMove(true, laneCarried);
+				emitLaneMove(false, laneFinished);
+			}
+		}
+		if (!finish)
+			emitLaneMove(true, laneCarried);
+		emitByte(RET, code, codePos);
+		return offset;
+	}
+
+	void JitCompilerX86::generateSuperscalarProgram(SuperscalarProgram& prog, bool last, std::vector<uint64_t> &reciprocalCache) {
+		for (unsigned i = 0; i < prog.getSize(); ++i) {
+			Instruction& instr = prog(i);
+			generateSuperscalarCode(instr, reciprocalCache);
+		}
+		emit(codeShhLoad, codeSshLoadSize, code, codePos);
+		if (!last) {
+			emit(REX_MOV_RR64, code, codePos);
+			emitByte(0xd8 + prog.getAddressRegister(), code, codePos);
+			emit(rxConfig->codeShhPrefetchTweaked, codeSshPrefetchSize, code, codePos);
 #ifdef RANDOMX_ALIGN
-				int align = (codePos % 16);
-				while (align != 0) {
-					int nopSize = 16 - align;
-					if (nopSize > 8) nopSize = 8;
-					emit(NOPX[nopSize - 1], nopSize, code, codePos);
-					align = (codePos % 16);
-				}
+			int align = (codePos % 16);
+			while (align != 0) {
+				int nopSize = 16 - align;
+				if (nopSize > 8) nopSize = 8;
+				emit(NOPX[nopSize - 1], nopSize, code, codePos);
+				align = (codePos % 16);
+			}
 #endif
+		}
+	}
+
+	void JitCompilerX86::emitCall(int32_t target) {
+		emitByte(CALL, code, codePos);
+		emit32(target - (codePos + 4), code, codePos);
+	}
+
+	//returns the position of the displacement, set by patchJumpShort() once the target is reached
+	int32_t JitCompilerX86::emitJumpShort(uint8_t opcode) {
+		emitByte(opcode, code, codePos);
+		emitByte(0, code, codePos);
+		return codePos - 1;
+	}
+
+	void JitCompilerX86::patchJumpShort(int32_t pos) {
+		code[pos] = static_cast<uint8_t>(codePos - (pos + 1));
+	}
+
+	//mov [rcx+offset], r8-r15, rbx (store) or the other way around
+	void JitCompilerX86::emitLaneMove(bool store, int32_t offset) {
+		for (int k = 0; k < 9; ++k) {
+			const int reg = k < 8 ? k : 3;
+			const int32_t disp = offset + 8 * k;
+			emitByte(k < 8 ? 0x4c : 0x48, code, codePos);
+			emitByte(store ? 0x89 : 0x8b, code, codePos);
+			if (disp < 128) {
+				emitByte(0x41 + 8 * reg, code, codePos);
+				emitByte(disp, code, codePos);
+			}
+			else {
+				emitByte(0x81 + 8 * reg, code, codePos);
+				emit32(disp, code, codePos);
 			}
 		}
-		emitByte(RET, code, codePos);
 	}
 
 	template
 	void JitCompilerX86::generateSuperscalarHash(SuperscalarProgram(&programs)[RANDOMX_CACHE_MAX_ACCESSES], std::vector<uint64_t> &reciprocalCache);
 
+	void JitCompilerX86::setConfig(const RandomX_ConfigurationBase& config) {
+		if (rxConfig == &config)
+			return;
+		rxConfig = &config;
+
+		int k = 0;
+#define INST_HANDLE(x) for (; k < config.CEIL_##x; ++k) engine[k] = &JitCompilerX86::h_##x;
+		INST_HANDLE(IADD_RS);
+		INST_HANDLE(IADD_M);
+		INST_HANDLE(ISUB_R);
+		INST_HANDLE(ISUB_M);
+		INST_HANDLE(IMUL_R);
+		INST_HANDLE(IMUL_M);
+		INST_HANDLE(IMULH_R);
+		INST_HANDLE(IMULH_M);
+		INST_HANDLE(ISMULH_R);
+		INST_HANDLE(ISMULH_M);
+		INST_HANDLE(IMUL_RCP);
+		INST_HANDLE(INEG_R);
+		INST_HANDLE(IXOR_R);
+		INST_HANDLE(IXOR_M);
+		INST_HANDLE(IROR_R);
+		INST_HANDLE(IROL_R);
+		INST_HANDLE(ISWAP_R);
+		INST_HANDLE(FSWAP_R);
+		INST_HANDLE(FADD_R);
+		INST_HANDLE(FADD_M);
+		INST_HANDLE(FSUB_R);
+		INST_HANDLE(FSUB_M);
+		INST_HANDLE(FSCAL_R);
+		INST_HANDLE(FMUL_R);
+		INST_HANDLE(FDIV_M);
+		INST_HANDLE(FSQRT_R);
+		INST_HANDLE(CBRANCH);
+		INST_HANDLE(CFROUND);
+		INST_HANDLE(ISTORE);
+		INST_HANDLE(NOP);
+#undef INST_HANDLE
+	}
+
 	void JitCompilerX86::generateDatasetInitCode() {
 		memcpy(code, codeDatasetInit, datasetInitSize);
 	}
@@ -271,11 +564,11 @@ namespace randomx {
 		codePos = ((uint8_t*)randomx_program_prologue_first_load) - ((uint8_t*)randomx_program_prologue);
 		code[codePos + 2] = 0xc0 + pcfg.readReg0;
 		code[codePos + 5] = 0xc0 + pcfg.readReg1;
-		*(uint32_t*)(code + codePos + 10) = RandomX_CurrentConfig.ScratchpadL3Mask64_Calculated;
-		*(uint32_t*)(code + codePos + 20) = RandomX_CurrentConfig.ScratchpadL3Mask64_Calculated;
+		*(uint32_t*)(code + codePos + 10) = rxConfig->ScratchpadL3Mask64_Calculated;
+		*(uint32_t*)(code + codePos + 20) = rxConfig->ScratchpadL3Mask64_Calculated;
 
-		codePos = prologueSize;
-		memcpy(code + codePos - 48, &pcfg.eMask, sizeof(pcfg.eMask));
+		memcpy(code + prologueSize - 48, &pcfg.eMask, sizeof(pcfg.eMask));
+		codePos = loopBegin;
 		memcpy(code + codePos, codeLoopLoad, loopLoadSize);
 		codePos += loopLoadSize;
 
@@ -287,7 +580,7 @@ namespace randomx {
 			r[j] = k;
 		}
 
-		for (int i = 0, n = static_cast<int>(RandomX_CurrentConfig.ProgramSize); i < n; ++i) {
+		for (int i = 0, n = static_cast<int>(rxConfig->ProgramSize); i < n; ++i) {
 			Instruction instr = prog(i);
 			*((uint64_t*)&instr) &= (uint64_t(-1) - (0xFFFF << 8)) | ((RegistersCount - 1) << 8) | ((RegistersCount - 1) << 16);
 			(this->*(engine[instr.opcode]))(instr);
@@ -304,12 +597,16 @@ namespace randomx {
 		emitByte(0xc0 + pcfg.readReg0, code, codePos);
 		emit(REX_XOR_RAX_R64, code, codePos);
 		emitByte(0xc0 + pcfg.readReg1, code, codePos);
-		emit(RandomX_CurrentConfig.codePrefetchScratchpadTweaked, prefetchScratchpadSize, code, codePos);
+		emit(rxConfig->codePrefetchScratchpadTweaked, prefetchScratchpadSize, code, codePos);
 		memcpy(code + codePos, codeLoopStore, loopStoreSize);
 		codePos += loopStoreSize;
 		emit(SUB_EBX, code, codePos);
 		emit(JNZ, code, codePos);
-		emit32(prologueSize - codePos - 4, code, codePos);
+		emit32(loopBegin - codePos - 4, code, codePos);
+		if (loopBegin != prologueSize) {
+			emit(ADD_RSP_I, code, codePos);
+			emit32(pipelineFrameSize, code, codePos);
+		}
 		emitByte(JMP, code, codePos);
 		emit32(epilogueOffset - codePos - 4, code, codePos);
 	}
@@ -419,7 +716,7 @@ namespace randomx {
 			emitByte(AND_EAX_I, code, codePos);
 		else
 			emit(AND_ECX_I, code, codePos);
-		emit32(instr.getModMem() ? ScratchpadL1Mask : ScratchpadL2Mask, code, codePos);
+		emit32(instr.getModMem() ? rxConfig->ScratchpadL1Mask_Calculated : rxConfig->ScratchpadL2Mask_Calculated, code, codePos);
 	}
 
 	void JitCompilerX86::genAddressRegDst(const Instruction& instr, uint8_t* code, int& codePos) {
@@ -431,15 +728,15 @@ namespace randomx {
 		emit32(instr.getImm32(), code, codePos);
 		emitByte(AND_EAX_I, code, codePos);
 		if (instr.getModCond() < StoreL3Condition) {
-			emit32(instr.getModMem() ? ScratchpadL1Mask : ScratchpadL2Mask, code, codePos);
+			emit32(instr.getModMem() ? rxConfig->ScratchpadL1Mask_Calculated : rxConfig->ScratchpadL2Mask_Calculated, code, codePos);
 		}
 		else {
-			emit32(ScratchpadL3Mask, code, codePos);
+			emit32(rxConfig->ScratchpadL3Mask_Calculated, code, codePos);
 		}
 	}
 
 	void JitCompilerX86::genAddressImm(const Instruction& instr, uint8_t* code, int& codePos) {
-		emit32(instr.getImm32() & ScratchpadL3Mask, code, codePos);
+		emit32(instr.getImm32() & rxConfig->ScratchpadL3Mask_Calculated, code, codePos);
 	}
 
 	static const uint32_t template_IADD_RS[8] = {
@@ -905,14 +1202,14 @@ namespace randomx {
 		int reg = instr.dst;
 		emit(REX_ADD_I, p, pos);
 		emitByte(0xc0 + reg, p, pos);
-		int shift = instr.getModCond() + RandomX_CurrentConfig.JumpOffset;
+		int shift = instr.getModCond() + rxConfig->JumpOffset;
 		uint32_t imm = instr.getImm32() | (1UL << shift);
-		if (RandomX_CurrentConfig.JumpOffset > 0 || shift > 0)
+		if (rxConfig->JumpOffset > 0 || shift > 0)
 			imm &= ~(1UL << (shift - 1));
 		emit32(imm, p, pos);
 		emit(REX_TEST, p, pos);
 		emitByte(0xc0 + reg, p, pos);
-		emit32(RandomX_CurrentConfig.ConditionMask_Calculated << shift, p, pos);
+		emit32(rxConfig->ConditionMask_Calculated << shift, p, pos);
 		emit(JZ, p, pos);
 		emit32(registerUsage[reg] - (pos + 4), p, pos);
 		//mark all registers as used
@@ -942,6 +1239,4 @@ namespace randomx {
 		emit(NOP1, code, codePos);
 	}
 
-	InstructionGeneratorX86 JitCompilerX86::engine[256] = {};
-
 }
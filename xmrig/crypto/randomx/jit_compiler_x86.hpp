@@ -43,41 +43,55 @@ namespace randomx {
 
 	typedef void(JitCompilerX86::*InstructionGeneratorX86)(const Instruction&);
 
-	constexpr uint32_t CodeSize = 64 * 1024;
+	constexpr uint32_t CodeSize = 128 * 1024;
 
 	class JitCompilerX86 {
 	public:
 		JitCompilerX86();
 		~JitCompilerX86();
 		void generateProgram(Program&, ProgramConfiguration&);
-		void generateProgramLight(Program&, ProgramConfiguration&, uint32_t);
+		void generateProgramLight(Program&, ProgramConfiguration&, uint32_t, const uint8_t*, uint32_t);
 		template<size_t N>
 		void generateSuperscalarHash(SuperscalarProgram (&programs)[N], std::vector<uint64_t> &);
 		void generateDatasetInitCode();
+		void setConfig(const RandomX_ConfigurationBase& config);
 		ProgramFunc* getProgramFunc() {
-			return (ProgramFunc*)code;
+			return (ProgramFunc*)codeExec;
 		}
 		DatasetInitFunc* getDatasetInitFunc() {
-			return (DatasetInitFunc*)code;
+			return (DatasetInitFunc*)codeExec;
 		}
 		uint8_t* getCode() {
 			return code;
 		}
 		size_t getCodeSize();
 
-		static InstructionGeneratorX86 engine[256];
+		const RandomX_ConfigurationBase* rxConfig = nullptr;
+		InstructionGeneratorX86 engine[256];
 		int registerUsage[RegistersCount];
 		uint8_t* code;
+		uint8_t* codeExec;
 		int32_t codePos;
+		int32_t loopBegin = 0;
+		int32_t superScalarHashStartOffset = 0;
+		int32_t superScalarHashFinishOffset = 0;
+		int32_t superScalarHashPipelinedOffset = 0;
 
+		void generateProgramLightPipelined(Program&, ProgramConfiguration&, uint32_t, const uint8_t*, uint32_t);
 		void generateProgramPrologue(Program&, ProgramConfiguration&);
 		void generateProgramEpilogue(Program&, ProgramConfiguration&);
-		static void genAddressReg(const Instruction&, uint8_t* code, int& codePos, bool rax = true);
-		static void genAddressRegDst(const Instruction&, uint8_t* code, int& codePos);
-		static void genAddressImm(const Instruction&, uint8_t* code, int& codePos);
+		void genAddressReg(const Instruction&, uint8_t* code, int& codePos, bool rax = true);
+		void genAddressRegDst(const Instruction&, uint8_t* code, int& codePos);
+		void genAddressImm(const Instruction&, uint8_t* code, int& codePos);
 		static void genSIB(int scale, int index, int base, uint8_t* code, int& codePos);
 
 		void generateSuperscalarCode(Instruction &, std::vector<uint64_t> &);
+		void generateSuperscalarProgram(SuperscalarProgram &, bool, std::vector<uint64_t> &);
+		int32_t generateSuperscalarHashPipelined(SuperscalarProgram*, bool finish, bool start, std::vector<uint64_t> &);
+		void emitLaneMove(bool store, int32_t offset);
+		void emitCall(int32_t target);
+		int32_t emitJumpShort(uint8_t opcode);
+		void patchJumpShort(int32_t pos);
 
 		static void emitByte(uint8_t val, uint8_t* code, int& codePos) {
 			code[codePos] = val;
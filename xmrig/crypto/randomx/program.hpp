@@ -48,9 +48,6 @@ namespace randomx {
 		uint64_t getEntropy(int i) {
 			return load64(&entropyBuffer[i]);
 		}
-		uint32_t getSize() {
-			return RandomX_CurrentConfig.ProgramSize;
-		}
 	private:
 		uint64_t entropyBuffer[16];
 		Instruction programBuffer[RANDOMX_PROGRAM_MAX_SIZE];
@@ -34,6 +34,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "crypto/randomx/vm_compiled.hpp"
 #include "crypto/randomx/vm_compiled_light.hpp"
 #include "crypto/randomx/blake2/blake2.h"
+#include "crypto/randomx/timing.hpp"
 
 #if defined(_M_X64) || defined(__x86_64__)
 #include "crypto/randomx/jit_compiler_x86_static.hpp"
@@ -203,9 +204,6 @@ void RandomX_ConfigurationBase::Apply()
 
 	*(uint32_t*)(codePrefetchScratchpadTweaked + 4) = ScratchpadL3Mask64_Calculated;
 	*(uint32_t*)(codePrefetchScratchpadTweaked + 18) = ScratchpadL3Mask64_Calculated;
-
-#define JIT_HANDLE(x, prev) randomx::JitCompilerX86::engine[k] = &randomx::JitCompilerX86::h_##x
-
 #elif defined(XMRIG_ARM)
 
 	Log2_ScratchpadL1 = Log2(ScratchpadL1_Size);
@@ -213,19 +211,12 @@ void RandomX_ConfigurationBase::Apply()
 	Log2_ScratchpadL3 = Log2(ScratchpadL3_Size);
 	Log2_DatasetBaseSize = Log2(DatasetBaseSize);
 	Log2_CacheSize = Log2((ArgonMemory * randomx::ArgonBlockSize) / randomx::CacheLineSize);
-
-#define JIT_HANDLE(x, prev) randomx::JitCompilerA64::engine[k] = &randomx::JitCompilerA64::h_##x
-
-#else
-#define JIT_HANDLE(x, prev)
 #endif
 
 	constexpr int CEIL_NULL = 0;
-	int k = 0;
 
 #define INST_HANDLE(x, prev) \
-	CEIL_##x = CEIL_##prev + RANDOMX_FREQ_##x; \
-	for (; k < CEIL_##x; ++k) { JIT_HANDLE(x, prev); }
+	CEIL_##x = CEIL_##prev + RANDOMX_FREQ_##x;
 
 	INST_HANDLE(IADD_RS, NULL);
 	INST_HANDLE(IADD_M, IADD_RS);
@@ -266,15 +257,15 @@ RandomX_ConfigurationWownero RandomX_WowneroConfig;
 RandomX_ConfigurationLoki RandomX_LokiConfig;
 RandomX_ConfigurationArqma RandomX_ArqmaConfig;
 
-RandomX_ConfigurationBase RandomX_CurrentConfig;
-
 extern "C" {
 
-	randomx_cache *randomx_alloc_cache(randomx_flags flags) {
+	randomx_cache *randomx_alloc_cache(randomx_flags flags, const RandomX_ConfigurationBase *config) {
+		assert(config != nullptr);
 		randomx_cache *cache = nullptr;
 
 		try {
 			cache = new randomx_cache();
+			cache->config = config;
 			switch (flags & (RANDOMX_FLAG_JIT | RANDOMX_FLAG_LARGE_PAGES)) {
 				case RANDOMX_FLAG_DEFAULT:
 					cache->dealloc = &randomx::deallocCache<randomx::DefaultAllocator>;
@@ -322,12 +313,62 @@ extern "C" {
 		return cache;
 	}
 
+	randomx_cache *randomx_alloc_cache_on(randomx_flags flags, const RandomX_ConfigurationBase *config, void *memory) {
+		assert(config != nullptr && memory != nullptr);
+		randomx_cache *cache = nullptr;
+
+		try {
+			cache = new randomx_cache();
+			cache->config = config;
+			cache->dealloc = &randomx::deallocCacheExternal;
+			if (flags & RANDOMX_FLAG_JIT) {
+				cache->jit = new randomx::JitCompiler();
+				cache->initialize = &randomx::initCacheCompile;
+				cache->datasetInit = cache->jit->getDatasetInitFunc();
+			}
+			else {
+				cache->jit = nullptr;
+				cache->initialize = &randomx::initCache;
+				cache->datasetInit = &randomx::initDataset;
+			}
+			cache->memory = (uint8_t*)memory;
+		}
+		catch (std::exception &ex) {
+			if (cache != nullptr) {
+				randomx_release_cache(cache);
+				cache = nullptr;
+			}
+		}
+
+		return cache;
+	}
+
 	void randomx_init_cache(randomx_cache *cache, const void *key, size_t keySize) {
 		assert(cache != nullptr);
 		assert(keySize == 0 || key != nullptr);
 		cache->initialize(cache, key, keySize);
 	}
 
+	void *randomx_get_cache_memory(randomx_cache *cache) {
+		assert(cache != nullptr);
+		return cache->memory;
+	}
+
+	size_t randomx_get_cache_programs(randomx_cache *cache, void *out) {
+		assert(cache != nullptr && cache->isInitialized());
+		return randomx::saveCachePrograms(cache, (uint8_t*)out);
+	}
+
+	bool randomx_init_cache_programs(randomx_cache *cache, const void *programs, size_t size) {
+		assert(cache != nullptr);
+		assert(programs != nullptr || size == 0);
+		if (!randomx::loadCachePrograms(cache, (const uint8_t*)programs, size)) {
+			cache->programs[0].setSize(0);
+			return false;
+		}
+		return true;
+	}
+
 	void randomx_release_cache(randomx_cache* cache) {
 		assert(cache != nullptr);
 		cache->dealloc(cache);
@@ -335,17 +376,23 @@ extern "C" {
 	}
 
 	randomx_dataset *randomx_alloc_dataset(randomx_flags flags) {
+		return randomx_alloc_partial_dataset(flags, RANDOMX_DATASET_MAX_SIZE / RANDOMX_DATASET_ITEM_SIZE);
+	}
+
+	randomx_dataset *randomx_alloc_partial_dataset(randomx_flags flags, unsigned long itemCount) {
+		assert(itemCount > 0 && itemCount <= RANDOMX_DATASET_MAX_SIZE / RANDOMX_DATASET_ITEM_SIZE);
 		randomx_dataset *dataset = nullptr;
 
 		try {
 			dataset = new randomx_dataset();
+			dataset->itemCount = itemCount;
 			if (flags & RANDOMX_FLAG_LARGE_PAGES) {
 				dataset->dealloc = &randomx::deallocDataset<randomx::LargePageAllocator>;
-				dataset->memory = (uint8_t*)randomx::LargePageAllocator::allocMemory(RANDOMX_DATASET_MAX_SIZE);
+				dataset->memory = (uint8_t*)randomx::LargePageAllocator::allocMemory(itemCount * randomx::CacheLineSize);
 			}
 			else {
 				dataset->dealloc = &randomx::deallocDataset<randomx::DefaultAllocator>;
-				dataset->memory = (uint8_t*)randomx::DefaultAllocator::allocMemory(RANDOMX_DATASET_MAX_SIZE);
+				dataset->memory = (uint8_t*)randomx::DefaultAllocator::allocMemory(itemCount * randomx::CacheLineSize);
 			}
 		}
 		catch (std::exception &ex) {
@@ -358,17 +405,37 @@ extern "C" {
 		return dataset;
 	}
 
-	#define DatasetItemCount ((RandomX_CurrentConfig.DatasetBaseSize + RandomX_CurrentConfig.DatasetExtraSize) / RANDOMX_DATASET_ITEM_SIZE)
+	randomx_dataset *randomx_alloc_dataset_on(const RandomX_ConfigurationBase *config, unsigned long itemCount, void *memory) {
+		assert(itemCount > 0 && itemCount <= RANDOMX_DATASET_MAX_SIZE / RANDOMX_DATASET_ITEM_SIZE);
+		assert(memory != nullptr);
+		randomx_dataset *dataset = nullptr;
+
+		try {
+			dataset = new randomx_dataset();
+			dataset->itemCount = itemCount;
+			dataset->config = config;
+			dataset->dealloc = &randomx::deallocDatasetExternal;
+			dataset->memory = (uint8_t*)memory;
+		}
+		catch (std::exception &ex) {
+		}
+
+		return dataset;
+	}
 
-	unsigned long randomx_dataset_item_count() {
-		return DatasetItemCount;
+	unsigned long randomx_dataset_item_count(const RandomX_ConfigurationBase *config) {
+		assert(config != nullptr);
+		return (config->DatasetBaseSize + config->DatasetExtraSize) / RANDOMX_DATASET_ITEM_SIZE;
 	}
 
 	void randomx_init_dataset(randomx_dataset *dataset, randomx_cache *cache, unsigned long startItem, unsigned long itemCount) {
 		assert(dataset != nullptr);
 		assert(cache != nullptr);
-		assert(startItem < DatasetItemCount && itemCount <= DatasetItemCount);
-		assert(startItem + itemCount <= DatasetItemCount);
+		assert(startItem < randomx_dataset_item_count(cache->config) && itemCount <= randomx_dataset_item_count(cache->config));
+		assert(startItem + itemCount <= randomx_dataset_item_count(cache->config));
+		assert(startItem + itemCount <= dataset->itemCount);
+		assert(dataset->config == nullptr || dataset->config == cache->config);
+		dataset->config = cache->config;
 		cache->datasetInit(cache, dataset->memory + startItem * randomx::CacheLineSize, startItem, startItem + itemCount);
 	}
 
@@ -387,6 +454,8 @@ extern "C" {
 		assert(cache != nullptr || (flags & RANDOMX_FLAG_FULL_MEM));
 		assert(cache == nullptr || cache->isInitialized());
 		assert(dataset != nullptr || !(flags & RANDOMX_FLAG_FULL_MEM));
+		assert(dataset == nullptr || dataset->config != nullptr);
+		assert(!(flags & RANDOMX_FLAG_FULL_MEM) || dataset->itemCount >= randomx_dataset_item_count(dataset->config));
 
 		randomx_vm *vm = nullptr;
 
@@ -454,7 +523,7 @@ extern "C" {
 
 	void randomx_vm_set_dataset(randomx_vm *machine, randomx_dataset *dataset) {
 		assert(machine != nullptr);
-		assert(dataset != nullptr);
+		assert(dataset != nullptr && dataset->config != nullptr);
 		machine->setDataset(dataset);
 	}
 
@@ -468,15 +537,50 @@ extern "C" {
 		assert(inputSize == 0 || input != nullptr);
 		assert(output != nullptr);
 		alignas(16) uint64_t tempHash[8];
-		rx_blake2b(tempHash, sizeof(tempHash), input, inputSize, nullptr, 0);
-		machine->initScratchpad(&tempHash);
+		RANDOMX_TIMED(TimingBlake2b, rx_blake2b(tempHash, sizeof(tempHash), input, inputSize, nullptr, 0));
+		RANDOMX_TIMED(TimingFillScratchpad, machine->initScratchpad(&tempHash));
 		machine->resetRoundingMode();
-		for (uint32_t chain = 0; chain < RandomX_CurrentConfig.ProgramCount - 1; ++chain) {
+		for (uint32_t chain = 0; chain < machine->getConfig().ProgramCount - 1; ++chain) {
 			machine->run(&tempHash);
-			rx_blake2b(tempHash, sizeof(tempHash), machine->getRegisterFile(), sizeof(randomx::RegisterFile), nullptr, 0);
+			RANDOMX_TIMED(TimingBlake2b, rx_blake2b(tempHash, sizeof(tempHash), machine->getRegisterFile(), sizeof(randomx::RegisterFile), nullptr, 0));
 		}
 		machine->run(&tempHash);
-		machine->getFinalResult(output, RANDOMX_HASH_SIZE);
+		RANDOMX_TIMED(TimingFinalize, machine->getFinalResult(output, RANDOMX_HASH_SIZE));
+	}
+
+	void randomx_calculate_hash_first(randomx_vm *machine, const void *input, size_t inputSize) {
+		assert(machine != nullptr);
+		assert(inputSize == 0 || input != nullptr);
+		RANDOMX_TIMED(TimingBlake2b, rx_blake2b(machine->tempHash, sizeof(machine->tempHash), input, inputSize, nullptr, 0));
+		RANDOMX_TIMED(TimingFillScratchpad, machine->initScratchpad(machine->tempHash));
+	}
+
+	void randomx_calculate_hash_next(randomx_vm *machine, const void *nextInput, size_t nextInputSize, void *output) {
+		assert(machine != nullptr);
+		assert(nextInputSize == 0 || nextInput != nullptr);
+		assert(output != nullptr);
+		machine->resetRoundingMode();
+		for (uint32_t chain = 0; chain < machine->getConfig().ProgramCount - 1; ++chain) {
+			machine->run(machine->tempHash);
+			RANDOMX_TIMED(TimingBlake2b, rx_blake2b(machine->tempHash, sizeof(machine->tempHash), machine->getRegisterFile(), sizeof(randomx::RegisterFile), nullptr, 0));
+		}
+		machine->run(machine->tempHash);
+
+		//finish the current hash and fill the scratchpad for the next one at the same time
+		RANDOMX_TIMED(TimingBlake2b, rx_blake2b(machine->tempHash, sizeof(machine->tempHash), nextInput, nextInputSize, nullptr, 0));
+		RANDOMX_TIMED(TimingFinalize, machine->hashAndFill(output, RANDOMX_HASH_SIZE, machine->tempHash));
+	}
+
+	void randomx_calculate_hash_last(randomx_vm *machine, void *output) {
+		assert(machine != nullptr);
+		assert(output != nullptr);
+		machine->resetRoundingMode();
+		for (uint32_t chain = 0; chain < machine->getConfig().ProgramCount - 1; ++chain) {
+			machine->run(machine->tempHash);
+			RANDOMX_TIMED(TimingBlake2b, rx_blake2b(machine->tempHash, sizeof(machine->tempHash), machine->getRegisterFile(), sizeof(randomx::RegisterFile), nullptr, 0));
+		}
+		machine->run(machine->tempHash);
+		RANDOMX_TIMED(TimingFinalize, machine->getFinalResult(output, RANDOMX_HASH_SIZE));
 	}
 
 }
@@ -36,6 +36,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #define RANDOMX_HASH_SIZE 32
 #define RANDOMX_DATASET_ITEM_SIZE 64
+#define RANDOMX_TIMING_BUCKETS 48
 
 #ifndef RANDOMX_EXPORT
 #define RANDOMX_EXPORT
@@ -55,7 +56,19 @@ struct randomx_dataset;
 struct randomx_cache;
 class randomx_vm;
 
+/* Cumulative timing of one phase: the number of runs, their total ticks and how many
+ * took [2^i, 2^(i+1)) ticks in histogram[i], the last element counting longer ones too */
+struct randomx_phase_timing {
+  const char *phase;
+  uint64_t count;
+  uint64_t ticks;
+  uint64_t histogram[RANDOMX_TIMING_BUCKETS];
+};
+
 
+/* Parameters of one RandomX variant. Caches, datasets and VMs keep a pointer to the
+ * configuration they were created for, so different variants can run side by side;
+ * Apply() must be called once after the parameters are set and before it is used. */
 struct RandomX_ConfigurationBase
 {
 	RandomX_ConfigurationBase();
@@ -185,16 +198,6 @@ extern RandomX_ConfigurationWownero RandomX_WowneroConfig;
 extern RandomX_ConfigurationLoki RandomX_LokiConfig;
 extern RandomX_ConfigurationArqma RandomX_ArqmaConfig;
 
-extern RandomX_ConfigurationBase RandomX_CurrentConfig;
-
-template<typename T>
-void randomx_apply_config(const T& config)
-{
-	static_assert(sizeof(T) == sizeof(RandomX_ConfigurationBase), "Invalid RandomX configuration struct size");
-	static_assert(std::is_base_of<RandomX_ConfigurationBase, T>::value, "Incompatible RandomX configuration struct");
-	RandomX_CurrentConfig = config;
-	RandomX_CurrentConfig.Apply();
-}
 
 #if defined(__cplusplus)
 extern "C" {
@@ -207,12 +210,29 @@ extern "C" {
  *        RANDOMX_FLAG_LARGE_PAGES - allocate memory in large pages
  *        RANDOMX_FLAG_JIT - create cache structure with JIT compilation support; this makes
  *                           subsequent Dataset initialization faster
+ * @param config is the applied configuration of the RandomX variant. Must not be NULL and
+ *        must outlive the cache and everything created from it.
  *
  * @return Pointer to an allocated randomx_cache structure.
  *         NULL is returned if memory allocation fails or if the RANDOMX_FLAG_JIT
  *         is set and JIT compilation is not supported on the current platform.
  */
-RANDOMX_EXPORT randomx_cache *randomx_alloc_cache(randomx_flags flags);
+RANDOMX_EXPORT randomx_cache *randomx_alloc_cache(randomx_flags flags, const RandomX_ConfigurationBase *config);
+
+/**
+ * Creates a randomx_cache structure on memory the caller owns instead of allocating it,
+ * e.g. a snapshot mapped from disk (see randomx_init_cache_programs).
+ *
+ * @param flags is RANDOMX_FLAG_JIT or RANDOMX_FLAG_DEFAULT, see randomx_alloc_cache.
+ * @param config is the applied configuration of the RandomX variant. Must not be NULL.
+ * @param memory is at least config->ArgonMemory * 1024 bytes, 64-byte aligned, that must
+ *        stay valid until the cache is released. Must not be NULL.
+ *
+ * @return Pointer to an allocated randomx_cache structure.
+ *         NULL is returned if the RANDOMX_FLAG_JIT is set and JIT compilation is not
+ *         supported on the current platform.
+ */
+RANDOMX_EXPORT randomx_cache *randomx_alloc_cache_on(randomx_flags flags, const RandomX_ConfigurationBase *config, void *memory);
 
 /**
  * Initializes the cache memory and SuperscalarHash using the provided key value.
@@ -223,6 +243,40 @@ RANDOMX_EXPORT randomx_cache *randomx_alloc_cache(randomx_flags flags);
 */
 RANDOMX_EXPORT void randomx_init_cache(randomx_cache *cache, const void *key, size_t keySize);
 
+/**
+ * Returns a pointer to the internal memory buffer of the cache structure. The cache
+ * uses the first config->ArgonMemory * 1024 bytes of it.
+ *
+ * @param cache is a pointer to a previously allocated randomx_cache structure. Must not be NULL.
+ *
+ * @return Pointer to the internal memory buffer of the cache structure.
+*/
+RANDOMX_EXPORT void *randomx_get_cache_memory(randomx_cache *cache);
+
+/**
+ * Saves the SuperscalarHash programs generated from the key. With the cache memory they are
+ * the whole state of an initialized cache, e.g. for a snapshot on disk.
+ *
+ * @param cache is a pointer to an initialized randomx_cache structure. Must not be NULL.
+ * @param out is where to write them, or NULL to only get their size.
+ *
+ * @return the number of bytes of the saved programs.
+*/
+RANDOMX_EXPORT size_t randomx_get_cache_programs(randomx_cache *cache, void *out);
+
+/**
+ * Initializes a cache from saved state instead of the key. The cache memory must already
+ * hold the saved memory, or be it (see randomx_alloc_cache_on).
+ *
+ * @param cache is a pointer to a previously allocated randomx_cache structure of the same
+ *        configuration as the saved one. Must not be NULL.
+ * @param programs is what randomx_get_cache_programs saved.
+ * @param size is the number of bytes of programs.
+ *
+ * @return true on success, false if programs is malformed. The cache is left uninitialized then.
+*/
+RANDOMX_EXPORT bool randomx_init_cache_programs(randomx_cache *cache, const void *programs, size_t size);
+
 /**
  * Releases all memory occupied by the randomx_cache structure.
  *
@@ -242,17 +296,49 @@ RANDOMX_EXPORT void randomx_release_cache(randomx_cache* cache);
 RANDOMX_EXPORT randomx_dataset *randomx_alloc_dataset(randomx_flags flags);
 
 /**
- * Gets the number of items contained in the dataset.
+ * Creates a randomx_dataset structure with memory for the first itemCount Dataset items only.
+ * A light mode virtual machine given such a dataset reads these items from it and computes
+ * the others from its cache (see randomx_vm_set_dataset).
+ *
+ * @param flags is the initialization flags. Only one flag is supported (can be set or not set):
+ *        RANDOMX_FLAG_LARGE_PAGES - allocate memory in large pages
+ * @param itemCount is the number of items to allocate memory for.
+ *
+ * @return Pointer to an allocated randomx_dataset structure.
+ *         NULL is returned if memory allocation fails.
+ */
+RANDOMX_EXPORT randomx_dataset *randomx_alloc_partial_dataset(randomx_flags flags, unsigned long itemCount);
+
+/**
+ * Creates a randomx_dataset structure for itemCount items on memory the caller owns instead
+ * of allocating it, e.g. shared memory another process initializes or has initialized.
+ *
+ * @param config is the applied configuration of the RandomX variant if the memory already
+ *        holds initialized items, NULL if they are initialized with randomx_init_dataset.
+ * @param itemCount is the number of items there is memory for, see randomx_alloc_partial_dataset.
+ * @param memory is at least itemCount * RANDOMX_DATASET_ITEM_SIZE bytes, 64-byte aligned, that
+ *        must stay valid until the dataset is released. Must not be NULL.
+ *
+ * @return Pointer to an allocated randomx_dataset structure.
+ *         NULL is returned if memory allocation fails.
+ */
+RANDOMX_EXPORT randomx_dataset *randomx_alloc_dataset_on(const RandomX_ConfigurationBase *config, unsigned long itemCount, void *memory);
+
+/**
+ * Gets the number of items contained in the dataset of a RandomX variant.
+ *
+ * @param config is the applied configuration of the RandomX variant. Must not be NULL.
  *
  * @return the number of items contained in the dataset.
 */
-RANDOMX_EXPORT unsigned long randomx_dataset_item_count(void);
+RANDOMX_EXPORT unsigned long randomx_dataset_item_count(const RandomX_ConfigurationBase *config);
 
 /**
- * Initializes dataset items.
+ * Initializes dataset items. The dataset takes the configuration of the cache.
  *
- * Note: In order to use the Dataset, all items from 0 to (randomx_dataset_item_count() - 1) must be initialized.
- * This may be done by several calls to this function using non-overlapping item sequences.
+ * Note: In order to use the Dataset, all items from 0 to (randomx_dataset_item_count() - 1) must be initialized,
+ * or all items a partial dataset has memory for. This may be done by several calls to this function
+ * using non-overlapping item sequences, all with caches of the same configuration.
  *
  * @param dataset is a pointer to a previously allocated randomx_dataset structure. Must not be NULL.
  * @param cache is a pointer to a previously allocated and initialized randomx_cache structure. Must not be NULL.
@@ -291,8 +377,11 @@ RANDOMX_EXPORT void randomx_release_dataset(randomx_dataset *dataset);
  *        Using RANDOMX_FLAG_DEFAULT (all flags not set) works on all platforms, but is the slowest.
  * @param cache is a pointer to an initialized randomx_cache structure. Can be
  *        NULL if RANDOMX_FLAG_FULL_MEM is set.
- * @param dataset is a pointer to a randomx_dataset structure. Can be NULL
- *        if RANDOMX_FLAG_FULL_MEM is not set.
+ * @param dataset is a pointer to an initialized randomx_dataset structure. Can be NULL
+ *        if RANDOMX_FLAG_FULL_MEM is not set. Without RANDOMX_FLAG_FULL_MEM it may be a partial
+ *        dataset built from the same cache, see randomx_vm_set_dataset.
+ *        The virtual machine uses the configuration of the cache or dataset it is given,
+ *        later ones must have the same configuration.
  *
  * @return Pointer to an initialized randomx_vm structure.
  *         Returns NULL if:
@@ -316,8 +405,11 @@ RANDOMX_EXPORT void randomx_vm_set_cache(randomx_vm *machine, randomx_cache* cac
 /**
  * Reinitializes a virtual machine with a new Dataset.
  *
- * @param machine is a pointer to a randomx_vm structure that was initialized
- *        with RANDOMX_FLAG_FULL_MEM. Must not be NULL.
+ * A virtual machine initialized without RANDOMX_FLAG_FULL_MEM takes a partial (or full) dataset
+ * built from its current cache: items the dataset holds are read from it, the others are computed
+ * as in light mode. Setting a new cache detaches the dataset. The ARM64 JIT compiler ignores it.
+ *
+ * @param machine is a pointer to a randomx_vm structure. Must not be NULL.
  * @param dataset is a pointer to an initialized randomx_dataset structure. Must not be NULL.
 */
 RANDOMX_EXPORT void randomx_vm_set_dataset(randomx_vm *machine, randomx_dataset *dataset);
@@ -340,6 +432,50 @@ RANDOMX_EXPORT void randomx_destroy_vm(randomx_vm *machine);
 */
 RANDOMX_EXPORT void randomx_calculate_hash(randomx_vm *machine, const void *input, size_t inputSize, void *output);
 
+/**
+ * Pipelined hashing of a sequence of inputs: randomx_calculate_hash_first for the first
+ * input, then randomx_calculate_hash_next for each of the others, which outputs the hash
+ * of the one before, then randomx_calculate_hash_last for the hash of the last one. The
+ * scratchpad of each input is filled in the same pass as the hash of the previous one is
+ * finished. Other calls with the same VM must not come in between.
+ *
+ * @param machine is a pointer to a randomx_vm structure. Must not be NULL.
+ * @param input, nextInput are pointers to memory to be hashed. Must not be NULL.
+ * @param inputSize, nextInputSize are the number of bytes to be hashed.
+ * @param output is a pointer to memory where the hash of the previous input will be
+ *        stored. Must not be NULL and at least RANDOMX_HASH_SIZE bytes must be available
+ *        for writing.
+*/
+RANDOMX_EXPORT void randomx_calculate_hash_first(randomx_vm *machine, const void *input, size_t inputSize);
+RANDOMX_EXPORT void randomx_calculate_hash_next(randomx_vm *machine, const void *nextInput, size_t nextInputSize, void *output);
+RANDOMX_EXPORT void randomx_calculate_hash_last(randomx_vm *machine, void *output);
+
+/**
+ * Turns timing of the phases of hashing (blake2b, fill_scratchpad, generate_program,
+ * compile_program, execute_program, finalize), of cache initialization (cache_init,
+ * superscalar_generate, superscalar_compile) and of light VMs switching to a cache
+ * (superscalar_vm) on or off for all VMs. Turning it on clears the histograms.
+ *
+ * @param enabled is true to turn timing on.
+*/
+RANDOMX_EXPORT void randomx_set_timing(bool enabled);
+RANDOMX_EXPORT bool randomx_timing_enabled(void);
+
+/**
+ * Gets the unit of the ticks: "cycles" of the TSC on x86, "ns" elsewhere.
+*/
+RANDOMX_EXPORT const char *randomx_timing_unit(void);
+
+/**
+ * Copies the timing of the phases since timing was turned on.
+ *
+ * @param out is a pointer to memory for count phases, may be NULL if count is 0.
+ * @param count is the number of phases out has room for.
+ *
+ * @return the number of phases.
+*/
+RANDOMX_EXPORT size_t randomx_get_timing(randomx_phase_timing *out, size_t count);
+
 #if defined(__cplusplus)
 }
 #endif
@@ -578,10 +578,10 @@ namespace randomx {
 	constexpr int MAX_THROWAWAY_COUNT = 256;
 
 	template<bool commit>
-	static int scheduleUop(ExecutionPort::type uop, ExecutionPort::type(&portBusy)[CYCLE_MAP_SIZE][3], int cycle) {
+	static int scheduleUop(ExecutionPort::type uop, ExecutionPort::type(&portBusy)[CYCLE_MAP_SIZE][3], int cycle, int latency) {
 		//The scheduling here is done optimistically by checking port availability in order P5 -> P0 -> P1 to not overload
 		//port P1 (multiplication) by instructions that can go to any port.
-		for (; cycle < static_cast<int>(RandomX_CurrentConfig.SuperscalarLatency) + 4; ++cycle) {
+		for (; cycle < latency + 4; ++cycle) {
 			if ((uop & ExecutionPort::P5) != 0 && !portBusy[cycle][2]) {
 				if (commit) {
 					if (trace) std::cout << "; P5 at cycle " << cycle << std::endl;
@@ -608,7 +608,7 @@ namespace randomx {
 	}
 
 	template<bool commit>
-	static int scheduleMop(const MacroOp& mop, ExecutionPort::type(&portBusy)[CYCLE_MAP_SIZE][3], int cycle, int depCycle) {
+	static int scheduleMop(const MacroOp& mop, ExecutionPort::type(&portBusy)[CYCLE_MAP_SIZE][3], int cycle, int depCycle, int latency) {
 		//if this macro-op depends on the previous one, increase the starting cycle if needed
 		//this handles an explicit dependency chain in IMUL_RCP
 		if (mop.isDependent()) {
@@ -622,19 +622,19 @@ namespace randomx {
 		} 
 		else if (mop.isSimple()) {
 			//this macro-op has only one uOP
-			return scheduleUop<commit>(mop.getUop1(), portBusy, cycle);
+			return scheduleUop<commit>(mop.getUop1(), portBusy, cycle, latency);
 		}
 		else {
 			//macro-ops with 2 uOPs are scheduled conservatively by requiring both uOPs to execute in the same cycle
-			for (; cycle < static_cast<int>(RandomX_CurrentConfig.SuperscalarLatency) + 4; ++cycle) {
+			for (; cycle < latency + 4; ++cycle) {
 
-				int cycle1 = scheduleUop<false>(mop.getUop1(), portBusy, cycle);
-				int cycle2 = scheduleUop<false>(mop.getUop2(), portBusy, cycle);
+				int cycle1 = scheduleUop<false>(mop.getUop1(), portBusy, cycle, latency);
+				int cycle2 = scheduleUop<false>(mop.getUop2(), portBusy, cycle, latency);
 
 				if (cycle1 == cycle2) {
 					if (commit) {
-						scheduleUop<true>(mop.getUop1(), portBusy, cycle1);
-						scheduleUop<true>(mop.getUop2(), portBusy, cycle2);
+						scheduleUop<true>(mop.getUop1(), portBusy, cycle1, latency);
+						scheduleUop<true>(mop.getUop2(), portBusy, cycle2, latency);
 					}
 					return cycle1;
 				}
@@ -644,7 +644,8 @@ namespace randomx {
 		return -1;
 	}
 
-	void generateSuperscalar(SuperscalarProgram& prog, Blake2Generator& gen) {
+	void generateSuperscalar(SuperscalarProgram& prog, Blake2Generator& gen, const RandomX_ConfigurationBase& config) {
+		const int latency = static_cast<int>(config.SuperscalarLatency);
 
 		ExecutionPort::type portBusy[CYCLE_MAP_SIZE][3];
 		memset(portBusy, 0, sizeof(portBusy));
@@ -669,7 +670,7 @@ namespace randomx {
 		//Since a decode cycle produces on average 3.45 macro-ops and there are only 3 ALU ports, execution ports are always
 		//saturated first. The cycle limit is present only to guarantee loop termination.
 		//Program size is limited to SuperscalarMaxSize instructions.
-		for (decodeCycle = 0; decodeCycle < static_cast<int>(RandomX_CurrentConfig.SuperscalarLatency) && !portsSaturated && programSize < 3 * static_cast<int>(RandomX_CurrentConfig.SuperscalarLatency) + 2; ++decodeCycle) {
+		for (decodeCycle = 0; decodeCycle < latency && !portsSaturated && programSize < 3 * latency + 2; ++decodeCycle) {
 
 			//select a decode configuration
 			decodeBuffer = decodeBuffer->fetchNext(currentInstruction.getType(), decodeCycle, mulCount, gen);
@@ -683,7 +684,7 @@ namespace randomx {
 
 				//if we have issued all macro-ops for the current RandomX instruction, create a new instruction
 				if (macroOpIndex >= currentInstruction.getInfo().getSize()) {
-					if (portsSaturated || programSize >= 3 * static_cast<int>(RandomX_CurrentConfig.SuperscalarLatency) + 2)
+					if (portsSaturated || programSize >= 3 * latency + 2)
 						break;
 					//select an instruction so that the first macro-op fits into the current slot
 					currentInstruction.createForSlot(gen, decodeBuffer->getCounts()[bufferIndex], decodeBuffer->getIndex(), decodeBuffer->getSize() == bufferIndex + 1, bufferIndex == 0);
@@ -694,7 +695,7 @@ namespace randomx {
 				if (trace) std::cout << mop.getName() << " ";
 
 				//calculate the earliest cycle when this macro-op (all of its uOPs) can be scheduled for execution
-				int scheduleCycle = scheduleMop<false>(mop, portBusy, cycle, depCycle);
+				int scheduleCycle = scheduleMop<false>(mop, portBusy, cycle, depCycle, latency);
 				if (scheduleCycle < 0) {
 					if (trace) std::cout << "Unable to map operation '" << mop.getName() << "' to execution port (cycle " << cycle << ")" << std::endl;
 					//__debugbreak();
@@ -753,7 +754,7 @@ namespace randomx {
 				throwAwayCount = 0;
 
 				//recalculate when the instruction can be scheduled for execution based on operand availability
-				scheduleCycle = scheduleMop<true>(mop, portBusy, scheduleCycle, scheduleCycle);
+				scheduleCycle = scheduleMop<true>(mop, portBusy, scheduleCycle, scheduleCycle, latency);
 
 				//calculate when the result will be ready
 				depCycle = scheduleCycle + mop.getLatency();
@@ -777,7 +778,7 @@ namespace randomx {
 				macroOpCount++;
 
 				//terminating condition
-				if (scheduleCycle >= static_cast<int>(RandomX_CurrentConfig.SuperscalarLatency)) {
+				if (scheduleCycle >= latency) {
 					portsSaturated = true;
 				}
 				cycle = topCycle;
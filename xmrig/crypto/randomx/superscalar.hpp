@@ -32,6 +32,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <vector>
 #include "crypto/randomx/superscalar_program.hpp"
 #include "crypto/randomx/blake2_generator.hpp"
+#include "crypto/randomx/randomx.h"
 
 namespace randomx {
 	                                              //                  Intel Ivy Bridge reference
@@ -55,6 +56,6 @@ namespace randomx {
 		INVALID = -1
 	};
 
-	void generateSuperscalar(SuperscalarProgram& prog, Blake2Generator& gen);
+	void generateSuperscalar(SuperscalarProgram& prog, Blake2Generator& gen, const RandomX_ConfigurationBase& config);
 	void executeSuperscalar(uint64_t(&r)[8], SuperscalarProgram& prog, std::vector<uint64_t> *reciprocals = nullptr);
 }
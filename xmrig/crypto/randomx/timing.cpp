@@ -0,0 +1,72 @@
+#include <algorithm>
+#include <chrono>
+
+#include "crypto/randomx/randomx.h"
+#include "crypto/randomx/timing.hpp"
+
+namespace randomx {
+
+	std::atomic<bool> timingEnabled(false);
+
+	// Count and total ticks, then the histogram, of each phase
+	static std::atomic<uint64_t> timings[TimingPhaseCount][2 + RANDOMX_TIMING_BUCKETS];
+
+	static const char* const timingPhaseNames[TimingPhaseCount] = {
+		"blake2b", "fill_scratchpad", "generate_program", "compile_program",
+		"execute_program", "finalize", "cache_init", "superscalar_generate",
+		"superscalar_compile", "superscalar_vm"
+	};
+
+#	ifndef RANDOMX_TIMING_TSC
+	uint64_t timingTicks() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+#	endif
+
+	void recordTiming(TimingPhase phase, uint64_t ticks) {
+		int bucket = 0;
+		while (bucket < RANDOMX_TIMING_BUCKETS - 1 && (ticks >> (bucket + 1)) != 0)
+			++bucket;
+		timings[phase][0].fetch_add(1, std::memory_order_relaxed);
+		timings[phase][1].fetch_add(ticks, std::memory_order_relaxed);
+		timings[phase][2 + bucket].fetch_add(1, std::memory_order_relaxed);
+	}
+
+}
+
+extern "C" {
+
+	void randomx_set_timing(bool enabled) {
+		if (enabled && !randomx::timingEnabled.load()) {
+			for (auto& timing : randomx::timings)
+				for (auto& value : timing)
+					value.store(0, std::memory_order_relaxed);
+		}
+		randomx::timingEnabled.store(enabled);
+	}
+
+	bool randomx_timing_enabled(void) {
+		return randomx::timingEnabled.load();
+	}
+
+	const char *randomx_timing_unit(void) {
+#		ifdef RANDOMX_TIMING_TSC
+		return "cycles";
+#		else
+		return "ns";
+#		endif
+	}
+
+	size_t randomx_get_timing(randomx_phase_timing *out, size_t count) {
+		count = std::min<size_t>(count, randomx::TimingPhaseCount);
+		for (size_t i = 0; i < count; ++i) {
+			out[i].phase = randomx::timingPhaseNames[i];
+			out[i].count = randomx::timings[i][0].load(std::memory_order_relaxed);
+			out[i].ticks = randomx::timings[i][1].load(std::memory_order_relaxed);
+			for (int j = 0; j < RANDOMX_TIMING_BUCKETS; ++j)
+				out[i].histogram[j] = randomx::timings[i][2 + j].load(std::memory_order_relaxed);
+		}
+		return randomx::TimingPhaseCount;
+	}
+
+}
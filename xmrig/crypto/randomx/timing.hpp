@@ -0,0 +1,58 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+#if defined(_M_X64) || defined(__x86_64__) || defined(_M_IX86) || defined(__i386__)
+#	ifdef _MSC_VER
+#		include <intrin.h>
+#	else
+#		include <x86intrin.h>
+#	endif
+#	define RANDOMX_TIMING_TSC
+#endif
+
+namespace randomx {
+
+	// Phases timed while randomx_set_timing() has turned timing on
+	enum TimingPhase {
+		TimingBlake2b,             // hashing the input (sipesh and k12 for DefyX) and the register files
+		TimingFillScratchpad,      // fillAes1Rx4
+		TimingGenerateProgram,     // fillAes4Rx4
+		TimingCompileProgram,      // JIT or bytecode compilation
+		TimingExecuteProgram,
+		TimingFinalize,            // hashAes1Rx4, together with the next fillAes1Rx4 when pipelined
+		TimingCacheInit,           // Argon2 fill of the cache
+		TimingSuperscalarGenerate, // generating the superscalar programs of a cache
+		TimingSuperscalarCompile,  // compiling them for dataset init, once per JIT cache
+		TimingSuperscalarVm,       // compiling them again in each light VM switching to the cache
+		TimingPhaseCount
+	};
+
+	extern std::atomic<bool> timingEnabled;
+
+	void recordTiming(TimingPhase phase, uint64_t ticks);
+
+#	ifdef RANDOMX_TIMING_TSC
+	inline uint64_t timingTicks() { return __rdtsc(); }
+#	else
+	uint64_t timingTicks();
+#	endif
+
+	// Records the time until the end of the scope, one relaxed load when timing is off
+	class TimingScope {
+	public:
+		explicit TimingScope(TimingPhase phase) : phase(phase), start(timingEnabled.load(std::memory_order_relaxed) ? timingTicks() : 0) {}
+		~TimingScope() {
+			if (start != 0)
+				recordTiming(phase, timingTicks() - start);
+		}
+
+	private:
+		TimingPhase phase;
+		uint64_t start;
+	};
+
+}
+
+#define RANDOMX_TIMED(phase, ...) do { randomx::TimingScope timingScope(randomx::phase); __VA_ARGS__; } while (0)
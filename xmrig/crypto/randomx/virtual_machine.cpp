@@ -78,7 +78,7 @@ void randomx_vm::initialize() {
 	store64(&reg.a[2].hi, randomx::getSmallPositiveFloatBits(program.getEntropy(5)));
 	store64(&reg.a[3].lo, randomx::getSmallPositiveFloatBits(program.getEntropy(6)));
 	store64(&reg.a[3].hi, randomx::getSmallPositiveFloatBits(program.getEntropy(7)));
-	mem.ma = program.getEntropy(8) & CacheLineAlignMask;
+	mem.ma = program.getEntropy(8) & rxConfig->CacheLineAlignMask_Calculated;
 	mem.mx = program.getEntropy(10);
 	auto addressRegisters = program.getEntropy(12);
 	config.readReg0 = 0 + (addressRegisters & 1);
@@ -88,7 +88,7 @@ void randomx_vm::initialize() {
 	config.readReg2 = 4 + (addressRegisters & 1);
 	addressRegisters >>= 1;
 	config.readReg3 = 6 + (addressRegisters & 1);
-	datasetOffset = (program.getEntropy(13) % (DatasetExtraItems + 1)) * randomx::CacheLineSize;
+	datasetOffset = (program.getEntropy(13) % (rxConfig->DatasetExtraItems_Calculated + 1)) * randomx::CacheLineSize;
 	store64(&config.eMask[0], randomx::getFloatMask(program.getEntropy(14)));
 	store64(&config.eMask[1], randomx::getFloatMask(program.getEntropy(15)));
 }
@@ -110,18 +110,24 @@ namespace randomx {
 
 	template<bool softAes>
 	void VmBase<softAes>::getFinalResult(void* out, size_t outSize) {
-		hashAes1Rx4<softAes>(scratchpad, ScratchpadSize, &reg.a);
+		hashAes1Rx4<softAes>(scratchpad, rxConfig->ScratchpadL3_Size, &reg.a);
         rx_blake2b(out, outSize, &reg, sizeof(RegisterFile), nullptr, 0);
 	}
 
+	template<bool softAes>
+	void VmBase<softAes>::hashAndFill(void* out, size_t outSize, uint64_t *fill_state) {
+		hashAndFillAes1Rx4<softAes>(scratchpad, rxConfig->ScratchpadL3_Size, &reg.a, fill_state);
+		rx_blake2b(out, outSize, &reg, sizeof(RegisterFile), nullptr, 0);
+	}
+
 	template<bool softAes>
 	void VmBase<softAes>::initScratchpad(void* seed) {
-		fillAes1Rx4<softAes>(seed, ScratchpadSize, scratchpad);
+		fillAes1Rx4<softAes>(seed, rxConfig->ScratchpadL3_Size, scratchpad);
 	}
 
 	template<bool softAes>
 	void VmBase<softAes>::generateProgram(void* seed) {
-		fillAes4Rx4<softAes>(seed, 128 + RandomX_CurrentConfig.ProgramSize * 8, &program);
+		fillAes4Rx4<softAes>(seed, 128 + rxConfig->ProgramSize * 8, &program, rxConfig->fillAes4Rx4_Key);
 	}
 
 	template class VmBase<false>;
@@ -39,6 +39,7 @@ public:
 	virtual ~randomx_vm() = 0;
 	virtual void setScratchpad(uint8_t *scratchpad) = 0;
 	virtual void getFinalResult(void* out, size_t outSize) = 0;
+	virtual void hashAndFill(void* out, size_t outSize, uint64_t *fill_state) = 0;
 	virtual void setDataset(randomx_dataset* dataset) { }
 	virtual void setCache(randomx_cache* cache) { }
 	virtual void initScratchpad(void* seed) = 0;
@@ -58,6 +59,12 @@ public:
 		return program;
 	}
 
+	const RandomX_ConfigurationBase& getConfig() const {
+		return *rxConfig;
+	}
+
+	alignas(16) uint64_t tempHash[8]; //state between randomx_calculate_hash_first/next calls
+
 protected:
 	void initialize();
 	alignas(64) randomx::Program program;
@@ -70,6 +77,7 @@ protected:
 		randomx_dataset* datasetPtr;
 	};
 	uint64_t datasetOffset;
+	const RandomX_ConfigurationBase* rxConfig = nullptr; //configuration of the cache/dataset
 };
 
 namespace randomx {
@@ -82,6 +90,7 @@ namespace randomx {
 		void setScratchpad(uint8_t *scratchpad) override;
 		void initScratchpad(void* seed) override;
 		void getFinalResult(void* out, size_t outSize) override;
+		void hashAndFill(void* out, size_t outSize, uint64_t *fill_state) override;
 
 	protected:
 		void generateProgram(void* seed);
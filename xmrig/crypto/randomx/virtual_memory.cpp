@@ -43,6 +43,16 @@ void* allocExecutableMemory(std::size_t bytes) {
 }
 
 
+void* allocDualMappedMemory(std::size_t bytes, void** writable) {
+    void *mem = xmrig::VirtualMemory::allocateDualMappedMemory(bytes, writable);
+    if (mem == nullptr) {
+        throw std::runtime_error("Failed to allocate executable memory");
+    }
+
+    return mem;
+}
+
+
 void* allocLargePagesMemory(std::size_t bytes) {
     void *mem = xmrig::VirtualMemory::allocateLargePagesMemory(bytes);
     if (mem == nullptr) {
@@ -56,3 +66,8 @@ void* allocLargePagesMemory(std::size_t bytes) {
 void freePagedMemory(void* ptr, std::size_t bytes) {
     xmrig::VirtualMemory::freeLargePagesMemory(ptr, bytes);
 }
+
+
+void freeDualMappedMemory(void* ptr, void* writable, std::size_t bytes) {
+    xmrig::VirtualMemory::freeDualMappedMemory(ptr, writable, bytes);
+}
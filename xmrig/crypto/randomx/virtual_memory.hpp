@@ -31,5 +31,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <cstddef>
 
 void* allocExecutableMemory(std::size_t);
+void* allocDualMappedMemory(std::size_t, void** writable);
 void* allocLargePagesMemory(std::size_t);
 void freePagedMemory(void*, std::size_t);
+void freeDualMappedMemory(void*, void* writable, std::size_t);
@@ -28,6 +28,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "crypto/randomx/vm_compiled.hpp"
 #include "crypto/randomx/common.hpp"
+#include "crypto/randomx/timing.hpp"
 
 namespace randomx {
 
@@ -37,15 +38,17 @@ namespace randomx {
 	template<bool softAes>
 	void CompiledVm<softAes>::setDataset(randomx_dataset* dataset) {
 		datasetPtr = dataset;
+		rxConfig = dataset->config;
+		compiler.setConfig(*rxConfig);
 	}
 
 	template<bool softAes>
 	void CompiledVm<softAes>::run(void* seed) {
-		VmBase<softAes>::generateProgram(seed);
+		RANDOMX_TIMED(TimingGenerateProgram, VmBase<softAes>::generateProgram(seed));
 		randomx_vm::initialize();
-		compiler.generateProgram(program, config);
+		RANDOMX_TIMED(TimingCompileProgram, compiler.generateProgram(program, config));
 		mem.memory = datasetPtr->memory + datasetOffset;
-		execute();
+		RANDOMX_TIMED(TimingExecuteProgram, execute());
 	}
 
 	template<bool softAes>
@@ -53,7 +56,7 @@ namespace randomx {
 #ifdef XMRIG_ARM
 		memcpy(reg.f, config.eMask, sizeof(config.eMask));
 #endif
-		compiler.getProgramFunc()(reg, mem, scratchpad, RandomX_CurrentConfig.ProgramIterations);
+		compiler.getProgramFunc()(reg, mem, scratchpad, rxConfig->ProgramIterations);
 	}
 
 	template class CompiledVm<false>;
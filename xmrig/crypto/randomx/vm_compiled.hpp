@@ -62,6 +62,7 @@ namespace randomx {
 		using VmBase<softAes>::scratchpad;
 		using VmBase<softAes>::datasetPtr;
 		using VmBase<softAes>::datasetOffset;
+		using VmBase<softAes>::rxConfig;
 
 	protected:
 		void execute();
@@ -28,6 +28,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "crypto/randomx/vm_compiled_light.hpp"
 #include "crypto/randomx/common.hpp"
+#include "crypto/randomx/timing.hpp"
+#include <cassert>
 #include <stdexcept>
 
 namespace randomx {
@@ -35,16 +37,31 @@ namespace randomx {
 	template<bool softAes>
 	void CompiledLightVm<softAes>::setCache(randomx_cache* cache) {
 		cachePtr = cache;
+		rxConfig = cache->config;
 		mem.memory = cache->memory;
-		compiler.generateSuperscalarHash(cache->programs, cache->reciprocalCache);
+		compiler.setConfig(*rxConfig);
+		RANDOMX_TIMED(TimingSuperscalarVm, compiler.generateSuperscalarHash(cache->programs, cache->reciprocalCache));
+		partialDataset = nullptr;
+	}
+
+	template<bool softAes>
+	void CompiledLightVm<softAes>::setDataset(randomx_dataset* dataset) {
+		assert(cachePtr != nullptr && dataset->config == cachePtr->config);
+		partialDataset = dataset;
 	}
 
 	template<bool softAes>
 	void CompiledLightVm<softAes>::run(void* seed) {
-		VmBase<softAes>::generateProgram(seed);
+		RANDOMX_TIMED(TimingGenerateProgram, VmBase<softAes>::generateProgram(seed));
 		randomx_vm::initialize();
-		compiler.generateProgramLight(program, config, datasetOffset);
-		CompiledVm<softAes>::execute();
+		{
+			TimingScope timing(TimingCompileProgram);
+			if (partialDataset != nullptr)
+				compiler.generateProgramLight(program, config, datasetOffset, partialDataset->memory, partialDataset->itemCount);
+			else
+				compiler.generateProgramLight(program, config, datasetOffset, nullptr, 0);
+		}
+		RANDOMX_TIMED(TimingExecuteProgram, CompiledVm<softAes>::execute());
 	}
 
 	template class CompiledLightVm<false>;
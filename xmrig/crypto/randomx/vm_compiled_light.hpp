@@ -49,7 +49,7 @@ namespace randomx {
 		}
 
 		void setCache(randomx_cache* cache) override;
-		void setDataset(randomx_dataset* dataset) override { }
+		void setDataset(randomx_dataset* dataset) override;
 		void run(void* seed) override;
 
 		using CompiledVm<softAes>::mem;
@@ -58,6 +58,10 @@ namespace randomx {
 		using CompiledVm<softAes>::config;
 		using CompiledVm<softAes>::cachePtr;
 		using CompiledVm<softAes>::datasetOffset;
+		using CompiledVm<softAes>::rxConfig;
+
+	protected:
+		randomx_dataset* partialDataset = nullptr; //items below its itemCount are read, not computed
 	};
 
 	using CompiledLightVmDefault = CompiledLightVm<true>;
@@ -30,18 +30,20 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "crypto/randomx/dataset.hpp"
 #include "crypto/randomx/intrin_portable.h"
 #include "crypto/randomx/reciprocal.h"
+#include "crypto/randomx/timing.hpp"
 
 namespace randomx {
 
 	template<bool softAes>
 	void InterpretedVm<softAes>::setDataset(randomx_dataset* dataset) {
 		datasetPtr = dataset;
+		rxConfig = dataset->config;
 		mem.memory = dataset->memory;
 	}
 
 	template<bool softAes>
 	void InterpretedVm<softAes>::run(void* seed) {
-		VmBase<softAes>::generateProgram(seed);
+		RANDOMX_TIMED(TimingGenerateProgram, VmBase<softAes>::generateProgram(seed));
 		randomx_vm::initialize();
 		execute();
 	}
@@ -54,17 +56,21 @@ namespace randomx {
 		for(unsigned i = 0; i < RegisterCountFlt; ++i)
 			nreg.a[i] = rx_load_vec_f128(&reg.a[i].lo);
 
-		compileProgram(program, bytecode, nreg);
+		RANDOMX_TIMED(TimingCompileProgram, compileProgram(program, bytecode, nreg, *rxConfig));
+		TimingScope timing(TimingExecuteProgram);
+
+		const uint32_t scratchpadL3Mask64 = rxConfig->ScratchpadL3Mask64_Calculated;
+		const uint32_t cacheLineAlignMask = rxConfig->CacheLineAlignMask_Calculated;
 
 		uint32_t spAddr0 = mem.mx;
 		uint32_t spAddr1 = mem.ma;
 
-		for(unsigned ic = 0; ic < RandomX_CurrentConfig.ProgramIterations; ++ic) {
+		for(unsigned ic = 0; ic < rxConfig->ProgramIterations; ++ic) {
 			uint64_t spMix = nreg.r[config.readReg0] ^ nreg.r[config.readReg1];
 			spAddr0 ^= spMix;
-			spAddr0 &= ScratchpadL3Mask64;
+			spAddr0 &= scratchpadL3Mask64;
 			spAddr1 ^= spMix >> 32;
-			spAddr1 &= ScratchpadL3Mask64;
+			spAddr1 &= scratchpadL3Mask64;
 			
 			for (unsigned i = 0; i < RegistersCount; ++i)
 				nreg.r[i] ^= load64(scratchpad + spAddr0 + 8 * i);
@@ -75,10 +81,10 @@ namespace randomx {
 			for (unsigned i = 0; i < RegisterCountFlt; ++i)
 				nreg.e[i] = maskRegisterExponentMantissa(config, rx_cvt_packed_int_vec_f128(scratchpad + spAddr1 + 8 * (RegisterCountFlt + i)));
 
-			executeBytecode(bytecode, scratchpad, config);
+			executeBytecode(bytecode, scratchpad, config, rxConfig->ProgramSize);
 
 			mem.mx ^= nreg.r[config.readReg2] ^ nreg.r[config.readReg3];
-			mem.mx &= CacheLineAlignMask;
+			mem.mx &= cacheLineAlignMask;
 			datasetPrefetch(datasetOffset + mem.mx);
 			datasetRead(datasetOffset + mem.ma, nreg.r);
 			std::swap(mem.mx, mem.ma);
@@ -48,6 +48,7 @@ namespace randomx {
 		using VmBase<softAes>::reg;
 		using VmBase<softAes>::datasetPtr;
 		using VmBase<softAes>::datasetOffset;
+		using VmBase<softAes>::rxConfig;
 
 		void* operator new(size_t size) {
 			void* ptr = AlignedAllocator<CacheLineSize>::allocMemory(size);
@@ -70,7 +71,7 @@ namespace randomx {
 	private:
 		void execute();
 
-		InstructionByteCode bytecode[RANDOMX_PROGRAM_MAX_SIZE];
+		InstructionByteCode bytecode[RANDOMX_PROGRAM_MAX_SIZE + 1];
 	};
 
 	using InterpretedVmDefault = InterpretedVm<true>;
@@ -28,18 +28,35 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #include "crypto/randomx/vm_interpreted_light.hpp"
 #include "crypto/randomx/dataset.hpp"
+#include "crypto/randomx/intrin_portable.h"
+#include <cassert>
 
 namespace randomx {
 
 	template<bool softAes>
 	void InterpretedLightVm<softAes>::setCache(randomx_cache* cache) {
 		cachePtr = cache;
+		rxConfig = cache->config;
 		mem.memory = cache->memory;
+		partialDataset = nullptr;
+	}
+
+	template<bool softAes>
+	void InterpretedLightVm<softAes>::setDataset(randomx_dataset* dataset) {
+		assert(cachePtr != nullptr && dataset->config == cachePtr->config);
+		partialDataset = dataset;
 	}
 
 	template<bool softAes>
 	void InterpretedLightVm<softAes>::datasetRead(uint64_t address, int_reg_t(&r)[8]) {
 		uint32_t itemNumber = address / CacheLineSize;
+		if (partialDataset != nullptr && itemNumber < partialDataset->itemCount) {
+			uint64_t* datasetLine = (uint64_t*)(partialDataset->memory + itemNumber * CacheLineSize);
+			for (unsigned q = 0; q < 8; ++q)
+				r[q] ^= datasetLine[q];
+			return;
+		}
+
 		int_reg_t rl[8];
 		
 		initDatasetItem(cachePtr, (uint8_t*)rl, itemNumber);
@@ -48,6 +65,13 @@ namespace randomx {
 			r[q] ^= rl[q];
 	}
 
+	template<bool softAes>
+	void InterpretedLightVm<softAes>::datasetPrefetch(uint64_t address) {
+		uint32_t itemNumber = address / CacheLineSize;
+		if (partialDataset != nullptr && itemNumber < partialDataset->itemCount)
+			rx_prefetch_nta(partialDataset->memory + itemNumber * CacheLineSize);
+	}
+
 	template class InterpretedLightVm<false>;
 	template class InterpretedLightVm<true>;
 }
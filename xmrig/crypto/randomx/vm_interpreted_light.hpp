@@ -38,6 +38,7 @@ namespace randomx {
 	public:
 		using VmBase<softAes>::mem;
 		using VmBase<softAes>::cachePtr;
+		using VmBase<softAes>::rxConfig;
 
 		void* operator new(size_t size) {
 			void* ptr = AlignedAllocator<CacheLineSize>::allocMemory(size);
@@ -50,12 +51,14 @@ namespace randomx {
 			AlignedAllocator<CacheLineSize>::freeMemory(ptr, sizeof(InterpretedLightVm));
 		}
 
-		void setDataset(randomx_dataset* dataset) override { }
+		void setDataset(randomx_dataset* dataset) override;
 		void setCache(randomx_cache* cache) override;
 
 	protected:
 		void datasetRead(uint64_t address, int_reg_t(&r)[8]) override;
-		void datasetPrefetch(uint64_t address) override { }
+		void datasetPrefetch(uint64_t address) override;
+
+		randomx_dataset* partialDataset = nullptr; //items below its itemCount are read, not computed
 	};
 
 	using InterpretedLightVmDefault = InterpretedLightVm<true>;